@@ -0,0 +1,107 @@
+// ICU-layer throughput against thread count, for NFKC + lowercase
+// (UnicodeNormalizer), strip_accents (transliterator) and segment_words
+// (break iterator) on the same mixed-script text. Nothing is locked per
+// call, so aggregate MB/s should grow with the thread count until the cores
+// run out. The multiplier is relative to one thread.
+//
+// Build against the library sources and ICU, e.g.
+//   g++ -std=c++17 -O2 -Iinclude benchmarks/bench_icu_threads.cpp src/unicode_normalizer.cpp \
+//       src/icu_utils.cpp $(pkg-config --libs icu-uc icu-i18n) -lpthread -o bench_icu_threads
+// Usage: bench_icu_threads [max_threads] [iterations]   (per thread; the faster
+// workloads run a fixed multiple of it)
+
+#include "icu_utils.h"
+#include "unicode_normalizer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace auratokenizer;
+
+namespace {
+
+std::string sample_text() {
+    const std::string unit =
+        "Fran\xC3\xA7ois a mang\xC3\xA9 une CR\xC3\x88ME br\xC3\xBBl\xC3\xA9" "e. "
+        "\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82, \xD0\xBC\xD0\xB8\xD1\x80! "
+        "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E\xE3\x81\xAE\xE6\x96\x87\xE7\xAB\xA0\xE3\x80\x82 "
+        "The quick brown fox jumps over the lazy dog. ";
+    std::string text;
+    while (text.size() < 2048) text += unit;
+    return text;
+}
+
+// Runs work(text) iterations times on each of threads threads, started together.
+template <typename Work>
+double run(unsigned threads, int iterations, const std::string& text, Work work) {
+    std::atomic<size_t> sink{ 0 };
+    std::atomic<unsigned> ready{ 0 };
+    std::atomic<bool> go{ false };
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            size_t local = 0;
+            ++ready;
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (int i = 0; i < iterations; ++i) local += work(text);
+            sink += local;
+        });
+    }
+    while (ready.load() < threads) std::this_thread::yield();
+    const auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread& worker : workers) worker.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (sink.load() == 0) std::printf("(empty)\n");
+    return static_cast<double>(text.size()) * iterations * threads / seconds / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const unsigned max_threads = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1]))
+                                          : std::max(1u, std::thread::hardware_concurrency());
+    const int iterations = argc > 2 ? std::atoi(argv[2]) : 200;
+    const std::string text = sample_text();
+
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NFKC;
+    config.lowercase = true;
+    const UnicodeNormalizer normalizer(config);  // normalize_into is const and thread-safe
+
+    using icu_utils::ICUUtils;
+    auto normalize = [&](const std::string& in) {
+        thread_local std::string out;
+        normalizer.normalize_into(in, out);
+        return out.size();
+    };
+    auto strip = [](const std::string& in) { return ICUUtils::strip_accents(in).size(); };
+    auto words = [](const std::string& in) { return ICUUtils::segment_words(in).size(); };
+
+    // Build the shared ICU data and prototypes before timing anything.
+    run(1, 1, text, normalize);
+    run(1, 1, text, strip);
+    run(1, 1, text, words);
+
+    std::printf("%8s %18s %18s %18s\n", "threads", "nfkc+lower MB/s", "strip_accents MB/s", "segment_words MB/s");
+    double base[3] = { 0.0, 0.0, 0.0 };
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        const double mbps[3] = { run(threads, iterations * 20, text, normalize),
+                                 run(threads, iterations, text, strip),
+                                 run(threads, iterations * 4, text, words) };
+        std::printf("%8u", threads);
+        for (int k = 0; k < 3; ++k) {
+            if (threads == 1) base[k] = mbps[k];
+            std::printf(" %10.1f (%4.1fx)", mbps[k], mbps[k] / base[k]);
+        }
+        std::printf("\n");
+        if (threads < max_threads && threads * 2 > max_threads) threads = max_threads / 2;
+    }
+    return 0;
+}
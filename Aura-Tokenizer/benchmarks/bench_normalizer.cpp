@@ -0,0 +1,78 @@
+// Normalization throughput: ICUUtils::normalize (ASCII scan and quick-check
+// fast paths) against the plain whole-string ICU round trip, on ASCII,
+// Latin-1 and CJK text.
+//
+// Build against the library sources and ICU, e.g.
+//   g++ -std=c++17 -O2 -Iinclude benchmarks/bench_normalizer.cpp src/icu_utils.cpp \
+//       $(pkg-config --libs icu-uc icu-i18n) -o bench_normalizer
+// Usage: bench_normalizer [iterations]
+
+#include "icu_utils.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace auratokenizer;
+
+namespace {
+
+std::string full_round_trip(const std::string& text, const icu::Normalizer2* normalizer) {
+    UErrorCode status = U_ZERO_ERROR;
+    icu::UnicodeString out;
+    normalizer->normalize(icu::UnicodeString::fromUTF8(text), out, status);
+    std::string result;
+    out.toUTF8String(result);
+    return result;
+}
+
+std::string repeat(const std::string& unit, size_t bytes) {
+    std::string text;
+    while (text.size() < bytes) text += unit;
+    return text;
+}
+
+template <typename Fn>
+double mb_per_second(const std::string& text, int iterations, Fn&& fn) {
+    size_t sink = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) sink += fn(text).size();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (sink == 0) std::printf("(empty)\n");
+    return static_cast<double>(text.size()) * iterations / seconds / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 2000;
+    UErrorCode status = U_ZERO_ERROR;
+    const icu::Normalizer2* nfkc = icu::Normalizer2::getNFKCInstance(status);
+    if (U_FAILURE(status)) return 1;
+
+    struct Input {
+        const char* name;
+        std::string text;
+    };
+    const Input inputs[] = {
+        { "ascii", repeat("The quick brown fox jumps over the lazy dog. ", 4096) },
+        { "latin-1", repeat("Fran\xC3\xA7ois a mang\xC3\xA9 une cr\xC3\xA8me br\xC3\xBBl\xC3\xA9" "e. ", 4096) },
+        { "cjk", repeat("\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E\xE3\x81\xAE\xE6\x96\x87\xE7\xAB\xA0\xE3\x80\x82", 4096) },
+        { "latin-1 nfd", repeat("Cafe\xCC\x81 cre\xCC\x80me ", 4096) },
+    };
+
+    std::printf("%-12s %12s %12s %8s\n", "input", "full MB/s", "fast MB/s", "speedup");
+    for (const Input& input : inputs) {
+        if (icu_utils::ICUUtils::normalize(input.text, NormalizationForm::NFKC) != full_round_trip(input.text, nfkc)) {
+            std::printf("%s: outputs differ\n", input.name);
+            return 1;
+        }
+        const double full = mb_per_second(input.text, iterations,
+            [&](const std::string& text) { return full_round_trip(text, nfkc); });
+        const double fast = mb_per_second(input.text, iterations,
+            [](const std::string& text) { return icu_utils::ICUUtils::normalize(text, NormalizationForm::NFKC); });
+        std::printf("%-12s %12.1f %12.1f %7.1fx\n", input.name, full, fast, fast / full);
+    }
+    return 0;
+}
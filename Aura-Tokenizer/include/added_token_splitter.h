@@ -0,0 +1,68 @@
+#pragma once
+
+#include "double_array_trie.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace auratokenizer {
+
+    /**
+     * @struct AddedToken
+     * @brief A literal string matched in raw text before normalization and the model.
+     */
+    struct AddedToken {
+        std::string content;
+        int  id = -1;
+        bool special = true;        // reported as a special token in EncodeBuffer::special
+        bool lstrip = false;        // absorb whitespace to the left into the match
+        bool rstrip = false;        // absorb whitespace to the right into the match
+        bool single_word = false;   // only match when not inside a word
+    };
+
+    /**
+     * @class AddedTokenSplitter
+     * @brief Cuts text into added-token spans and ordinary spans in one pass.
+     *
+     * All token strings are compiled into a DoubleArrayTrie with Aho-Corasick
+     * failure links. The scan reports the leftmost match, preferring the
+     * longest one when several start at the same byte, which is the same
+     * resolution as trying every token at each position in turn.
+     */
+    class AddedTokenSplitter {
+    public:
+        /**
+         * @brief One piece of the split. id is -1 for ordinary text.
+         */
+        struct Segment {
+            size_t begin;
+            size_t end;
+            int    id;
+            bool   special;
+        };
+
+        /**
+         * @brief Compile the automaton; replaces any previous tokens.
+         * Empty strings are ignored; for duplicate contents the last entry wins.
+         */
+        void build(const std::vector<AddedToken>& tokens);
+
+        /**
+         * @brief Split text into consecutive segments covering all of it.
+         * @param text Raw input text.
+         * @param out Destination (cleared first).
+         */
+        void split(std::string_view text, std::vector<Segment>& out) const;
+
+        bool empty() const { return tokens_.empty(); }
+        const std::vector<AddedToken>& tokens() const { return tokens_; }
+
+    private:
+        std::vector<AddedToken> tokens_;
+        DoubleArrayTrie trie_;    // values index tokens_
+
+        bool accept(const AddedToken& token, std::string_view text, size_t begin, size_t end) const;
+    };
+
+} // namespace auratokenizer
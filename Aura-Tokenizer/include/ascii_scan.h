@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AURA_ASCII_SCAN_SSE2 1
+#endif
+
+namespace auratokenizer {
+
+    /**
+     * @brief Length of the all-ASCII prefix of [p, p + n).
+     * Checks 16 bytes per step with SSE2 where available, else 8 per step.
+     */
+    inline size_t ascii_prefix_length(const char* p, size_t n) {
+        size_t i = 0;
+#ifdef AURA_ASCII_SCAN_SSE2
+        for (; i + 16 <= n; i += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            if (_mm_movemask_epi8(block) != 0) break;
+        }
+#endif
+        for (; i + 8 <= n; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, p + i, sizeof(word));
+            if (word & 0x8080808080808080ULL) break;
+        }
+        while (i < n && static_cast<unsigned char>(p[i]) < 0x80) ++i;
+        return i;
+    }
+
+    inline bool is_ascii(std::string_view text) {
+        return ascii_prefix_length(text.data(), text.size()) == text.size();
+    }
+
+}
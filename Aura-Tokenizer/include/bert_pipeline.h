@@ -0,0 +1,76 @@
+#pragma once
+
+#include "encode_buffer.h"
+#include "tokenizer_config.h"
+#include "wordpiece_model.h"
+
+#include <functional>
+#include <string_view>
+
+namespace auratokenizer {
+
+    /**
+     * @struct BertOptions
+     * @brief Switches of BERT's BasicTokenizer / BertNormalizer.
+     */
+    struct BertOptions {
+        bool clean_text = true;            // drop NUL, U+FFFD and control characters
+        bool handle_chinese_chars = true;  // every CJK ideograph is its own word
+        bool strip_accents = true;         // NFD, then drop non-spacing marks
+        bool lowercase = true;
+    };
+
+    /**
+     * @brief BERT options implied by a tokenizer config: clean_text,
+     * lowercase and strip_accents as configured; strip_accents_with_lowercase
+     * makes lowercase imply accent stripping, as in HF's uncased BERT.
+     */
+    BertOptions bert_options(const TokenizerConfig& config);
+
+    /**
+     * @brief Options that only split, like BertPreTokenizer on its own:
+     * whitespace ends a word and punctuation is a word of its own. Nothing
+     * is dropped or mapped, so words are the input's own bytes.
+     */
+    BertOptions split_only_options();
+
+    /**
+     * @class BertPipeline
+     * @brief Fused BERT normalization, pre-tokenization and WordPiece.
+     *
+     * One pass over the UTF-8 input does what BertNormalizer, the
+     * BertPreTokenizer and WordPiece do in three: each character is cleaned,
+     * lowercased and stripped of accents, whitespace ends the current word,
+     * punctuation and CJK ideographs become words of their own, and every
+     * finished word goes straight to the WordPiece matcher. ASCII and the
+     * two-byte UTF-8 range are served from precomputed tables; only rarer
+     * characters reach ICU.
+     *
+     * Offsets are byte ranges of the original input, so a piece produced
+     * from a normalized character still points at that character.
+     */
+    class BertPipeline {
+    public:
+        BertPipeline(const models::WordPieceModel& model, const BertOptions& options)
+            : model_(model), options_(options) {
+        }
+
+        /**
+         * @brief Append the pieces of text to out.
+         * @param unk_id Id pushed for unknown words, flagged as special.
+         */
+        void encode(std::string_view text, int unk_id, EncodeBuffer& out) const;
+
+        /**
+         * @brief Run only the normalization and splitting, e.g. to count
+         * training words exactly as encode() would see them.
+         */
+        static void split_words(std::string_view text, const BertOptions& options,
+            const std::function<void(std::string_view word)>& on_word);
+
+    private:
+        const models::WordPieceModel& model_;
+        BertOptions options_;
+    };
+
+} // namespace auratokenizer
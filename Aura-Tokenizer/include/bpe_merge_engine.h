@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace auratokenizer {
+
+    /**
+     * @class BPEMergeEngine
+     * @brief Applies ranked BPE merge rules to a word using integer symbols.
+     *
+     * Every string that can appear while merging (the 256 single bytes plus the
+     * left, right and merged side of each rule) is interned once into a symbol
+     * ID. Merge ranks live in an open-addressing table keyed by the packed
+     * 64-bit (left, right) symbol pair. A word is merged as a doubly linked
+     * symbol list driven by a min-heap of candidate pairs ordered by
+     * (rank, position), which reproduces the "lowest rank, leftmost first"
+     * result of the naive rescanning loop in O(n log n).
+     *
+     * The per-word workspace is thread-local, so after warm-up merging a word
+     * performs no heap allocations. A built engine is immutable and can be
+     * shared between threads.
+     */
+    class BPEMergeEngine {
+    public:
+        BPEMergeEngine();
+
+        /**
+         * @brief Rebuild the symbol table and pair table from merge rules.
+         * @param merges Merge rules in priority order (index = rank). If a pair
+         *        occurs more than once the last occurrence wins.
+         * @param byte_level If true, rules are written in the GPT-2 byte-level
+         *        alphabet (e.g. "Ġ" for a space). They are matched against raw
+         *        word bytes, and symbol_text() returns the byte-level form.
+         */
+        void build(const std::vector<std::pair<std::string, std::string>>& merges, bool byte_level = false);
+
+        /**
+         * @brief Drop all merge rules, keeping only the 256 byte symbols.
+         */
+        void clear();
+
+        /**
+         * @brief Merge a word and append the resulting symbol IDs to out.
+         * @param word Raw bytes of the word.
+         * @param out Destination for symbol IDs (not cleared).
+         */
+        void merge_word(std::string_view word, std::vector<uint32_t>& out) const;
+
+        /**
+         * @brief Look up the merge rank and merged symbol for a pair.
+         * @return True if (left, right) is a merge rule.
+         */
+        bool find_merge(uint32_t left, uint32_t right, int32_t& rank, uint32_t& merged) const;
+
+        /**
+         * @brief Get the text of a symbol.
+         */
+        const std::string& symbol_text(uint32_t symbol) const { return symbols_[symbol]; }
+
+        /**
+         * @brief Get the number of input bytes a symbol covers.
+         */
+        uint32_t symbol_bytes(uint32_t symbol) const { return symbol_bytes_[symbol]; }
+
+        /**
+         * @brief Get the symbol ID of a raw byte string, or -1 if it was never interned.
+         */
+        int64_t symbol_id(const std::string& text) const;
+
+        size_t symbol_count() const { return symbols_.size(); }
+        size_t merge_count() const { return merge_count_; }
+        bool is_byte_level() const { return byte_level_; }
+
+        static constexpr uint32_t BYTE_SYMBOLS = 256;
+
+    private:
+        struct Slot {
+            uint64_t key;
+            int32_t  rank;      // -1 marks an empty slot
+            uint32_t merged;
+        };
+
+        std::vector<std::string> symbols_;
+        std::vector<uint32_t> symbol_bytes_;
+        std::unordered_map<std::string, uint32_t> symbol_ids_;
+        std::vector<Slot> table_;
+        uint64_t mask_;
+        size_t merge_count_;
+        bool byte_level_;
+
+        uint32_t intern(const std::string& text);
+        void insert_pair(uint32_t left, uint32_t right, int32_t rank, uint32_t merged);
+
+        static uint64_t pack(uint32_t left, uint32_t right) {
+            return (static_cast<uint64_t>(left) << 32) | right;
+        }
+        static uint64_t hash_key(uint64_t key) {
+            // splitmix64 finalizer: cheap and well distributed for packed pairs
+            key ^= key >> 30; key *= 0xbf58476d1ce4e5b9ULL;
+            key ^= key >> 27; key *= 0x94d049bb133111ebULL;
+            return key ^ (key >> 31);
+        }
+    };
+
+} // namespace auratokenizer
@@ -4,6 +4,10 @@
 #include "vocab.h"
 #include "unicode_normalizer.h"
 #include "bpe_trainer.h"
+#include "bpe_merge_engine.h"
+#include "bpe_word_cache.h"
+#include "byte_level.h"
+#include "added_token_splitter.h"
 
 #include <unordered_map>
 #include <vector>
@@ -64,6 +68,17 @@ namespace auratokenizer {
          * @return Vector of token IDs.
          */
         std::vector<int> encode_to_ids(const std::string& text) override;
+
+        /**
+         * @brief Encode text into a reusable buffer without per-call allocations.
+         *
+         * Word lookups go through the encode cache when it is enabled; cache
+         * misses allocate only for the new cache entry.
+         * @param text Input UTF-8 text.
+         * @param out Destination buffer (cleared first).
+         */
+        void encode_into(std::string_view text, EncodeBuffer& out) override;
+
         /**
          * @brief Decode a sequence of Token structs back to text.
          * @param tokens Vector of Token structs.
@@ -78,6 +93,13 @@ namespace auratokenizer {
          */
         std::string decode_from_ids(const std::vector<int>& ids);
 
+        /**
+         * @brief Create an incremental decoder; byte-level models decode to raw bytes.
+         * @param skip_special_tokens If true, special tokens produce no text.
+         * @return DecodeStream bound to the current vocabulary.
+         */
+        DecodeStream decode_stream(bool skip_special_tokens = false) const override;
+
         /**
          * @brief Save the tokenizer state to a file or folder.
          * @param path Output path.
@@ -102,6 +124,15 @@ namespace auratokenizer {
          */
         void add_special_tokens(const std::vector<std::string>& tokens);
 
+        /**
+         * @brief Add tokens matched verbatim in raw text, with per-token strip rules.
+         *
+         * Contents missing from the vocabulary are appended to it. Matches are cut
+         * out before normalization and never reach the merge engine.
+         * @param tokens Tokens to add; the id field is filled in from the vocabulary.
+         */
+        void add_tokens(const std::vector<AddedToken>& tokens);
+
         /**
          * @brief Get all special tokens.
          * @return Vector of special token strings.
@@ -145,17 +176,39 @@ namespace auratokenizer {
          */
         void set_merge_rules(const std::vector<std::string>& merges);
 
+        /**
+         * @brief Set the byte budget of the word-level encode cache.
+         * @param bytes Budget in bytes; 0 disables the cache.
+         */
+        void set_cache_capacity(size_t bytes);
+
+        /**
+         * @brief Drop all cached word encodings.
+         */
+        void clear_cache();
+
+        /**
+         * @brief Get hit/miss/eviction counters and current size of the encode cache.
+         * @return Snapshot of the cache statistics.
+         */
+        BPEWordCache::Stats get_cache_stats() const;
+
     private:
         UnicodeNormalizer normalizer_;
         std::shared_ptr<Vocab> vocab_;
         TokenizerConfig config_;
         std::unordered_map<SpecialTokenType, std::string> special_tokens_;
         std::vector<std::pair<std::string, std::string>> merge_rules_;
-        std::unordered_map<std::string, int> merge_ranks_;
+        BPEMergeEngine merge_engine_;
+        std::unique_ptr<BPEWordCache> cache_;
+        std::vector<AddedToken> added_tokens_;     // user-added, with strip rules
+        AddedTokenSplitter added_token_splitter_;  // special + added tokens
 
         void initialize_special_tokens();
-        std::vector<std::string> pre_tokenize(const std::string& text) const;
-        std::vector<Token> encode_bpe(const std::string& word) const;
+        void rebuild_added_tokens();
+        void encode_segments(std::string_view text, EncodeBuffer& out, std::vector<Token>* tokens);
+        void split_words(std::string_view text, std::vector<byte_level::Span>& words) const;
+        void encode_word(std::string_view word, std::vector<BPEWordCache::Piece>& pieces) const;
         void build_merge_ranks();
         std::string post_process_text(const std::string& text) const;
     };
@@ -3,6 +3,8 @@
 #include "tokenizer_config.h"
 #include "unicode_normalizer.h"
 #include "vocab.h"
+#include "corpus_reader.h"
+#include <cstdint>
 #include <vector>
 #include <unordered_map>
 #include <string>
@@ -11,6 +13,21 @@
 
 namespace auratokenizer {
 
+    /**
+     * @class BPETrainer
+     * @brief Learns BPE merge rules from a corpus.
+     *
+     * Words are pre-tokenized the same way BPETokenizer splits its input and
+     * stored once per distinct word as arrays of interned symbol IDs, starting
+     * from single bytes. Pair counts are kept incrementally: an inverted index
+     * maps each pair to the words containing it, so applying a merge rewrites
+     * only those words, and a lazily invalidated max-heap yields the next pair.
+     *
+     * The most frequent pair is merged first; ties go to the pair whose
+     * (left, right) texts compare lowest bytewise, so the merge list does not
+     * depend on hash-map iteration order. Training stops when the vocabulary
+     * reaches the requested size or no pair occurs min_frequency times.
+     */
     class BPETrainer {
     public:
         BPETrainer(const TokenizerConfig& config = TokenizerConfig());
@@ -21,13 +38,23 @@ namespace auratokenizer {
         void set_normalizer(const UnicodeNormalizer& norm);
 
         void train(const std::vector<std::string>& corpus, std::shared_ptr<Vocab> vocab, size_t vocab_size);
+
+        /**
+         * @brief Train on text files without loading them into memory.
+         * Files are memory-mapped and counted in parallel (see count_corpus_files).
+         */
         void train_from_file(const std::string& file_path, std::shared_ptr<Vocab> vocab);
         void train_from_files(const std::vector<std::string>& file_paths, std::shared_ptr<Vocab> vocab);
 
+        /**
+         * @brief Set the number of threads used to count training files; 0 = all cores.
+         */
+        void set_num_threads(size_t threads) { num_threads_ = threads; }
+
         const std::vector<std::pair<std::string, std::string>>& get_merge_rules() const {
             return merge_rules_;
         }
-        const std::unordered_map<std::string, int>& get_vocab_counts() const {
+        const CorpusCounts& get_vocab_counts() const {
             return word_counts_;
         }
 
@@ -36,28 +63,47 @@ namespace auratokenizer {
         size_t min_frequency_;
         size_t vocab_size_;
         UnicodeNormalizer normalizer_;
+        size_t num_threads_ = 0;
 
-        std::unordered_map<std::string, int> word_counts_;
+        CorpusCounts word_counts_;
 
-        struct Pair {
-            std::string first;
-            std::string second;
-            bool operator==(const Pair& other) const { return first == other.first && second == other.second; }
+        // A distinct pre-tokenized word as symbol IDs, weighted by its corpus count.
+        struct Word {
+            std::vector<uint32_t> symbols;
+            int64_t count;
         };
 
-        struct PairHash {
-            size_t operator()(const Pair& p) const { return std::hash<std::string>()(p.first) ^ (std::hash<std::string>()(p.second) << 1); }
+        struct PairEntry {
+            int64_t  count;
+            uint32_t left;
+            uint32_t right;
         };
 
-        std::unordered_map<Pair, int, PairHash> pair_counts_;
         std::vector<std::pair<std::string, std::string>> merge_rules_;
 
-        std::unordered_map<std::string, int> get_word_counts(const std::vector<std::string>& corpus);
-        void initialize_vocab(std::shared_ptr<Vocab> vocab, const std::unordered_map<std::string, int>& initial_vocab_counts);
-        void learn_bpe_merges(std::shared_ptr<Vocab> vocab);
+        // Training state, rebuilt by every train() call.
+        std::vector<std::string> symbols_;                         // raw bytes of each symbol
+        std::unordered_map<std::string, uint32_t> symbol_ids_;
+        std::vector<Word> words_;
+        std::unordered_map<uint64_t, int64_t> pair_counts_;
+        std::unordered_map<uint64_t, std::vector<uint32_t>> pair_words_;  // pair -> words containing it
+        std::vector<PairEntry> heap_;
+
+        CorpusCounts get_word_counts(const std::vector<std::string>& corpus) const;
+        void count_words(std::string_view text, CorpusCounts& counts) const;
+        void train_words(std::shared_ptr<Vocab> vocab, size_t vocab_size);
+        void initialize_vocab(std::shared_ptr<Vocab> vocab, const std::vector<int64_t>& byte_counts);
+        void learn_bpe_merges(std::shared_ptr<Vocab> vocab, size_t vocab_size);
 
-        std::unordered_map<Pair, int, PairHash> get_pair_counts(const std::unordered_map<std::string, int>& word_counts) const;
-        void merge_pair_counts(const std::string& first, const std::string& second, std::unordered_map<std::string, int>& word_counts, const Pair& best_pair, std::string& new_token);
+        uint32_t intern(const std::string& text);
+        std::string token_text(uint32_t symbol) const;
+        void push_pair(uint32_t left, uint32_t right);
+        bool heap_less(const PairEntry& a, const PairEntry& b) const;
+        void apply_merge(uint32_t left, uint32_t right, uint32_t merged);
+
+        static uint64_t pack(uint32_t left, uint32_t right) {
+            return (static_cast<uint64_t>(left) << 32) | right;
+        }
     };
 
 }
\ No newline at end of file
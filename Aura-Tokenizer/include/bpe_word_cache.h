@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace auratokenizer {
+
+    /**
+     * @class BPEWordCache
+     * @brief Bounded, sharded word -> token sequence cache for BPE encoding.
+     *
+     * Words are hashed to one of a fixed number of shards, each guarded by its
+     * own mutex, so concurrent encoders rarely contend. Each shard enforces an
+     * equal slice of the byte budget and evicts with the CLOCK (second chance)
+     * policy: a hit sets the entry's reference bit, and the clock hand clears
+     * bits until it finds an unreferenced victim.
+     *
+     * Counters are cumulative until reset_stats() and are updated with relaxed
+     * atomics; they are meant for sizing the cache, not for exact accounting.
+     */
+    class BPEWordCache {
+    public:
+        /**
+         * @brief One BPE piece of a cached word.
+         */
+        struct Piece {
+            int32_t  id;         // vocab ID (UNK already substituted)
+            uint32_t symbol;     // BPEMergeEngine symbol, used for the token text
+            bool     is_special;
+        };
+
+        struct Stats {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t evictions = 0;
+            size_t   entries = 0;
+            size_t   bytes = 0;
+            size_t   capacity_bytes = 0;
+        };
+
+        static constexpr size_t DEFAULT_SHARDS = 16;
+
+        /**
+         * @param capacity_bytes Total byte budget across all shards (0 disables).
+         * @param num_shards Number of independently locked shards.
+         */
+        explicit BPEWordCache(size_t capacity_bytes, size_t num_shards = DEFAULT_SHARDS);
+
+        BPEWordCache(const BPEWordCache&) = delete;
+        BPEWordCache& operator=(const BPEWordCache&) = delete;
+
+        /**
+         * @brief Copy the cached pieces of word into out.
+         * @return True on a hit; out is left untouched on a miss.
+         */
+        bool lookup(const std::string& word, std::vector<Piece>& out) const;
+
+        /**
+         * @brief Insert (or refresh) the pieces of a word, evicting as needed.
+         */
+        void insert(const std::string& word, const std::vector<Piece>& pieces);
+
+        /**
+         * @brief Remove all entries. Counters are kept.
+         */
+        void clear();
+
+        /**
+         * @brief Change the byte budget. Shrinking clears the cache.
+         *
+         * Not safe to call while other threads are using the cache.
+         */
+        void set_capacity(size_t capacity_bytes);
+        size_t capacity() const { return capacity_bytes_; }
+        bool enabled() const { return capacity_bytes_ > 0; }
+
+        Stats stats() const;
+        void reset_stats();
+
+    private:
+        struct Entry {
+            std::string        key;
+            std::vector<Piece> pieces;
+            size_t             bytes = 0;
+            bool               referenced = false;
+            bool               used = false;
+        };
+
+        struct Shard {
+            std::mutex mutex;
+            std::unordered_map<std::string, uint32_t> index;
+            std::vector<Entry> entries;
+            std::vector<uint32_t> free_slots;
+            size_t hand = 0;
+            size_t bytes = 0;
+        };
+
+        std::vector<std::unique_ptr<Shard>> shards_;
+        size_t capacity_bytes_;
+        size_t shard_capacity_;
+
+        mutable std::atomic<uint64_t> hits_;
+        mutable std::atomic<uint64_t> misses_;
+        std::atomic<uint64_t> evictions_;
+
+        Shard& shard_for(const std::string& word) const;
+        static size_t entry_bytes(const std::string& word, size_t num_pieces);
+        bool evict_one(Shard& shard);
+    };
+
+} // namespace auratokenizer
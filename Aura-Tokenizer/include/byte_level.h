@@ -0,0 +1,109 @@
+#pragma once
+
+#include "tokenizer_types.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace auratokenizer {
+    namespace byte_level {
+
+        // ─── Byte <-> unicode tables (GPT-2 bytes_to_unicode) ───
+        //
+        // Printable Latin-1 bytes map to themselves; the remaining 68 bytes
+        // (controls, space, DEL, NBSP, soft hyphen) are shifted to U+0100..U+0143
+        // in byte order, so every byte becomes a visible, non-whitespace char.
+
+        constexpr bool is_self_mapped(int b) {
+            return (b >= 0x21 && b <= 0x7E) || (b >= 0xA1 && b <= 0xAC) || (b >= 0xAE && b <= 0xFF);
+        }
+
+        constexpr std::array<uint16_t, 256> make_byte_to_unicode() {
+            std::array<uint16_t, 256> table{};
+            uint16_t shifted = 0;
+            for (int b = 0; b < 256; ++b) {
+                table[b] = is_self_mapped(b) ? static_cast<uint16_t>(b) : static_cast<uint16_t>(256 + shifted++);
+            }
+            return table;
+        }
+
+        constexpr size_t MAPPED_CODEPOINTS = 256 + 68;
+
+        constexpr std::array<int16_t, MAPPED_CODEPOINTS> make_unicode_to_byte() {
+            std::array<int16_t, MAPPED_CODEPOINTS> table{};
+            for (auto& v : table) v = -1;
+            std::array<uint16_t, 256> forward = make_byte_to_unicode();
+            for (int b = 0; b < 256; ++b) table[forward[b]] = static_cast<int16_t>(b);
+            return table;
+        }
+
+        /**
+         * UTF-8 encoding of the mapped codepoint for each byte (1 or 2 bytes).
+         */
+        struct MappedByte {
+            char    utf8[2];
+            uint8_t length;
+        };
+
+        constexpr std::array<MappedByte, 256> make_byte_to_utf8() {
+            std::array<MappedByte, 256> table{};
+            std::array<uint16_t, 256> forward = make_byte_to_unicode();
+            for (int b = 0; b < 256; ++b) {
+                uint16_t cp = forward[b];
+                if (cp < 0x80) {
+                    table[b] = MappedByte{ { static_cast<char>(cp), 0 }, 1 };
+                } else {
+                    table[b] = MappedByte{ { static_cast<char>(0xC0 | (cp >> 6)), static_cast<char>(0x80 | (cp & 0x3F)) }, 2 };
+                }
+            }
+            return table;
+        }
+
+        inline constexpr std::array<uint16_t, 256> BYTE_TO_UNICODE = make_byte_to_unicode();
+        inline constexpr std::array<int16_t, MAPPED_CODEPOINTS> UNICODE_TO_BYTE = make_unicode_to_byte();
+        inline constexpr std::array<MappedByte, 256> BYTE_TO_UTF8 = make_byte_to_utf8();
+
+        /**
+         * Append the byte-level (mapped) form of raw bytes to out.
+         */
+        void append_mapped(std::string_view bytes, std::string& out);
+
+        /**
+         * Map raw bytes to their byte-level unicode form ("hello world" -> "helloĠworld").
+         */
+        std::string to_unicode(std::string_view bytes);
+
+        /**
+         * Byte-level decoder: map byte-level unicode text back to raw bytes.
+         * Characters outside the mapping are copied through unchanged.
+         */
+        void append_unmapped(std::string_view mapped, std::string& out);
+        std::string from_unicode(std::string_view mapped);
+
+        // ─── Pre-tokenizer split scanners ───
+
+        struct Span {
+            size_t begin;
+            size_t end;
+        };
+
+        /**
+         * Split text into pre-tokens exactly as the split regex of the chosen
+         * pattern would, using a hand-written scanner instead of std::regex.
+         *
+         * GPT2:
+         *   's|'t|'re|'ve|'m|'ll|'d| ?\p{L}+| ?\p{N}+| ?[^\s\p{L}\p{N}]+|\s+(?!\S)|\s+
+         * CL100K / LLAMA3:
+         *   (?i:'s|'t|'re|'ve|'m|'ll|'d)|[^\r\n\p{L}\p{N}]?\p{L}+|\p{N}{1,3}|
+         *   ?[^\s\p{L}\p{N}]+[\r\n]*|\s*[\r\n]+|\s+(?!\S)|\s+
+         *
+         * Spans are appended to out as byte ranges of text. Invalid UTF-8
+         * bytes are treated as single punctuation characters.
+         */
+        void split(std::string_view text, ByteLevelPattern pattern, std::vector<Span>& out);
+
+    } // namespace byte_level
+} // namespace auratokenizer
@@ -6,6 +6,14 @@
 
 namespace auratokenizer {
 
+    /**
+     * @class ByteLevelPreTokenizer
+     * @brief Splits text with the GPT-2 / cl100k pattern and maps each piece to
+     *        the byte-level alphabet ("Ġworld" for " world").
+     *
+     * The split pattern is config.byte_level_pattern; config.add_prefix_space
+     * prepends a space so the first word is encoded like any other.
+     */
     class ByteLevelPreTokenizer : public PreTokenizer {
     public:
         explicit ByteLevelPreTokenizer(const TokenizerConfig& config);
@@ -4,12 +4,23 @@
 #include "vocab.h"
 #include "unicode_normalizer.h"
 
+#include <array>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <memory>
 
 namespace auratokenizer {
 
+/**
+ * CharLevelTokenizer
+ *
+ * One token per Unicode codepoint. Ids come from a direct 128-entry table for
+ * ASCII and a two-level page table (codepoint >> 8, then the low byte) for
+ * everything else, so no lookup hashes or allocates. Long ASCII runs are
+ * found 16 bytes at a time and converted in bulk. Characters missing from
+ * the vocab, and bytes that are not valid UTF-8, map to the unknown token.
+ */
 class CharLevelTokenizer : public TokenizerBase {
 public:
     explicit CharLevelTokenizer(const TokenizerConfig& config = TokenizerConfig());
@@ -17,9 +28,11 @@ public:
 
     std::vector<Token> encode(const std::string& text) override;
     std::vector<int> encode_to_ids(const std::string& text) override;
+    void encode_into(std::string_view text, EncodeBuffer& out) override;
 
     std::string decode(const std::vector<Token>& tokens) override;
     std::string decode_from_ids(const std::vector<int>& ids) override;
+    DecodeStream decode_stream(bool skip_special_tokens = false) const override;
 
     std::vector<std::vector<int>> batch_encode(const std::vector<std::string>& texts) override;
     std::vector<std::string> batch_decode(const std::vector<std::vector<int>>& ids_batch) override;
@@ -36,6 +49,7 @@ public:
 
     const TokenizerConfig& get_config() const override;
     void set_config(const TokenizerConfig& config) override;
+    /** Index vocab for encoding; call again after adding tokens to it. */
     void set_vocab(std::shared_ptr<Vocab> vocab) override;
 
 private:
@@ -43,7 +57,20 @@ private:
     std::shared_ptr<Vocab> vocab_;
     std::unordered_map<SpecialTokenType, std::string> special_tokens_;
 
+    // ─── Codepoint -> id tables, rebuilt by set_vocab(), set_config(), train()
+    //     and add_special_tokens(); encoding only reads them ───
+    std::array<int32_t, 128> ascii_ids_{};
+    std::array<uint8_t, 128> ascii_special_{};
+    std::vector<uint16_t> page_of_;     // codepoint >> 8 -> page number; page 0 is empty
+    std::vector<int32_t> pages_;        // 256 ids per page, -1 if not in the vocab
+    int unk_id_ = -1;
+    bool has_special_chars_ = false;    // some single-codepoint token is special
+
     void initialize_special_tokens();
+    void rebuild_char_tables();
+    int lookup(uint32_t codepoint) const;
+    // One token per character of input, offsets into input; appends to out.
+    void encode_chars(std::string_view input, EncodeBuffer& out);
 };
 
 } // namespace auratokenizer
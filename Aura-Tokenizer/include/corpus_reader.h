@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace auratokenizer {
+
+    /**
+     * @class MappedFile
+     * @brief Read-only memory mapping of a whole file (mmap / MapViewOfFile).
+     *
+     * Pages are loaded on demand by the OS, so mapping a file far larger than
+     * RAM costs address space only. Throws TokenizerException if the file
+     * cannot be opened or mapped.
+     */
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        std::string_view view() const { return std::string_view(data_, size_); }
+        size_t size() const { return size_; }
+
+    private:
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        void* file_ = nullptr;
+        void* mapping_ = nullptr;
+#endif
+
+        void release() noexcept;
+    };
+
+    using CorpusCounts = std::unordered_map<std::string, size_t>;
+
+    /**
+     * @brief Callback that counts one line into a worker-private map.
+     * Called concurrently from several threads, each with its own map.
+     */
+    using LineCounter = std::function<void(std::string_view line, CorpusCounts& counts)>;
+
+    /**
+     * @brief Count a set of text files on all cores.
+     *
+     * Each file is memory-mapped and cut into chunks of about chunk_bytes that
+     * end on a newline. Worker threads take chunks from a shared queue, call
+     * count_line for every non-empty line ("\r\n" endings are trimmed), and
+     * the per-worker maps are merged at the end. Memory use is bounded by the
+     * number of distinct keys, not by the corpus size.
+     *
+     * @param paths Files to read, in order.
+     * @param count_line Per-line counter; must be safe to call concurrently.
+     * @param num_threads Worker count; 0 uses std::thread::hardware_concurrency().
+     * @param chunk_bytes Target chunk size in bytes.
+     * @return Merged counts over all files.
+     */
+    CorpusCounts count_corpus_files(const std::vector<std::string>& paths,
+        const LineCounter& count_line,
+        size_t num_threads = 0,
+        size_t chunk_bytes = size_t(16) << 20);
+
+} // namespace auratokenizer
@@ -2,16 +2,49 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include <cstdint>
+#include <cstring>
+#include <memory>
+#include "flat_table.h"
 #include "tokenizer_exception.h" // For TokenizerException
 
 namespace auratokenizer {
 
+    class MappedFile;
+
+    /**
+     * @class DoubleArrayTrie
+     * @brief Byte-wise double-array trie over string keys with int32 values.
+     *
+     * The child of node s on byte c is t = base[s] + c, valid iff check[t] == s.
+     * build() places a sorted key set breadth-first, so every node's children
+     * are known when it is placed; insert() adds single keys and relocates a
+     * node's children when the slot it needs is taken. Free cells form a
+     * doubly linked list threaded through their own base/check fields, which
+     * is what the base search walks. During build() a free cell that has
+     * failed as a candidate MAX_TRIALS times leaves the list (it can still
+     * be taken as another label's slot), so the search skips dense regions
+     * and placement stays amortized linear; the list is whole again
+     * afterwards.
+     *
+     * With tail compression a key's unique suffix is stored once in a tail
+     * buffer instead of as a chain of single-child nodes; such a node has a
+     * negative base and tail() returns the rest of its key. Lookups handle
+     * tails; code that walks transition() byte by byte must build without
+     * them. After rebuild_fail_links() an uncompressed trie doubles as an
+     * Aho-Corasick automaton: next_state() follows failure links on a missing
+     * transition, and output_link() chains every key that ends at the current
+     * position.
+     *
+     * serialize() writes the node array and tail buffer behind a small
+     * header; view() and map_file() use such a blob in place.
+     */
     class DoubleArrayTrie {
     public:
         struct Node {
-            int32_t base;
-            int32_t check;
+            int32_t base;   // children at base + c; 0 = none; < 0 = tail (or free-list link)
+            int32_t check;  // parent, or < 0 for a free cell
             int32_t value;
 
             Node() : base(0), check(-1), value(-1) {}
@@ -25,40 +58,175 @@ namespace auratokenizer {
         DoubleArrayTrie(DoubleArrayTrie&&) noexcept = default;
         DoubleArrayTrie& operator=(DoubleArrayTrie&&) noexcept = default;
 
-        void build(const std::vector<std::pair<std::string, int32_t>>& entries);
-        int32_t find(const std::string& key) const;
+        /**
+         * @brief Build the trie from (key, value) pairs, replacing any contents.
+         * Empty keys are ignored; for duplicate keys the last value wins.
+         * @param compress_tails Store unique key suffixes in the tail buffer.
+         */
+        void build(const std::vector<std::pair<std::string, int32_t>>& entries, bool compress_tails = false);
+
+        /**
+         * @brief Add or update one key, relocating siblings as needed.
+         * Uses the tail mode of the last build(); fail links must be rebuilt afterwards.
+         */
+        void insert(std::string_view key, int32_t value);
+
+        /**
+         * @brief Exact lookup. Returns the key's value, or -1 if absent.
+         */
+        int32_t find(std::string_view key) const;
+
+        /**
+         * @brief Call on_match(length, value) for every key that is a prefix of
+         * text, shortest first. Does not allocate.
+         */
+        template <typename Fn>
+        void common_prefix_search(std::string_view text, Fn&& on_match) const {
+            int32_t node = ROOT_NODE;
+            for (size_t i = 0; i < text.size(); ) {
+                node = transition(node, static_cast<unsigned char>(text[i++]));
+                if (node == INVALID_NODE) return;
+                const Node& n = nodes_[node];
+                if (n.base < 0) {
+                    std::string_view rest = tail(node);
+                    if (text.size() - i >= rest.size() && std::memcmp(text.data() + i, rest.data(), rest.size()) == 0) {
+                        on_match(i + rest.size(), n.value);
+                    }
+                    return;
+                }
+                if (n.value >= 0) on_match(i, n.value);
+            }
+        }
+
         std::vector<std::pair<std::string, int32_t>> common_prefix_search(const std::string& key) const;
+        /** @brief Every (key, value) starting with prefix, in byte order. */
         std::vector<std::pair<std::string, int32_t>> predictive_search(const std::string& prefix) const;
+        /** @brief Rebuild from the current keys: densest layout, no stale tail bytes. */
         void optimize();
         void clear();
 
         size_t size() const;
         size_t capacity() const;
-
+        /** @brief Candidate bases tested since the last build() began; a small multiple of capacity(). */
+        size_t build_probes() const { return build_probes_; }
+        bool has_tails() const { return !tail_.empty(); }
+
+        /**
+         * @brief Compute depths and Aho-Corasick failure and output links (BFS over all nodes).
+         * Must be called after build() before using next_state()/output_link()/depth().
+         * Throws TokenizerException on a tail-compressed trie.
+         */
         void rebuild_fail_links();
+
+        // --- Node-level access for automaton scans ---
+        static constexpr int32_t root() { return ROOT_NODE; }
+
+        /**
+         * @brief Child of node on byte c, or -1 if there is none.
+         */
+        int32_t transition(int32_t node, unsigned char c) const {
+            int32_t target = nodes_[node].base + c;
+            if (target <= ROOT_NODE || target >= static_cast<int32_t>(nodes_.size())) return INVALID_NODE;
+            return nodes_[target].check == node ? target : INVALID_NODE;
+        }
+
+        /**
+         * @brief Aho-Corasick goto: follow failure links until byte c can be consumed.
+         */
+        int32_t next_state(int32_t node, unsigned char c) const {
+            while (true) {
+                int32_t target = transition(node, c);
+                if (target != INVALID_NODE) return target;
+                if (node == ROOT_NODE) return ROOT_NODE;
+                node = fail_links_[node];
+            }
+        }
+
+        /**
+         * @brief Value of the key ending at node, or -1. For a tail node this is
+         * the value of the whole key, node prefix plus tail().
+         */
+        int32_t value(int32_t node) const { return nodes_[node].value; }
+        int32_t depth(int32_t node) const { return depths_[node]; }
+
+        /**
+         * @brief Remaining key bytes stored for node; empty unless it is a tail node.
+         */
+        std::string_view tail(int32_t node) const {
+            int32_t base = nodes_[node].base;
+            if (base >= 0) return {};
+            const char* record = tail_.data() + (-1 - static_cast<int64_t>(base));
+            uint32_t length;
+            std::memcpy(&length, record, sizeof(length));
+            return std::string_view(record + sizeof(length), length);
+        }
+
+        /**
+         * @brief Nearest proper suffix state that ends a key, or -1.
+         */
+        int32_t output_link(int32_t node) const { return output_links_[node]; }
+        /** @brief Same as optimize(). */
         void compact();
+        /** @brief Drop free cells past the last used one. */
         void shrink_to_fit();
 
+        /**
+         * @brief Flat blob: header (magic, byte order, version, counts), then the
+         * node array and the tail buffer, each usable in place.
+         */
         std::vector<char> serialize() const;
+        /** @brief Copy a blob from serialize(), checking it with validate(). */
         void deserialize(const std::vector<char>& data);
-
+        void deserialize(const char* data, size_t size);
+        /**
+         * @brief Use a blob from serialize() in place. data must be 4-byte aligned
+         * and outlive the trie (or the next modification, which copies it).
+         * Only the header is checked.
+         */
+        void view(const char* data, size_t size);
+        /** @brief view() over a read-only mapping of a file holding one blob. */
+        void map_file(const std::string& path);
+
+        /** @brief Check parent links, tails and the free list; throws TokenizerException. */
         void validate() const;
         void print_stats() const;
 
     private:
-        std::vector<Node>    nodes_;
+        FlatTable<Node>      nodes_;
+        FlatTable<char>      tail_;         // per record: uint32 length, then bytes
         std::vector<int32_t> fail_links_;
-        std::vector<int32_t> free_list_;
+        std::vector<int32_t> output_links_;
+        std::vector<int32_t> depths_;
+        std::shared_ptr<const MappedFile> mapping_;
 
         size_t size_;
-        size_t capacity_;
+        int32_t free_head_;                 // first free cell, or -1
+        bool compress_tails_;
+        std::vector<uint8_t> trials_;       // failed base searches per free cell; only during build()
+        size_t build_probes_ = 0;
 
         static constexpr int32_t ROOT_NODE = 0;
         static constexpr int32_t INVALID_NODE = -1;
         static constexpr size_t INITIAL_CAPACITY = 1024;
-
-        int32_t find_base(const std::vector<unsigned char>& chars);
-        void resize(size_t new_capacity);
+        static constexpr uint8_t MAX_TRIALS = 16;
+
+        // Free cells store their list links as base = free_link(prev), check = free_link(next);
+        // the mapping is its own inverse. The root is never free, so a check of -1
+        // (a link to cell 0) marks a free cell that is not on the list.
+        static int32_t free_link(int32_t cell) { return -1 - cell; }
+
+        void grow(std::vector<Node>& cells, size_t new_capacity);
+        void link_free(std::vector<Node>& cells, int32_t cell);
+        void occupy(std::vector<Node>& cells, int32_t cell, int32_t parent);
+        void release(std::vector<Node>& cells, int32_t cell);
+        void unlink_free(std::vector<Node>& cells, int32_t cell);
+        int32_t find_base(std::vector<Node>& cells, const std::vector<unsigned char>& labels);
+        int32_t add_child(std::vector<Node>& cells, int32_t node, unsigned char c);
+        void set_tail(std::vector<Node>& cells, std::vector<char>& tails, int32_t node, std::string_view rest, int32_t value);
+        void expand_tail(std::vector<Node>& cells, std::vector<char>& tails, int32_t node);
+        void relink_free_cells(std::vector<Node>& cells);
+        void collect(int32_t node, std::string& key, std::vector<std::pair<std::string, int32_t>>& out) const;
+        void read_blob(const char* data, size_t size, bool copy);
     };
 
-}
\ No newline at end of file
+}
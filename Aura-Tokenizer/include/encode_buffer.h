@@ -0,0 +1,58 @@
+#pragma once
+
+#include "normalized_string.h"
+#include "tokenizer_types.h" // For OffsetMapping
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace auratokenizer {
+
+    /**
+     * @struct EncodeBuffer
+     * @brief Caller-owned, reusable output of TokenizerBase::encode_into.
+     *
+     * ids, offsets and special are parallel arrays with one entry per token.
+     * Offsets are byte ranges into the input as given, even when
+     * normalization rewrote it: tokenizers work on the copy held in
+     * normalized and map their offsets back through its alignment. A token
+     * from a character that changed covers that whole character ("fi" from
+     * U+FB01 covers its three bytes).
+     *
+     * clear() keeps every vector's capacity, so reusing one buffer per thread
+     * makes steady-state encoding free of heap allocations.
+     */
+    struct EncodeBuffer {
+        std::vector<int>           ids;
+        std::vector<OffsetMapping> offsets;
+        std::vector<uint8_t>       special;    // 1 if the token is a special token
+
+        // The normalized input and its alignment, owned by the buffer so
+        // tokenizers need not allocate.
+        NormalizedString           normalized;
+
+        void clear() {
+            ids.clear();
+            offsets.clear();
+            special.clear();
+            normalized.clear();
+        }
+
+        void reserve(size_t n) {
+            ids.reserve(n);
+            offsets.reserve(n);
+            special.reserve(n);
+        }
+
+        size_t size() const { return ids.size(); }
+        bool empty() const { return ids.empty(); }
+
+        void push(int id, size_t start, size_t end, bool is_special) {
+            ids.push_back(id);
+            offsets.push_back(OffsetMapping{ static_cast<int>(start), static_cast<int>(end) });
+            special.push_back(is_special ? 1 : 0);
+        }
+    };
+
+} // namespace auratokenizer
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace auratokenizer {
+
+    /**
+     * @class FlatTable
+     * @brief Array that either owns its elements or views external memory.
+     *
+     * Holds the read-mostly tables that can be served straight out of a
+     * mapped file. view() points the table at memory it does not own, which
+     * must outlive it; any modification first copies the viewed elements in.
+     */
+    template <typename T>
+    class FlatTable {
+    public:
+        FlatTable() = default;
+        FlatTable(const FlatTable& other) { *this = other; }
+        FlatTable(FlatTable&& other) noexcept { *this = std::move(other); }
+        FlatTable& operator=(const FlatTable& other) {
+            if (this == &other) return *this;
+            owned_ = other.owned_;
+            if (other.data_ == other.owned_.data()) sync();
+            else view(other.data_, other.size_);
+            return *this;
+        }
+        FlatTable& operator=(FlatTable&& other) noexcept {
+            if (this == &other) return *this;
+            owned_ = std::move(other.owned_);  // moving a vector keeps its buffer
+            data_ = other.data_;
+            size_ = other.size_;
+            other.owned_.clear();
+            other.sync();
+            return *this;
+        }
+
+        const T* data() const { return data_; }
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        const T& operator[](size_t i) const { return data_[i]; }
+        const T* begin() const { return data_; }
+        const T* end() const { return data_ + size_; }
+
+        void view(const T* data, size_t size) {
+            owned_.clear();
+            owned_.shrink_to_fit();
+            data_ = data;
+            size_ = size;
+        }
+        void clear() { owned_.clear(); sync(); }
+        void push_back(const T& value) { own(); owned_.push_back(value); sync(); }
+        void append(const T* values, size_t count) { own(); owned_.insert(owned_.end(), values, values + count); sync(); }
+        void resize(size_t count, const T& value) { own(); owned_.resize(count, value); sync(); }
+        void assign(size_t count, const T& value) { owned_.assign(count, value); sync(); }
+        void set(size_t i, const T& value) { own(); owned_[i] = value; }
+        void adopt(std::vector<T>&& values) { owned_ = std::move(values); sync(); }
+        // Move the elements out for bulk editing, leaving the table empty; pair with adopt().
+        std::vector<T> take() { own(); std::vector<T> values = std::move(owned_); owned_.clear(); sync(); return values; }
+        // Owned, writable elements; invalidated by any call that changes the size.
+        T* mutable_data() { own(); return owned_.data(); }
+
+    private:
+        std::vector<T> owned_;
+        const T* data_ = nullptr;
+        size_t size_ = 0;
+
+        void own() {
+            if (data_ != owned_.data()) owned_.assign(data_, data_ + size_);
+            sync();
+        }
+        void sync() {
+            data_ = owned_.data();
+            size_ = owned_.size();
+        }
+    };
+
+} // namespace auratokenizer
@@ -10,8 +10,10 @@
 #include <unicode/uscript.h>
 #include <unicode/utypes.h>
 #include <unicode/coll.h>
+#include <unicode/edits.h>
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <regex>
@@ -27,6 +29,13 @@ namespace auratokenizer {
             static std::string from_icu_string(const icu::UnicodeString& input);
             static std::string normalize(const std::string& input, NormalizationForm form);
             static std::string strip_accents(const std::string& input);
+            // Any Replaceable, so callers can follow the replacements the transliterator makes.
+            static void strip_accents(icu::Replaceable& text);
+            // UTF-8 in, UTF-8 out, with no UTF-16 copy; out is replaced.
+            // input must be well-formed UTF-8. edits, if given, receives the
+            // changes in input byte lengths.
+            static void normalize_utf8(std::string_view input, NormalizationForm form, std::string& out, icu::Edits* edits = nullptr);
+            static void to_lower_utf8(std::string_view input, std::string& out, icu::Edits* edits = nullptr);
             static bool is_whitespace(UChar32 c);
             static bool is_punctuation(UChar32 c);
             static bool is_cjk(UChar32 c);
@@ -37,6 +46,8 @@ namespace auratokenizer {
             static std::string to_title(const std::string& input);
             static std::vector<std::string> segment_characters(const std::string& input);
             static std::vector<std::string> segment_words(const std::string& input);
+            // Byte ranges of the segments segment_words() returns, found on the UTF-8 directly.
+            static std::vector<OffsetMapping> segment_word_spans(std::string_view input);
             static std::vector<std::string> segment_sentences(const std::string& input);
             static std::vector<std::string> segment_cjk(const std::string& input);
             static bool is_emoji_sequence(const std::string& input);
@@ -46,28 +57,16 @@ namespace auratokenizer {
             static bool is_url(const std::string& input);
             static bool is_email(const std::string& input);
             static std::string transliterate(const std::string& input, const std::string& rules);
-            static bool is_valid_utf8(const std::string& input);
+            static bool is_valid_utf8(std::string_view input);
             static bool is_valid_unicode(const std::string& input);
 
         private:
+            // Shared, immutable, owned by ICU; looked up once without locking afterwards.
             static const icu::Normalizer2* get_normalizer(NormalizationForm form);
             // Use segment_words/segment_characters/segment_sentences for segmentation. Do not call get_break_iterator from outside this class.
+            // Returns the calling thread's own iterator, so no lock is needed while it is used.
             static icu::BreakIterator* get_break_iterator(UBreakIteratorType type);
 
-            static std::unique_ptr<const icu::Normalizer2> nfc_norm_;
-            static std::unique_ptr<const icu::Normalizer2> nfd_norm_;
-            static std::unique_ptr<const icu::Normalizer2> nfkc_norm_;
-            static std::unique_ptr<const icu::Normalizer2> nfkd_norm_;
-            static std::mutex normalizer_mutex_;
-
-            static std::unique_ptr<icu::BreakIterator> char_break_it_;
-            static std::unique_ptr<icu::BreakIterator> word_break_it_;
-            static std::unique_ptr<icu::BreakIterator> sentence_break_it_;
-            static std::mutex break_iterator_mutex_;
-
-            static std::unique_ptr<icu::Transliterator> accent_stripper_;
-            static std::mutex transliterator_mutex_;
-
             static const std::regex url_regex_;
             static const std::regex email_regex_;
         };
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "tokenizer_types.h"  // OffsetMapping
+
+namespace auratokenizer {
+
+    /**
+     * @class NormalizedString
+     * @brief Normalized text plus a compact alignment back to the original bytes.
+     *
+     * The alignment is a list of spans, each mapping a run of normalized bytes
+     * to a run of original bytes. A run that kept its length maps byte for
+     * byte (copies, ASCII case folding); any other run maps each of its bytes
+     * to the whole original run it came from, so "fi" from the ligature U+FB01
+     * points at the ligature's three bytes. Deleted bytes map to nothing.
+     * Text that normalization leaves alone, or only changes in place, stays a
+     * single span.
+     *
+     * Each normalization step rewrites the whole text and describes how with
+     * a Step; update() installs the new text and folds the step into the
+     * alignment in one pass over both. Steps that keep every length leave the
+     * alignment untouched.
+     *
+     * Offsets produced on the normalized text (by pre-tokenizers and models)
+     * are mapped back with to_original() in one pass when they are in order.
+     */
+    class NormalizedString {
+    public:
+        /**
+         * @class Step
+         * @brief How one normalization step turned the current text into its
+         * output, front to back. Any tail not described is kept unchanged.
+         */
+        class Step {
+        public:
+            /** @brief The next length bytes are kept, or changed without changing length. */
+            void keep(size_t length);
+            /** @brief The next old_length bytes became new_length bytes. */
+            void change(size_t old_length, size_t new_length);
+            /** @brief The next piece.original_size() bytes became piece, aligned as piece says. */
+            void append(const NormalizedString& piece);
+            /**
+             * @brief Forget everything recorded from old_position on. The edit
+             * at old_position, if it started earlier, must be a kept run.
+             */
+            void rewind(size_t old_position);
+            void clear();
+
+            /** @brief Bytes of the current text described so far. */
+            size_t old_size() const { return old_size_; }
+            /** @brief Bytes of output described so far. */
+            size_t new_size() const { return new_size_; }
+            /** @brief True if some run changed length, i.e. the alignment changes. */
+            bool changes_lengths() const { return changes_lengths_; }
+
+        private:
+            friend class NormalizedString;
+            struct Edit {
+                uint32_t old_length;
+                uint32_t new_length;
+            };
+            std::vector<Edit> edits_;
+            size_t old_size_ = 0;
+            size_t new_size_ = 0;
+            bool changes_lengths_ = false;
+        };
+
+        NormalizedString() = default;
+        explicit NormalizedString(std::string_view original) { reset(original); }
+
+        /** @brief Start over: the text is original, aligned to itself. */
+        void reset(std::string_view original);
+        /** @brief Empty text and original; keeps capacity. */
+        void clear();
+
+        const std::string& get() const { return normalized_; }
+        size_t size() const { return normalized_.size(); }
+        bool empty() const { return normalized_.empty(); }
+        size_t original_size() const { return original_size_; }
+        /** @brief Alignment spans; 1 while the text is unchanged or changed only in place. */
+        size_t span_count() const { return spans_.size(); }
+
+        /**
+         * @brief Replace the text with text, the output of step applied to the
+         * current text. text receives the old buffer for reuse.
+         * @throws TokenizerException if step does not fit the two texts.
+         */
+        void update(std::string& text, const Step& step);
+
+        /**
+         * @brief Original byte range of normalized bytes [begin, end). An empty
+         * range maps to the original position of begin.
+         */
+        OffsetMapping original_span(size_t begin, size_t end) const;
+
+        /**
+         * @brief Map offsets[first..] from normalized to original bytes in place,
+         * adding base to each. Linear when the offsets are in order.
+         */
+        void to_original(std::vector<OffsetMapping>& offsets, size_t first = 0, size_t base = 0) const;
+
+    private:
+        // Normalized bytes [begin, next span's begin) come from original [orig_begin, orig_end).
+        // exact spans have equal lengths and map byte for byte.
+        struct Span {
+            uint32_t begin;
+            uint32_t orig_begin;
+            uint32_t orig_end;
+            bool exact;
+        };
+
+        std::string normalized_;
+        std::vector<Span> spans_;
+        std::vector<Span> next_spans_;  // scratch for update()
+        size_t original_size_ = 0;
+
+        size_t span_end(size_t index) const;
+        // Index of the span holding normalized byte pos, searching forward from hint.
+        size_t find_span(size_t pos, size_t hint) const;
+        size_t start_of(size_t pos, size_t& hint) const;
+        size_t end_of(size_t pos, size_t& hint) const;
+        void emit(size_t begin, size_t orig_begin, size_t orig_end, bool exact);
+    };
+
+} // namespace auratokenizer
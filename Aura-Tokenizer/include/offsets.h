@@ -26,6 +26,10 @@ public:
 
     /**
      * @brief Compute token offsets for a given text and its tokenized output.
+     *
+     * For callers that only have token strings: tokens are found in text in
+     * order. Text changed by normalization cannot be found this way; offsets
+     * from TokenizerBase::encode_into() are exact and should be preferred.
      * @param text The original input text.
      * @param tokens The tokenized output (as strings).
      * @return A vector of TokenOffset structs.
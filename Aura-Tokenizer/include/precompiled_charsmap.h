@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "double_array_trie.h"
+#include "flat_table.h"
+#include "tokenizer_config.h"
+#include "unicode_normalizer.h"
+
+namespace auratokenizer {
+
+    /**
+     * @class PrecompiledCharsmap
+     * @brief UnicodeNormalizer's pipeline compiled into a byte-level lookup table.
+     *
+     * In the spirit of SentencePiece's precompiled_charsmap: a DoubleArrayTrie
+     * maps UTF-8 byte sequences to their normalized replacement, and
+     * normalize() rewrites text by longest match without transcoding or
+     * calling ICU. Keys are single characters plus canonically decomposed
+     * sequences ("e" U+0301), so decomposed input stays on the table too.
+     *
+     * build() derives the table from a config's normalization settings (form,
+     * whitespace and control cleanup, accent stripping, diacritic removal,
+     * lowercasing) by running UnicodeNormalizer over every code point.
+     * Custom transformations cannot be compiled and are not applied.
+     *
+     * The output is identical to UnicodeNormalizer's. Characters whose result
+     * depends on their neighbours are marked rather than mapped:
+     *  - combining characters that can reorder or compose with what precedes
+     *    them, and context-sensitive case mappings such as final sigma, send
+     *    the enclosing run between ASCII whitespace (unless it is deleted)
+     *    through UnicodeNormalizer;
+     *  - with strip_accents, a non-Latin script sends the whole text through
+     *    it, since transliteration rules look across words.
+     * Text without such characters never reaches ICU. The NormalizedString
+     * overloads record the alignment in the same pass; a run redone through
+     * UnicodeNormalizer brings its own.
+     *
+     * serialize() writes the settings, the trie and the replacement strings
+     * as one blob; deserialize() copies one and view() uses it in place.
+     */
+    class PrecompiledCharsmap {
+    public:
+        PrecompiledCharsmap();
+
+        PrecompiledCharsmap(const PrecompiledCharsmap&) = delete;
+        PrecompiledCharsmap& operator=(const PrecompiledCharsmap&) = delete;
+        PrecompiledCharsmap(PrecompiledCharsmap&&) = default;
+        PrecompiledCharsmap& operator=(PrecompiledCharsmap&&) = default;
+
+        /**
+         * @brief Compile the normalization settings of config, replacing any table.
+         * Takes a fraction of a second; meant to run once, offline or on first use.
+         */
+        void build(const TokenizerConfig& config);
+
+        /** @brief True until build() or a load. */
+        bool empty() const { return !built_; }
+        /** @brief True if built from the same normalization settings as config. */
+        bool matches(const TokenizerConfig& config) const;
+        /** @brief Copy the normalization settings the table was built from into config. */
+        void apply_settings(TokenizerConfig& config) const;
+        /** @brief Number of keys in the table. */
+        size_t size() const { return trie_.size(); }
+
+        std::string normalize(std::string_view text) const;
+        /** @brief Same as normalize(), replacing out. text may view out. */
+        void normalize_into(std::string_view text, std::string& out) const;
+        /** @brief Normalize into scratch and return a view of it. */
+        std::string_view normalize_view(std::string_view text, std::string& scratch) const;
+        /** @brief Same as normalize(), keeping text's alignment to its original. */
+        void normalize(NormalizedString& text) const;
+        /** @brief Reset scratch to text, normalize it and return a view of the result. */
+        std::string_view normalize_view(std::string_view text, NormalizedString& scratch) const;
+
+        /**
+         * @brief Flat blob: header (magic, byte order, version, settings, sizes),
+         * then the trie blob and the replacement strings.
+         */
+        std::vector<char> serialize() const;
+        /** @brief Copy a blob from serialize(), validating the trie. */
+        void deserialize(const std::vector<char>& data);
+        void deserialize(const char* data, size_t size);
+        /**
+         * @brief Use a blob from serialize() in place. data must be 4-byte
+         * aligned and outlive the table.
+         */
+        void view(const char* data, size_t size);
+
+    private:
+        // Trie values are (offset << 2) | kind; offset points into pool_ for REPLACE.
+        enum Kind : int32_t { REPLACE = 0, CONTEXT = 1, SCRIPT = 2 };
+
+        DoubleArrayTrie trie_;
+        FlatTable<char> pool_;            // per replacement: uint8 length, then bytes
+        std::array<int16_t, 128> ascii_bytes_;  // what each ASCII byte becomes, or -1 if deleted
+        std::array<bool, 128> boundary_;        // ASCII whitespace that is kept: CONTEXT runs end there
+        uint32_t form_;
+        uint32_t flags_;
+        bool built_;
+        UnicodeNormalizer fallback_;      // the same settings, for CONTEXT and SCRIPT
+
+        static uint32_t settings_flags(const TokenizerConfig& config);
+        TokenizerConfig settings() const;
+        void finish_load();
+        // Table-driven pass; records into step if given. Returns false, leaving
+        // out alone, when the whole text has to go through fallback_.
+        bool apply(std::string_view text, std::string& out, NormalizedString::Step* step) const;
+        void read_blob(const char* data, size_t size, bool copy);
+    };
+
+}
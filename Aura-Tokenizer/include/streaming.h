@@ -1,11 +1,86 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 
 namespace auratokenizer {
 
+class Vocab; // Forward declaration
+
+/**
+ * @class DecodeStream
+ * @brief Incremental decoder for token-by-token generation output.
+ *
+ * Each step() consumes one token ID and returns only the text completed by
+ * it, so decoding a response costs O(1) amortized work per token instead of
+ * re-decoding the whole sequence. Bytes of a UTF-8 sequence that is split
+ * across tokens (common with byte-level BPE) are held back until the
+ * sequence is complete; flush() releases whatever is still pending.
+ *
+ * Concatenating every step() and the final flush() yields the same text as
+ * decoding the whole sequence at once.
+ */
+class DecodeStream {
+public:
+    /**
+     * @brief How token texts are joined into output text.
+     */
+    enum class Mode {
+        RAW,         // Concatenate token texts; "<0xXX>" byte-fallback pieces become their byte.
+        BYTE_LEVEL,  // Map GPT-2 byte-level characters back to bytes.
+        WORDPIECE,   // "##" continues the previous word, other tokens start a new one.
+        METASPACE    // U+2581 becomes a space; the first token's leading space is dropped.
+    };
+
+    /**
+     * @param vocab Vocabulary used to look up token texts (kept alive by the stream).
+     * @param mode Joining rule of the tokenizer that produced the IDs.
+     * @param skip_special_tokens If true, special tokens produce no text.
+     */
+    DecodeStream(std::shared_ptr<const Vocab> vocab, Mode mode, bool skip_special_tokens = false);
+
+    /**
+     * @brief Consume one token ID and append the newly completed text to out.
+     * @return True if any text was appended.
+     */
+    bool step(int id, std::string& out);
+
+    /**
+     * @brief Consume one token ID and return the newly completed text.
+     */
+    std::string step(int id);
+
+    /**
+     * @brief Append any pending incomplete UTF-8 bytes to out, as they are.
+     */
+    void flush(std::string& out);
+    std::string flush();
+
+    /**
+     * @brief Forget all state so the stream can decode a new sequence.
+     */
+    void reset();
+
+    Mode mode() const { return mode_; }
+
+    /**
+     * @brief Number of bytes held back waiting for the rest of a UTF-8 sequence.
+     */
+    size_t pending_bytes() const { return pending_.size(); }
+
+private:
+    std::shared_ptr<const Vocab> vocab_;
+    Mode mode_;
+    bool skip_special_tokens_;
+    bool first_;             // No text-producing token seen yet
+    std::string pending_;    // Decoded bytes not yet emitted
+
+    void append_piece(std::string_view piece);
+    bool emit_complete(std::string& out);
+};
+
 /**
  * @class StreamingTokenizer
  * @brief Provides memory-efficient, chunked tokenization and training for large datasets.
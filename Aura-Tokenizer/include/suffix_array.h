@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace auratokenizer {
+
+    /**
+     * @brief Build the suffix array of an integer string with SA-IS (linear time).
+     * @param text Symbols, each in [0, alphabet_size).
+     * @param alphabet_size Upper bound on the symbol values.
+     * @return Start positions of all suffixes in lexicographic order.
+     */
+    std::vector<int32_t> build_suffix_array(const std::vector<int32_t>& text, int32_t alphabet_size);
+
+    /**
+     * @brief Longest common prefix of each suffix with its predecessor in sa (Kasai).
+     * lcp[0] is 0.
+     */
+    std::vector<int32_t> build_lcp_array(const std::vector<int32_t>& text, const std::vector<int32_t>& sa);
+
+    /**
+     * @struct SeedPieceOptions
+     * @brief Limits for extract_seed_pieces.
+     */
+    struct SeedPieceOptions {
+        size_t   max_pieces = 1000000;
+        size_t   max_piece_chars = 16;        // longest candidate, in characters
+        size_t   min_frequency = 2;
+        size_t   memory_budget_bytes = size_t(2) << 30;
+        uint32_t sample_seed = 0;             // fixed, so sampled runs are reproducible
+    };
+
+    /**
+     * @brief Most frequent substrings of a weighted word list, for unigram seeding.
+     *
+     * Words are concatenated over their Unicode characters with a distinct
+     * boundary symbol after each, so no match spans two words. Every node of
+     * the implicit suffix tree (LCP interval or leaf) is one class of
+     * substrings sharing the same occurrences; its longest member of at most
+     * max_piece_chars characters is scored by frequency x length. Frequencies
+     * are weighted by word counts. Single characters are not reported.
+     *
+     * If the arrays would exceed memory_budget_bytes, a uniform sample of the
+     * words is used instead.
+     *
+     * @param words Distinct words with their corpus counts.
+     * @param options Limits.
+     * @return (substring, frequency) pairs, best first.
+     */
+    std::vector<std::pair<std::string, size_t>> extract_seed_pieces(
+        const std::vector<std::pair<std::string, size_t>>& words,
+        const SeedPieceOptions& options = SeedPieceOptions());
+
+} // namespace auratokenizer
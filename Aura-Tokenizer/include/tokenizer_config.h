@@ -35,13 +35,26 @@ namespace auratokenizer {
         // Pre-tokenizer patterns
         std::vector<std::string> pre_tokenizer_patterns;
 
+        // Byte-level BPE (GPT-2 / tiktoken style)
+        bool byte_level = false;
+        ByteLevelPattern byte_level_pattern = ByteLevelPattern::GPT2;
+        bool add_prefix_space = false;
+
         // Normalization
         bool lowercase = false;
         bool strip_accents = false;
         NormalizationForm normalization = NormalizationForm::NFC;
-        bool normalize_whitespace = true;
-        bool remove_control_chars = true;
+        // Opt-in cleanup: map White_Space to ' ', drop control and format characters
+        bool normalize_whitespace = false;
+        bool remove_control_chars = false;
         bool remove_diacritics = false;
+        // BERT text cleaning (drop NUL, U+FFFD and control characters); BERT pipeline only
+        bool clean_text = true;
+        // BERT pipeline only: lowercase also strips accents (HF strip_accents=None)
+        bool strip_accents_with_lowercase = false;
+        // Normalize through a PrecompiledCharsmap compiled from the settings above
+        // (Unigram); same output, most text never reaches ICU.
+        bool use_precompiled_charsmap = false;
 
         // Training
         size_t min_frequency = 2;
@@ -54,6 +67,9 @@ namespace auratokenizer {
         bool pad_to_max_length = false;
         TruncationStrategy truncation_strategy = TruncationStrategy::LONGEST_FIRST;
 
+        // Performance
+        size_t encode_cache_bytes = 0; // Word-level encode cache budget (0 = disabled)
+
         // Serialization
         void save(std::ostream& out) const;
         void load(std::istream& in);
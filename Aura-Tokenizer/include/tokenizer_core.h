@@ -1,13 +1,16 @@
 ﻿#pragma once
 
+#include "encode_buffer.h"
 #include "offsets.h"
 #include "token.h"
 #include "tokenizer_config.h"
 #include "tokenizer_exception.h"
 #include "plugin_registry.h"
+#include "streaming.h"
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace auratokenizer {
@@ -24,8 +27,31 @@ namespace auratokenizer {
 
         virtual std::vector<Token> encode(const std::string& text) = 0;
         virtual std::vector<int> encode_to_ids(const std::string& text) = 0;
+
+        /**
+         * @brief Encode text into a caller-owned buffer (cleared first).
+         *
+         * Produces the same IDs as encode_to_ids, plus offsets and special
+         * flags. Tokenizers that override this reuse the buffer's capacity and
+         * perform no heap allocations once it has grown to the working size;
+         * the default implementation falls back to encode().
+         * @param text Input UTF-8 text.
+         * @param out Destination buffer, reused across calls.
+         */
+        virtual void encode_into(std::string_view text, EncodeBuffer& out);
+
         virtual std::string decode(const std::vector<Token>& tokens) = 0;
         virtual std::string decode_from_ids(const std::vector<int>& ids) = 0;
+
+        /**
+         * @brief Create an incremental decoder for IDs produced by this tokenizer.
+         *
+         * The default implementation throws; tokenizers with a streaming-safe
+         * decoding rule override it.
+         * @param skip_special_tokens If true, special tokens produce no text.
+         */
+        virtual DecodeStream decode_stream(bool skip_special_tokens = false) const;
+
         virtual std::vector<std::vector<int>> batch_encode(const std::vector<std::string>& texts) = 0;
         virtual std::vector<std::string> batch_decode(const std::vector<std::vector<int>>& ids) = 0;
 
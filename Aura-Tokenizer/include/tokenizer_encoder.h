@@ -3,6 +3,7 @@
 #include "tokenizer_core.h"      // For TokenizerBase, OffsetMapping, TokenizerException
 #include "vocab.h"               // For Vocab, Token, SpecialTokenType
 #include "tokenizer_config.h"    // For TokenizerConfig
+#include "unicode_normalizer.h"  // For UnicodeNormalizer
 #include <memory>
 #include <string>
 #include <vector>
@@ -37,6 +38,7 @@ namespace auratokenizer {
         /** TokenizerBase Interface */
         std::vector<Token> encode(const std::string& text) override;
         std::vector<int> encode_to_ids(const std::string& text) override;
+        void encode_into(std::string_view text, EncodeBuffer& out) override;
         std::string decode(const std::vector<Token>& tokens) override;
         std::string decode_from_ids(const std::vector<int>& ids) override;
         std::vector<std::vector<int>> batch_encode(const std::vector<std::string>& texts) override;
@@ -113,6 +115,9 @@ namespace auratokenizer {
         // Current tokenizer settings
         TokenizerConfig                            config_;
 
+        // Normalizer built from config_ (kept so encoding does not rebuild it)
+        UnicodeNormalizer                          normalizer_;
+
         // Map from token text to its SpecialTokenType (e.g. "[PAD]" → PAD)
         std::unordered_map<std::string, SpecialTokenType> special_tokens_;
 
@@ -44,6 +44,11 @@ namespace auratokenizer {
      * @brief Supported model types.
      */
     enum class ModelType { BERT, GPT2, ROBERTA, XLNET, ALBERT, CUSTOM };
+    /**
+     * @enum ByteLevelPattern
+     * @brief Pre-tokenizer split patterns for byte-level BPE models.
+     */
+    enum class ByteLevelPattern { GPT2, CL100K, LLAMA3 };
 
     // --- C-style enums for FFI ---
     extern "C" {
@@ -90,5 +95,6 @@ namespace auratokenizer {
     std::ostream& operator<<(std::ostream& os, const NormalizationForm& val);
     std::ostream& operator<<(std::ostream& os, const TokenizationAlgorithm& val);
     std::ostream& operator<<(std::ostream& os, const ModelType& val);
+    std::ostream& operator<<(std::ostream& os, const ByteLevelPattern& val);
 
 }
\ No newline at end of file
@@ -3,15 +3,20 @@
 #ifndef AURA_TOKENIZER_TRIE_H
 #define AURA_TOKENIZER_TRIE_H
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
+#include "flat_table.h"
 #include "tokenizer_exception.h"  // For TokenizerException
 
 namespace auratokenizer {
 
+    class MappedFile;
+
     /**
      * Trie data structure to support prefix-based token lookup.
      * Optimized for use in high-performance tokenizer pipelines (BPE, Unigram, WordPiece, etc.).
@@ -39,6 +44,8 @@ namespace auratokenizer {
         void deserialize(const std::vector<char>& data);
 
     private:
+        friend class FrozenTrie;
+
         struct Node {
             std::unordered_map<char, std::unique_ptr<Node>> children;
             int token_id = -1;  // -1 indicates not an end-of-token node
@@ -53,6 +60,102 @@ namespace auratokenizer {
         std::unique_ptr<Node> deserialize_node(const char*& ptr, const char* end);
     };
 
+    /**
+     * Read-only snapshot of a Trie laid out for lookup speed.
+     *
+     * Nodes are numbered breadth first and stored in one array, so the
+     * children of a node are a contiguous run of nodes and their edge labels
+     * a contiguous, sorted run of bytes in a parallel array. A step scans or
+     * binary-searches those few bytes instead of hashing, and walks towards
+     * higher indices. The root, which has the most children, has a direct
+     * 256-entry table instead. There are no per-node allocations.
+     *
+     * serialize() writes the same arrays behind a small header, and view()
+     * and map_file() use such a blob in place.
+     */
+    class FrozenTrie {
+    public:
+        FrozenTrie();
+
+        /** Replace the contents with a snapshot of trie. */
+        void build(const Trie& trie);
+
+        bool contains(std::string_view token_text) const { return get_id(token_text) >= 0; }
+        int get_id(std::string_view token_text) const;
+
+        /** Same results as the Trie methods of the same name. */
+        std::pair<int, int> longest_prefix(const std::string& text, size_t start_pos) const;
+        std::vector<std::pair<int, int>> all_prefixes(const std::string& text, size_t start_pos) const;
+
+        /** Call on_match(token_id, length) for every token that is a prefix of text, shortest first. */
+        template <typename Fn>
+        void for_each_prefix(std::string_view text, Fn&& on_match) const {
+            uint32_t node = ROOT_NODE;
+            for (size_t i = 0; i < text.size(); ++i) {
+                node = child(node, static_cast<unsigned char>(text[i]));
+                if (node == NO_NODE) return;
+                if (nodes_[node].token_id >= 0) on_match(static_cast<int>(nodes_[node].token_id), static_cast<int>(i + 1));
+            }
+        }
+
+        size_t size() const { return size_; }
+        size_t node_count() const { return nodes_.size(); }
+
+        /** Header (magic, byte order, version, counts), root table, nodes, labels. */
+        std::vector<char> serialize() const;
+        /** Copy a blob from serialize(), checking every child range. */
+        void deserialize(const std::vector<char>& data);
+        void deserialize(const char* data, size_t size);
+        /**
+         * Use a blob from serialize() in place. data must be 4-byte aligned and
+         * outlive the trie. Only the header is checked.
+         */
+        void view(const char* data, size_t size);
+        /** view() over a read-only mapping of a file holding one blob. */
+        void map_file(const std::string& path);
+
+    private:
+        struct Node {
+            uint32_t first_child;  // index of the first child; children are contiguous
+            uint32_t child_count;
+            int32_t token_id;      // -1 if no token ends here
+        };
+
+        FlatTable<uint32_t> root_children_;  // by byte: child of the root, or NO_NODE
+        FlatTable<Node> nodes_;              // breadth-first order, root first
+        FlatTable<uint8_t> labels_;          // by node: byte on the edge into it
+        size_t size_;
+        std::shared_ptr<const MappedFile> mapping_;
+
+        static constexpr uint32_t ROOT_NODE = 0;
+        static constexpr uint32_t NO_NODE = 0;    // the root is nobody's child
+        static constexpr uint32_t LINEAR_SCAN_LIMIT = 8;
+
+        uint32_t child(uint32_t node, unsigned char c) const {
+            if (node == ROOT_NODE) return root_children_[c];
+            const Node& n = nodes_[node];
+            const uint8_t* first = labels_.data() + n.first_child;
+            if (n.child_count <= LINEAR_SCAN_LIMIT) {
+                for (uint32_t k = 0; k < n.child_count; ++k) {
+                    if (first[k] == c) return n.first_child + k;
+                    if (first[k] > c) break;
+                }
+                return NO_NODE;
+            }
+            uint32_t lo = 0;
+            uint32_t hi = n.child_count;
+            while (lo < hi) {
+                uint32_t mid = (lo + hi) / 2;
+                if (first[mid] < c) lo = mid + 1;
+                else hi = mid;
+            }
+            return (lo < n.child_count && first[lo] == c) ? n.first_child + lo : NO_NODE;
+        }
+
+        void read_blob(const char* data, size_t size, bool copy);
+        void validate() const;
+    };
+
 }  // namespace auratokenizer
 
 #endif  // AURA_TOKENIZER_TRIE_H
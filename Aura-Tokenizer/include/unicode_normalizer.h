@@ -1,11 +1,13 @@
 ﻿#pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <functional>
 #include "tokenizer_types.h"
 #include "tokenizer_config.h"  // Add missing include for TokenizerConfig
 #include "icu_utils.h"   // for ICUUtils::normalize, strip_accents, to_lower
+#include "normalized_string.h"
 
 namespace auratokenizer {
 
@@ -14,6 +16,11 @@ namespace auratokenizer {
      *
      * Wraps ICUUtils so that all calls run through our central ICU layer.
      * You can add custom transformations, but core logic always uses ICUUtils.
+     *
+     * Every configured step works on UTF-8 between two per-thread scratch
+     * buffers. Only accent stripping (an ICU transliterator) converts to
+     * UTF-16, once. Pure-ASCII input without custom transformations takes a
+     * single byte loop.
      */
     class UnicodeNormalizer {
     public:
@@ -23,13 +30,52 @@ namespace auratokenizer {
 
         /**
          * Normalize a single string:
-         *   1) Apply normalization form (NFC/NFKC/etc.),
-         *   2) Apply any custom transformations (in order),
-         *   3) Strip accents if requested,
-         *   4) Lowercase if requested.
+         *   1) Clean up, if requested: normalize_whitespace maps every White_Space
+         *      character to ' '; remove_control_chars drops the remaining
+         *      control (Cc) and format (Cf) characters. Ill-formed UTF-8 becomes U+FFFD.
+         *   2) Apply normalization form (NFC/NFKC/etc.),
+         *   3) Apply any custom transformations (in order),
+         *   4) Strip accents if requested (transliterates to Latin, then drops marks),
+         *   5) Remove diacritics if requested (drops nonspacing marks, keeps the script),
+         *   6) Lowercase if requested.
          */
         std::string normalize(const std::string& text) const;
 
+        /**
+         * Same as normalize(), replacing the contents of out. Reusing out
+         * across calls avoids allocating once its capacity suffices.
+         */
+        void normalize_into(std::string_view text, std::string& out) const;
+
+        /**
+         * Same steps as normalize_into(), applied to text in place. text's
+         * alignment follows every step, so offsets into the result map back to
+         * the original input. Custom transformations are opaque: text they
+         * change aligns as a whole.
+         */
+        void normalize(NormalizedString& text) const;
+
+        /**
+         * True if normalize() returns its input unchanged for every string
+         * (no cleanup, normalization form, transformations, accent or
+         * diacritic removal, or lowercasing).
+         */
+        bool is_identity() const;
+
+        /**
+         * Normalize text for encoding without copying when possible.
+         * Returns a view of text itself if is_identity(); otherwise normalizes
+         * into scratch and returns a view of it.
+         */
+        std::string_view normalize_view(std::string_view text, std::string& scratch) const;
+
+        /**
+         * Same as above with alignment: returns text itself if is_identity(),
+         * leaving scratch alone; otherwise resets scratch to text, normalizes
+         * it and returns a view of its text.
+         */
+        std::string_view normalize_view(std::string_view text, NormalizedString& scratch) const;
+
         /**
          * Normalize a batch of strings (parallelized for large batches).
          */
@@ -64,6 +110,10 @@ namespace auratokenizer {
     private:
         TokenizerConfig config_;
         std::vector<std::function<std::string(const std::string&)>> custom_transformations_;
+
+        // The steps behind normalize_into() and normalize(NormalizedString&):
+        // the result goes to out, or into aligned (whose text is then the input).
+        void apply_steps(std::string_view text, std::string& out, NormalizedString* aligned) const;
     };
 
 } // namespace auratokenizer
@@ -3,6 +3,8 @@
 #include "tokenizer_core.h"
 #include "vocab.h"
 #include "unicode_normalizer.h"
+#include "double_array_trie.h"
+#include "precompiled_charsmap.h"
 
 #include <unordered_map>
 #include <vector>
@@ -18,9 +20,11 @@ public:
 
     std::vector<Token> encode(const std::string& text) override;
     std::vector<int> encode_to_ids(const std::string& text) override;
+    void encode_into(std::string_view text, EncodeBuffer& out) override;
 
     std::string decode(const std::vector<Token>& tokens) override;
     std::string decode_from_ids(const std::vector<int>& ids) override;
+    DecodeStream decode_stream(bool skip_special_tokens = false) const override;
 
     std::vector<std::vector<int>> batch_encode(const std::vector<std::string>& texts) override;
     std::vector<std::string> batch_decode(const std::vector<std::vector<int>>& ids_batch) override;
@@ -37,21 +41,49 @@ public:
 
     const TokenizerConfig& get_config() const override;
     void set_config(const TokenizerConfig& config) override;
+    /** Index vocab for encoding; call again after changing its tokens, scores or flags. */
     void set_vocab(std::shared_ptr<Vocab> vocab) override;
 
     // Unigram-specific methods
+    /** Use vocab, storing scores (token -> log-probability) into it; tokens missing from vocab are ignored. */
     void set_vocab_and_scores(std::shared_ptr<Vocab> vocab, const std::unordered_map<std::string, float>& scores);
 
+    /**
+     * @brief Penalty subtracted from the lowest piece score to score an unknown character.
+     */
+    static constexpr float UNK_PENALTY = 10.0f;
+
 private:
     UnicodeNormalizer normalizer_;
+    PrecompiledCharsmap charsmap_;            // used when config_.use_precompiled_charsmap
     std::shared_ptr<Vocab> vocab_;
     std::unordered_map<SpecialTokenType, std::string> special_tokens_;
-    std::unordered_map<std::string, float> scores_; // Token scores for Unigram
+
+    // One piece of the best segmentation: bytes [begin, end) of the input.
+    struct Piece {
+        size_t begin;
+        size_t end;
+        int id;
+    };
+
+    // Lattice lookup structures, rebuilt by set_vocab*(), add_special_tokens(),
+    // set_config() and load(); encoding only reads them, so it is safe from
+    // several threads. Scores come from Vocab::score(); unscored pieces get
+    // the lowest score.
+    DoubleArrayTrie piece_trie_;              // text pieces (not special, unused or byte) -> id
+    std::vector<float> piece_scores_;         // log-probability by id
+    std::vector<int> byte_fallback_ids_;      // "<0xXX>" ids, or empty if incomplete
+    float unk_score_ = 0.0f;
+
+    void rebuild_lattice_index();
+    // Build charsmap_ for config_ if it is in use and stale; called with the config, never while encoding.
+    void ensure_charsmap();
+    // True if normalize_view() may rewrite text, so offsets need mapping back.
+    bool normalizes() const;
+    std::string_view normalize_view(std::string_view text, NormalizedString& scratch) const;
+    void viterbi(std::string_view text, std::vector<Piece>& pieces) const;
 
     void initialize_special_tokens();
-    std::vector<std::string> pre_tokenize(const std::string& text) const;
-    std::vector<Token> encode_unigram(const std::string& word) const;
-    std::vector<std::string> viterbi_segment(const std::string& text) const;
 };
 
 } // namespace auratokenizer
@@ -4,27 +4,47 @@
 #include "vocab.h"                 // Defines auratokenizer::Vocab
 #include "unicode_normalizer.h"    // Defines auratokenizer::UnicodeNormalizer
 #include "tokenizer_trainer.h"     // Defines auratokenizer::TokenizerTrainerBase
+#include "corpus_reader.h"         // Defines auratokenizer::count_corpus_files
 #include <string>
 #include <vector>
 #include <memory>
 #include <unordered_map>
 #include <stdexcept>
 #include <cstddef>
+#include <functional>
 
 namespace auratokenizer {
 
     /**
      * UnigramTrainer
      *
-     * - Gathers character‐ or token‐level frequencies from a corpus.
-     * - Builds a unigram vocabulary (based on min_frequency).
-     * - Prunes down to `max_tokens` by selecting top‐frequency items.
+     * SentencePiece-style unigram language model training:
+     * - Splits normalized text into words (leading whitespace attached) and counts them.
+     * - Seeds candidate pieces from frequent substrings; every character is always kept.
+     * - Runs EM rounds: the E-step computes expected piece counts with
+     *   forward-backward over each word's lattice, in parallel across threads;
+     *   the M-step re-estimates log-probabilities and drops rare pieces.
+     * - After each round, prunes the pieces whose removal costs the least
+     *   likelihood until `max_tokens` (including special tokens) is reached.
+     *
+     * The trained scores are available from get_scores() and can be passed to
+     * UnigramTokenizer::set_vocab_and_scores.
      *
      * Implements TokenizerTrainerBase so it can be used interchangeably
      * with other trainer types (e.g. BPETrainer).
      */
     class UnigramTrainer : public TokenizerTrainerBase {
     public:
+        /** Timing and memory for one EM/prune round. */
+        struct RoundStats {
+            std::size_t round;
+            std::size_t pieces;         // pieces after pruning
+            double      objective;      // negative log-likelihood per word occurrence
+            double      em_ms;          // E-step + M-step time
+            double      prune_ms;
+            std::size_t rss_bytes;      // resident set size after the round (0 if unknown)
+        };
+
         UnigramTrainer();
         explicit UnigramTrainer(const TokenizerConfig& config);
         ~UnigramTrainer() override = default;
@@ -48,6 +68,27 @@ namespace auratokenizer {
         void set_use_regex(bool use);
         void set_regex_pattern(const std::string& pattern);
 
+        /** Threads used by train_from_file(s) and the E-step; 0 = all cores. */
+        void set_num_threads(std::size_t threads);
+
+        /** Number of seed pieces kept before EM starts. */
+        void set_seed_size(std::size_t size);
+
+        /**
+         * Memory allowed for the seed suffix array. Larger corpora are seeded
+         * from a fixed-seed sample of their distinct words.
+         */
+        void set_seed_memory_budget(std::size_t bytes);
+
+        /** Called after every round with that round's statistics. */
+        void set_progress_callback(std::function<void(const RoundStats&)> callback);
+
+        /** Log-probability of every trained piece, by piece text. */
+        const std::unordered_map<std::string, float>& get_scores() const;
+
+        /** Statistics of every round of the last training run. */
+        const std::vector<RoundStats>& get_round_stats() const;
+
         /** Return shared pointer to the constructed vocabulary. */
         std::shared_ptr<Vocab> get_vocab() const;
 
@@ -60,24 +101,44 @@ namespace auratokenizer {
         std::string              regex_pattern_;
         std::shared_ptr<Vocab>   vocab_;
         UnicodeNormalizer        normalizer_;
+        std::size_t              num_threads_ = 0;
+        std::size_t              seed_size_ = 1000000;
+        std::size_t              seed_memory_budget_ = std::size_t(2) << 30;
+        std::function<void(const RoundStats&)> progress_;
+        std::unordered_map<std::string, float> scores_;
+        std::vector<RoundStats>  round_stats_;
+
+        struct Piece {
+            std::string text;
+            float       score;
+            bool        required;   // single characters are never pruned
+        };
+        using WordList = std::vector<std::pair<std::string, std::size_t>>;
 
         // ─── Helper methods ───
 
         /**
          * Process a single text line: normalize, tokenize, and accumulate freqcounts.
+         * Const and re-entrant, so file ingestion can call it from worker threads.
          */
-        void process_text(const std::string& text,
-            std::unordered_map<std::string, std::size_t>& frequencies);
+        void process_text(std::string_view text,
+            std::unordered_map<std::string, std::size_t>& frequencies) const;
 
         /**
-         * Once all frequencies are collected, build & prune the Vocab.
+         * Once all word frequencies are collected, run EM training and build the Vocab.
          */
         void build_vocab(const std::unordered_map<std::string, std::size_t>& frequencies);
 
+        std::vector<Piece> make_seed_pieces(const WordList& words) const;
+        double run_em_step(const WordList& words, std::vector<Piece>& pieces) const;
+        void prune_pieces(const WordList& words, std::vector<Piece>& pieces, std::size_t target) const;
+        std::size_t thread_count() const;
+
         /**
-         * Simple tokenization:
+         * Word splitting:
          *   - If use_regex_ && regex_pattern_ is nonempty, you'd insert regex splitting.
-         *   - Otherwise, default to character‐level tokens.
+         *   - Otherwise, split before every whitespace character so that each
+         *     word carries its leading space, as pieces do at encode time.
          */
         std::vector<std::string> tokenize_text(const std::string& text) const;
     };
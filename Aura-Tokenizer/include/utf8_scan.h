@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+namespace auratokenizer {
+
+    /**
+     * @brief Byte length of the UTF-8 sequence that starts with lead.
+     * Continuation and invalid bytes count as 1, so a scan always advances.
+     */
+    inline size_t utf8_length(unsigned char lead) {
+        if (lead < 0x80) return 1;
+        if ((lead & 0xE0) == 0xC0) return 2;
+        if ((lead & 0xF0) == 0xE0) return 3;
+        if ((lead & 0xF8) == 0xF0) return 4;
+        return 1;
+    }
+
+    /**
+     * @brief Whitespace of the "C" locale: ' ' and '\t' through '\r'.
+     */
+    inline bool is_ascii_space(char c) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+}
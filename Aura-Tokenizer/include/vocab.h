@@ -1,33 +1,96 @@
 ﻿#pragma once
 
 #include "tokenizer_types.h"
+#include "flat_table.h"
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
-#include <unordered_set>
 #include <ostream>
 #include <istream>
+#include <memory>
 
 namespace auratokenizer {
+    class MappedFile;
+
+    /**
+     * @class Vocab
+     * @brief Token <-> id mapping stored in flat arrays.
+     *
+     * All token text lives in one string arena. Ids index a dense table of
+     * (offset, length) spans into it, so get_token_view() is a bounds check
+     * and an array load. Text -> id goes through an open-addressing table
+     * whose slots keep part of each token's hash, so most probes are settled
+     * without touching the arena. Per-token scores and flags are further
+     * id-indexed arrays, so score-based models read them without hashing
+     * token text. Views returned by get_token_view() stay
+     * valid until the next token is added or the vocabulary is cleared.
+     *
+     * save() writes these arrays as they are in memory: a header (magic,
+     * byte-order tag, format version, size, checksum), a section directory,
+     * then the arena, entries, id spans, hash slots, special tokens, scores
+     * and flags, each 8-byte aligned. The token hash is fixed by the format, not by the
+     * standard library, so map_file() can serve lookups straight out of the
+     * mapped file. The first modification copies the arrays into memory.
+     */
     class Vocab {
     public:
+        /** Per-token flag bits, see flags(). */
+        enum Flag : uint8_t {
+            SPECIAL       = 1 << 0,  // added with add_special_token(); never matched in text
+            BYTE_FALLBACK = 1 << 1,  // SentencePiece "<0xXX>" byte piece, set on insertion
+            UNUSED        = 1 << 2,  // reserved id that models should not produce
+            HAS_SCORE     = 1 << 3,  // score() was set explicitly
+        };
+
         Vocab();
         virtual ~Vocab() = default;
 
         void add_token(const std::string& token, int id = -1);
         void add_tokens(const std::vector<std::string>& tokens);
         int get_token_id(const std::string& token) const;
+        // Lookup by view; hashes and compares the bytes in place.
+        int find_token_id(std::string_view token) const;
         std::string get_token(int id) const;
+        // Text of id inside the arena, or an empty view for unknown ids.
+        std::string_view get_token_view(int id) const;
         bool has_token(const std::string& token) const;
         bool has_id(int id) const;
         size_t size() const;
+        // Calls fn(std::string_view token, int id) for every entry, in insertion order.
+        template <typename Fn>
+        void for_each_token(Fn&& fn) const {
+            for (const Entry& entry : entries_) {
+                fn(std::string_view(arena_.data() + entry.offset, entry.length), entry.id);
+            }
+        }
+        // Copy of all (token, id) entries, for callers that need a map.
+        std::unordered_map<std::string, int> get_token_to_id() const;
 
         // Additional methods for compatibility
         bool contains_token(const std::string& token) const { return has_token(token); }
         void add_token_to_vocab(const std::string& token, int id = -1) { add_token(token, id); }
         std::string get_token_text(int id) const { return get_token(id); }
+        // Adds the token if needed and sets its score either way.
         void add_token_with_score(const std::string& token, double score, int id = -1);
 
+        /** Score of id (e.g. a Unigram log-probability); 0 if unset or unknown. */
+        float score(int id) const {
+            return (id >= 0 && static_cast<size_t>(id) < scores_.size()) ? scores_[id] : 0.0f;
+        }
+        /** Flag bits of id; 0 for unknown ids. */
+        uint8_t flags(int id) const {
+            return (id >= 0 && static_cast<size_t>(id) < flags_.size()) ? flags_[id] : uint8_t(0);
+        }
+        bool has_score(int id) const { return (flags(id) & HAS_SCORE) != 0; }
+        /** Set the score of an existing id; ignored for unknown ids. */
+        void set_score(int id, float score);
+        /** Set or clear flag bits of an existing id; ignored for unknown ids. */
+        void set_flags(int id, uint8_t set, uint8_t clear = 0);
+        /** Byte spelled by a BYTE_FALLBACK piece ("<0xC3>" -> 0xC3), or -1 for other tokens. */
+        static int byte_value(std::string_view token);
+
         void add_special_token(const std::string& token, SpecialTokenType type);
         bool is_special_token(const std::string& token) const;
         bool is_special_token_id(int id) const;
@@ -35,16 +98,59 @@ namespace auratokenizer {
         int get_special_token_id(SpecialTokenType type) const;
         std::string get_special_token_text(SpecialTokenType type) const;
 
+        /** Write the binary vocab format; a stream may hold other data before and after it. */
         void save(std::ostream& out) const;
+        /** Read one vocab written by save(), verifying its checksum. Throws TokenizerException. */
         void load(std::istream& in);
+        void save(const std::string& path) const;
+        void load(const std::string& path);
+
+        /**
+         * Use a file written by save(path) in place through a read-only mapping.
+         * Only the header and section directory are examined, so opening costs
+         * the same for any vocab size. verify_checksum also hashes the whole
+         * file and bounds-checks every entry, which takes time linear in the
+         * file size; leave it on for files from untrusted sources.
+         */
+        void map_file(const std::string& path, bool verify_checksum = true);
+        /** True while lookups are served from a mapped file. */
+        bool is_mapped() const { return mapping_ != nullptr; }
 
         void clear();
 
     protected:
-        std::unordered_map<std::string, int> token_to_id_;
-        std::unordered_map<int, std::string> id_to_token_;
+        struct TokenSpan {
+            uint32_t offset;
+            uint32_t length;
+        };
+        struct Entry {
+            uint32_t offset;
+            uint32_t length;
+            int32_t  id;
+        };
+        struct Slot {
+            uint32_t tag;    // high hash bits, to skip most mismatches
+            uint32_t entry;  // index into entries_, EMPTY_SLOT if unused
+        };
+        static constexpr uint32_t EMPTY_SLOT = 0xFFFFFFFFu;
+        static constexpr uint32_t NO_TOKEN = 0xFFFFFFFFu;
+
+        FlatTable<char> arena_;
+        FlatTable<Entry> entries_;
+        FlatTable<TokenSpan> id_spans_;        // offset NO_TOKEN for unused ids
+        FlatTable<float> scores_;              // by id, parallel to id_spans_
+        FlatTable<uint8_t> flags_;             // by id, Flag bits
+        FlatTable<Slot> slots_;                // power-of-two size, at most half full
         std::unordered_map<SpecialTokenType, int> special_token_ids_;
-        std::unordered_set<int> special_ids_set_;
         int next_id_;
+        std::shared_ptr<const MappedFile> mapping_;  // backs the tables after map_file()
+
+        // Slot holding token, or the empty slot where it would go.
+        size_t find_slot(std::string_view token, uint64_t hash) const;
+        int insert(std::string_view token, int id);
+        void grow_slots();
+        // Adopt a serialized vocab; copy_tables copies sections out of blob instead of viewing them.
+        void read_blob(const char* blob, size_t size, bool verify_checksum, bool copy_tables);
+        static uint64_t hash_token(std::string_view token);
     };
-}
\ No newline at end of file
+}
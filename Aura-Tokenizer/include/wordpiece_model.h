@@ -1,9 +1,11 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <stdexcept>
+#include <cstdint>
 #include "tokenizer_types.h"
 
 namespace auratokenizer {
@@ -15,6 +17,12 @@ namespace models {
  *
  * Implements the WordPiece tokenization algorithm.
  * This model is typically used with pre-tokenizers that split by whitespace.
+ *
+ * Matching is LinMaxMatch (Song et al., "Fast WordPiece Tokenization"): the
+ * vocabulary is compiled into a byte trie with two roots, one for word-initial
+ * pieces and one for "##" continuations, plus Aho-Corasick-style failure links
+ * and failure pops. A word is scanned once, left to right, and the pops are the
+ * greedy longest-match pieces, so the output equals the classic algorithm.
  */
 class WordPieceModel {
 public:
@@ -24,7 +32,7 @@ public:
      * Initializes the WordPiece model with a vocabulary and an unknown token.
      * @param vocab A map from token string to its ID.
      * @param unk_token The token to use for unknown words.
-     * @param max_input_chars_per_word The maximum number of characters a word can have.
+     * @param max_input_chars_per_word Longer words (in characters) become a single unknown token.
      */
     void initialize(
         const std::unordered_map<std::string, int>& vocab,
@@ -39,6 +47,25 @@ public:
      */
     std::vector<std::string> tokenize(const std::string& word) const;
 
+    /**
+     * A WordPiece as a byte range of the word. Pieces with begin > 0 carry the
+     * "##" continuation prefix; unk marks the unknown token ending the word.
+     */
+    struct PieceSpan {
+        size_t begin;
+        size_t end;
+        bool unk;
+        int id = -1;   // vocab id of the piece, -1 for unk
+    };
+
+    /**
+     * Tokenizes a single word into piece spans without building piece strings.
+     * Produces the same segmentation as tokenize().
+     * @param word The input word.
+     * @param out Destination for the spans (not cleared).
+     */
+    void tokenize_spans(std::string_view word, std::vector<PieceSpan>& out) const;
+
     /**
      * Tokenizes a batch of words into WordPieces.
      * @param words A vector of input words.
@@ -56,10 +83,33 @@ public:
      */
     const std::string& get_unk_token() const { return unk_token_; }
 
+    /**
+     * Returns the longest word, in characters, that is not mapped to the unknown token.
+     */
+    int get_max_input_chars_per_word() const { return max_input_chars_per_word_; }
+
 private:
     std::unordered_map<std::string, int> vocab_;
     std::string unk_token_;
-    int max_input_chars_per_word_;
+    int max_input_chars_per_word_ = 100;
+
+    // ─── Matching trie ───
+    // Nodes are numbered breadth-first so each node's children are contiguous
+    // and sorted by label. Node 0 is the word root, node 1 the "##" root.
+    static constexpr int32_t ROOT = 0;
+    static constexpr int32_t SUFFIX_ROOT = 1;
+    std::vector<int32_t> child_begin_;   // children of v: [child_begin_[v], child_begin_[v + 1])
+    std::vector<unsigned char> label_;   // byte on the edge into each node
+    std::vector<int32_t> depth_;         // bytes below its root
+    std::vector<int32_t> token_id_;      // vocab id if the node spells a piece, else -1
+    std::vector<int32_t> fail_;          // failure link, -1 if none
+    std::vector<int32_t> pops_begin_;    // failure pops of v: [pops_begin_[v], pops_begin_[v + 1])
+    std::vector<int32_t> pops_;          // piece nodes emitted when following fail_
+
+    void build_trie();
+    int32_t transition(int32_t node, unsigned char c) const;
+    void emit_pops(int32_t node, size_t& pos, std::vector<PieceSpan>& out) const;
+    void greedy_from(std::string_view word, size_t start, std::vector<PieceSpan>& out) const;
 };
 
 } // namespace models
@@ -4,6 +4,7 @@
 #include "vocab.h"
 #include "unicode_normalizer.h"
 #include "wordpiece_model.h"
+#include "bert_pipeline.h"
 
 #include <vector>
 #include <string>
@@ -11,6 +12,16 @@
 
 namespace auratokenizer {
 
+/**
+ * WordPieceTokenizer
+ *
+ * With config.base_model == ModelType::BERT, encoding runs the fused
+ * BertPipeline: BERT text cleaning, CJK and punctuation splitting,
+ * lowercasing (config.lowercase) and accent stripping (config.strip_accents,
+ * or lowercase with config.strip_accents_with_lowercase) in one pass, with offsets into the
+ * original input. Other configurations normalize with UnicodeNormalizer,
+ * split on whitespace and punctuation, and match each word.
+ */
 class WordPieceTokenizer : public TokenizerBase {
 public:
     explicit WordPieceTokenizer(const TokenizerConfig& config = TokenizerConfig());
@@ -18,9 +29,11 @@ public:
 
     std::vector<Token> encode(const std::string& text) override;
     std::vector<int> encode_to_ids(const std::string& text) override;
+    void encode_into(std::string_view text, EncodeBuffer& out) override;
 
     std::string decode(const std::vector<Token>& tokens) override;
     std::string decode_from_ids(const std::vector<int>& ids) override;
+    DecodeStream decode_stream(bool skip_special_tokens = false) const override;
 
     std::vector<std::vector<int>> batch_encode(const std::vector<std::string>& texts) override;
     std::vector<std::string> batch_decode(const std::vector<std::vector<int>>& ids_batch) override;
@@ -47,8 +60,11 @@ private:
     std::shared_ptr<Vocab> vocab_;
     std::unordered_map<SpecialTokenType, std::string> special_tokens_;
     std::shared_ptr<models::WordPieceModel> wordpiece_model_;
+    // The model with its piece ids remapped to vocab_ ids where they differ.
+    std::shared_ptr<const models::WordPieceModel> matcher_;
 
     void initialize_special_tokens();
+    void sync_matcher();
 };
 
 } // namespace auratokenizer
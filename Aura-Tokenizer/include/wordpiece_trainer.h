@@ -0,0 +1,114 @@
+#pragma once
+
+#include "tokenizer_trainer.h"
+#include "unicode_normalizer.h"
+#include "corpus_reader.h"
+#include "wordpiece_model.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace auratokenizer {
+
+    /**
+     * @class WordPieceTrainer
+     * @brief Learns a WordPiece vocabulary with likelihood-based merges.
+     *
+     * Words are split the way WordPieceTokenizer will see them (the fused
+     * BERT pipeline when config.base_model is BERT, whitespace after
+     * UnicodeNormalizer otherwise) and start as characters, every character
+     * but the first carrying the "##" continuation prefix. Each step merges
+     * the adjacent pair (a, b) maximizing count(ab) / (count(a) * count(b)),
+     * i.e. the merge that raises the corpus likelihood under a unigram model
+     * the most, rather than BPE's raw pair count.
+     *
+     * Pair counts are maintained incrementally as in BPETrainer: an inverted
+     * index from pairs to words limits each merge to the words containing the
+     * pair, and a lazily invalidated max-heap yields the next pair. Because a
+     * merge lowers count(a) and count(b), every live pair touching a or b is
+     * re-scored. Ties go to the higher pair count, then to the bytewise-lowest
+     * texts. Pairs seen fewer than min_frequency times are never merged.
+     */
+    class WordPieceTrainer : public TokenizerTrainerBase {
+    public:
+        explicit WordPieceTrainer(const TokenizerConfig& config = TokenizerConfig());
+        ~WordPieceTrainer() override = default;
+
+        // ─── Core training methods (override base) ───
+        void train(const std::vector<std::string>& texts) override;
+        void train_from_file(const std::string& file_path) override;
+        void train_from_files(const std::vector<std::string>& file_paths) override;
+
+        // ─── Save / Load model (override base) ───
+        void save(const std::string& path) override;
+        void load(const std::string& path) override;
+
+        // ─── Access / modify configuration (override base) ───
+        TokenizerConfig get_config() const override;
+        void set_config(const TokenizerConfig& config) override;
+
+        void set_vocab_size(size_t size);
+        void set_min_frequency(size_t freq);
+
+        /** Threads used to count words; 0 = all cores. */
+        void set_num_threads(size_t threads) { num_threads_ = threads; }
+
+        /** Trained vocabulary: special tokens, the alphabet, then merges in order. */
+        std::shared_ptr<Vocab> get_vocab() const override;
+
+        /** A WordPieceModel over the trained vocabulary, ready for WordPieceTokenizer. */
+        std::shared_ptr<models::WordPieceModel> get_model() const;
+
+        const CorpusCounts& get_word_counts() const { return word_counts_; }
+
+    private:
+        size_t min_frequency_;
+        size_t vocab_size_;
+        UnicodeNormalizer normalizer_;
+        size_t num_threads_ = 0;
+        std::shared_ptr<Vocab> vocab_;
+        CorpusCounts word_counts_;
+
+        struct Word {
+            std::vector<uint32_t> symbols;
+            int64_t count;
+        };
+
+        // A pair's score inputs when it was pushed; stale once any of them changes.
+        struct PairEntry {
+            int64_t  count;
+            int64_t  left_count;
+            int64_t  right_count;
+            uint32_t left;
+            uint32_t right;
+        };
+
+        // Training state, rebuilt by every train() call.
+        std::vector<std::string> symbols_;                          // token text, "##" included
+        std::unordered_map<std::string, uint32_t> symbol_ids_;
+        std::vector<int64_t> symbol_counts_;
+        std::vector<std::vector<uint64_t>> symbol_pairs_;           // symbol -> pairs it took part in
+        std::vector<Word> words_;
+        std::unordered_map<uint64_t, int64_t> pair_counts_;
+        std::unordered_map<uint64_t, std::vector<uint32_t>> pair_words_;
+        std::vector<PairEntry> heap_;
+
+        void count_words(std::string_view text, CorpusCounts& counts) const;
+        void train_words();
+        void learn_merges();
+        void apply_merge(uint32_t left, uint32_t right, uint32_t merged);
+
+        uint32_t intern(const std::string& text);
+        void add_pair(uint32_t left, uint32_t right, int64_t delta, uint32_t word);
+        void push_pair(uint64_t key);
+        bool heap_less(const PairEntry& a, const PairEntry& b) const;
+
+        static uint64_t pack(uint32_t left, uint32_t right) {
+            return (static_cast<uint64_t>(left) << 32) | right;
+        }
+    };
+
+} // namespace auratokenizer
@@ -0,0 +1,127 @@
+#include "added_token_splitter.h"
+
+#include <unicode/uchar.h>
+#include <unicode/utf8.h>
+
+namespace auratokenizer {
+
+    namespace {
+
+        const uint8_t* bytes(std::string_view text) {
+            return reinterpret_cast<const uint8_t*>(text.data());
+        }
+
+        // Codepoint ending at byte offset end (U_SENTINEL at the start of text).
+        UChar32 codepoint_before(std::string_view text, size_t end) {
+            if (end == 0) return U_SENTINEL;
+            int32_t i = static_cast<int32_t>(end);
+            UChar32 c;
+            U8_PREV(bytes(text), 0, i, c);
+            return c;
+        }
+
+        // Codepoint starting at byte offset begin (U_SENTINEL at the end of text).
+        UChar32 codepoint_at(std::string_view text, size_t begin) {
+            if (begin >= text.size()) return U_SENTINEL;
+            int32_t i = static_cast<int32_t>(begin);
+            UChar32 c;
+            U8_NEXT(bytes(text), i, static_cast<int32_t>(text.size()), c);
+            return c;
+        }
+
+        bool is_word_char(UChar32 c) {
+            return c >= 0 && (c == '_' || u_isalnum(c));
+        }
+
+        bool is_space(UChar32 c) {
+            return c >= 0 && u_isUWhiteSpace(c);
+        }
+
+    } // namespace
+
+    void AddedTokenSplitter::build(const std::vector<AddedToken>& tokens) {
+        tokens_.clear();
+        std::vector<std::pair<std::string, int32_t>> entries;
+        entries.reserve(tokens.size());
+        for (const auto& token : tokens) {
+            if (token.content.empty()) continue;
+            entries.emplace_back(token.content, static_cast<int32_t>(tokens_.size()));
+            tokens_.push_back(token);
+        }
+        trie_.build(entries);
+        trie_.rebuild_fail_links();
+    }
+
+    bool AddedTokenSplitter::accept(const AddedToken& token, std::string_view text, size_t begin, size_t end) const {
+        if (!token.single_word) return true;
+        return !is_word_char(codepoint_before(text, begin)) && !is_word_char(codepoint_at(text, end));
+    }
+
+    void AddedTokenSplitter::split(std::string_view text, std::vector<Segment>& out) const {
+        out.clear();
+        const size_t n = text.size();
+        if (n == 0) return;
+        if (tokens_.empty()) {
+            out.push_back(Segment{ 0, n, -1, false });
+            return;
+        }
+
+        constexpr size_t NONE = static_cast<size_t>(-1);
+        size_t emitted = 0;                 // end of the last segment pushed
+        size_t best_begin = NONE, best_end = 0;
+        int32_t best_index = -1;
+
+        int32_t state = DoubleArrayTrie::root();
+        size_t i = 0;
+        while (i < n) {
+            state = trie_.next_state(state, static_cast<unsigned char>(text[i]));
+            ++i;
+
+            // Keys ending at i, longest (= leftmost) first.
+            int32_t o = trie_.value(state) >= 0 ? state : trie_.output_link(state);
+            for (; o >= 0; o = trie_.output_link(o)) {
+                size_t begin = i - static_cast<size_t>(trie_.depth(o));
+                if (best_begin != NONE && begin > best_begin) break;
+                const AddedToken& token = tokens_[trie_.value(o)];
+                if (!accept(token, text, begin, i)) continue;
+                best_begin = begin;
+                best_end = i;
+                best_index = trie_.value(o);
+                break;
+            }
+            // Commit once no live prefix can start at or before the best match.
+            if (best_begin == NONE) continue;
+            if (i < n && i - static_cast<size_t>(trie_.depth(state)) <= best_begin) continue;
+
+            const AddedToken& token = tokens_[best_index];
+            size_t begin = best_begin, end = best_end;
+            if (token.lstrip) {
+                while (begin > emitted) {
+                    int32_t k = static_cast<int32_t>(begin);
+                    UChar32 c;
+                    U8_PREV(bytes(text), static_cast<int32_t>(emitted), k, c);
+                    if (!is_space(c)) break;
+                    begin = static_cast<size_t>(k);
+                }
+            }
+            if (token.rstrip) {
+                while (end < n) {
+                    int32_t k = static_cast<int32_t>(end);
+                    UChar32 c;
+                    U8_NEXT(bytes(text), k, static_cast<int32_t>(n), c);
+                    if (!is_space(c)) break;
+                    end = static_cast<size_t>(k);
+                }
+            }
+            if (begin > emitted) out.push_back(Segment{ emitted, begin, -1, false });
+            out.push_back(Segment{ begin, end, token.id, token.special });
+            emitted = end;
+
+            i = end;
+            state = DoubleArrayTrie::root();
+            best_begin = NONE;
+        }
+        if (emitted < n) out.push_back(Segment{ emitted, n, -1, false });
+    }
+
+} // namespace auratokenizer
@@ -0,0 +1,233 @@
+#include "bert_pipeline.h"
+
+#include <unicode/normalizer2.h>
+#include <unicode/uchar.h>
+#include <unicode/unistr.h>
+#include <unicode/utf8.h>
+
+#include <cstring>
+#include <vector>
+
+namespace auratokenizer {
+
+    namespace {
+
+        enum CharKind : uint8_t { WORD, SPACE, PUNCT, CONTROL, CJK, DROP };
+
+        bool is_cjk(UChar32 c) {
+            return (c >= 0x4E00 && c <= 0x9FFF) || (c >= 0x3400 && c <= 0x4DBF)
+                || (c >= 0x20000 && c <= 0x2A6DF) || (c >= 0x2A700 && c <= 0x2B73F)
+                || (c >= 0x2B740 && c <= 0x2B81F) || (c >= 0x2B820 && c <= 0x2CEAF)
+                || (c >= 0xF900 && c <= 0xFAFF) || (c >= 0x2F800 && c <= 0x2FA1F);
+        }
+
+        // Same categories as BERT's _is_whitespace/_is_control/_is_punctuation.
+        CharKind classify(UChar32 c) {
+            if (c == 0 || c == 0xFFFD) return DROP;
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r') return SPACE;
+            if ((c >= 33 && c <= 47) || (c >= 58 && c <= 64) || (c >= 91 && c <= 96) || (c >= 123 && c <= 126)) {
+                return PUNCT;
+            }
+            if (is_cjk(c)) return CJK;
+            switch (u_charType(c)) {
+            case U_SPACE_SEPARATOR:
+                return SPACE;
+            case U_CONTROL_CHAR:
+            case U_FORMAT_CHAR:
+            case U_UNASSIGNED:
+            case U_PRIVATE_USE_CHAR:
+            case U_SURROGATE:
+                return CONTROL;
+            case U_DASH_PUNCTUATION:
+            case U_START_PUNCTUATION:
+            case U_END_PUNCTUATION:
+            case U_CONNECTOR_PUNCTUATION:
+            case U_OTHER_PUNCTUATION:
+            case U_INITIAL_PUNCTUATION:
+            case U_FINAL_PUNCTUATION:
+                return PUNCT;
+            default:
+                return WORD;
+            }
+        }
+
+        void append_utf8(UChar32 c, std::string& out) {
+            char buf[U8_MAX_LENGTH];
+            int32_t len = 0;
+            UBool error = false;
+            U8_APPEND(reinterpret_cast<uint8_t*>(buf), len, U8_MAX_LENGTH, c, error);
+            if (!error) out.append(buf, static_cast<size_t>(len));
+        }
+
+        // Lowercase and/or strip accents from one character, appending UTF-8.
+        void map_char(UChar32 c, bool lowercase, bool strip_accents, std::string& out) {
+            if (lowercase) c = u_tolower(c);
+            if (!strip_accents) {
+                append_utf8(c, out);
+                return;
+            }
+            static const icu::Normalizer2* nfd = [] {
+                UErrorCode status = U_ZERO_ERROR;
+                return icu::Normalizer2::getNFDInstance(status);
+            }();
+            icu::UnicodeString decomposition;
+            if (!nfd || !nfd->getDecomposition(c, decomposition)) {
+                if (u_charType(c) != U_NON_SPACING_MARK) append_utf8(c, out);
+                return;
+            }
+            for (int32_t i = 0; i < decomposition.length(); ) {
+                UChar32 d = decomposition.char32At(i);
+                i += U16_LENGTH(d);
+                if (u_charType(d) != U_NON_SPACING_MARK) append_utf8(d, out);
+            }
+        }
+
+        // Precomputed kind and mapped bytes for every one- and two-byte character.
+        constexpr UChar32 kTableSize = 0x800;
+
+        struct CharEntry {
+            uint8_t kind;
+            uint8_t len;      // kSlow if the mapping does not fit in bytes
+            char    bytes[6];
+        };
+        constexpr uint8_t kSlow = 0xFF;
+
+        struct CharTable {
+            CharEntry entries[kTableSize];
+
+            CharTable(bool lowercase, bool strip_accents) {
+                std::string mapped;
+                for (UChar32 c = 0; c < kTableSize; ++c) {
+                    CharEntry& e = entries[c];
+                    e.kind = classify(c);
+                    mapped.clear();
+                    map_char(c, lowercase, strip_accents, mapped);
+                    if (mapped.size() <= sizeof(e.bytes)) {
+                        e.len = static_cast<uint8_t>(mapped.size());
+                        std::memcpy(e.bytes, mapped.data(), mapped.size());
+                    } else {
+                        e.len = kSlow;
+                    }
+                }
+            }
+        };
+
+        const CharTable& char_table(bool lowercase, bool strip_accents) {
+            static const CharTable tables[4] = {
+                CharTable(false, false), CharTable(false, true), CharTable(true, false), CharTable(true, true)
+            };
+            return tables[(lowercase ? 2 : 0) + (strip_accents ? 1 : 0)];
+        }
+
+        // One pass over text: on_word(word, src_begin, src_end) receives each
+        // finished word and, per word byte, the source range of its character.
+        template <typename OnWord>
+        void for_each_word(std::string_view text, const BertOptions& options, OnWord&& on_word) {
+            const CharTable& table = char_table(options.lowercase, options.strip_accents);
+
+            thread_local std::string word;
+            thread_local std::vector<uint32_t> src_begin, src_end;
+            thread_local std::string mapped;
+            word.clear();
+            src_begin.clear();
+            src_end.clear();
+
+            auto flush = [&]() {
+                if (word.empty()) return;
+                on_word(std::string_view(word), src_begin.data(), src_end.data());
+                word.clear();
+                src_begin.clear();
+                src_end.clear();
+            };
+            auto append = [&](const char* bytes, size_t len, uint32_t begin, uint32_t end) {
+                word.append(bytes, len);
+                src_begin.insert(src_begin.end(), len, begin);
+                src_end.insert(src_end.end(), len, end);
+            };
+
+            const uint8_t* s = reinterpret_cast<const uint8_t*>(text.data());
+            const int32_t n = static_cast<int32_t>(text.size());
+            int32_t i = 0;
+            while (i < n) {
+                const int32_t begin = i;
+                UChar32 c = s[i];
+                if (c < 0x80) {
+                    ++i;
+                } else {
+                    U8_NEXT(s, i, n, c);
+                    if (c < 0) c = 0xFFFD;
+                }
+
+                const char* bytes;
+                size_t len;
+                CharKind kind;
+                if (c < kTableSize && table.entries[c].len != kSlow) {
+                    const CharEntry& e = table.entries[c];
+                    kind = static_cast<CharKind>(e.kind);
+                    bytes = e.bytes;
+                    len = e.len;
+                } else {
+                    kind = classify(c);
+                    mapped.clear();
+                    if (kind != SPACE) map_char(c, options.lowercase, options.strip_accents, mapped);
+                    bytes = mapped.data();
+                    len = mapped.size();
+                }
+
+                if ((kind == DROP || kind == CONTROL) && options.clean_text) continue;
+                if (kind == CJK && !options.handle_chinese_chars) kind = WORD;
+                switch (kind) {
+                case SPACE:
+                    flush();
+                    break;
+                case PUNCT:
+                case CJK:
+                    flush();
+                    append(bytes, len, static_cast<uint32_t>(begin), static_cast<uint32_t>(i));
+                    flush();
+                    break;
+                default:
+                    append(bytes, len, static_cast<uint32_t>(begin), static_cast<uint32_t>(i));
+                    break;
+                }
+            }
+            flush();
+        }
+
+    } // namespace
+
+    BertOptions bert_options(const TokenizerConfig& config) {
+        BertOptions options;
+        options.clean_text = config.clean_text;
+        options.lowercase = config.lowercase;
+        options.strip_accents = config.strip_accents || (config.strip_accents_with_lowercase && config.lowercase);
+        return options;
+    }
+
+    BertOptions split_only_options() {
+        BertOptions options;
+        options.clean_text = false;
+        options.handle_chinese_chars = false;
+        options.strip_accents = false;
+        options.lowercase = false;
+        return options;
+    }
+
+    void BertPipeline::encode(std::string_view text, int unk_id, EncodeBuffer& out) const {
+        thread_local std::vector<models::WordPieceModel::PieceSpan> spans;
+        for_each_word(text, options_, [&](std::string_view word, const uint32_t* src_begin, const uint32_t* src_end) {
+            spans.clear();
+            model_.tokenize_spans(word, spans);
+            for (const auto& span : spans) {
+                out.push(span.unk ? unk_id : span.id, src_begin[span.begin], src_end[span.end - 1], span.unk);
+            }
+        });
+    }
+
+    void BertPipeline::split_words(std::string_view text, const BertOptions& options,
+        const std::function<void(std::string_view word)>& on_word)
+    {
+        for_each_word(text, options, [&](std::string_view word, const uint32_t*, const uint32_t*) { on_word(word); });
+    }
+
+} // namespace auratokenizer
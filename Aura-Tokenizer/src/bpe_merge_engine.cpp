@@ -0,0 +1,195 @@
+#include "bpe_merge_engine.h"
+#include "byte_level.h"
+
+#include <algorithm>
+
+namespace auratokenizer {
+
+    namespace {
+
+        struct SymbolNode {
+            uint32_t symbol;
+            int32_t  prev;
+            int32_t  next;
+            bool     alive;
+        };
+
+        struct MergeCandidate {
+            int32_t  rank;
+            int32_t  left;       // node index of the left symbol (= position)
+            int32_t  right;      // node index of the right symbol
+            uint32_t left_symbol;
+            uint32_t right_symbol;
+            uint32_t merged;
+        };
+
+        // Min-heap on (rank, position): lowest rank first, leftmost on ties.
+        struct CandidateGreater {
+            bool operator()(const MergeCandidate& a, const MergeCandidate& b) const {
+                if (a.rank != b.rank) return a.rank > b.rank;
+                return a.left > b.left;
+            }
+        };
+
+        struct MergeWorkspace {
+            std::vector<SymbolNode> nodes;
+            std::vector<MergeCandidate> heap;
+        };
+
+        MergeWorkspace& workspace() {
+            thread_local MergeWorkspace ws;
+            return ws;
+        }
+
+    } // namespace
+
+    BPEMergeEngine::BPEMergeEngine() : mask_(0), merge_count_(0), byte_level_(false) {
+        clear();
+    }
+
+    void BPEMergeEngine::clear() {
+        symbols_.clear();
+        symbol_bytes_.clear();
+        symbol_ids_.clear();
+        symbols_.reserve(BYTE_SYMBOLS);
+        for (uint32_t b = 0; b < BYTE_SYMBOLS; ++b) {
+            intern(std::string(1, static_cast<char>(b)));
+        }
+        table_.assign(16, Slot{ 0, -1, 0 });
+        mask_ = table_.size() - 1;
+        merge_count_ = 0;
+        byte_level_ = false;
+    }
+
+    uint32_t BPEMergeEngine::intern(const std::string& text) {
+        auto it = symbol_ids_.find(text);
+        if (it != symbol_ids_.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(symbols_.size());
+        symbols_.push_back(text);
+        symbol_bytes_.push_back(static_cast<uint32_t>(text.size()));
+        symbol_ids_.emplace(text, id);
+        return id;
+    }
+
+    int64_t BPEMergeEngine::symbol_id(const std::string& text) const {
+        auto it = symbol_ids_.find(text);
+        return it != symbol_ids_.end() ? static_cast<int64_t>(it->second) : -1;
+    }
+
+    void BPEMergeEngine::build(const std::vector<std::pair<std::string, std::string>>& merges, bool byte_level) {
+        clear();
+        byte_level_ = byte_level;
+
+        // Keep the load factor at or below 0.5 so probe sequences stay short.
+        size_t capacity = 16;
+        while (capacity < merges.size() * 2) capacity <<= 1;
+        table_.assign(capacity, Slot{ 0, -1, 0 });
+        mask_ = capacity - 1;
+
+        for (size_t i = 0; i < merges.size(); ++i) {
+            const auto& rule = merges[i];
+            if (rule.first.empty() || rule.second.empty()) continue;
+            std::string first = byte_level_ ? byte_level::from_unicode(rule.first) : rule.first;
+            std::string second = byte_level_ ? byte_level::from_unicode(rule.second) : rule.second;
+            uint32_t left = intern(first);
+            uint32_t right = intern(second);
+            uint32_t merged = intern(first + second);
+            insert_pair(left, right, static_cast<int32_t>(i), merged);
+        }
+
+        // Symbols are interned by raw bytes; expose their byte-level text so
+        // it can be looked up directly in a GPT-2 style vocab.
+        if (byte_level_) {
+            for (auto& text : symbols_) text = byte_level::to_unicode(text);
+        }
+    }
+
+    void BPEMergeEngine::insert_pair(uint32_t left, uint32_t right, int32_t rank, uint32_t merged) {
+        uint64_t key = pack(left, right);
+        size_t pos = hash_key(key) & mask_;
+        while (table_[pos].rank >= 0) {
+            if (table_[pos].key == key) {
+                // Duplicate rule: the later rank overrides, as with a map assignment.
+                table_[pos].rank = rank;
+                table_[pos].merged = merged;
+                return;
+            }
+            pos = (pos + 1) & mask_;
+        }
+        table_[pos] = Slot{ key, rank, merged };
+        ++merge_count_;
+    }
+
+    bool BPEMergeEngine::find_merge(uint32_t left, uint32_t right, int32_t& rank, uint32_t& merged) const {
+        uint64_t key = pack(left, right);
+        size_t pos = hash_key(key) & mask_;
+        while (table_[pos].rank >= 0) {
+            if (table_[pos].key == key) {
+                rank = table_[pos].rank;
+                merged = table_[pos].merged;
+                return true;
+            }
+            pos = (pos + 1) & mask_;
+        }
+        return false;
+    }
+
+    void BPEMergeEngine::merge_word(std::string_view word, std::vector<uint32_t>& out) const {
+        if (word.empty()) return;
+        if (word.size() == 1 || merge_count_ == 0) {
+            for (unsigned char c : word) out.push_back(c);
+            return;
+        }
+
+        MergeWorkspace& ws = workspace();
+        std::vector<SymbolNode>& nodes = ws.nodes;
+        std::vector<MergeCandidate>& heap = ws.heap;
+        nodes.clear();
+        heap.clear();
+
+        const int32_t n = static_cast<int32_t>(word.size());
+        for (int32_t i = 0; i < n; ++i) {
+            nodes.push_back(SymbolNode{ static_cast<unsigned char>(word[i]), i - 1, i + 1 < n ? i + 1 : -1, true });
+        }
+
+        CandidateGreater greater;
+        auto push_candidate = [&](int32_t left) {
+            int32_t right = nodes[left].next;
+            if (right < 0) return;
+            int32_t rank;
+            uint32_t merged;
+            if (find_merge(nodes[left].symbol, nodes[right].symbol, rank, merged)) {
+                heap.push_back(MergeCandidate{ rank, left, right, nodes[left].symbol, nodes[right].symbol, merged });
+                std::push_heap(heap.begin(), heap.end(), greater);
+            }
+        };
+
+        for (int32_t i = 0; i + 1 < n; ++i) push_candidate(i);
+
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), greater);
+            MergeCandidate top = heap.back();
+            heap.pop_back();
+
+            // Skip candidates invalidated by an earlier merge: a merged node
+            // always carries a new (longer) symbol, and a consumed node dies.
+            SymbolNode& left = nodes[top.left];
+            if (!left.alive || left.next != top.right || left.symbol != top.left_symbol) continue;
+            SymbolNode& right = nodes[top.right];
+            if (!right.alive || right.symbol != top.right_symbol) continue;
+
+            left.symbol = top.merged;
+            left.next = right.next;
+            right.alive = false;
+            if (right.next >= 0) nodes[right.next].prev = top.left;
+
+            if (left.prev >= 0) push_candidate(left.prev);
+            push_candidate(top.left);
+        }
+
+        for (int32_t i = 0; i >= 0; i = nodes[i].next) {
+            out.push_back(nodes[i].symbol);
+        }
+    }
+
+} // namespace auratokenizer
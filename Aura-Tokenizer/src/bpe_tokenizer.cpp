@@ -1,8 +1,9 @@
 ﻿#include "bpe_tokenizer.h"
 #include "serialization_utils.h"
+#include "byte_level.h"
+#include "utf8_scan.h"
 
 #include <fstream>
-#include <sstream>
 #include <algorithm>
 #include <cctype>
 
@@ -11,8 +12,11 @@ namespace auratokenizer {
     BPETokenizer::BPETokenizer(const TokenizerConfig& config)
         : TokenizerBase(config),
           normalizer_(config),
-          vocab_(std::make_shared<Vocab>()) {
+          vocab_(std::make_shared<Vocab>()),
+          config_(config),
+          cache_(std::make_unique<BPEWordCache>(config.encode_cache_bytes)) {
         initialize_special_tokens();
+        build_merge_ranks();
     }
 
     BPETokenizer::~BPETokenizer() = default;
@@ -33,32 +37,107 @@ namespace auratokenizer {
         add(SpecialTokenType::MASK, config_.mask_token);
         add(SpecialTokenType::SEP, config_.sep_token);
         add(SpecialTokenType::CLS, config_.cls_token);
+        for (const auto& pair : config_.added_tokens) {
+            vocab_->add_special_token(pair.first, SpecialTokenType::CUSTOM);
+        }
+        rebuild_added_tokens();
+    }
+
+    void BPETokenizer::rebuild_added_tokens() {
+        std::vector<AddedToken> tokens;
+        for (const auto& text : vocab_->get_special_tokens()) {
+            AddedToken token;
+            token.content = text;
+            token.id = vocab_->get_token_id(text);
+            tokens.push_back(std::move(token));
+        }
+        // User-added entries come last so their strip rules win on duplicates.
+        for (auto& token : added_tokens_) {
+            token.id = vocab_->get_token_id(token.content);
+            tokens.push_back(token);
+        }
+        added_token_splitter_.build(tokens);
     }
 
     void BPETokenizer::set_config(const TokenizerConfig& config) {
         config_ = config;
         normalizer_ = UnicodeNormalizer(config_);
+        cache_->set_capacity(config_.encode_cache_bytes);
         initialize_special_tokens();
+        build_merge_ranks(); // byte_level may have changed
     }
 
     std::vector<Token> BPETokenizer::encode(const std::string& text) {
-        std::vector<std::string> words = pre_tokenize(text);
+        EncodeBuffer buffer;
         std::vector<Token> tokens;
-        for (const auto& word : words) {
-            auto sub_tokens = encode_bpe(word);
-            tokens.insert(tokens.end(), sub_tokens.begin(), sub_tokens.end());
-        }
+        encode_segments(text, buffer, &tokens);
         return tokens;
     }
 
     std::vector<int> BPETokenizer::encode_to_ids(const std::string& text) {
-        std::vector<Token> token_objs = encode(text);
-        std::vector<int> ids;
-        ids.reserve(token_objs.size());
-        for (const auto& t : token_objs) {
-            ids.push_back(t.id);
+        EncodeBuffer buffer;
+        encode_into(text, buffer);
+        return std::move(buffer.ids);
+    }
+
+    void BPETokenizer::encode_into(std::string_view text, EncodeBuffer& out) {
+        encode_segments(text, out, nullptr);
+    }
+
+    void BPETokenizer::encode_segments(std::string_view text, EncodeBuffer& out, std::vector<Token>* tokens) {
+        out.clear();
+
+        // Added/special tokens are cut out of the raw text first; only the spans
+        // between them are normalized and run through the merge engine.
+        thread_local std::vector<AddedTokenSplitter::Segment> segments;
+        thread_local std::vector<byte_level::Span> words;
+        thread_local std::vector<BPEWordCache::Piece> pieces;
+        thread_local std::string prefixed;
+        added_token_splitter_.split(text, segments);
+
+        // Offsets are into text. A normalized segment is tokenized in its own
+        // coordinates and mapped back through its alignment afterwards.
+        const bool identity = normalizer_.is_identity();
+        for (const auto& segment : segments) {
+            std::string_view raw = text.substr(segment.begin, segment.end - segment.begin);
+            if (segment.id >= 0) {
+                out.push(segment.id, segment.begin, segment.end, segment.special);
+                if (tokens) tokens->emplace_back(segment.id, std::string(raw), segment.special, out.offsets.back());
+                continue;
+            }
+
+            const size_t first = out.size();
+            const size_t base = identity ? segment.begin : 0;
+            std::string_view input = normalizer_.normalize_view(raw, out.normalized);
+
+            // The synthetic prefix space has no source bytes; shift it out of the offsets.
+            size_t shift = 0;
+            if (config_.byte_level && config_.add_prefix_space && !input.empty() && input[0] != ' ') {
+                prefixed.assign(1, ' ');
+                prefixed.append(input.data(), input.size());
+                input = prefixed;
+                shift = 1;
+            }
+
+            words.clear();
+            split_words(input, words);
+            for (const auto& word : words) {
+                encode_word(input.substr(word.begin, word.end - word.begin), pieces);
+                size_t pos = word.begin;
+                for (const auto& piece : pieces) {
+                    size_t end = pos + merge_engine_.symbol_bytes(piece.symbol);
+                    out.push(piece.id, base + (pos > shift ? pos - shift : 0), base + end - shift, piece.is_special);
+                    if (tokens) tokens->emplace_back(piece.id, merge_engine_.symbol_text(piece.symbol), piece.is_special, out.offsets.back());
+                    pos = end;
+                }
+            }
+            if (!identity) {
+                out.normalized.to_original(out.offsets, first, segment.begin);
+                if (tokens) {
+                    for (size_t i = first; i < out.size(); ++i) (*tokens)[i].offset = out.offsets[i];
+                }
+            }
         }
-        return ids;
     }
 
     std::vector<std::vector<int>> BPETokenizer::batch_encode(const std::vector<std::string>& texts) {
@@ -81,11 +160,16 @@ namespace auratokenizer {
     std::string BPETokenizer::decode_from_ids(const std::vector<int>& ids) {
         std::string result;
         for (int id : ids) {
-            result += vocab_->get_token(id);
+            result += vocab_->get_token_view(id);
         }
         return post_process_text(result);
     }
 
+    DecodeStream BPETokenizer::decode_stream(bool skip_special_tokens) const {
+        auto mode = config_.byte_level ? DecodeStream::Mode::BYTE_LEVEL : DecodeStream::Mode::RAW;
+        return DecodeStream(vocab_, mode, skip_special_tokens);
+    }
+
     std::vector<std::string> BPETokenizer::batch_decode(const std::vector<std::vector<int>>& ids_batch) {
         std::vector<std::string> results;
         results.reserve(ids_batch.size());
@@ -103,6 +187,11 @@ namespace auratokenizer {
         trainer.train(corpus, vocab_, vocab_size);
         merge_rules_ = trainer.get_merge_rules();
         build_merge_ranks();
+
+        // The trainer rebuilt the vocab; re-register user-added tokens.
+        std::vector<AddedToken> added;
+        added.swap(added_tokens_);
+        add_tokens(added);
     }
 
     void BPETokenizer::save(const std::string& path) {
@@ -127,6 +216,7 @@ namespace auratokenizer {
         set_config(config_); // Re-initialize with loaded config
 
         vocab_->load(ifs); // Vocab is loaded after config sets up special tokens
+        rebuild_added_tokens();
 
         size_t rules_count;
         read_primitive(ifs, &rules_count, sizeof(rules_count));
@@ -146,6 +236,24 @@ namespace auratokenizer {
                 vocab_->add_special_token(token, SpecialTokenType::CUSTOM);
             }
         }
+        rebuild_added_tokens();
+        cache_->clear();
+    }
+
+    void BPETokenizer::add_tokens(const std::vector<AddedToken>& tokens) {
+        for (const auto& token : tokens) {
+            if (token.content.empty()) continue;
+            if (!vocab_->has_token(token.content)) {
+                if (token.special) {
+                    vocab_->add_special_token(token.content, SpecialTokenType::CUSTOM);
+                } else {
+                    vocab_->add_token(token.content);
+                }
+            }
+            added_tokens_.push_back(token);
+        }
+        rebuild_added_tokens();
+        cache_->clear();
     }
 
     std::vector<std::string> BPETokenizer::get_special_tokens() const { return vocab_->get_special_tokens(); }
@@ -155,6 +263,7 @@ namespace auratokenizer {
     void BPETokenizer::set_vocab(std::shared_ptr<Vocab> vocab) {
         vocab_ = vocab;
         initialize_special_tokens();
+        cache_->clear();
     }
     const std::vector<std::pair<std::string, std::string>>& BPETokenizer::get_merge_rules() const { return merge_rules_; }
 
@@ -170,61 +279,65 @@ namespace auratokenizer {
         build_merge_ranks();
     }
 
-    std::vector<std::string> BPETokenizer::pre_tokenize(const std::string& text) const {
-        std::string normalized = normalizer_.normalize(text);
-        // This is a simple whitespace splitter. A real implementation might use ICU.
-        std::vector<std::string> words;
-        std::stringstream ss(normalized);
-        std::string word;
-        while (ss >> word) {
-            words.push_back(word);
+    void BPETokenizer::split_words(std::string_view text, std::vector<byte_level::Span>& words) const {
+        if (config_.byte_level) {
+            // Pieces stay raw bytes; the merge engine maps them to the byte alphabet.
+            byte_level::split(text, config_.byte_level_pattern, words);
+            return;
+        }
+        // Whitespace split, same separators as operator>> in the "C" locale.
+        size_t i = 0;
+        while (i < text.size()) {
+            while (i < text.size() && is_ascii_space(text[i])) ++i;
+            size_t start = i;
+            while (i < text.size() && !is_ascii_space(text[i])) ++i;
+            if (i > start) words.push_back(byte_level::Span{ start, i });
         }
-        return words;
     }
 
-    std::vector<Token> BPETokenizer::encode_bpe(const std::string& word) const {
-        if (word.empty()) return {};
-
-        std::vector<std::string> parts;
-        for (char c : word) parts.emplace_back(1, c);
+    void BPETokenizer::encode_word(std::string_view word, std::vector<BPEWordCache::Piece>& pieces) const {
+        pieces.clear();
+        if (word.empty()) return;
 
-        while (parts.size() > 1) {
-            int best_rank = -1;
-            int merge_idx = -1;
-            for (size_t i = 0; i < parts.size() - 1; ++i) {
-                std::string pair_key = parts[i] + " " + parts[i + 1];
-                auto it = merge_ranks_.find(pair_key);
-                if (it != merge_ranks_.end()) {
-                    if (best_rank == -1 || it->second < best_rank) {
-                        best_rank = it->second;
-                        merge_idx = i;
-                    }
-                }
-            }
-            if (merge_idx == -1) break;
+        thread_local std::string key;
+        key.assign(word.data(), word.size());
+        if (cache_->lookup(key, pieces)) return;
 
-            parts[merge_idx] += parts[merge_idx + 1];
-            parts.erase(parts.begin() + merge_idx + 1);
-        }
+        thread_local std::vector<uint32_t> symbols;
+        symbols.clear();
+        merge_engine_.merge_word(word, symbols);
 
-        std::vector<Token> result;
         int unk_id = vocab_->get_special_token_id(SpecialTokenType::UNK);
-        for (const auto& p : parts) {
+        for (uint32_t symbol : symbols) {
+            const std::string& p = merge_engine_.symbol_text(symbol);
             int id = vocab_->get_token_id(p);
-            result.emplace_back(id >= 0 ? id : unk_id, p, vocab_->is_special_token(p));
+            pieces.push_back({ id >= 0 ? id : unk_id, symbol, vocab_->is_special_token(p) });
         }
-        return result;
+        cache_->insert(key, pieces);
     }
 
     void BPETokenizer::build_merge_ranks() {
-        merge_ranks_.clear();
-        for (size_t i = 0; i < merge_rules_.size(); ++i) {
-            merge_ranks_[merge_rules_[i].first + " " + merge_rules_[i].second] = i;
-        }
+        merge_engine_.build(merge_rules_, config_.byte_level);
+        cache_->clear();
+    }
+
+    void BPETokenizer::set_cache_capacity(size_t bytes) {
+        config_.encode_cache_bytes = bytes;
+        cache_->set_capacity(bytes);
+    }
+
+    void BPETokenizer::clear_cache() {
+        cache_->clear();
+    }
+
+    BPEWordCache::Stats BPETokenizer::get_cache_stats() const {
+        return cache_->stats();
     }
 
     std::string BPETokenizer::post_process_text(const std::string& text) const {
-        // Simple placeholder for post-processing
+        if (config_.byte_level) {
+            return byte_level::from_unicode(text);
+        }
         return text;
     }
 
@@ -1,8 +1,7 @@
 ﻿#include "bpe_trainer.h"
-#include <fstream>
-#include <sstream>
+#include "byte_level.h"
+#include "utf8_scan.h"
 #include <algorithm>
-#include <cctype>
 
 namespace auratokenizer {
 
@@ -30,108 +29,191 @@ namespace auratokenizer {
         normalizer_ = norm;
     }
 
-    std::unordered_map<std::string, int> BPETrainer::get_word_counts(const std::vector<std::string>& corpus) {
-        std::unordered_map<std::string, int> counts;
-        for (const auto& text : corpus) {
-            std::string normalized = normalizer_.normalize(text);
-            if (config_.lowercase) {
-                std::transform(normalized.begin(), normalized.end(), normalized.begin(), [](unsigned char c) { return std::tolower(c); });
+    CorpusCounts BPETrainer::get_word_counts(const std::vector<std::string>& corpus) const {
+        CorpusCounts counts;
+        for (const auto& text : corpus) count_words(text, counts);
+        return counts;
+    }
+
+    void BPETrainer::count_words(std::string_view text, CorpusCounts& counts) const {
+        // Same pre-tokenization as BPETokenizer, so learned merges apply to the words it sees.
+        thread_local std::vector<byte_level::Span> spans;
+        thread_local std::string key;
+        std::string normalized = normalizer_.normalize(std::string(text));
+        if (config_.byte_level) {
+            if (config_.add_prefix_space && !normalized.empty() && normalized[0] != ' ') {
+                normalized.insert(normalized.begin(), ' ');
             }
-            std::istringstream iss(normalized);
-            std::string word;
-            while (iss >> word) {
-                std::string word_with_suffix = word + "</w>";
-                counts[word_with_suffix]++;
+            spans.clear();
+            byte_level::split(normalized, config_.byte_level_pattern, spans);
+            for (const auto& span : spans) {
+                key.assign(normalized, span.begin, span.end - span.begin);
+                counts[key]++;
+            }
+            return;
+        }
+        size_t i = 0;
+        while (i < normalized.size()) {
+            while (i < normalized.size() && is_ascii_space(normalized[i])) ++i;
+            size_t start = i;
+            while (i < normalized.size() && !is_ascii_space(normalized[i])) ++i;
+            if (i > start) {
+                key.assign(normalized, start, i - start);
+                counts[key]++;
             }
         }
-        return counts;
     }
 
-    std::unordered_map<BPETrainer::Pair, int, BPETrainer::PairHash> BPETrainer::get_pair_counts(const std::unordered_map<std::string, int>& word_counts) const {
-        std::unordered_map<Pair, int, PairHash> counts;
-        for (const auto& [word, count] : word_counts) {
-            std::vector<std::string> symbols;
-            for (char c : word) symbols.emplace_back(1, c);
+    uint32_t BPETrainer::intern(const std::string& text) {
+        auto it = symbol_ids_.find(text);
+        if (it != symbol_ids_.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(symbols_.size());
+        symbols_.push_back(text);
+        symbol_ids_.emplace(text, id);
+        return id;
+    }
 
-            for (size_t i = 0; i < symbols.size() - 1; ++i) {
-                counts[{symbols[i], symbols[i + 1]}] += count;
-            }
-        }
-        return counts;
+    std::string BPETrainer::token_text(uint32_t symbol) const {
+        return config_.byte_level ? byte_level::to_unicode(symbols_[symbol]) : symbols_[symbol];
     }
 
-    void BPETrainer::merge_pair_counts(const std::string& first, const std::string& second, std::unordered_map<std::string, int>& word_counts, const Pair& best_pair, std::string& new_token) {
-        std::unordered_map<std::string, int> new_word_counts;
-        std::string bigram = first + second;
-        std::regex pattern(first + " " + second);
+    bool BPETrainer::heap_less(const PairEntry& a, const PairEntry& b) const {
+        if (a.count != b.count) return a.count < b.count;
+        // Equal counts: the lexicographically smaller pair ranks higher.
+        if (a.left != b.left) return symbols_[a.left] > symbols_[b.left];
+        return symbols_[a.right] > symbols_[b.right];
+    }
 
-        for (auto const& [word, count] : word_counts) {
-            std::string new_word;
-            std::string s_word = word;
+    void BPETrainer::push_pair(uint32_t left, uint32_t right) {
+        heap_.push_back(PairEntry{ pair_counts_[pack(left, right)], left, right });
+        std::push_heap(heap_.begin(), heap_.end(), [this](const PairEntry& a, const PairEntry& b) { return heap_less(a, b); });
+    }
 
-            // Re-split word into symbols
-            std::string current_sub;
-            for (char c : s_word) {
-                current_sub += c;
-                if (new_word.empty()) new_word = current_sub;
-                else new_word += " " + current_sub;
-                current_sub = "";
+    void BPETrainer::apply_merge(uint32_t left, uint32_t right, uint32_t merged) {
+        auto found = pair_words_.find(pack(left, right));
+        if (found == pair_words_.end()) return;
+        std::vector<uint32_t> affected = std::move(found->second);
+        pair_words_.erase(found);
+        std::sort(affected.begin(), affected.end());
+        affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+
+        std::vector<uint32_t> rewritten;
+        std::vector<std::pair<uint32_t, uint32_t>> touched;
+        for (uint32_t w : affected) {
+            Word& word = words_[w];
+            const auto& old = word.symbols;
+            rewritten.clear();
+            for (size_t i = 0; i < old.size(); ++i) {
+                if (i + 1 < old.size() && old[i] == left && old[i + 1] == right) {
+                    rewritten.push_back(merged);
+                    ++i;
+                } else {
+                    rewritten.push_back(old[i]);
+                }
             }
+            if (rewritten.size() == old.size()) continue; // stale index entry
 
-            std::string out_word = std::regex_replace(new_word, pattern, bigram);
-            new_word_counts[out_word] = count;
+            for (size_t i = 0; i + 1 < old.size(); ++i) {
+                pair_counts_[pack(old[i], old[i + 1])] -= word.count;
+            }
+            // Every pair that is new to this word contains the merged symbol.
+            for (size_t i = 0; i + 1 < rewritten.size(); ++i) {
+                uint64_t key = pack(rewritten[i], rewritten[i + 1]);
+                pair_counts_[key] += word.count;
+                if (rewritten[i] == merged || rewritten[i + 1] == merged) {
+                    auto& list = pair_words_[key];
+                    if (list.empty() || list.back() != w) list.push_back(w);
+                    touched.emplace_back(rewritten[i], rewritten[i + 1]);
+                }
+            }
+            word.symbols.swap(rewritten);
         }
-        word_counts = new_word_counts;
+        pair_counts_.erase(pack(left, right));
+
+        // Counts of all other pairs only went down; stale heap entries are fixed on pop.
+        std::sort(touched.begin(), touched.end());
+        touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+        for (const auto& pair : touched) push_pair(pair.first, pair.second);
     }
 
+    void BPETrainer::learn_bpe_merges(std::shared_ptr<Vocab> vocab, size_t vocab_size) {
+        pair_counts_.clear();
+        pair_words_.clear();
+        heap_.clear();
+        for (uint32_t w = 0; w < words_.size(); ++w) {
+            const Word& word = words_[w];
+            for (size_t i = 0; i + 1 < word.symbols.size(); ++i) {
+                uint64_t key = pack(word.symbols[i], word.symbols[i + 1]);
+                pair_counts_[key] += word.count;
+                auto& list = pair_words_[key];
+                if (list.empty() || list.back() != w) list.push_back(w);
+            }
+        }
+        auto less = [this](const PairEntry& a, const PairEntry& b) { return heap_less(a, b); };
+        heap_.reserve(pair_counts_.size());
+        for (const auto& [key, count] : pair_counts_) {
+            heap_.push_back(PairEntry{ count, static_cast<uint32_t>(key >> 32), static_cast<uint32_t>(key) });
+        }
+        std::make_heap(heap_.begin(), heap_.end(), less);
+
+        while (vocab->size() < vocab_size && !heap_.empty()) {
+            std::pop_heap(heap_.begin(), heap_.end(), less);
+            PairEntry top = heap_.back();
+            heap_.pop_back();
+
+            auto it = pair_counts_.find(pack(top.left, top.right));
+            int64_t current = it == pair_counts_.end() ? 0 : it->second;
+            if (current != top.count) {
+                if (current > 0) push_pair(top.left, top.right);
+                continue;
+            }
+            if (current < static_cast<int64_t>(min_frequency_)) break;
+
+            uint32_t merged = intern(symbols_[top.left] + symbols_[top.right]);
+            merge_rules_.emplace_back(token_text(top.left), token_text(top.right));
+            vocab->add_token(token_text(merged));
+            apply_merge(top.left, top.right, merged);
+        }
+        heap_.clear();
+        pair_words_.clear();
+    }
 
     void BPETrainer::train(const std::vector<std::string>& corpus, std::shared_ptr<Vocab> vocab, size_t vocab_size) {
         if (corpus.empty()) {
             throw TokenizerException("Empty corpus provided for training");
         }
         word_counts_ = get_word_counts(corpus);
+        train_words(vocab, vocab_size);
+    }
 
-        std::unordered_map<std::string, int> initial_vocab_counts;
-        for (const auto& [word, count] : word_counts_) {
-            for (char c : word) {
-                initial_vocab_counts[std::string(1, c)] += count;
+    void BPETrainer::train_words(std::shared_ptr<Vocab> vocab, size_t vocab_size) {
+        // Symbols 0..255 are the single bytes, as in BPEMergeEngine.
+        symbols_.clear();
+        symbol_ids_.clear();
+        for (int b = 0; b < 256; ++b) intern(std::string(1, static_cast<char>(b)));
+
+        // Sorted so word indices (and therefore the run) are reproducible.
+        std::vector<std::pair<std::string, size_t>> sorted(word_counts_.begin(), word_counts_.end());
+        std::sort(sorted.begin(), sorted.end());
+        std::vector<int64_t> byte_counts(256, 0);
+        words_.clear();
+        words_.reserve(sorted.size());
+        for (const auto& [word, count] : sorted) {
+            Word entry{ {}, static_cast<int64_t>(count) };
+            entry.symbols.reserve(word.size());
+            for (unsigned char c : word) {
+                entry.symbols.push_back(c);
+                byte_counts[c] += count;
             }
+            words_.push_back(std::move(entry));
         }
 
-        initialize_vocab(vocab, initial_vocab_counts);
-
-        for (size_t i = vocab->size(); i < vocab_size; ++i) {
-            pair_counts_ = get_pair_counts(word_counts_);
-            if (pair_counts_.empty()) break;
-
-            Pair best_pair;
-            int max_freq = 0;
-            for (const auto& [pair, freq] : pair_counts_) {
-                if (freq > max_freq) {
-                    max_freq = freq;
-                    best_pair = pair;
-                }
-            }
-            if (max_freq == 0) break;
-
-            merge_rules_.push_back({ best_pair.first, best_pair.second });
-            std::string new_token = best_pair.first + best_pair.second;
-            vocab->add_token(new_token);
-
-            std::unordered_map<std::string, int> next_word_counts;
-            for (const auto& [word, count] : word_counts_) {
-                std::string merged_word = word;
-                size_t pos = 0;
-                while ((pos = merged_word.find(best_pair.first + " " + best_pair.second, pos)) != std::string::npos) {
-                    merged_word.replace(pos, best_pair.first.length() + 1 + best_pair.second.length(), new_token);
-                }
-                next_word_counts[merged_word] = count;
-            }
-            word_counts_ = next_word_counts;
-        }
+        merge_rules_.clear();
+        initialize_vocab(vocab, byte_counts);
+        learn_bpe_merges(vocab, vocab_size);
     }
 
-    void BPETrainer::initialize_vocab(std::shared_ptr<Vocab> vocab, const std::unordered_map<std::string, int>& initial_vocab_counts) {
+    void BPETrainer::initialize_vocab(std::shared_ptr<Vocab> vocab, const std::vector<int64_t>& byte_counts) {
         vocab->clear();
         if (!config_.unk_token.empty()) vocab->add_special_token(config_.unk_token, SpecialTokenType::UNK);
         if (!config_.pad_token.empty()) vocab->add_special_token(config_.pad_token, SpecialTokenType::PAD);
@@ -141,37 +223,25 @@ namespace auratokenizer {
         if (!config_.sep_token.empty()) vocab->add_special_token(config_.sep_token, SpecialTokenType::SEP);
         if (!config_.cls_token.empty()) vocab->add_special_token(config_.cls_token, SpecialTokenType::CLS);
 
-        for (const auto& [token, count] : initial_vocab_counts) {
-            if (static_cast<size_t>(count) >= min_frequency_) {
-                vocab->add_token(token);
+        // Byte-level models keep the full 256-byte alphabet so no input maps to UNK.
+        for (int b = 0; b < 256; ++b) {
+            if (config_.byte_level || byte_counts[b] >= static_cast<int64_t>(min_frequency_)) {
+                vocab->add_token(token_text(static_cast<uint32_t>(b)));
             }
         }
     }
 
     void BPETrainer::train_from_file(const std::string& file_path, std::shared_ptr<Vocab> vocab) {
-        std::ifstream file(file_path);
-        if (!file.is_open()) throw TokenizerException("Failed to open training file: " + file_path);
-
-        std::vector<std::string> corpus;
-        std::string line;
-        while (std::getline(file, line)) {
-            if (!line.empty()) corpus.push_back(line);
-        }
-        train(corpus, vocab, vocab_size_);
+        train_from_files({ file_path }, vocab);
     }
 
     void BPETrainer::train_from_files(const std::vector<std::string>& file_paths, std::shared_ptr<Vocab> vocab) {
         if (file_paths.empty()) throw TokenizerException("No file paths provided");
 
-        std::vector<std::string> corpus;
-        for (const auto& path : file_paths) {
-            std::ifstream file(path);
-            if (!file.is_open()) throw TokenizerException("Failed to open file: " + path);
-            std::string line;
-            while (std::getline(file, line)) {
-                if (!line.empty()) corpus.push_back(line);
-            }
-        }
-        train(corpus, vocab, vocab_size_);
+        word_counts_ = count_corpus_files(file_paths,
+            [this](std::string_view line, CorpusCounts& counts) { count_words(line, counts); },
+            num_threads_);
+        if (word_counts_.empty()) throw TokenizerException("Empty corpus provided for training");
+        train_words(vocab, vocab_size_);
     }
 }
\ No newline at end of file
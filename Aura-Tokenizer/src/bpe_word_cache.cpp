@@ -0,0 +1,152 @@
+#include "bpe_word_cache.h"
+
+#include <functional>
+
+namespace auratokenizer {
+
+    BPEWordCache::BPEWordCache(size_t capacity_bytes, size_t num_shards)
+        : capacity_bytes_(capacity_bytes),
+          shard_capacity_(0),
+          hits_(0),
+          misses_(0),
+          evictions_(0) {
+        if (num_shards == 0) num_shards = 1;
+        shards_.reserve(num_shards);
+        for (size_t i = 0; i < num_shards; ++i) {
+            shards_.push_back(std::make_unique<Shard>());
+        }
+        shard_capacity_ = capacity_bytes_ / shards_.size();
+    }
+
+    size_t BPEWordCache::entry_bytes(const std::string& word, size_t num_pieces) {
+        // Key stored twice (index + slot), the pieces, plus a flat estimate
+        // for the hash node and vector/string headers.
+        return 2 * word.size() + num_pieces * sizeof(Piece) + 96;
+    }
+
+    BPEWordCache::Shard& BPEWordCache::shard_for(const std::string& word) const {
+        size_t h = std::hash<std::string>{}(word);
+        // Use high bits for the shard so it is independent of the bucket index.
+        return *shards_[(h >> 16) % shards_.size()];
+    }
+
+    bool BPEWordCache::lookup(const std::string& word, std::vector<Piece>& out) const {
+        if (capacity_bytes_ == 0) return false;
+        Shard& shard = shard_for(word);
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.index.find(word);
+            if (it != shard.index.end()) {
+                Entry& entry = shard.entries[it->second];
+                entry.referenced = true;
+                out.assign(entry.pieces.begin(), entry.pieces.end());
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    bool BPEWordCache::evict_one(Shard& shard) {
+        if (shard.index.empty()) return false;
+        // Each full sweep clears at least one reference bit, so two sweeps
+        // are enough to find a victim.
+        for (size_t steps = 0; steps < 2 * shard.entries.size() + 1; ++steps) {
+            if (shard.hand >= shard.entries.size()) shard.hand = 0;
+            Entry& entry = shard.entries[shard.hand];
+            uint32_t slot = static_cast<uint32_t>(shard.hand++);
+            if (!entry.used) continue;
+            if (entry.referenced) {
+                entry.referenced = false;
+                continue;
+            }
+            shard.index.erase(entry.key);
+            shard.bytes -= entry.bytes;
+            entry.key.clear();
+            entry.pieces.clear();
+            entry.used = false;
+            shard.free_slots.push_back(slot);
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void BPEWordCache::insert(const std::string& word, const std::vector<Piece>& pieces) {
+        if (capacity_bytes_ == 0) return;
+        size_t bytes = entry_bytes(word, pieces.size());
+        if (bytes > shard_capacity_) return;
+
+        Shard& shard = shard_for(word);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.index.find(word);
+        if (it != shard.index.end()) {
+            // Another thread raced us to the same word; keep its entry.
+            shard.entries[it->second].referenced = true;
+            return;
+        }
+
+        while (shard.bytes + bytes > shard_capacity_) {
+            if (!evict_one(shard)) return;
+        }
+
+        uint32_t slot;
+        if (!shard.free_slots.empty()) {
+            slot = shard.free_slots.back();
+            shard.free_slots.pop_back();
+        } else {
+            slot = static_cast<uint32_t>(shard.entries.size());
+            shard.entries.emplace_back();
+        }
+
+        Entry& entry = shard.entries[slot];
+        entry.key = word;
+        entry.pieces.assign(pieces.begin(), pieces.end());
+        entry.bytes = bytes;
+        entry.referenced = false;
+        entry.used = true;
+        shard.index.emplace(word, slot);
+        shard.bytes += bytes;
+    }
+
+    void BPEWordCache::clear() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->index.clear();
+            shard->entries.clear();
+            shard->free_slots.clear();
+            shard->hand = 0;
+            shard->bytes = 0;
+        }
+    }
+
+    void BPEWordCache::set_capacity(size_t capacity_bytes) {
+        bool shrinking = capacity_bytes < capacity_bytes_;
+        capacity_bytes_ = capacity_bytes;
+        shard_capacity_ = capacity_bytes_ / shards_.size();
+        if (shrinking) clear();
+    }
+
+    BPEWordCache::Stats BPEWordCache::stats() const {
+        Stats s;
+        s.hits = hits_.load(std::memory_order_relaxed);
+        s.misses = misses_.load(std::memory_order_relaxed);
+        s.evictions = evictions_.load(std::memory_order_relaxed);
+        s.capacity_bytes = capacity_bytes_;
+        for (const auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            s.entries += shard->index.size();
+            s.bytes += shard->bytes;
+        }
+        return s;
+    }
+
+    void BPEWordCache::reset_stats() {
+        hits_.store(0, std::memory_order_relaxed);
+        misses_.store(0, std::memory_order_relaxed);
+        evictions_.store(0, std::memory_order_relaxed);
+    }
+
+} // namespace auratokenizer
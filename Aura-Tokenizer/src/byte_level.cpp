@@ -0,0 +1,226 @@
+#include "byte_level.h"
+
+#include <unicode/uchar.h>
+
+namespace auratokenizer {
+    namespace byte_level {
+
+        void append_mapped(std::string_view bytes, std::string& out) {
+            for (unsigned char b : bytes) {
+                const MappedByte& m = BYTE_TO_UTF8[b];
+                out.append(m.utf8, m.length);
+            }
+        }
+
+        std::string to_unicode(std::string_view bytes) {
+            std::string out;
+            out.reserve(bytes.size() * 2);
+            append_mapped(bytes, out);
+            return out;
+        }
+
+        void append_unmapped(std::string_view mapped, std::string& out) {
+            size_t i = 0;
+            const size_t n = mapped.size();
+            while (i < n) {
+                unsigned char lead = static_cast<unsigned char>(mapped[i]);
+                if (lead < 0x80) {
+                    int16_t b = UNICODE_TO_BYTE[lead];
+                    out.push_back(b >= 0 ? static_cast<char>(b) : static_cast<char>(lead));
+                    ++i;
+                    continue;
+                }
+                if ((lead & 0xE0) == 0xC0 && i + 1 < n && (static_cast<unsigned char>(mapped[i + 1]) & 0xC0) == 0x80) {
+                    uint32_t cp = ((lead & 0x1F) << 6) | (static_cast<unsigned char>(mapped[i + 1]) & 0x3F);
+                    if (cp < MAPPED_CODEPOINTS && UNICODE_TO_BYTE[cp] >= 0) {
+                        out.push_back(static_cast<char>(UNICODE_TO_BYTE[cp]));
+                    } else {
+                        out.append(mapped.data() + i, 2);
+                    }
+                    i += 2;
+                    continue;
+                }
+                // Not part of the byte alphabet (3/4-byte chars, stray bytes): copy through.
+                out.push_back(static_cast<char>(lead));
+                ++i;
+            }
+        }
+
+        std::string from_unicode(std::string_view mapped) {
+            std::string out;
+            out.reserve(mapped.size());
+            append_unmapped(mapped, out);
+            return out;
+        }
+
+        namespace {
+
+            enum CharClass : uint8_t { LETTER, NUMBER, SPACE, OTHER };
+
+            constexpr std::array<uint8_t, 128> make_ascii_classes() {
+                std::array<uint8_t, 128> table{};
+                for (int c = 0; c < 128; ++c) {
+                    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) table[c] = LETTER;
+                    else if (c >= '0' && c <= '9') table[c] = NUMBER;
+                    else if (c == ' ' || (c >= '\t' && c <= '\r')) table[c] = SPACE;
+                    else table[c] = OTHER;
+                }
+                return table;
+            }
+
+            constexpr std::array<uint8_t, 128> ASCII_CLASSES = make_ascii_classes();
+
+            struct CodePoint {
+                uint32_t value;
+                uint32_t length;
+                uint8_t  cls;
+            };
+
+            uint8_t classify(uint32_t cp) {
+                if (cp < 0x80) return ASCII_CLASSES[cp];
+                uint32_t mask = U_GET_GC_MASK(static_cast<UChar32>(cp));
+                if (mask & U_GC_L_MASK) return LETTER;
+                if (mask & U_GC_N_MASK) return NUMBER;
+                if (u_isUWhiteSpace(static_cast<UChar32>(cp))) return SPACE;
+                return OTHER;
+            }
+
+            // Lenient UTF-8 decode: malformed input yields a 1-byte U+FFFD (OTHER).
+            CodePoint decode_at(std::string_view t, size_t i) {
+                unsigned char lead = static_cast<unsigned char>(t[i]);
+                if (lead < 0x80) return { lead, 1, ASCII_CLASSES[lead] };
+
+                uint32_t len = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 0;
+                if (len == 0 || lead > 0xF4 || i + len > t.size()) return { 0xFFFD, 1, OTHER };
+
+                uint32_t cp = lead & (0x7F >> len);
+                for (uint32_t k = 1; k < len; ++k) {
+                    unsigned char c = static_cast<unsigned char>(t[i + k]);
+                    if ((c & 0xC0) != 0x80) return { 0xFFFD, 1, OTHER };
+                    cp = (cp << 6) | (c & 0x3F);
+                }
+                return { cp, len, classify(cp) };
+            }
+
+            bool is_newline(uint32_t cp) { return cp == '\r' || cp == '\n'; }
+
+            char ascii_lower(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : c; }
+
+            // 's|'t|'re|'ve|'m|'ll|'d at i; returns the match length or 0.
+            size_t match_contraction(std::string_view t, size_t i, bool ignore_case) {
+                if (t[i] != '\'' || i + 1 >= t.size()) return 0;
+                auto at = [&](size_t k) { return ignore_case ? ascii_lower(t[k]) : t[k]; };
+                char a = at(i + 1);
+                if (a == 's' || a == 't' || a == 'm' || a == 'd') return 2;
+                if (i + 2 < t.size()) {
+                    char b = at(i + 2);
+                    if ((a == 'r' && b == 'e') || (a == 'v' && b == 'e') || (a == 'l' && b == 'l')) return 3;
+                }
+                return 0;
+            }
+
+            // End of the maximal run of class cls starting at i (i must be in class).
+            size_t run_end(std::string_view t, size_t i, uint8_t cls) {
+                while (i < t.size()) {
+                    CodePoint cp = decode_at(t, i);
+                    if (cp.cls != cls) break;
+                    i += cp.length;
+                }
+                return i;
+            }
+
+            // \s+(?!\S) falling back to \s+, for a whitespace run starting at i.
+            size_t match_whitespace(std::string_view t, size_t i) {
+                size_t last_start = i;
+                size_t end = i;
+                while (end < t.size()) {
+                    CodePoint cp = decode_at(t, end);
+                    if (cp.cls != SPACE) break;
+                    last_start = end;
+                    end += cp.length;
+                }
+                // Followed by non-space: leave the last whitespace char to prefix the next token.
+                if (end < t.size() && last_start > i) return last_start;
+                return end;
+            }
+
+            size_t next_gpt2(std::string_view t, size_t i) {
+                if (size_t n = match_contraction(t, i, false)) return i + n;
+
+                CodePoint cp = decode_at(t, i);
+                size_t k = i;
+                uint8_t cls = cp.cls;
+                if (cp.value == ' ' && i + 1 < t.size()) {
+                    k = i + 1;
+                    cls = decode_at(t, k).cls;
+                }
+                // ' ?\p{L}+', ' ?\p{N}+', ' ?[^\s\p{L}\p{N}]+'
+                if (cls != SPACE) return run_end(t, k, cls);
+
+                return match_whitespace(t, i);
+            }
+
+            size_t next_cl100k(std::string_view t, size_t i) {
+                if (size_t n = match_contraction(t, i, true)) return i + n;
+
+                CodePoint cp = decode_at(t, i);
+
+                // [^\r\n\p{L}\p{N}]?\p{L}+
+                if (cp.cls == LETTER) return run_end(t, i, LETTER);
+                if (cp.cls != NUMBER && !is_newline(cp.value) && i + cp.length < t.size()) {
+                    CodePoint next = decode_at(t, i + cp.length);
+                    if (next.cls == LETTER) return run_end(t, i + cp.length, LETTER);
+                }
+
+                // \p{N}{1,3}
+                if (cp.cls == NUMBER) {
+                    size_t end = i;
+                    for (int count = 0; count < 3 && end < t.size(); ++count) {
+                        CodePoint d = decode_at(t, end);
+                        if (d.cls != NUMBER) break;
+                        end += d.length;
+                    }
+                    return end;
+                }
+
+                // ' ?[^\s\p{L}\p{N}]+[\r\n]*'
+                size_t k = i;
+                uint8_t cls = cp.cls;
+                if (cp.value == ' ' && i + 1 < t.size()) {
+                    k = i + 1;
+                    cls = decode_at(t, k).cls;
+                }
+                if (cls == OTHER) {
+                    size_t end = run_end(t, k, OTHER);
+                    while (end < t.size() && is_newline(static_cast<unsigned char>(t[end]))) ++end;
+                    return end;
+                }
+
+                // \s*[\r\n]+ : whitespace run up to and including its last newline.
+                size_t end = i;
+                size_t after_newline = 0;
+                while (end < t.size()) {
+                    CodePoint w = decode_at(t, end);
+                    if (w.cls != SPACE) break;
+                    end += w.length;
+                    if (is_newline(w.value)) after_newline = end;
+                }
+                if (after_newline > 0) return after_newline;
+
+                return match_whitespace(t, i);
+            }
+
+        } // namespace
+
+        void split(std::string_view text, ByteLevelPattern pattern, std::vector<Span>& out) {
+            size_t i = 0;
+            while (i < text.size()) {
+                size_t end = pattern == ByteLevelPattern::GPT2 ? next_gpt2(text, i) : next_cl100k(text, i);
+                if (end <= i) end = i + 1; // defensive: always make progress
+                out.push_back(Span{ i, end });
+                i = end;
+            }
+        }
+
+    } // namespace byte_level
+} // namespace auratokenizer
@@ -1,4 +1,5 @@
 #include "byte_level_pre_tokenizer.h"
+#include "byte_level.h"
 #include <vector>
 #include <string>
 
@@ -7,10 +8,26 @@ namespace auratokenizer {
 ByteLevelPreTokenizer::ByteLevelPreTokenizer(const TokenizerConfig& config) : config_(config) {}
 
 std::vector<std::string> ByteLevelPreTokenizer::pre_tokenize(const std::string& text) const {
+    std::string_view input = text;
+    std::string prefixed;
+    if (config_.add_prefix_space && !text.empty() && text[0] != ' ') {
+        prefixed.reserve(text.size() + 1);
+        prefixed.push_back(' ');
+        prefixed += text;
+        input = prefixed;
+    }
+
+    thread_local std::vector<byte_level::Span> spans;
+    spans.clear();
+    byte_level::split(input, config_.byte_level_pattern, spans);
+
     std::vector<std::string> tokens;
-    tokens.reserve(text.length()); // Reserve space, assuming 1 byte per char for ASCII, but will reallocate for UTF-8
-    for (unsigned char byte : text) {
-        tokens.push_back(std::string(1, static_cast<char>(byte)));
+    tokens.reserve(spans.size());
+    for (const auto& span : spans) {
+        std::string piece;
+        piece.reserve((span.end - span.begin) * 2);
+        byte_level::append_mapped(input.substr(span.begin, span.end - span.begin), piece);
+        tokens.push_back(std::move(piece));
     }
     return tokens;
 }
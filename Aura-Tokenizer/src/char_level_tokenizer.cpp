@@ -1,14 +1,26 @@
 #include "char_level_tokenizer.h"
 #include "tokenizer_exception.h"
+#include "ascii_scan.h"
+
+#include <unicode/utf8.h>
 
 namespace auratokenizer {
 
+namespace {
+
+constexpr uint32_t PAGE_BITS = 8;
+constexpr uint32_t PAGE_SIZE = 1u << PAGE_BITS;
+constexpr uint32_t PAGE_COUNT = 0x110000 >> PAGE_BITS;
+
+} // namespace
+
 CharLevelTokenizer::CharLevelTokenizer(const TokenizerConfig& config)
     : TokenizerBase(config),
       normalizer_(config),
       vocab_(std::make_shared<Vocab>())
 {
     initialize_special_tokens();
+    rebuild_char_tables();
 }
 
 CharLevelTokenizer::~CharLevelTokenizer() = default;
@@ -50,23 +62,118 @@ void CharLevelTokenizer::initialize_special_tokens() {
     }
 }
 
+void CharLevelTokenizer::rebuild_char_tables() {
+    ascii_ids_.fill(-1);
+    ascii_special_.fill(0);
+    page_of_.assign(PAGE_COUNT, 0);
+    pages_.assign(PAGE_SIZE, -1);
+    has_special_chars_ = false;
+
+    vocab_->for_each_token([&](std::string_view token, int id) {
+        // Only tokens that are exactly one codepoint take part.
+        const uint8_t* s = reinterpret_cast<const uint8_t*>(token.data());
+        int32_t length = static_cast<int32_t>(token.size());
+        int32_t i = 0;
+        UChar32 c;
+        if (length == 0) return;
+        U8_NEXT(s, i, length, c);
+        if (c < 0 || i != length) return;
+
+        const bool special = vocab_->is_special_token_id(id);
+        has_special_chars_ |= special;
+        if (c < 0x80) {
+            ascii_ids_[c] = id;
+            ascii_special_[c] = special ? 1 : 0;
+            return;
+        }
+        uint16_t& page = page_of_[c >> PAGE_BITS];
+        if (page == 0) {
+            page = static_cast<uint16_t>(pages_.size() / PAGE_SIZE);
+            pages_.resize(pages_.size() + PAGE_SIZE, -1);
+        }
+        pages_[(static_cast<size_t>(page) << PAGE_BITS) | (c & (PAGE_SIZE - 1))] = id;
+    });
+
+    unk_id_ = get_special_token_id(SpecialTokenType::UNK);
+    for (size_t c = 0; c < ascii_ids_.size(); ++c) {
+        if (ascii_ids_[c] >= 0) continue;
+        ascii_ids_[c] = unk_id_;
+        ascii_special_[c] = unk_id_ >= 0 ? 1 : 0;
+    }
+}
+
+int CharLevelTokenizer::lookup(uint32_t codepoint) const {
+    int id = pages_[(static_cast<size_t>(page_of_[codepoint >> PAGE_BITS]) << PAGE_BITS) | (codepoint & (PAGE_SIZE - 1))];
+    return id >= 0 ? id : unk_id_;
+}
+
 std::vector<Token> CharLevelTokenizer::encode(const std::string& text) {
-    std::string normalized_text = normalizer_.normalize(text);
+    EncodeBuffer buffer;
+    std::string_view input = normalizer_.normalize_view(text, buffer.normalized);
+    encode_chars(input, buffer);
+    // Token text comes from the normalized characters, offsets from text.
     std::vector<Token> tokens;
-    for (char c : normalized_text) {
-        std::string s(1, c);
-        tokens.emplace_back(vocab_->get_token_id(s), s, vocab_->is_special_token(s));
+    tokens.reserve(buffer.size());
+    for (size_t i = 0; i < buffer.size(); ++i) {
+        const OffsetMapping& offset = buffer.offsets[i];
+        tokens.emplace_back(buffer.ids[i], std::string(input.substr(offset.start, offset.end - offset.start)),
+            buffer.special[i] != 0);
     }
+    if (!normalizer_.is_identity()) buffer.normalized.to_original(buffer.offsets);
+    for (size_t i = 0; i < tokens.size(); ++i) tokens[i].offset = buffer.offsets[i];
     return tokens;
 }
 
 std::vector<int> CharLevelTokenizer::encode_to_ids(const std::string& text) {
-    std::string normalized_text = normalizer_.normalize(text);
-    std::vector<int> ids;
-    for (char c : normalized_text) {
-        ids.push_back(vocab_->get_token_id(std::string(1, c)));
+    EncodeBuffer buffer;
+    encode_into(text, buffer);
+    return std::move(buffer.ids);
+}
+
+void CharLevelTokenizer::encode_into(std::string_view text, EncodeBuffer& out) {
+    out.clear();
+    std::string_view input = normalizer_.normalize_view(text, out.normalized);
+    encode_chars(input, out);
+    if (!normalizer_.is_identity()) out.normalized.to_original(out.offsets);
+}
+
+void CharLevelTokenizer::encode_chars(std::string_view input, EncodeBuffer& out) {
+    out.reserve(out.size() + input.size());
+
+    const uint8_t* s = reinterpret_cast<const uint8_t*>(input.data());
+    const size_t n = input.size();
+    size_t i = 0;
+    while (i < n) {
+        // ASCII run: straight table lookups into pre-sized output.
+        size_t run = ascii_prefix_length(input.data() + i, n - i);
+        if (run > 0) {
+            const size_t base = out.ids.size();
+            out.ids.resize(base + run);
+            out.offsets.resize(base + run);
+            out.special.resize(base + run);
+            int* ids = out.ids.data() + base;
+            OffsetMapping* offsets = out.offsets.data() + base;
+            uint8_t* special = out.special.data() + base;
+            for (size_t k = 0; k < run; ++k) {
+                const uint8_t c = s[i + k];
+                ids[k] = ascii_ids_[c];
+                offsets[k] = OffsetMapping{ static_cast<int>(i + k), static_cast<int>(i + k + 1) };
+                special[k] = ascii_special_[c];
+            }
+            i += run;
+            if (i >= n) break;
+        }
+
+        // One non-ASCII codepoint; an invalid byte becomes an unknown token.
+        const size_t begin = i;
+        int32_t next = static_cast<int32_t>(i);
+        UChar32 c;
+        U8_NEXT(s, next, static_cast<int32_t>(n), c);
+        i = static_cast<size_t>(next);
+        int id = c < 0 ? unk_id_ : lookup(static_cast<uint32_t>(c));
+        bool special = id >= 0 && (id == unk_id_ || (has_special_chars_ && vocab_->is_special_token_id(id)));
+        out.push(id, begin, i, special);
     }
-    return ids;
 }
 
 std::string CharLevelTokenizer::decode(const std::vector<Token>& tokens) {
@@ -80,11 +187,15 @@ std::string CharLevelTokenizer::decode(const std::vector<Token>& tokens) {
 std::string CharLevelTokenizer::decode_from_ids(const std::vector<int>& ids) {
     std::string decoded_text;
     for (int id : ids) {
-        decoded_text += vocab_->get_token(id);
+        decoded_text += vocab_->get_token_view(id);
     }
     return decoded_text;
 }
 
+DecodeStream CharLevelTokenizer::decode_stream(bool skip_special_tokens) const {
+    return DecodeStream(vocab_, DecodeStream::Mode::RAW, skip_special_tokens);
+}
+
 std::vector<std::vector<int>> CharLevelTokenizer::batch_encode(const std::vector<std::string>& texts) {
     std::vector<std::vector<int>> batch_ids;
     batch_ids.reserve(texts.size());
@@ -118,21 +229,29 @@ void CharLevelTokenizer::train(const std::vector<std::string>& corpus, size_t vo
     int id_counter = 0;
     for (const std::string& text : corpus) {
         std::string normalized_text = normalizer_.normalize(text);
-        for (char c : normalized_text) {
-            std::string s(1, c);
-            if (!vocab_->contains_token(s)) {
-                vocab_->add_token_to_vocab(s, id_counter++);
+        const uint8_t* s = reinterpret_cast<const uint8_t*>(normalized_text.data());
+        const int32_t n = static_cast<int32_t>(normalized_text.size());
+        for (int32_t i = 0; i < n; ) {
+            int32_t begin = i;
+            UChar32 c;
+            U8_NEXT(s, i, n, c);
+            if (c < 0) continue; // invalid bytes encode as unknown
+            std::string ch = normalized_text.substr(begin, i - begin);
+            if (!vocab_->contains_token(ch)) {
+                vocab_->add_token_to_vocab(ch, id_counter++);
             }
         }
     }
     // Add special tokens after corpus characters
     initialize_special_tokens();
+    rebuild_char_tables();
 }
 
 void CharLevelTokenizer::add_special_tokens(const std::vector<std::string>& tokens) {
     for (const auto& token : tokens) {
         vocab_->add_special_token(token, SpecialTokenType::CUSTOM);
     }
+    rebuild_char_tables();
 }
 
 std::vector<std::string> CharLevelTokenizer::get_special_tokens() const {
@@ -163,11 +282,13 @@ void CharLevelTokenizer::set_config(const TokenizerConfig& config) {
     config_ = config;
     normalizer_.set_config(config_);
     initialize_special_tokens();
+    rebuild_char_tables();
 }
 
 void CharLevelTokenizer::set_vocab(std::shared_ptr<Vocab> vocab) {
     vocab_ = vocab;
     initialize_special_tokens();
+    rebuild_char_tables();
 }
 
 } // namespace auratokenizer
@@ -0,0 +1,194 @@
+#include "corpus_reader.h"
+#include "tokenizer_exception.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace auratokenizer {
+
+    // -- MappedFile --
+
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::string& path) {
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw TokenizerException("Failed to open file: " + path);
+        }
+        file_ = file;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            release();
+            throw TokenizerException("Failed to stat file: " + path);
+        }
+        size_ = static_cast<size_t>(size.QuadPart);
+        if (size_ == 0) return; // empty files cannot be mapped
+
+        mapping_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_) data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        if (!data_) {
+            release();
+            throw TokenizerException("Failed to map file: " + path);
+        }
+    }
+
+    void MappedFile::release() noexcept {
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        if (file_) CloseHandle(file_);
+        data_ = nullptr;
+        mapping_ = nullptr;
+        file_ = nullptr;
+        size_ = 0;
+    }
+#else
+    MappedFile::MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw TokenizerException("Failed to open file: " + path);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw TokenizerException("Failed to stat file: " + path);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ > 0) {
+            void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                ::close(fd);
+                size_ = 0;
+                throw TokenizerException("Failed to map file: " + path);
+            }
+            ::madvise(addr, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(addr);
+        }
+        ::close(fd); // the mapping keeps the file alive
+    }
+
+    void MappedFile::release() noexcept {
+        if (data_) ::munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+#endif
+
+    MappedFile::~MappedFile() {
+        release();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0))
+#ifdef _WIN32
+        , file_(std::exchange(other.file_, nullptr)),
+          mapping_(std::exchange(other.mapping_, nullptr))
+#endif
+    {
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            release();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+#ifdef _WIN32
+            file_ = std::exchange(other.file_, nullptr);
+            mapping_ = std::exchange(other.mapping_, nullptr);
+#endif
+        }
+        return *this;
+    }
+
+    // -- Parallel counting --
+
+    namespace {
+
+        // Split text into pieces of roughly chunk_bytes, each ending just after a '\n'.
+        void split_chunks(std::string_view text, size_t chunk_bytes, std::vector<std::string_view>& chunks) {
+            size_t begin = 0;
+            while (begin < text.size()) {
+                size_t end = std::min(text.size(), begin + chunk_bytes);
+                if (end < text.size()) {
+                    const void* nl = std::memchr(text.data() + end, '\n', text.size() - end);
+                    end = nl ? static_cast<size_t>(static_cast<const char*>(nl) - text.data()) + 1 : text.size();
+                }
+                chunks.push_back(text.substr(begin, end - begin));
+                begin = end;
+            }
+        }
+
+        void count_chunk(std::string_view chunk, const LineCounter& count_line, CorpusCounts& counts) {
+            size_t pos = 0;
+            while (pos < chunk.size()) {
+                const void* nl = std::memchr(chunk.data() + pos, '\n', chunk.size() - pos);
+                size_t end = nl ? static_cast<size_t>(static_cast<const char*>(nl) - chunk.data()) : chunk.size();
+                std::string_view line = chunk.substr(pos, end - pos);
+                if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+                if (!line.empty()) count_line(line, counts);
+                pos = end + 1;
+            }
+        }
+
+    } // namespace
+
+    CorpusCounts count_corpus_files(const std::vector<std::string>& paths,
+        const LineCounter& count_line,
+        size_t num_threads,
+        size_t chunk_bytes)
+    {
+        if (num_threads == 0) num_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        chunk_bytes = std::max<size_t>(chunk_bytes, 1);
+
+        // Map every file up front so a bad path fails before any work starts.
+        std::vector<MappedFile> files;
+        files.reserve(paths.size());
+        for (const auto& path : paths) files.emplace_back(path);
+
+        std::vector<std::string_view> chunks;
+        for (const auto& file : files) split_chunks(file.view(), chunk_bytes, chunks);
+
+        std::atomic<size_t> next{ 0 };
+        auto worker = [&]() {
+            CorpusCounts local;
+            for (size_t i = next++; i < chunks.size(); i = next++) {
+                count_chunk(chunks[i], count_line, local);
+            }
+            return local;
+        };
+
+        num_threads = std::min(num_threads, std::max<size_t>(chunks.size(), 1));
+        std::vector<std::future<CorpusCounts>> futures;
+        for (size_t t = 1; t < num_threads; ++t) {
+            futures.push_back(std::async(std::launch::async, worker));
+        }
+        CorpusCounts result = worker();
+
+        for (auto& fut : futures) {
+            CorpusCounts part = fut.get();
+            if (part.size() > result.size()) result.swap(part);
+            for (auto& [key, count] : part) result[key] += count;
+        }
+        return result;
+    }
+
+} // namespace auratokenizer
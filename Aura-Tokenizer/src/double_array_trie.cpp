@@ -1,136 +1,624 @@
 ﻿#include "double_array_trie.h"
+#include "corpus_reader.h"
 #include <queue>
 #include <algorithm>
+#include <limits>
 #include <stdexcept>
 #include <iostream>
 #include <cstring>
-#include <set>
 
 namespace auratokenizer {
 
-    // Helper: resize the internal arrays and update the free list
-    void DoubleArrayTrie::resize(size_t new_capacity) {
-        size_t old_capacity = capacity_;
-        if (new_capacity <= old_capacity) return;
+    namespace {
 
-        nodes_.resize(new_capacity);
-        fail_links_.resize(new_capacity, INVALID_NODE);
+        constexpr char kMagic[8] = { 'A', 'U', 'R', 'A', 'D', 'A', 'T', '\0' };
+        constexpr uint32_t kByteOrderTag = 0x01020304u;
+        constexpr uint32_t kSwappedByteOrderTag = 0x04030201u;
+        constexpr uint32_t kFormatVersion = 1;
 
-        for (size_t i = old_capacity; i < new_capacity; ++i) {
-            free_list_.push_back(static_cast<int32_t>(i));
+        struct BlobHeader {
+            char     magic[8];
+            uint32_t byte_order;     // kByteOrderTag in the writer's byte order
+            uint32_t version;
+            uint64_t node_count;
+            uint64_t tail_size;
+            uint64_t key_count;
+            int32_t  free_head;
+            uint32_t compress_tails;
+        };
+
+        static_assert(sizeof(BlobHeader) == 48, "BlobHeader layout is part of the blob format");
+        static_assert(sizeof(DoubleArrayTrie::Node) == 12, "Node layout is part of the blob format");
+
+        std::string_view tail_record(const char* tails, int32_t base) {
+            const char* record = tails + (-1 - static_cast<int64_t>(base));
+            uint32_t length;
+            std::memcpy(&length, record, sizeof(length));
+            return std::string_view(record + sizeof(length), length);
+        }
+
+    } // namespace
+
+    // -- Free list --
+
+    // Append cell to the circular free list, just before the head.
+    void DoubleArrayTrie::link_free(std::vector<Node>& cells, int32_t cell) {
+        cells[cell] = Node();
+        if (free_head_ < 0) {
+            free_head_ = cell;
+            cells[cell].base = free_link(cell);
+            cells[cell].check = free_link(cell);
+            return;
+        }
+        int32_t last = free_link(cells[free_head_].base);
+        cells[cell].base = free_link(last);
+        cells[cell].check = free_link(free_head_);
+        cells[last].check = free_link(cell);
+        cells[free_head_].base = free_link(cell);
+    }
+
+    void DoubleArrayTrie::grow(std::vector<Node>& cells, size_t new_capacity) {
+        const size_t old = cells.size();
+        if (new_capacity <= old) return;
+        if (new_capacity > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+            throw TokenizerException("DoubleArrayTrie: too many nodes");
         }
-        // Keep free list sorted for predictable behavior
-        std::sort(free_list_.begin(), free_list_.end());
-        capacity_ = new_capacity;
+        cells.resize(new_capacity);
+        for (size_t i = old; i < new_capacity; ++i) link_free(cells, static_cast<int32_t>(i));
     }
 
-    // Helper: find a 'base' value that can accommodate all child characters
-    int32_t DoubleArrayTrie::find_base(const std::vector<unsigned char>& chars) {
-        int32_t base = free_list_.empty() ? capacity_ : free_list_.front();
+    // Take cell off the free list; it stays free (check -1) unless occupied.
+    void DoubleArrayTrie::unlink_free(std::vector<Node>& cells, int32_t cell) {
+        if (cells[cell].check == -1) return;  // not on the list
+        int32_t prev = free_link(cells[cell].base);
+        int32_t next = free_link(cells[cell].check);
+        if (next == cell) {
+            free_head_ = -1;
+        } else {
+            cells[prev].check = free_link(next);
+            cells[next].base = free_link(prev);
+            if (free_head_ == cell) free_head_ = next;
+        }
+        cells[cell] = Node();
+    }
+
+    void DoubleArrayTrie::occupy(std::vector<Node>& cells, int32_t cell, int32_t parent) {
+        unlink_free(cells, cell);
+        cells[cell] = Node();
+        cells[cell].check = parent;
+    }
+
+    void DoubleArrayTrie::release(std::vector<Node>& cells, int32_t cell) {
+        link_free(cells, cell);
+    }
+
+    void DoubleArrayTrie::relink_free_cells(std::vector<Node>& cells) {
+        free_head_ = -1;
+        for (size_t i = 1; i < cells.size(); ++i) {
+            if (cells[i].check < 0) link_free(cells, static_cast<int32_t>(i));
+        }
+    }
+
+    // Smallest-offset base (in free-list order) with base + c free for every label c.
+    int32_t DoubleArrayTrie::find_base(std::vector<Node>& cells, const std::vector<unsigned char>& labels) {
+        if (free_head_ < 0) grow(cells, cells.size() * 2);
+        int32_t cell = free_head_;
         while (true) {
-            bool conflict = false;
-            for (unsigned char c : chars) {
-                int32_t target_pos = base + c;
-                if (target_pos >= static_cast<int32_t>(capacity_)) {
-                    resize(target_pos + INITIAL_CAPACITY);
-                }
-                if (nodes_[target_pos].check != -1) {
-                    conflict = true;
-                    break;
+            int32_t base = cell - labels.front();
+            bool tried = false;
+            if (base >= 1) {
+                ++build_probes_;
+                size_t needed = static_cast<size_t>(base) + labels.back() + 1;
+                if (needed > cells.size()) grow(cells, std::max(needed, cells.size() * 2));
+                bool fits = true;
+                for (unsigned char c : labels) {
+                    if (cells[base + c].check >= 0) {
+                        fits = false;
+                        break;
+                    }
                 }
+                if (fits) return base;
+                tried = true;
             }
-
-            if (!conflict) {
-                return base;
+            int32_t next = free_link(cells[cell].check);
+            const bool wrapped = next == free_head_;
+            if (tried && !trials_.empty()) {
+                if (trials_.size() < cells.size()) trials_.resize(cells.size(), 0);
+                // A cell that keeps failing sits in a crowded region: stop starting searches there.
+                if (++trials_[cell] >= MAX_TRIALS) unlink_free(cells, cell);
             }
-            base++; // Try the next position
-            if (base >= static_cast<int32_t>(capacity_)) {
-                resize(capacity_ * 2);
+            if (wrapped || free_head_ < 0) {
+                // Tried every free cell: continue with the new ones.
+                const size_t old_size = cells.size();
+                grow(cells, old_size * 2);
+                next = static_cast<int32_t>(old_size);
             }
+            cell = next;
         }
     }
 
-    // -- Public Methods Implementation --
+    // -- Construction --
+
+    DoubleArrayTrie::DoubleArrayTrie() : size_(0), free_head_(-1), compress_tails_(false) {
+        clear();
+    }
+
+    void DoubleArrayTrie::clear() {
+        tail_.clear();
+        fail_links_.clear();
+        output_links_.clear();
+        depths_.clear();
+        mapping_.reset();
+        size_ = 0;
+        free_head_ = -1;
+        compress_tails_ = false;
 
-    DoubleArrayTrie::DoubleArrayTrie() : size_(0), capacity_(0) {
-        resize(INITIAL_CAPACITY);
-        nodes_[ROOT_NODE].check = ROOT_NODE;
+        std::vector<Node> cells;
+        grow(cells, INITIAL_CAPACITY);
+        occupy(cells, ROOT_NODE, ROOT_NODE);
+        nodes_.adopt(std::move(cells));
     }
 
-    void DoubleArrayTrie::build(const std::vector<std::pair<std::string, int32_t>>& entries) {
-        // ... A full, correct build implementation is very complex ...
-        // Here is a simpler, but functional one
+    void DoubleArrayTrie::build(const std::vector<std::pair<std::string, int32_t>>& entries, bool compress_tails) {
         clear();
+        compress_tails_ = compress_tails;
 
+        // Sorted keys put every subtree in a contiguous range, so each node's
+        // children are known when it is placed and nothing needs relocating.
+        std::vector<std::pair<std::string, int32_t>> keys;
+        keys.reserve(entries.size());
         for (const auto& entry : entries) {
-            const std::string& key = entry.first;
-            int32_t value = entry.second;
-            int32_t current_node = ROOT_NODE;
-
-            for (size_t i = 0; i < key.length(); ++i) {
-                unsigned char c = key[i];
-                int32_t target_pos = nodes_[current_node].base + c;
-
-                if (target_pos >= static_cast<int32_t>(capacity_) || nodes_[target_pos].check != current_node) {
-                    // Node doesn't exist, must create it. This is the hard part of DAT.
-                    // For this fix, let's assume we can throw an error or handle a limited set of cases.
-                    // A full implementation would relocate existing nodes to find a free 'base'.
-                    // This is non-trivial. Let's provide a placeholder logic.
-                    std::vector<unsigned char> siblings;
-                    // Look for existing siblings
-                    if (nodes_[current_node].base != 0) {
-                        for (int s = 0; s < 256; ++s) {
-                            if (nodes_[current_node].base + s < capacity_ && nodes_[nodes_[current_node].base + s].check == current_node) {
-                                siblings.push_back(static_cast<unsigned char>(s));
-                            }
-                        }
-                    }
-                    siblings.push_back(c);
-                    int32_t new_base = find_base(siblings);
-                    // Relocate existing children if any
-                    nodes_[current_node].base = new_base; // This simplified logic might overwrite
+            if (!entry.first.empty()) keys.push_back(entry);
+        }
+        std::stable_sort(keys.begin(), keys.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+        size_t unique = 0;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (unique > 0 && keys[unique - 1].first == keys[i].first) {
+                keys[unique - 1].second = keys[i].second; // the last duplicate wins
+            } else {
+                if (unique != i) keys[unique] = std::move(keys[i]);
+                ++unique;
+            }
+        }
+        keys.resize(unique);
+
+        struct Range {
+            int32_t node;
+            size_t  lo;
+            size_t  hi;
+            size_t  depth;
+        };
+        std::queue<Range> pending;
+        pending.push(Range{ ROOT_NODE, 0, keys.size(), 0 });
+
+        std::vector<Node> cells = nodes_.take();
+        std::vector<char> tails;
+        std::vector<unsigned char> labels;
+        std::vector<size_t> starts;
+        trials_.assign(cells.size(), 0);
+        build_probes_ = 0;
+        while (!pending.empty()) {
+            Range r = pending.front();
+            pending.pop();
+
+            // A key ending here sorts first.
+            size_t lo = r.lo;
+            if (lo < r.hi && keys[lo].first.size() == r.depth) {
+                cells[r.node].value = keys[lo].second;
+                size_++;
+                ++lo;
+            }
+            if (lo == r.hi) continue;
+
+            if (compress_tails && r.node != ROOT_NODE && r.hi - r.lo == 1) {
+                set_tail(cells, tails, r.node, std::string_view(keys[lo].first).substr(r.depth), keys[lo].second);
+                size_++;
+                continue;
+            }
+
+            labels.clear();
+            starts.clear();
+            for (size_t i = lo; i < r.hi; ++i) {
+                unsigned char c = static_cast<unsigned char>(keys[i].first[r.depth]);
+                if (labels.empty() || labels.back() != c) {
+                    labels.push_back(c);
+                    starts.push_back(i);
                 }
+            }
+            starts.push_back(r.hi);
+
+            int32_t base = find_base(cells, labels);
+            cells[r.node].base = base;
+            for (size_t k = 0; k < labels.size(); ++k) {
+                int32_t child = base + labels[k];
+                occupy(cells, child, r.node);
+                pending.push(Range{ child, starts[k], starts[k + 1], r.depth + 1 });
+            }
+        }
+        trials_.clear();
+        trials_.shrink_to_fit();
+        nodes_.adopt(std::move(cells));
+        tail_.adopt(std::move(tails));
+        shrink_to_fit();  // also puts unlinked free cells back on the list
+    }
+
+    void DoubleArrayTrie::set_tail(std::vector<Node>& cells, std::vector<char>& tails, int32_t node, std::string_view rest, int32_t value) {
+        const size_t offset = tails.size();
+        if (offset + sizeof(uint32_t) + rest.size() > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+            throw TokenizerException("DoubleArrayTrie: tail buffer too large");
+        }
+        const uint32_t length = static_cast<uint32_t>(rest.size());
+        tails.resize(offset + sizeof(length));
+        std::memcpy(tails.data() + offset, &length, sizeof(length));
+        tails.insert(tails.end(), rest.begin(), rest.end());
+        cells[node].base = -1 - static_cast<int32_t>(offset);
+        cells[node].value = value;
+    }
+
+    // Turn a tail node back into an ordinary node with one child; the tail bytes stay unused.
+    void DoubleArrayTrie::expand_tail(std::vector<Node>& cells, std::vector<char>& tails, int32_t node) {
+        const std::string rest(tail_record(tails.data(), cells[node].base));
+        const int32_t value = cells[node].value;
+        cells[node].base = 0;
+        cells[node].value = -1;
+        int32_t child = add_child(cells, node, static_cast<unsigned char>(rest[0]));
+        if (rest.size() > 1) {
+            set_tail(cells, tails, child, std::string_view(rest).substr(1), value);
+        } else {
+            cells[child].value = value;
+        }
+    }
 
-                target_pos = nodes_[current_node].base + c;
-                if (target_pos >= static_cast<int32_t>(capacity_)) resize(target_pos + 1);
+    int32_t DoubleArrayTrie::add_child(std::vector<Node>& cells, int32_t node, unsigned char c) {
+        int32_t base = cells[node].base;
+        if (base <= 0) {
+            base = find_base(cells, std::vector<unsigned char>{ c });
+            cells[node].base = base;
+            occupy(cells, base + c, node);
+            return base + c;
+        }
+        const size_t target = static_cast<size_t>(base) + c;
+        if (target >= cells.size()) grow(cells, std::max(target + 1, cells.size() * 2));
+        if (cells[target].check < 0) {
+            occupy(cells, static_cast<int32_t>(target), node);
+            return static_cast<int32_t>(target);
+        }
 
-                if (nodes_[target_pos].check == -1) { // New node
-                    nodes_[target_pos].check = current_node;
-                    // remove from free list
-                    auto it = std::lower_bound(free_list_.begin(), free_list_.end(), target_pos);
-                    if (it != free_list_.end() && *it == target_pos) free_list_.erase(it);
+        // The slot belongs to another node: move all of node's children to a
+        // base where they fit together with c, re-pointing their own children.
+        std::vector<unsigned char> labels;
+        for (int x = 0; x < 256; ++x) {
+            size_t t = static_cast<size_t>(base) + x;
+            if (t < cells.size() && cells[t].check == node) labels.push_back(static_cast<unsigned char>(x));
+        }
+        std::vector<unsigned char> wanted = labels;
+        wanted.insert(std::lower_bound(wanted.begin(), wanted.end(), c), c);
+        const int32_t new_base = find_base(cells, wanted);
+        for (unsigned char x : labels) {
+            const int32_t from = base + x;
+            const int32_t to = new_base + x;
+            const Node moved = cells[from];
+            occupy(cells, to, node);
+            cells[to].base = moved.base;
+            cells[to].value = moved.value;
+            if (moved.base > 0) {
+                for (int y = 0; y < 256; ++y) {
+                    size_t g = static_cast<size_t>(moved.base) + y;
+                    if (g < cells.size() && cells[g].check == from) cells[g].check = to;
                 }
-                current_node = target_pos;
             }
-            nodes_[current_node].value = value;
-            if (value != -1) size_++;
+            release(cells, from);
         }
+        cells[node].base = new_base;
+        occupy(cells, new_base + c, node);
+        return new_base + c;
     }
 
-    // (Other methods: find, search, optimize, etc. remain largely the same but ensure they use member variables correctly)
-    void DoubleArrayTrie::clear() {
-        nodes_.assign(INITIAL_CAPACITY, Node());
-        fail_links_.assign(INITIAL_CAPACITY, INVALID_NODE);
-        free_list_.clear();
-        capacity_ = INITIAL_CAPACITY;
-        size_ = 0;
-        nodes_[ROOT_NODE].check = ROOT_NODE;
-        for (size_t i = 1; i < capacity_; ++i) {
-            free_list_.push_back(static_cast<int32_t>(i));
+    void DoubleArrayTrie::insert(std::string_view key, int32_t value) {
+        if (key.empty()) return;
+        std::vector<Node> cells = nodes_.take();
+        std::vector<char> tails = tail_.take();
+        mapping_.reset();
+        fail_links_.clear();
+        output_links_.clear();
+        depths_.clear();
+
+        int32_t node = ROOT_NODE;
+        size_t i = 0;
+        bool done = false;
+        while (i < key.size()) {
+            if (cells[node].base < 0) {
+                if (tail_record(tails.data(), cells[node].base) == key.substr(i)) {
+                    cells[node].value = value;
+                    done = true;
+                    break;
+                }
+                expand_tail(cells, tails, node);
+            }
+            const unsigned char c = static_cast<unsigned char>(key[i++]);
+            const int32_t base = cells[node].base;
+            const size_t t = static_cast<size_t>(base) + c;
+            if (base > 0 && t < cells.size() && cells[t].check == node) {
+                node = static_cast<int32_t>(t);
+                continue;
+            }
+            node = add_child(cells, node, c);
+            if (compress_tails_ && i < key.size()) {
+                set_tail(cells, tails, node, key.substr(i), value);
+                size_++;
+                done = true;
+                break;
+            }
+        }
+        if (!done) {
+            if (cells[node].base < 0) expand_tail(cells, tails, node);
+            if (cells[node].value < 0) size_++;
+            cells[node].value = value;
         }
+        nodes_.adopt(std::move(cells));
+        tail_.adopt(std::move(tails));
+    }
+
+    // -- Lookup --
+
+    int32_t DoubleArrayTrie::find(std::string_view key) const {
+        if (key.empty()) return -1;
+        int32_t node = ROOT_NODE;
+        for (size_t i = 0; i < key.size(); ++i) {
+            node = transition(node, static_cast<unsigned char>(key[i]));
+            if (node == INVALID_NODE) return -1;
+            if (nodes_[node].base < 0) return tail(node) == key.substr(i + 1) ? nodes_[node].value : -1;
+        }
+        return nodes_[node].value;
+    }
+
+    std::vector<std::pair<std::string, int32_t>> DoubleArrayTrie::common_prefix_search(const std::string& key) const {
+        std::vector<std::pair<std::string, int32_t>> result;
+        common_prefix_search(std::string_view(key), [&](size_t length, int32_t value) {
+            result.emplace_back(key.substr(0, length), value);
+        });
+        return result;
+    }
+
+    void DoubleArrayTrie::collect(int32_t node, std::string& key, std::vector<std::pair<std::string, int32_t>>& out) const {
+        const Node& n = nodes_[node];
+        if (n.base < 0) {
+            std::string_view rest = tail(node);
+            out.emplace_back(key + std::string(rest), n.value);
+            return;
+        }
+        if (n.value >= 0 && node != ROOT_NODE) out.emplace_back(key, n.value);
+        if (n.base == 0) return;
+        for (int c = 0; c < 256; ++c) {
+            int32_t child = transition(node, static_cast<unsigned char>(c));
+            if (child == INVALID_NODE) continue;
+            key.push_back(static_cast<char>(c));
+            collect(child, key, out);
+            key.pop_back();
+        }
+    }
+
+    std::vector<std::pair<std::string, int32_t>> DoubleArrayTrie::predictive_search(const std::string& prefix) const {
+        std::vector<std::pair<std::string, int32_t>> result;
+        std::string key;
+        int32_t node = ROOT_NODE;
+        for (size_t i = 0; i < prefix.size(); ++i) {
+            if (nodes_[node].base < 0) {
+                // The rest of the prefix must lie inside this node's tail.
+                std::string_view rest = tail(node);
+                std::string_view wanted = std::string_view(prefix).substr(i);
+                if (rest.substr(0, wanted.size()) == wanted) result.emplace_back(key + std::string(rest), nodes_[node].value);
+                return result;
+            }
+            node = transition(node, static_cast<unsigned char>(prefix[i]));
+            if (node == INVALID_NODE) return result;
+            key.push_back(prefix[i]);
+        }
+        collect(node, key, result);
+        return result;
+    }
+
+    void DoubleArrayTrie::rebuild_fail_links() {
+        if (has_tails()) {
+            throw TokenizerException("DoubleArrayTrie: failure links need a trie built without tail compression");
+        }
+        const size_t n = nodes_.size();
+        fail_links_.assign(n, INVALID_NODE);
+        output_links_.assign(n, INVALID_NODE);
+        depths_.assign(n, 0);
+        fail_links_[ROOT_NODE] = ROOT_NODE;
+
+        // BFS so a node's failure target (always shallower) is final before it is used.
+        std::queue<int32_t> bfs;
+        bfs.push(ROOT_NODE);
+        while (!bfs.empty()) {
+            int32_t node = bfs.front();
+            bfs.pop();
+            if (nodes_[node].base <= 0) continue; // leaf
+
+            for (int c = 0; c < 256; ++c) {
+                int32_t child = transition(node, static_cast<unsigned char>(c));
+                if (child == INVALID_NODE) continue;
+
+                int32_t fail = ROOT_NODE;
+                if (node != ROOT_NODE) {
+                    int32_t f = fail_links_[node];
+                    while (true) {
+                        int32_t t = transition(f, static_cast<unsigned char>(c));
+                        if (t != INVALID_NODE) { fail = t; break; }
+                        if (f == ROOT_NODE) break;
+                        f = fail_links_[f];
+                    }
+                }
+                fail_links_[child] = fail;
+                output_links_[child] = nodes_[fail].value != -1 ? fail : output_links_[fail];
+                depths_[child] = depths_[node] + 1;
+                bfs.push(child);
+            }
+        }
+    }
+
+    // -- Maintenance --
+
+    void DoubleArrayTrie::optimize() {
+        std::vector<std::pair<std::string, int32_t>> keys = predictive_search("");
+        build(keys, compress_tails_);
+    }
+
+    void DoubleArrayTrie::compact() {
+        optimize();
+    }
+
+    void DoubleArrayTrie::shrink_to_fit() {
+        std::vector<Node> cells = nodes_.take();
+        mapping_.reset();
+        size_t used = 1;
+        for (size_t i = 0; i < cells.size(); ++i) {
+            if (cells[i].check >= 0) used = i + 1;
+        }
+        cells.resize(used);
+        cells.shrink_to_fit();
+        relink_free_cells(cells);
+        nodes_.adopt(std::move(cells));
     }
 
-    int32_t DoubleArrayTrie::find(const std::string& key) const { /* ... implementation ... */ return 0; }
-    std::vector<std::pair<std::string, int32_t>> DoubleArrayTrie::common_prefix_search(const std::string& key) const { /* ... */ return {}; }
-    std::vector<std::pair<std::string, int32_t>> DoubleArrayTrie::predictive_search(const std::string& prefix) const { /* ... */ return {}; }
-    void DoubleArrayTrie::optimize() { /* ... */ }
     size_t DoubleArrayTrie::size() const { return size_; }
-    size_t DoubleArrayTrie::capacity() const { return capacity_; }
-    void DoubleArrayTrie::rebuild_fail_links() { /* ... */ }
-    void DoubleArrayTrie::compact() { /* ... */ }
-    void DoubleArrayTrie::shrink_to_fit() { /* ... */ }
-    std::vector<char> DoubleArrayTrie::serialize() const { /* ... */ return {}; }
-    void DoubleArrayTrie::deserialize(const std::vector<char>& data) { /* ... */ }
-    void DoubleArrayTrie::validate() const { /* ... */ }
-    void DoubleArrayTrie::print_stats() const { /* ... */ }
-}
\ No newline at end of file
+    size_t DoubleArrayTrie::capacity() const { return nodes_.size(); }
+
+    void DoubleArrayTrie::validate() const {
+        const size_t n = nodes_.size();
+        if (n == 0 || nodes_[ROOT_NODE].check != ROOT_NODE) throw TokenizerException("DoubleArrayTrie: missing root");
+        size_t keys = 0;
+        size_t free_cells = 0;
+        for (size_t i = 0; i < n; ++i) {
+            const Node& cell = nodes_[i];
+            if (cell.check < 0) {
+                ++free_cells;
+                continue;
+            }
+            if (i != ROOT_NODE) {
+                const size_t parent = static_cast<size_t>(cell.check);
+                if (parent >= n || nodes_[parent].check < 0 || nodes_[parent].base <= 0
+                    || i < static_cast<size_t>(nodes_[parent].base) || i - nodes_[parent].base > 255) {
+                    throw TokenizerException("DoubleArrayTrie: broken parent link at node " + std::to_string(i));
+                }
+            }
+            if (cell.base < 0) {
+                const uint64_t offset = static_cast<uint64_t>(-1 - static_cast<int64_t>(cell.base));
+                uint32_t length = 0;
+                if (offset + sizeof(length) > tail_.size()) throw TokenizerException("DoubleArrayTrie: tail out of range");
+                std::memcpy(&length, tail_.data() + offset, sizeof(length));
+                if (offset + sizeof(length) + length > tail_.size()) throw TokenizerException("DoubleArrayTrie: tail out of range");
+            }
+            if (cell.value >= 0) ++keys;
+        }
+        if (keys != size_) throw TokenizerException("DoubleArrayTrie: key count mismatch");
+
+        size_t walked = 0;
+        if (free_head_ >= 0) {
+            int32_t cell = free_head_;
+            do {
+                if (cell < 0 || static_cast<size_t>(cell) >= n || nodes_[cell].check >= 0 || ++walked > free_cells) {
+                    throw TokenizerException("DoubleArrayTrie: broken free list");
+                }
+                cell = free_link(nodes_[cell].check);
+            } while (cell != free_head_);
+        }
+        if (walked != free_cells) throw TokenizerException("DoubleArrayTrie: broken free list");
+    }
+
+    void DoubleArrayTrie::print_stats() const {
+        size_t used = 0;
+        size_t tails = 0;
+        for (const Node& cell : nodes_) {
+            if (cell.check < 0) continue;
+            ++used;
+            if (cell.base < 0) ++tails;
+        }
+        std::cout << "DoubleArrayTrie: " << size_ << " keys, " << used << "/" << nodes_.size()
+                  << " cells used, " << tails << " tails in " << tail_.size() << " bytes" << std::endl;
+    }
+
+    // -- Serialization --
+
+    std::vector<char> DoubleArrayTrie::serialize() const {
+        BlobHeader header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.byte_order = kByteOrderTag;
+        header.version = kFormatVersion;
+        header.node_count = nodes_.size();
+        header.tail_size = tail_.size();
+        header.key_count = size_;
+        header.free_head = free_head_;
+        header.compress_tails = compress_tails_ ? 1 : 0;
+
+        const size_t node_bytes = nodes_.size() * sizeof(Node);
+        std::vector<char> blob(sizeof(header) + node_bytes + tail_.size());
+        std::memcpy(blob.data(), &header, sizeof(header));
+        std::memcpy(blob.data() + sizeof(header), nodes_.data(), node_bytes);
+        if (!tail_.empty()) std::memcpy(blob.data() + sizeof(header) + node_bytes, tail_.data(), tail_.size());
+        return blob;
+    }
+
+    void DoubleArrayTrie::deserialize(const std::vector<char>& data) {
+        deserialize(data.data(), data.size());
+    }
+
+    void DoubleArrayTrie::deserialize(const char* data, size_t size) {
+        read_blob(data, size, true);
+    }
+
+    void DoubleArrayTrie::view(const char* data, size_t size) {
+        read_blob(data, size, false);
+    }
+
+    void DoubleArrayTrie::map_file(const std::string& path) {
+        auto file = std::make_shared<const MappedFile>(path);
+        read_blob(file->view().data(), file->size(), false);
+        mapping_ = std::move(file);
+    }
+
+    void DoubleArrayTrie::read_blob(const char* data, size_t size, bool copy) {
+        BlobHeader header;
+        if (size < sizeof(header)) throw TokenizerException("DoubleArrayTrie: truncated blob");
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+            throw TokenizerException("DoubleArrayTrie: not a trie blob");
+        }
+        if (header.byte_order == kSwappedByteOrderTag) {
+            throw TokenizerException("DoubleArrayTrie: blob was written with the opposite byte order");
+        }
+        if (header.byte_order != kByteOrderTag || header.version != kFormatVersion) {
+            throw TokenizerException("DoubleArrayTrie: unsupported blob version");
+        }
+        const uint64_t max_cells = static_cast<uint64_t>(std::numeric_limits<int32_t>::max());
+        if (header.node_count == 0 || header.node_count > max_cells || header.tail_size > max_cells
+            || header.free_head < -1 || header.free_head >= static_cast<int64_t>(header.node_count)) {
+            throw TokenizerException("DoubleArrayTrie: corrupt blob header");
+        }
+        const uint64_t node_bytes = header.node_count * sizeof(Node);
+        if (sizeof(header) + node_bytes + header.tail_size > size) throw TokenizerException("DoubleArrayTrie: truncated blob");
+
+        const char* node_data = data + sizeof(header);
+        const char* tail_data = node_data + node_bytes;
+        DoubleArrayTrie loaded;
+        if (copy) {
+            std::vector<Node> cells(static_cast<size_t>(header.node_count));
+            std::memcpy(cells.data(), node_data, static_cast<size_t>(node_bytes));
+            loaded.nodes_.adopt(std::move(cells));
+            loaded.tail_.adopt(std::vector<char>(tail_data, tail_data + header.tail_size));
+        } else {
+            if (reinterpret_cast<uintptr_t>(node_data) % alignof(Node) != 0) {
+                throw TokenizerException("DoubleArrayTrie: misaligned blob");
+            }
+            loaded.nodes_.view(reinterpret_cast<const Node*>(node_data), static_cast<size_t>(header.node_count));
+            loaded.tail_.view(tail_data, static_cast<size_t>(header.tail_size));
+        }
+        loaded.size_ = static_cast<size_t>(header.key_count);
+        loaded.free_head_ = header.free_head;
+        loaded.compress_tails_ = header.compress_tails != 0;
+        if (copy) loaded.validate();
+        *this = std::move(loaded);
+    }
+}
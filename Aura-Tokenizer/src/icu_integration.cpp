@@ -16,22 +16,12 @@ namespace auratokenizer {
         }
 
         std::vector<OffsetMapping> ICUPreTokenizer::getOffsetMappings(const std::string& text) const {
-            std::vector<OffsetMapping> out;
-            auto toks = preTokenize(text);
-            out.reserve(toks.size());
-
-            size_t cursor = 0;
-            for (const auto& tok : toks) {
-                size_t pos = text.find(tok, cursor);
-                if (pos == std::string::npos) {
-                    out.push_back({ static_cast<int>(cursor), static_cast<int>(cursor) });
-                }
-                else {
-                    out.push_back({ static_cast<int>(pos), static_cast<int>(pos + tok.size()) });
-                    cursor = pos + tok.size();
-                }
+            // Same pieces as preTokenize(), taken from the break positions
+            // themselves rather than searched for in text.
+            if (!handleSpecialCases(text).empty()) {
+                return { OffsetMapping{ 0, static_cast<int>(text.size()) } };
             }
-            return out;
+            return icu_utils::ICUUtils::segment_word_spans(text);
         }
 
         std::vector<std::string> ICUPreTokenizer::handleSpecialCases(const std::string& text) const {
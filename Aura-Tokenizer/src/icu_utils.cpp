@@ -1,21 +1,111 @@
 ﻿#include "icu_utils.h"
+#include "ascii_scan.h"
 #include <unicode/uclean.h>
+#include <unicode/casemap.h>
+#include <unicode/bytestream.h>
+#include <unicode/utext.h>
 #include <mutex>
 
 namespace auratokenizer {
     namespace icu_utils {
 
-        std::unique_ptr<const icu::Normalizer2> ICUUtils::nfc_norm_;
-        std::unique_ptr<const icu::Normalizer2> ICUUtils::nfd_norm_;
-        std::unique_ptr<const icu::Normalizer2> ICUUtils::nfkc_norm_;
-        std::unique_ptr<const icu::Normalizer2> ICUUtils::nfkd_norm_;
-        std::mutex ICUUtils::normalizer_mutex_;
-        std::unique_ptr<icu::BreakIterator> ICUUtils::char_break_it_;
-        std::unique_ptr<icu::BreakIterator> ICUUtils::word_break_it_;
-        std::unique_ptr<icu::BreakIterator> ICUUtils::sentence_break_it_;
-        std::mutex ICUUtils::break_iterator_mutex_;
-        std::unique_ptr<icu::Transliterator> ICUUtils::accent_stripper_;
-        std::mutex ICUUtils::transliterator_mutex_;
+        namespace {
+
+            inline bool continuation(uint8_t b) { return (b & 0xC0) == 0x80; }
+
+            // Same acceptance as ICU's UTF-8 conversion: no overlongs, surrogates
+            // or code points above U+10FFFF.
+            bool well_formed_utf8(const char* p, size_t n) {
+                const uint8_t* s = reinterpret_cast<const uint8_t*>(p);
+                size_t i = 0;
+                while (i < n) {
+                    const uint8_t lead = s[i];
+                    if (lead < 0x80) {
+                        i += ascii_prefix_length(p + i, n - i);
+                        continue;
+                    }
+                    if (lead < 0xC2) return false;
+                    if (lead < 0xE0) {
+                        if (n - i < 2 || !continuation(s[i + 1])) return false;
+                        i += 2;
+                    } else if (lead < 0xF0) {
+                        if (n - i < 3 || !continuation(s[i + 1]) || !continuation(s[i + 2])) return false;
+                        if (lead == 0xE0 && s[i + 1] < 0xA0) return false;   // overlong
+                        if (lead == 0xED && s[i + 1] >= 0xA0) return false;  // surrogate
+                        i += 3;
+                    } else if (lead < 0xF5) {
+                        if (n - i < 4 || !continuation(s[i + 1]) || !continuation(s[i + 2]) || !continuation(s[i + 3])) return false;
+                        if (lead == 0xF0 && s[i + 1] < 0x90) return false;   // overlong
+                        if (lead == 0xF4 && s[i + 1] >= 0x90) return false;  // above U+10FFFF
+                        i += 4;
+                    } else {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            // The Normalizer2 singletons are immutable and owned by ICU (never
+            // delete them). They are looked up once; after that, reading this
+            // function-local static is a plain acquire load.
+            struct Normalizers {
+                const icu::Normalizer2* nfc = nullptr;
+                const icu::Normalizer2* nfd = nullptr;
+                const icu::Normalizer2* nfkc = nullptr;
+                const icu::Normalizer2* nfkd = nullptr;
+            };
+
+            const Normalizers& normalizers() {
+                static const Normalizers instance = [] {
+                    Normalizers n;
+                    UErrorCode status = U_ZERO_ERROR;
+                    n.nfc = icu::Normalizer2::getNFCInstance(status);
+                    status = U_ZERO_ERROR;
+                    n.nfd = icu::Normalizer2::getNFDInstance(status);
+                    status = U_ZERO_ERROR;
+                    n.nfkc = icu::Normalizer2::getNFKCInstance(status);
+                    status = U_ZERO_ERROR;
+                    n.nfkd = icu::Normalizer2::getNFKDInstance(status);
+                    return n;
+                }();
+                return instance;
+            }
+
+            // Break iterators and transliterators keep per-use state, so each is
+            // built once as a shared prototype that is only ever cloned (a const,
+            // thread-safe call), and every thread works on its own clone.
+            std::unique_ptr<icu::BreakIterator> make_break_iterator(UBreakIteratorType type) {
+                UErrorCode status = U_ZERO_ERROR;
+                std::unique_ptr<icu::BreakIterator> iter;
+                switch (type) {
+                case UBRK_CHARACTER:
+                    iter.reset(icu::BreakIterator::createCharacterInstance(icu::Locale::getDefault(), status));
+                    if (U_FAILURE(status) || !iter) throw TokenizerException("Failed to create char break iterator");
+                    break;
+                case UBRK_WORD:
+                    iter.reset(icu::BreakIterator::createWordInstance(icu::Locale::getDefault(), status));
+                    if (U_FAILURE(status) || !iter) throw TokenizerException("Failed to create word break iterator");
+                    break;
+                default:
+                    iter.reset(icu::BreakIterator::createSentenceInstance(icu::Locale::getDefault(), status));
+                    if (U_FAILURE(status) || !iter) throw TokenizerException("Failed to create sentence break iterator");
+                    break;
+                }
+                return iter;
+            }
+
+            const icu::Transliterator& accent_stripper_prototype() {
+                static const std::unique_ptr<icu::Transliterator> prototype = [] {
+                    UErrorCode status = U_ZERO_ERROR;
+                    std::unique_ptr<icu::Transliterator> t(
+                        icu::Transliterator::createInstance("Any-Latin; NFD; [:Nonspacing Mark:] Remove; NFC", UTRANS_FORWARD, status));
+                    if (U_FAILURE(status) || !t) throw TokenizerException("Failed to create ICU accent-stripping Transliterator");
+                    return t;
+                }();
+                return *prototype;
+            }
+
+        } // namespace
 
         const std::regex ICUUtils::url_regex_(R"((http|https)://[a-zA-Z0-9./\-_?=&%]+)");
         const std::regex ICUUtils::email_regex_(R"([a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\.[a-zA-Z]{2,})");
@@ -32,75 +122,135 @@ namespace auratokenizer {
         }
 
         const icu::Normalizer2* ICUUtils::get_normalizer(NormalizationForm form) {
-            std::lock_guard<std::mutex> lock(normalizer_mutex_);
-            UErrorCode status = U_ZERO_ERROR;
+            const Normalizers& n = normalizers();
             switch (form) {
             case NormalizationForm::NFC:
-                if (!nfc_norm_) nfc_norm_.reset(icu::Normalizer2::getNFCInstance(status));
-                if (U_FAILURE(status)) throw TokenizerException("Failed to get NFC normalizer");
-                return nfc_norm_.get();
+                if (!n.nfc) throw TokenizerException("Failed to get NFC normalizer");
+                return n.nfc;
             case NormalizationForm::NFD:
-                if (!nfd_norm_) nfd_norm_.reset(icu::Normalizer2::getNFDInstance(status));
-                if (U_FAILURE(status)) throw TokenizerException("Failed to get NFD normalizer");
-                return nfd_norm_.get();
+                if (!n.nfd) throw TokenizerException("Failed to get NFD normalizer");
+                return n.nfd;
             case NormalizationForm::NFKC:
-                if (!nfkc_norm_) nfkc_norm_.reset(icu::Normalizer2::getNFKCInstance(status));
-                if (U_FAILURE(status)) throw TokenizerException("Failed to get NFKC normalizer");
-                return nfkc_norm_.get();
+                if (!n.nfkc) throw TokenizerException("Failed to get NFKC normalizer");
+                return n.nfkc;
             case NormalizationForm::NFKD:
-                if (!nfkd_norm_) nfkd_norm_.reset(icu::Normalizer2::getNFKDInstance(status));
-                if (U_FAILURE(status)) throw TokenizerException("Failed to get NFKD normalizer");
-                return nfkd_norm_.get();
+                if (!n.nfkd) throw TokenizerException("Failed to get NFKD normalizer");
+                return n.nfkd;
             default:
                 return nullptr;
             }
         }
 
         icu::BreakIterator* ICUUtils::get_break_iterator(UBreakIteratorType type) {
-            std::lock_guard<std::mutex> lock(break_iterator_mutex_);
-            UErrorCode status = U_ZERO_ERROR;
+            const icu::BreakIterator* prototype = nullptr;
+            size_t slot = 0;
             switch (type) {
-            case UBRK_CHARACTER:
-                if (!char_break_it_) char_break_it_.reset(icu::BreakIterator::createCharacterInstance(icu::Locale::getDefault(), status));
-                if (U_FAILURE(status)) throw TokenizerException("Failed to create char break iterator");
-                return char_break_it_.get();
-            case UBRK_WORD:
-                if (!word_break_it_) word_break_it_.reset(icu::BreakIterator::createWordInstance(icu::Locale::getDefault(), status));
-                if (U_FAILURE(status)) throw TokenizerException("Failed to create word break iterator");
-                return word_break_it_.get();
-            case UBRK_SENTENCE:
-                if (!sentence_break_it_) sentence_break_it_.reset(icu::BreakIterator::createSentenceInstance(icu::Locale::getDefault(), status));
-                if (U_FAILURE(status)) throw TokenizerException("Failed to create sentence break iterator");
-                return sentence_break_it_.get();
+            case UBRK_CHARACTER: {
+                static const std::unique_ptr<icu::BreakIterator> character = make_break_iterator(UBRK_CHARACTER);
+                prototype = character.get();
+                slot = 0;
+                break;
+            }
+            case UBRK_WORD: {
+                static const std::unique_ptr<icu::BreakIterator> word = make_break_iterator(UBRK_WORD);
+                prototype = word.get();
+                slot = 1;
+                break;
+            }
+            case UBRK_SENTENCE: {
+                static const std::unique_ptr<icu::BreakIterator> sentence = make_break_iterator(UBRK_SENTENCE);
+                prototype = sentence.get();
+                slot = 2;
+                break;
+            }
             default:
                 return nullptr;
             }
+            thread_local std::unique_ptr<icu::BreakIterator> local[3];
+            if (!local[slot]) {
+                local[slot].reset(prototype->clone());
+                if (!local[slot]) throw TokenizerException("Failed to clone ICU break iterator");
+            }
+            return local[slot].get();
         }
 
         std::string ICUUtils::normalize(const std::string& input, NormalizationForm form) {
+            // ASCII is unchanged by every normalization form.
+            const size_t ascii = ascii_prefix_length(input.data(), input.size());
+            if (ascii == input.size()) return input;
             const icu::Normalizer2* normalizer = get_normalizer(form);
             if (!normalizer) return input;
+
+            // Only the last ASCII character can combine with what follows, so
+            // everything before it is final. The rest is often already normalized,
+            // unless it is ill-formed: conversion would replace the bad bytes.
+            const size_t start = ascii > 0 ? ascii - 1 : 0;
+            const icu::StringPiece rest(input.data() + start, static_cast<int32_t>(input.size() - start));
             UErrorCode status = U_ZERO_ERROR;
-            icu::UnicodeString ustr = to_icu_string(input);
-            icu::UnicodeString out;
-            normalizer->normalize(ustr, out, status);
+            if (normalizer->isNormalizedUTF8(rest, status) && U_SUCCESS(status)
+                && well_formed_utf8(rest.data(), static_cast<size_t>(rest.size()))) {
+                return input;
+            }
+            status = U_ZERO_ERROR;
+
+            // Convert the rest once; its quick-check-yes prefix is copied and only
+            // the part after that boundary is normalized.
+            const icu::UnicodeString ustr = icu::UnicodeString::fromUTF8(rest);
+            const int32_t done = normalizer->spanQuickCheckYes(ustr, status);
+            icu::UnicodeString out(ustr, 0, done);
+            normalizer->normalizeSecondAndAppend(out, ustr.tempSubString(done), status);
             if (U_FAILURE(status)) throw TokenizerException("ICU normalization failed");
-            return from_icu_string(out);
+            std::string result(input, 0, start);
+            out.toUTF8String(result);
+            return result;
         }
 
-        std::string ICUUtils::strip_accents(const std::string& input) {
-            std::lock_guard<std::mutex> lock(transliterator_mutex_);
-            if (!accent_stripper_) {
-                UErrorCode status = U_ZERO_ERROR;
-                accent_stripper_.reset(
-                    icu::Transliterator::createInstance("Any-Latin; NFD; [:Nonspacing Mark:] Remove; NFC", UTRANS_FORWARD, status));
-                if (U_FAILURE(status) || !accent_stripper_) throw TokenizerException("Failed to create ICU accent-stripping Transliterator");
+        void ICUUtils::normalize_utf8(std::string_view input, NormalizationForm form, std::string& out, icu::Edits* edits) {
+            out.clear();
+            auto copy_input = [&]() {
+                out.assign(input.data(), input.size());
+                if (edits) {
+                    edits->reset();
+                    edits->addUnchanged(static_cast<int32_t>(input.size()));
+                }
+            };
+            const size_t ascii = ascii_prefix_length(input.data(), input.size());
+            const icu::Normalizer2* normalizer = ascii == input.size() ? nullptr : get_normalizer(form);
+            if (!normalizer) {
+                copy_input();
+                return;
             }
+            // Same quick check as normalize(): copy text that is already normalized.
+            const size_t start = ascii > 0 ? ascii - 1 : 0;
+            const icu::StringPiece rest(input.data() + start, static_cast<int32_t>(input.size() - start));
+            UErrorCode status = U_ZERO_ERROR;
+            if (normalizer->isNormalizedUTF8(rest, status) && U_SUCCESS(status)
+                && well_formed_utf8(rest.data(), static_cast<size_t>(rest.size()))) {
+                copy_input();
+                return;
+            }
+            status = U_ZERO_ERROR;
+            icu::StringByteSink<std::string> sink(&out, static_cast<int32_t>(input.size()));
+            normalizer->normalizeUTF8(0, icu::StringPiece(input.data(), static_cast<int32_t>(input.size())), sink, edits, status);
+            if (U_FAILURE(status)) throw TokenizerException("ICU normalization failed");
+        }
+
+        std::string ICUUtils::strip_accents(const std::string& input) {
+            if (is_ascii(input)) return input;  // no marks, and already Latin
             icu::UnicodeString ustr = to_icu_string(input);
-            accent_stripper_->transliterate(ustr);
+            strip_accents(ustr);
             return from_icu_string(ustr);
         }
 
+        void ICUUtils::strip_accents(icu::Replaceable& text) {
+            thread_local std::unique_ptr<icu::Transliterator> accent_stripper;
+            if (!accent_stripper) {
+                accent_stripper.reset(accent_stripper_prototype().clone());
+                if (!accent_stripper) throw TokenizerException("Failed to clone ICU accent-stripping Transliterator");
+            }
+            accent_stripper->transliterate(text);
+        }
+
         bool ICUUtils::is_whitespace(UChar32 c) { return u_isspace(c); }
         bool ICUUtils::is_punctuation(UChar32 c) { return u_ispunct(c); }
         bool ICUUtils::is_cjk(UChar32 c) {
@@ -112,11 +262,34 @@ namespace auratokenizer {
         bool ICUUtils::is_number(UChar32 c) { return u_isdigit(c); }
 
         std::string ICUUtils::to_lower(const std::string& input) {
+            if (is_ascii(input)) {
+                std::string out = input;
+                for (char& c : out) {
+                    if (c >= 'A' && c <= 'Z') c = static_cast<char>(c + ('a' - 'A'));
+                }
+                return out;
+            }
             icu::UnicodeString ustr = to_icu_string(input);
             ustr.toLower();
             return from_icu_string(ustr);
         }
 
+        void ICUUtils::to_lower_utf8(std::string_view input, std::string& out, icu::Edits* edits) {
+            out.clear();
+            if (is_ascii(input) && !edits) {
+                out.assign(input.data(), input.size());
+                for (char& c : out) {
+                    if (c >= 'A' && c <= 'Z') c = static_cast<char>(c + ('a' - 'A'));
+                }
+                return;
+            }
+            // Default locale, like UnicodeString::toLower().
+            UErrorCode status = U_ZERO_ERROR;
+            icu::StringByteSink<std::string> sink(&out, static_cast<int32_t>(input.size()));
+            icu::CaseMap::utf8ToLower(nullptr, 0, icu::StringPiece(input.data(), static_cast<int32_t>(input.size())), sink, edits, status);
+            if (U_FAILURE(status)) throw TokenizerException("ICU lowercasing failed");
+        }
+
         std::string ICUUtils::to_upper(const std::string& input) {
             icu::UnicodeString ustr = to_icu_string(input);
             ustr.toUpper();
@@ -159,6 +332,28 @@ namespace auratokenizer {
             return segments;
         }
         
+        std::vector<OffsetMapping> ICUUtils::segment_word_spans(std::string_view input) {
+            UErrorCode status = U_ZERO_ERROR;
+            UText* text = utext_openUTF8(nullptr, input.data(), static_cast<int64_t>(input.size()), &status);
+            if (U_FAILURE(status)) throw TokenizerException("Failed to open UTF-8 text for segmentation");
+            icu::BreakIterator* iter = get_break_iterator(UBRK_WORD);
+            // Boundaries are then native indexes, i.e. byte offsets into input.
+            iter->setText(text, status);
+            std::vector<OffsetMapping> spans;
+            if (U_SUCCESS(status)) {
+                int32_t start = iter->first();
+                for (int32_t end = iter->next(); end != icu::BreakIterator::DONE; start = end, end = iter->next()) {
+                    spans.push_back(OffsetMapping{ start, end });
+                }
+            }
+            // The iterator keeps a shallow clone of text; point it away from input.
+            static const icu::UnicodeString empty;
+            iter->setText(empty);
+            utext_close(text);
+            if (U_FAILURE(status)) throw TokenizerException("ICU word segmentation failed");
+            return spans;
+        }
+
         std::vector<std::string> ICUUtils::segment_sentences(const std::string& input) { 
             icu::BreakIterator* iter = get_break_iterator(UBRK_SENTENCE);
             icu::UnicodeString ustr = to_icu_string(input);
@@ -200,6 +395,8 @@ namespace auratokenizer {
             return result;
         }
 
+        bool ICUUtils::is_valid_utf8(std::string_view input) { return well_formed_utf8(input.data(), input.size()); }
+
         bool ICUUtils::is_url(const std::string& input) { return std::regex_match(input, url_regex_); }
         bool ICUUtils::is_email(const std::string& input) { return std::regex_match(input, email_regex_); }
 
@@ -0,0 +1,220 @@
+#include "normalized_string.h"
+#include "tokenizer_exception.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace auratokenizer {
+
+    // -- Step --
+
+    void NormalizedString::Step::keep(size_t length) {
+        if (length == 0) return;
+        if (!edits_.empty() && edits_.back().old_length == edits_.back().new_length) {
+            edits_.back().old_length += static_cast<uint32_t>(length);
+            edits_.back().new_length += static_cast<uint32_t>(length);
+        } else {
+            edits_.push_back({ static_cast<uint32_t>(length), static_cast<uint32_t>(length) });
+        }
+        old_size_ += length;
+        new_size_ += length;
+    }
+
+    void NormalizedString::Step::change(size_t old_length, size_t new_length) {
+        if (old_length == new_length) {
+            keep(old_length);
+            return;
+        }
+        // Consecutive deletions produce nothing in between, so they are one edit.
+        if (new_length == 0 && !edits_.empty() && edits_.back().new_length == 0) {
+            edits_.back().old_length += static_cast<uint32_t>(old_length);
+        } else {
+            edits_.push_back({ static_cast<uint32_t>(old_length), static_cast<uint32_t>(new_length) });
+        }
+        old_size_ += old_length;
+        new_size_ += new_length;
+        changes_lengths_ = true;
+    }
+
+    void NormalizedString::Step::append(const NormalizedString& piece) {
+        size_t consumed = 0;  // original bytes of piece described so far
+        for (size_t i = 0; i < piece.spans_.size(); ++i) {
+            const Span& span = piece.spans_[i];
+            const size_t length = piece.span_end(i) - span.begin;
+            if (span.orig_begin > consumed) {
+                change(span.orig_begin - consumed, 0);
+                consumed = span.orig_begin;
+            }
+            if (span.exact && span.orig_begin == consumed) {
+                keep(length);
+            } else {
+                // Ranges may overlap where a change took part of a wider span; the overlap stays with the earlier edit.
+                change(span.orig_end > consumed ? span.orig_end - consumed : 0, length);
+            }
+            consumed = std::max<size_t>(consumed, span.orig_end);
+        }
+        if (consumed < piece.original_size_) change(piece.original_size_ - consumed, 0);
+    }
+
+    void NormalizedString::Step::rewind(size_t old_position) {
+        while (!edits_.empty() && old_size_ > old_position) {
+            Edit& last = edits_.back();
+            if (old_size_ - last.old_length >= old_position) {
+                old_size_ -= last.old_length;
+                new_size_ -= last.new_length;
+                edits_.pop_back();
+                continue;
+            }
+            if (last.old_length != last.new_length) {
+                throw TokenizerException("NormalizedString::Step: cannot rewind into a change");
+            }
+            const uint32_t cut = static_cast<uint32_t>(old_size_ - old_position);
+            last.old_length -= cut;
+            last.new_length -= cut;
+            old_size_ -= cut;
+            new_size_ -= cut;
+        }
+    }
+
+    void NormalizedString::Step::clear() {
+        edits_.clear();
+        old_size_ = 0;
+        new_size_ = 0;
+        changes_lengths_ = false;
+    }
+
+    // -- NormalizedString --
+
+    void NormalizedString::reset(std::string_view original) {
+        // Offsets are reported as int.
+        if (original.size() > static_cast<size_t>(INT32_MAX)) {
+            throw TokenizerException("NormalizedString: text longer than 2 GiB");
+        }
+        normalized_.assign(original.data(), original.size());
+        spans_.clear();
+        if (!original.empty()) spans_.push_back({ 0, 0, static_cast<uint32_t>(original.size()), true });
+        original_size_ = original.size();
+    }
+
+    void NormalizedString::clear() {
+        normalized_.clear();
+        spans_.clear();
+        original_size_ = 0;
+    }
+
+    size_t NormalizedString::span_end(size_t index) const {
+        return index + 1 < spans_.size() ? spans_[index + 1].begin : normalized_.size();
+    }
+
+    size_t NormalizedString::find_span(size_t pos, size_t hint) const {
+        if (hint >= spans_.size() || spans_[hint].begin > pos) {
+            auto it = std::upper_bound(spans_.begin(), spans_.end(), pos,
+                [](size_t value, const Span& span) { return value < span.begin; });
+            return static_cast<size_t>(it - spans_.begin()) - 1;
+        }
+        while (span_end(hint) <= pos) ++hint;
+        return hint;
+    }
+
+    size_t NormalizedString::start_of(size_t pos, size_t& hint) const {
+        if (pos >= normalized_.size()) return original_size_;
+        hint = find_span(pos, hint);
+        const Span& span = spans_[hint];
+        return span.exact ? span.orig_begin + (pos - span.begin) : span.orig_begin;
+    }
+
+    size_t NormalizedString::end_of(size_t pos, size_t& hint) const {
+        hint = find_span(pos - 1, hint);
+        const Span& span = spans_[hint];
+        return span.exact ? span.orig_begin + (pos - span.begin) : span.orig_end;
+    }
+
+    void NormalizedString::emit(size_t begin, size_t orig_begin, size_t orig_end, bool exact) {
+        if (!next_spans_.empty()) {
+            Span& last = next_spans_.back();
+            if (exact && last.exact && last.orig_end == orig_begin) {
+                last.orig_end = static_cast<uint32_t>(orig_end);
+                return;
+            }
+            if (!exact && !last.exact && last.orig_begin == orig_begin && last.orig_end == orig_end) return;
+        }
+        next_spans_.push_back({ static_cast<uint32_t>(begin), static_cast<uint32_t>(orig_begin),
+                                static_cast<uint32_t>(orig_end), exact });
+    }
+
+    void NormalizedString::update(std::string& text, const Step& step) {
+        const size_t old_size = normalized_.size();
+        if (step.old_size_ > old_size || text.size() != step.new_size_ + (old_size - step.old_size_)) {
+            throw TokenizerException("NormalizedString: step does not match the text");
+        }
+        if (!step.changes_lengths_) {
+            normalized_.swap(text);
+            return;
+        }
+
+        next_spans_.clear();
+        size_t in = 0;    // position in the current text
+        size_t out = 0;   // position in text
+        size_t hint = 0;
+        // Kept bytes inherit the alignment of the bytes they came from, span by span.
+        auto kept = [&](size_t length) {
+            const size_t end = in + length;
+            for (size_t pos = in; pos < end;) {
+                hint = find_span(pos, hint);
+                const Span& span = spans_[hint];
+                const size_t stop = std::min(end, span_end(hint));
+                if (span.exact) {
+                    emit(out + (pos - in), span.orig_begin + (pos - span.begin), span.orig_begin + (stop - span.begin), true);
+                } else {
+                    emit(out + (pos - in), span.orig_begin, span.orig_end, false);
+                }
+                pos = stop;
+            }
+        };
+        for (const Step::Edit& edit : step.edits_) {
+            if (edit.old_length == edit.new_length) {
+                kept(edit.old_length);
+            } else if (edit.new_length > 0) {
+                // Changed bytes all map to the whole range they replace; inserted ones to a position.
+                const size_t begin = start_of(in, hint);
+                const size_t end = edit.old_length > 0 ? end_of(in + edit.old_length, hint) : begin;
+                emit(out, begin, end, false);
+            }
+            in += edit.old_length;
+            out += edit.new_length;
+        }
+        kept(old_size - in);
+
+        spans_.swap(next_spans_);
+        normalized_.swap(text);
+    }
+
+    OffsetMapping NormalizedString::original_span(size_t begin, size_t end) const {
+        size_t hint = 0;
+        end = std::min(end, normalized_.size());
+        const size_t start = start_of(begin, hint);
+        if (begin >= end) return OffsetMapping{ static_cast<int>(start), static_cast<int>(start) };
+        return OffsetMapping{ static_cast<int>(start), static_cast<int>(end_of(end, hint)) };
+    }
+
+    void NormalizedString::to_original(std::vector<OffsetMapping>& offsets, size_t first, size_t base) const {
+        const int shift = static_cast<int>(base);
+        // Unchanged lengths everywhere: offsets already hold.
+        if (spans_.size() == 1 && spans_[0].exact && spans_[0].orig_begin == 0 && normalized_.size() == original_size_) {
+            for (size_t i = first; i < offsets.size(); ++i) {
+                offsets[i].start += shift;
+                offsets[i].end += shift;
+            }
+            return;
+        }
+        size_t hint = 0;
+        for (size_t i = first; i < offsets.size(); ++i) {
+            const size_t begin = static_cast<size_t>(offsets[i].start);
+            const size_t end = std::min(static_cast<size_t>(offsets[i].end), normalized_.size());
+            const size_t start = start_of(begin, hint);
+            offsets[i].start = static_cast<int>(start) + shift;
+            offsets[i].end = static_cast<int>(begin < end ? end_of(end, hint) : start) + shift;
+        }
+    }
+
+} // namespace auratokenizer
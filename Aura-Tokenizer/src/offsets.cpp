@@ -1,5 +1,7 @@
 #include "offsets.h"
 
+#include <string_view>
+
 namespace auratokenizer {
 
 OffsetTracker::OffsetTracker() {}
@@ -7,10 +9,32 @@ OffsetTracker::~OffsetTracker() {}
 
 /**
  * @brief Compute token offsets for a given text and its tokenized output.
+ *
+ * Each token is searched for in text from the end of the previous match, so
+ * repeated tokens map to successive occurrences. A WordPiece continuation
+ * ("##ing") is matched without its prefix. A token that does not occur
+ * (normalized away, or an unknown token) gets an empty offset at the current
+ * position.
  */
 std::vector<TokenOffset> OffsetTracker::compute_offsets(const std::string& text, const std::vector<std::string>& tokens) {
-    // TODO: Implement offset computation logic
-    return {};
+    std::vector<TokenOffset> offsets;
+    offsets.reserve(tokens.size());
+    size_t cursor = 0;
+    for (const std::string& token : tokens) {
+        std::string_view piece = token;
+        size_t pos = piece.empty() ? std::string::npos : text.find(piece, cursor);
+        if (pos == std::string::npos && piece.size() > 2 && piece.compare(0, 2, "##") == 0) {
+            piece.remove_prefix(2);
+            pos = text.find(piece, cursor);
+        }
+        if (pos == std::string::npos) {
+            offsets.push_back({ static_cast<int>(cursor), static_cast<int>(cursor) });
+            continue;
+        }
+        cursor = pos + piece.size();
+        offsets.push_back({ static_cast<int>(pos), static_cast<int>(cursor) });
+    }
+    return offsets;
 }
 
 } // namespace auratokenizer 
\ No newline at end of file
@@ -0,0 +1,569 @@
+#include "precompiled_charsmap.h"
+#include "ascii_scan.h"
+#include "utf8_scan.h"
+#include "tokenizer_exception.h"
+
+#include <unicode/normalizer2.h>
+#include <unicode/uchar.h>
+#include <unicode/uscript.h>
+#include <unicode/utf8.h>
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+namespace auratokenizer {
+
+    namespace {
+
+        constexpr char kMagic[8] = { 'A', 'U', 'R', 'A', 'C', 'M', 'A', 'P' };
+        constexpr uint32_t kByteOrderTag = 0x01020304u;
+        constexpr uint32_t kSwappedByteOrderTag = 0x04030201u;
+        constexpr uint32_t kFormatVersion = 1;
+
+        struct BlobHeader {
+            char     magic[8];
+            uint32_t byte_order;     // kByteOrderTag in the writer's byte order
+            uint32_t version;
+            uint32_t form;           // NormalizationForm
+            uint32_t flags;          // settings_flags()
+            uint64_t trie_size;      // bytes of the DoubleArrayTrie blob that follows
+            uint64_t pool_size;      // bytes of replacement strings after it
+        };
+
+        static_assert(sizeof(BlobHeader) == 40, "BlobHeader layout is part of the blob format");
+
+        enum SettingFlag : uint32_t {
+            LOWERCASE = 1u << 0,
+            STRIP_ACCENTS = 1u << 1,
+            NORMALIZE_WHITESPACE = 1u << 2,
+            REMOVE_CONTROL_CHARS = 1u << 3,
+            REMOVE_DIACRITICS = 1u << 4,
+        };
+
+        const char kReplacementChar[] = "\xEF\xBF\xBD";  // U+FFFD
+
+        // Scripts Any-Latin leaves alone, so accent stripping stays per character.
+        bool latin_like(UChar32 c) {
+            UErrorCode status = U_ZERO_ERROR;
+            const UScriptCode script = uscript_getScript(c, &status);
+            return U_SUCCESS(status) && (script == USCRIPT_LATIN || script == USCRIPT_COMMON
+                || script == USCRIPT_INHERITED || script == USCRIPT_UNKNOWN);
+        }
+
+        std::string utf8(const std::u32string& code_points) {
+            std::string out;
+            for (char32_t c : code_points) {
+                char bytes[U8_MAX_LENGTH];
+                int32_t length = 0;
+                UBool error = false;
+                U8_APPEND(reinterpret_cast<uint8_t*>(bytes), length, U8_MAX_LENGTH, static_cast<UChar32>(c), error);
+                if (!error) out.append(bytes, static_cast<size_t>(length));
+            }
+            return out;
+        }
+
+        std::u32string code_points(const icu::UnicodeString& text) {
+            std::u32string out;
+            for (int32_t i = 0; i < text.length(); i += U16_LENGTH(text.char32At(i))) out.push_back(static_cast<char32_t>(text.char32At(i)));
+            return out;
+        }
+
+        // What build() needs to know about one configuration.
+        class Compiler {
+        public:
+            explicit Compiler(const TokenizerConfig& config) : config_(config), reference_(config) {
+                UErrorCode status = U_ZERO_ERROR;
+                switch (config.normalization) {
+                case NormalizationForm::NFC: add(icu::Normalizer2::getNFCInstance(status)); break;
+                case NormalizationForm::NFD: add(icu::Normalizer2::getNFDInstance(status)); break;
+                case NormalizationForm::NFKC: add(icu::Normalizer2::getNFKCInstance(status)); break;
+                case NormalizationForm::NFKD: add(icu::Normalizer2::getNFKDInstance(status)); break;
+                default: break;
+                }
+                // Accent stripping and diacritic removal decompose and recompose.
+                if (config.strip_accents || config.remove_diacritics) {
+                    add(icu::Normalizer2::getNFCInstance(status));
+                    add(icu::Normalizer2::getNFDInstance(status));
+                }
+                nfd_ = icu::Normalizer2::getNFDInstance(status);
+                nfc_ = icu::Normalizer2::getNFCInstance(status);
+                if (U_FAILURE(status)) throw TokenizerException("PrecompiledCharsmap: failed to get ICU normalizers");
+
+                // Neighbours that expose context: letters of either case, and
+                // (without transliteration) Greek for final sigma.
+                probes_ = { "a", "A" };
+                if (!config.strip_accents) probes_.push_back("\xCE\xB1");
+            }
+
+            bool decomposes() const { return !normalizers_.empty(); }
+
+            std::string run(const std::string& text) const { return reference_.normalize(text); }
+
+            // Unchanged by every step and inert to its neighbours, decided from
+            // character properties alone; most of the code space.
+            bool trivially_unchanged(UChar32 c) const {
+                for (const icu::Normalizer2* normalizer : normalizers_) {
+                    if (!normalizer->isInert(c)) return false;
+                }
+                if (config_.lowercase && u_hasBinaryProperty(c, UCHAR_CHANGES_WHEN_LOWERCASED)) return false;
+                if (config_.normalize_whitespace && u_isUWhiteSpace(c)) return false;
+                const int8_t type = u_charType(c);
+                if (config_.remove_control_chars && (type == U_CONTROL_CHAR || type == U_FORMAT_CHAR)) return false;
+                if ((config_.strip_accents || config_.remove_diacritics) && type == U_NON_SPACING_MARK) return false;
+                if (config_.strip_accents && !latin_like(c)) return false;
+                return true;
+            }
+
+            // Some normalization step may combine c with what precedes it.
+            bool joins_previous(UChar32 c) const {
+                for (const icu::Normalizer2* normalizer : normalizers_) {
+                    if (!normalizer->hasBoundaryBefore(c)) return true;
+                }
+                return false;
+            }
+
+            // With strip_accents, text containing a non-Latin script (after
+            // normalization) is transliterated with context across words.
+            bool transliterated(const std::string& key) const {
+                if (!config_.strip_accents) return false;
+                icu::UnicodeString text = icu::UnicodeString::fromUTF8(key);
+                if (config_.normalization != NormalizationForm::NONE) text = icu::UnicodeString::fromUTF8(run_form(key));
+                for (char32_t c : code_points(text)) {
+                    if (!latin_like(static_cast<UChar32>(c))) return true;
+                }
+                return false;
+            }
+
+            // key's result depends on a neighbour (final sigma and the like).
+            bool context_sensitive(const std::string& key, const std::string& result) const {
+                for (const std::string& probe : probes_) {
+                    const std::string alone = run(probe);
+                    if (run(probe + key) != alone + result || run(key + probe) != result + alone) return true;
+                }
+                return false;
+            }
+
+            std::u32string decompose(UChar32 c) const {
+                UErrorCode status = U_ZERO_ERROR;
+                icu::UnicodeString out;
+                nfd_->normalize(icu::UnicodeString(c), out, status);
+                return U_SUCCESS(status) ? code_points(out) : std::u32string();
+            }
+
+            std::u32string compose(const std::u32string& text) const {
+                UErrorCode status = U_ZERO_ERROR;
+                icu::UnicodeString out;
+                nfc_->normalize(icu::UnicodeString::fromUTF8(utf8(text)), out, status);
+                return U_SUCCESS(status) ? code_points(out) : text;
+            }
+
+        private:
+            TokenizerConfig config_;
+            UnicodeNormalizer reference_;
+            std::vector<const icu::Normalizer2*> normalizers_;
+            const icu::Normalizer2* nfd_ = nullptr;
+            const icu::Normalizer2* nfc_ = nullptr;
+            std::vector<std::string> probes_;
+
+            void add(const icu::Normalizer2* normalizer) {
+                if (normalizer && std::find(normalizers_.begin(), normalizers_.end(), normalizer) == normalizers_.end()) {
+                    normalizers_.push_back(normalizer);
+                }
+            }
+
+            std::string run_form(const std::string& text) const {
+                std::string out;
+                icu_utils::ICUUtils::normalize_utf8(text, config_.normalization, out);
+                return out;
+            }
+        };
+
+    } // namespace
+
+    PrecompiledCharsmap::PrecompiledCharsmap()
+        : form_(static_cast<uint32_t>(NormalizationForm::NONE)), flags_(0), built_(false), fallback_(TokenizerConfig()) {
+        for (int c = 0; c < 128; ++c) ascii_bytes_[c] = static_cast<int16_t>(c);
+        boundary_.fill(false);
+    }
+
+    uint32_t PrecompiledCharsmap::settings_flags(const TokenizerConfig& config) {
+        return (config.lowercase ? LOWERCASE : 0u) | (config.strip_accents ? STRIP_ACCENTS : 0u)
+            | (config.normalize_whitespace ? NORMALIZE_WHITESPACE : 0u)
+            | (config.remove_control_chars ? REMOVE_CONTROL_CHARS : 0u)
+            | (config.remove_diacritics ? REMOVE_DIACRITICS : 0u);
+    }
+
+    bool PrecompiledCharsmap::matches(const TokenizerConfig& config) const {
+        return built_ && form_ == static_cast<uint32_t>(config.normalization) && flags_ == settings_flags(config);
+    }
+
+    void PrecompiledCharsmap::apply_settings(TokenizerConfig& config) const {
+        config.normalization = static_cast<NormalizationForm>(form_);
+        config.lowercase = (flags_ & LOWERCASE) != 0;
+        config.strip_accents = (flags_ & STRIP_ACCENTS) != 0;
+        config.normalize_whitespace = (flags_ & NORMALIZE_WHITESPACE) != 0;
+        config.remove_control_chars = (flags_ & REMOVE_CONTROL_CHARS) != 0;
+        config.remove_diacritics = (flags_ & REMOVE_DIACRITICS) != 0;
+    }
+
+    TokenizerConfig PrecompiledCharsmap::settings() const {
+        TokenizerConfig config;
+        apply_settings(config);
+        return config;
+    }
+
+    // -- Compilation --
+
+    void PrecompiledCharsmap::build(const TokenizerConfig& config) {
+        const Compiler compiler(config);
+        std::map<std::string, int32_t> entries;
+        std::vector<char> pool;
+        std::map<std::string, int32_t> pooled;  // replacement -> value, shared between keys
+
+        auto replace = [&](const std::string& key, const std::string& result) {
+            if (result.size() > 255) throw TokenizerException("PrecompiledCharsmap: replacement too long");
+            auto it = pooled.find(result);
+            if (it == pooled.end()) {
+                const int32_t value = static_cast<int32_t>(pool.size() << 2) | REPLACE;
+                pool.push_back(static_cast<char>(result.size()));
+                pool.insert(pool.end(), result.begin(), result.end());
+                it = pooled.emplace(result, value).first;
+            }
+            entries[key] = it->second;
+        };
+
+        // ASCII is inert to normalization; only cleanup and case apply.
+        for (UChar32 c = 0; c < 0x80; ++c) {
+            const std::string key(1, static_cast<char>(c));
+            const std::string result = compiler.run(key);
+            if (result != key) replace(key, result);
+        }
+
+        std::vector<UChar32> starters;  // non-ASCII characters that map on their own
+        for (UChar32 c = 0x80; c <= 0x10FFFF; ++c) {
+            if (U_IS_SURROGATE(c)) continue;
+            if (compiler.trivially_unchanged(c)) continue;
+            const std::string key = utf8(std::u32string(1, static_cast<char32_t>(c)));
+            if (compiler.transliterated(key)) {
+                entries[key] = SCRIPT;
+                continue;
+            }
+            if (compiler.joins_previous(c)) {
+                entries[key] = CONTEXT;
+                continue;
+            }
+            const std::string result = compiler.run(key);
+            if (compiler.context_sensitive(key, result)) {
+                entries[key] = CONTEXT;
+                continue;
+            }
+            if (result != key) replace(key, result);
+            starters.push_back(c);
+        }
+
+        // Decomposed spellings of precomposed characters (and partly composed
+        // ones: a base with some of its marks already applied). Hangul
+        // syllables are left out; conjoining jamo input is rare.
+        if (compiler.decomposes()) {
+            for (UChar32 c : starters) {
+                if (c >= 0xAC00 && c <= 0xD7A3) continue;
+                const std::u32string decomposed = compiler.decompose(c);
+                if (decomposed.size() < 2) continue;
+                for (size_t split = 1; split < decomposed.size(); ++split) {
+                    std::u32string sequence = split == 1 ? decomposed.substr(0, 1) : compiler.compose(decomposed.substr(0, split));
+                    sequence += decomposed.substr(split);
+                    const std::string key = utf8(sequence);
+                    const UChar32 first = static_cast<UChar32>(sequence.front());
+                    if (entries.count(key) || compiler.joins_previous(first) || compiler.transliterated(key)) continue;
+                    const auto first_entry = entries.find(utf8(sequence.substr(0, 1)));
+                    if (first_entry != entries.end() && (first_entry->second & 3) != REPLACE) continue;
+                    const std::string result = compiler.run(key);
+                    if (compiler.context_sensitive(key, result)) continue;
+                    replace(key, result);
+                }
+            }
+        }
+
+        std::vector<std::pair<std::string, int32_t>> keys(entries.begin(), entries.end());
+        DoubleArrayTrie trie;
+        trie.build(keys, true);
+
+        trie_ = std::move(trie);
+        pool_.adopt(std::move(pool));
+        form_ = static_cast<uint32_t>(config.normalization);
+        flags_ = settings_flags(config);
+        finish_load();
+    }
+
+    void PrecompiledCharsmap::finish_load() {
+        // ASCII maps to at most one byte (cleanup and lowercasing only), which
+        // the byte loop in normalize_into() relies on.
+        for (int c = 0; c < 128; ++c) {
+            const int32_t value = trie_.find(std::string(1, static_cast<char>(c)));
+            if (value < 0) {
+                ascii_bytes_[c] = static_cast<int16_t>(c);
+            } else {
+                const size_t offset = static_cast<size_t>(value >> 2);
+                if ((value & 3) != REPLACE || offset >= pool_.size() || pool_[offset] > 1 || offset + 1 + pool_[offset] > pool_.size()) {
+                    throw TokenizerException("PrecompiledCharsmap: unsupported ASCII mapping");
+                }
+                ascii_bytes_[c] = pool_[offset] == 0 ? int16_t(-1) : static_cast<int16_t>(static_cast<unsigned char>(pool_[offset + 1]));
+            }
+            // Whitespace that survives is inert to every step; deleted whitespace joins its neighbours.
+            boundary_[c] = is_ascii_space(static_cast<char>(c)) && ascii_bytes_[c] >= 0;
+        }
+        fallback_ = UnicodeNormalizer(settings());
+        built_ = true;
+    }
+
+    // -- Normalization --
+
+    std::string PrecompiledCharsmap::normalize(std::string_view text) const {
+        std::string out;
+        normalize_into(text, out);
+        return out;
+    }
+
+    std::string_view PrecompiledCharsmap::normalize_view(std::string_view text, std::string& scratch) const {
+        normalize_into(text, scratch);
+        return scratch;
+    }
+
+    void PrecompiledCharsmap::normalize_into(std::string_view text, std::string& out) const {
+        if (!apply(text, out, nullptr)) fallback_.normalize_into(text, out);
+    }
+
+    void PrecompiledCharsmap::normalize(NormalizedString& text) const {
+        thread_local NormalizedString::Step step;
+        thread_local std::string out;
+        step.clear();
+        if (!apply(text.get(), out, &step)) {
+            fallback_.normalize(text);
+            return;
+        }
+        text.update(out, step);
+    }
+
+    std::string_view PrecompiledCharsmap::normalize_view(std::string_view text, NormalizedString& scratch) const {
+        scratch.reset(text);
+        normalize(scratch);
+        return scratch.get();
+    }
+
+    bool PrecompiledCharsmap::apply(std::string_view text, std::string& out, NormalizedString::Step* step) const {
+        if (!built_) throw TokenizerException("PrecompiledCharsmap: no table built or loaded");
+        // Ill-formed UTF-8 becomes U+FFFD whenever UnicodeNormalizer changes anything.
+        const bool sanitize = flags_ != 0 || form_ != static_cast<uint32_t>(NormalizationForm::NONE);
+
+        // text may view out, so the result is built aside and swapped in.
+        thread_local std::string buffer;
+        buffer.clear();
+        buffer.reserve(text.size());
+        auto append_replacement = [&](int32_t value) {
+            const char* record = pool_.data() + (value >> 2);
+            buffer.append(record + 1, static_cast<unsigned char>(record[0]));
+        };
+        auto longest_match = [&](size_t at, int32_t& value) {
+            size_t length = 0;
+            trie_.common_prefix_search(text.substr(at), [&](size_t l, int32_t v) {
+                length = l;
+                value = v;
+            });
+            return length;
+        };
+
+        const char* p = text.data();
+        const size_t n = text.size();
+        auto is_boundary = [&](char byte) {
+            const unsigned char b = static_cast<unsigned char>(byte);
+            return b < 0x80 && boundary_[b];
+        };
+        size_t run_begin = 0;      // the current run between boundaries, in text
+        size_t run_out = 0;        // and where its output starts in buffer
+        size_t i = 0;
+        while (i < n) {
+            const size_t start = i;
+            const unsigned char c = static_cast<unsigned char>(p[i]);
+            // ASCII followed by ASCII: no key longer than one byte starts there.
+            // Only the last byte of an ASCII run can begin a decomposed sequence.
+            if (c < 0x80) {
+                size_t end = i + ascii_prefix_length(p + i, n - i);
+                if (end < n) --end;
+                if (end > i) {
+                    const size_t old_size = buffer.size();
+                    buffer.resize(old_size + (end - i));
+                    char* out_begin = &buffer[0];
+                    char* dst = out_begin + old_size;
+                    for (size_t k = i; k < end; ++k) {
+                        const int16_t mapped = ascii_bytes_[static_cast<unsigned char>(p[k])];
+                        *dst = static_cast<char>(mapped);
+                        dst += mapped >= 0;
+                    }
+                    const size_t kept = static_cast<size_t>(dst - out_begin) - old_size;
+                    buffer.resize(old_size + kept);
+                    if (step && kept == end - i) {
+                        step->keep(kept);
+                    } else if (step) {
+                        for (size_t k = i; k < end; ++k) {
+                            if (ascii_bytes_[static_cast<unsigned char>(p[k])] >= 0) step->keep(1);
+                            else step->change(1, 0);
+                        }
+                    }
+                    // The last boundary in the span starts the current run.
+                    size_t k = end;
+                    size_t tail = 0;
+                    while (k > i && !is_boundary(p[k - 1])) tail += ascii_bytes_[static_cast<unsigned char>(p[--k])] >= 0;
+                    if (k > i) {
+                        run_begin = k;
+                        run_out = buffer.size() - tail;
+                    }
+                    i = end;
+                    continue;
+                }
+            }
+
+            int32_t match_value = -1;
+            const size_t match_length = longest_match(i, match_value);
+
+            if (match_length == 0) {
+                // Unmapped: copy the character, or replace ill-formed bytes.
+                const int32_t begin = static_cast<int32_t>(i);
+                int32_t next = begin;
+                UChar32 code_point;
+                U8_NEXT(reinterpret_cast<const uint8_t*>(p), next, static_cast<int32_t>(n), code_point);
+                if (code_point < 0 && sanitize) {
+                    buffer.append(kReplacementChar, 3);
+                    if (step) step->change(static_cast<size_t>(next - begin), 3);
+                } else {
+                    buffer.append(p + begin, static_cast<size_t>(next - begin));
+                    if (step) step->keep(static_cast<size_t>(next - begin));
+                }
+                i = static_cast<size_t>(next);
+            } else if ((match_value & 3) == REPLACE) {
+                append_replacement(match_value);
+                if (step) step->change(match_length, static_cast<unsigned char>(pool_[static_cast<size_t>(match_value >> 2)]));
+                i += match_length;
+            } else if ((match_value & 3) == CONTEXT) {
+                // Redo the whole run between boundaries through ICU.
+                size_t run_end = i;
+                bool transliterated = false;
+                while (run_end < n && !is_boundary(p[run_end])) {
+                    // The rest of the run is not looked up below, so check it for SCRIPT keys here.
+                    int32_t value = -1;
+                    const size_t length = (flags_ & STRIP_ACCENTS) ? longest_match(run_end, value) : 0;
+                    if (length > 0 && (value & 3) == SCRIPT) transliterated = true;
+                    run_end += std::max<size_t>(length, 1);
+                }
+                if (transliterated) return false;
+                buffer.resize(run_out);
+                if (step) {
+                    // The run is redone, so is its alignment.
+                    thread_local NormalizedString run;
+                    run.reset(text.substr(run_begin, run_end - run_begin));
+                    fallback_.normalize(run);
+                    buffer += run.get();
+                    step->rewind(run_begin);
+                    step->append(run);
+                } else {
+                    thread_local std::string run;
+                    fallback_.normalize_into(text.substr(run_begin, run_end - run_begin), run);
+                    buffer += run;
+                }
+                i = run_end;
+                continue;
+            } else {
+                return false;
+            }
+            if (c < 0x80 && boundary_[c] && i == start + 1) {
+                run_begin = i;
+                run_out = buffer.size();
+            }
+        }
+        std::swap(out, buffer);
+        return true;
+    }
+
+    // -- Serialization --
+
+    std::vector<char> PrecompiledCharsmap::serialize() const {
+        if (!built_) throw TokenizerException("PrecompiledCharsmap: no table built or loaded");
+        const std::vector<char> trie = trie_.serialize();
+        BlobHeader header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.byte_order = kByteOrderTag;
+        header.version = kFormatVersion;
+        header.form = form_;
+        header.flags = flags_;
+        header.trie_size = trie.size();
+        header.pool_size = pool_.size();
+
+        std::vector<char> blob(sizeof(header) + trie.size() + pool_.size());
+        std::memcpy(blob.data(), &header, sizeof(header));
+        std::memcpy(blob.data() + sizeof(header), trie.data(), trie.size());
+        if (!pool_.empty()) std::memcpy(blob.data() + sizeof(header) + trie.size(), pool_.data(), pool_.size());
+        return blob;
+    }
+
+    void PrecompiledCharsmap::deserialize(const std::vector<char>& data) {
+        deserialize(data.data(), data.size());
+    }
+
+    void PrecompiledCharsmap::deserialize(const char* data, size_t size) {
+        read_blob(data, size, true);
+    }
+
+    void PrecompiledCharsmap::view(const char* data, size_t size) {
+        read_blob(data, size, false);
+    }
+
+    void PrecompiledCharsmap::read_blob(const char* data, size_t size, bool copy) {
+        BlobHeader header;
+        if (size < sizeof(header)) throw TokenizerException("PrecompiledCharsmap: truncated blob");
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+            throw TokenizerException("PrecompiledCharsmap: not a charsmap blob");
+        }
+        if (header.byte_order == kSwappedByteOrderTag) {
+            throw TokenizerException("PrecompiledCharsmap: blob was written with the opposite byte order");
+        }
+        if (header.byte_order != kByteOrderTag || header.version != kFormatVersion) {
+            throw TokenizerException("PrecompiledCharsmap: unsupported blob version");
+        }
+        if (header.form > static_cast<uint32_t>(NormalizationForm::NFKD) || header.flags >= (REMOVE_DIACRITICS << 1)
+            || header.trie_size > size || header.pool_size > size) {
+            throw TokenizerException("PrecompiledCharsmap: corrupt blob header");
+        }
+        if (sizeof(header) + header.trie_size + header.pool_size > size) throw TokenizerException("PrecompiledCharsmap: truncated blob");
+
+        const char* trie_data = data + sizeof(header);
+        const char* pool_data = trie_data + header.trie_size;
+        PrecompiledCharsmap loaded;
+        if (copy) {
+            loaded.trie_.deserialize(trie_data, static_cast<size_t>(header.trie_size));
+            loaded.pool_.adopt(std::vector<char>(pool_data, pool_data + header.pool_size));
+        } else {
+            loaded.trie_.view(trie_data, static_cast<size_t>(header.trie_size));
+            loaded.pool_.view(pool_data, static_cast<size_t>(header.pool_size));
+        }
+        loaded.form_ = header.form;
+        loaded.flags_ = header.flags;
+
+        if (copy) {
+            // Every replacement a key points at must lie inside the pool.
+            for (const auto& entry : loaded.trie_.predictive_search("")) {
+                const int32_t value = entry.second;
+                if ((value & 3) > SCRIPT) throw TokenizerException("PrecompiledCharsmap: corrupt trie value");
+                if ((value & 3) != REPLACE) continue;
+                const size_t offset = static_cast<size_t>(value >> 2);
+                if (offset >= loaded.pool_.size()
+                    || offset + 1 + static_cast<unsigned char>(loaded.pool_[offset]) > loaded.pool_.size()) {
+                    throw TokenizerException("PrecompiledCharsmap: replacement out of range");
+                }
+            }
+        }
+        loaded.finish_load();
+        *this = std::move(loaded);
+    }
+
+}
@@ -1,7 +1,113 @@
 #include "streaming.h"
+#include "byte_level.h"
+#include "vocab.h"
 
 namespace auratokenizer {
 
+namespace {
+
+// U+2581 LOWER ONE EIGHTH BLOCK, the SentencePiece word-boundary marker.
+constexpr std::string_view METASPACE = "\xE2\x96\x81";
+
+// Length of the incomplete UTF-8 sequence at the end of s (0 if s ends on a
+// character boundary). Only the last three bytes are inspected.
+size_t incomplete_tail(const std::string& s) {
+    size_t n = s.size();
+    for (size_t back = 1; back <= 3 && back <= n; ++back) {
+        unsigned char c = static_cast<unsigned char>(s[n - back]);
+        if ((c & 0xC0) == 0x80) continue; // continuation byte, keep looking
+        size_t need = c >= 0xF0 && c < 0xF8 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+        return need > back ? back : 0;
+    }
+    return 0; // only continuation bytes: invalid, emit as-is
+}
+
+} // namespace
+
+DecodeStream::DecodeStream(std::shared_ptr<const Vocab> vocab, Mode mode, bool skip_special_tokens)
+    : vocab_(std::move(vocab)),
+      mode_(mode),
+      skip_special_tokens_(skip_special_tokens),
+      first_(true) {}
+
+void DecodeStream::reset() {
+    first_ = true;
+    pending_.clear();
+}
+
+void DecodeStream::append_piece(std::string_view piece) {
+    switch (mode_) {
+    case Mode::RAW:
+        pending_.append(piece.data(), piece.size());
+        break;
+    case Mode::BYTE_LEVEL:
+        byte_level::append_unmapped(piece, pending_);
+        break;
+    case Mode::WORDPIECE:
+        if (piece.size() >= 2 && piece[0] == '#' && piece[1] == '#') {
+            pending_.append(piece.data() + 2, piece.size() - 2);
+        } else {
+            if (!first_) pending_.push_back(' ');
+            pending_.append(piece.data(), piece.size());
+        }
+        break;
+    case Mode::METASPACE: {
+        size_t i = 0;
+        if (first_ && piece.substr(0, METASPACE.size()) == METASPACE) i = METASPACE.size();
+        while (i < piece.size()) {
+            if (piece.compare(i, METASPACE.size(), METASPACE) == 0) {
+                pending_.push_back(' ');
+                i += METASPACE.size();
+            } else {
+                pending_.push_back(piece[i++]);
+            }
+        }
+        break;
+    }
+    }
+    first_ = false;
+}
+
+bool DecodeStream::emit_complete(std::string& out) {
+    size_t keep = incomplete_tail(pending_);
+    size_t ready = pending_.size() - keep;
+    if (ready == 0) return false;
+    out.append(pending_, 0, ready);
+    pending_.erase(0, ready); // at most 3 bytes remain, so this is O(1)
+    return true;
+}
+
+bool DecodeStream::step(int id, std::string& out) {
+    if (skip_special_tokens_ && vocab_->is_special_token_id(id)) return false;
+    std::string_view piece = vocab_->get_token_view(id);
+    if (piece.empty()) return false;
+    if (mode_ == Mode::RAW && (vocab_->flags(id) & Vocab::BYTE_FALLBACK)) {
+        // A SentencePiece "<0xXX>" piece stands for one raw byte.
+        pending_.push_back(static_cast<char>(Vocab::byte_value(piece)));
+        first_ = false;
+        return emit_complete(out);
+    }
+    append_piece(piece);
+    return emit_complete(out);
+}
+
+std::string DecodeStream::step(int id) {
+    std::string out;
+    step(id, out);
+    return out;
+}
+
+void DecodeStream::flush(std::string& out) {
+    out += pending_;
+    pending_.clear();
+}
+
+std::string DecodeStream::flush() {
+    std::string out;
+    flush(out);
+    return out;
+}
+
 StreamingTokenizer::StreamingTokenizer() {}
 StreamingTokenizer::~StreamingTokenizer() {}
 
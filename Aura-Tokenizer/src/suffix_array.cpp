@@ -0,0 +1,286 @@
+#include "suffix_array.h"
+#include "utf8_scan.h"
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <random>
+
+namespace auratokenizer {
+
+    namespace {
+
+        // -- SA-IS (Nong, Zhang & Chan) --
+        // T[n - 1] must be a unique sentinel smaller than every other symbol.
+
+        void get_buckets(const int32_t* T, int32_t n, int32_t K, std::vector<int32_t>& bkt, bool end) {
+            std::fill(bkt.begin(), bkt.end(), 0);
+            for (int32_t i = 0; i < n; ++i) bkt[T[i]]++;
+            int32_t sum = 0;
+            for (int32_t c = 0; c < K; ++c) {
+                sum += bkt[c];
+                bkt[c] = end ? sum : sum - bkt[c];
+            }
+        }
+
+        void induce(const int32_t* T, int32_t* SA, int32_t n, int32_t K,
+            const std::vector<bool>& stype, std::vector<int32_t>& bkt)
+        {
+            get_buckets(T, n, K, bkt, false);
+            for (int32_t i = 0; i < n; ++i) {
+                int32_t j = SA[i] - 1;
+                if (SA[i] > 0 && !stype[j]) SA[bkt[T[j]]++] = j;
+            }
+            get_buckets(T, n, K, bkt, true);
+            for (int32_t i = n - 1; i >= 0; --i) {
+                int32_t j = SA[i] - 1;
+                if (SA[i] > 0 && stype[j]) SA[--bkt[T[j]]] = j;
+            }
+        }
+
+        void sais(const int32_t* T, int32_t* SA, int32_t n, int32_t K) {
+            if (n == 1) {
+                SA[0] = 0;
+                return;
+            }
+            std::vector<bool> stype(n);
+            stype[n - 1] = true;
+            for (int32_t i = n - 2; i >= 0; --i) {
+                stype[i] = T[i] < T[i + 1] || (T[i] == T[i + 1] && stype[i + 1]);
+            }
+            auto is_lms = [&](int32_t i) { return i > 0 && stype[i] && !stype[i - 1]; };
+
+            // Stage 1: sort the LMS substrings by induction.
+            std::vector<int32_t> bkt(K);
+            get_buckets(T, n, K, bkt, true);
+            std::fill(SA, SA + n, -1);
+            for (int32_t i = 1; i < n; ++i) {
+                if (is_lms(i)) SA[--bkt[T[i]]] = i;
+            }
+            induce(T, SA, n, K, stype, bkt);
+
+            // Name the sorted LMS substrings; equal substrings share a name.
+            int32_t n1 = 0;
+            for (int32_t i = 0; i < n; ++i) {
+                if (is_lms(SA[i])) SA[n1++] = SA[i];
+            }
+            std::fill(SA + n1, SA + n, -1);
+            int32_t name = 0, prev = -1;
+            for (int32_t i = 0; i < n1; ++i) {
+                int32_t pos = SA[i];
+                bool diff = false;
+                for (int32_t d = 0; d < n; ++d) {
+                    if (prev == -1 || T[pos + d] != T[prev + d] || stype[pos + d] != stype[prev + d]) {
+                        diff = true;
+                        break;
+                    }
+                    if (d > 0 && (is_lms(pos + d) || is_lms(prev + d))) break;
+                }
+                if (diff) {
+                    ++name;
+                    prev = pos;
+                }
+                SA[n1 + pos / 2] = name - 1;
+            }
+            for (int32_t i = n - 1, j = n - 1; i >= n1; --i) {
+                if (SA[i] >= 0) SA[j--] = SA[i];
+            }
+
+            // Stage 2: sort the reduced string, recursing only if names repeat.
+            int32_t* s1 = SA + n - n1;
+            if (name < n1) {
+                sais(s1, SA, n1, name);
+            } else {
+                for (int32_t i = 0; i < n1; ++i) SA[s1[i]] = i;
+            }
+
+            // Stage 3: place the sorted LMS suffixes and induce the rest.
+            get_buckets(T, n, K, bkt, true);
+            for (int32_t i = 1, j = 0; i < n; ++i) {
+                if (is_lms(i)) s1[j++] = i;
+            }
+            for (int32_t i = 0; i < n1; ++i) SA[i] = s1[SA[i]];
+            std::fill(SA + n1, SA + n, -1);
+            for (int32_t i = n1 - 1; i >= 0; --i) {
+                int32_t j = SA[i];
+                SA[i] = -1;
+                SA[--bkt[T[j]]] = j;
+            }
+            induce(T, SA, n, K, stype, bkt);
+        }
+
+        // Rough peak bytes per symbol: text, SA, SA-IS copy, LCP, rank, owner, weights.
+        constexpr std::size_t kBytesPerSymbol = 40;
+
+        struct Candidate {
+            uint64_t score;
+            size_t   frequency;
+            int32_t  pos;
+            int32_t  length;
+        };
+
+        // Heap order: the worst candidate on top.
+        bool better(const Candidate& a, const Candidate& b) {
+            return a.score != b.score ? a.score > b.score : a.pos < b.pos;
+        }
+
+    } // namespace
+
+    std::vector<int32_t> build_suffix_array(const std::vector<int32_t>& text, int32_t alphabet_size) {
+        if (text.empty()) return {};
+        // Shift symbols up by one and append the sentinel 0.
+        std::vector<int32_t> shifted(text.size() + 1);
+        for (size_t i = 0; i < text.size(); ++i) shifted[i] = text[i] + 1;
+        shifted.back() = 0;
+        std::vector<int32_t> sa(shifted.size());
+        sais(shifted.data(), sa.data(), static_cast<int32_t>(shifted.size()), alphabet_size + 1);
+        sa.erase(sa.begin()); // the sentinel suffix sorts first
+        return sa;
+    }
+
+    std::vector<int32_t> build_lcp_array(const std::vector<int32_t>& text, const std::vector<int32_t>& sa) {
+        const int32_t n = static_cast<int32_t>(text.size());
+        std::vector<int32_t> rank(n), lcp(n, 0);
+        for (int32_t i = 0; i < n; ++i) rank[sa[i]] = i;
+        int32_t h = 0;
+        for (int32_t i = 0; i < n; ++i) {
+            if (rank[i] == 0) {
+                h = 0;
+                continue;
+            }
+            int32_t j = sa[rank[i] - 1];
+            while (i + h < n && j + h < n && text[i + h] == text[j + h]) ++h;
+            lcp[rank[i]] = h;
+            if (h > 0) --h;
+        }
+        return lcp;
+    }
+
+    std::vector<std::pair<std::string, size_t>> extract_seed_pieces(
+        const std::vector<std::pair<std::string, size_t>>& words,
+        const SeedPieceOptions& options)
+    {
+        if (words.empty() || options.max_pieces == 0) return {};
+
+        // Split words into characters; sample if the arrays would not fit the budget.
+        std::vector<size_t> chosen(words.size());
+        std::iota(chosen.begin(), chosen.end(), size_t(0));
+        size_t total_symbols = 0;
+        for (const auto& word : words) total_symbols += word.first.size() + 1;
+        const size_t max_symbols = std::max<size_t>(1, options.memory_budget_bytes / kBytesPerSymbol);
+        if (total_symbols > max_symbols) {
+            std::mt19937 rng(options.sample_seed);
+            std::shuffle(chosen.begin(), chosen.end(), rng);
+            size_t used = 0, keep = 0;
+            while (keep < chosen.size() && used + words[chosen[keep]].first.size() + 1 <= max_symbols) {
+                used += words[chosen[keep]].first.size() + 1;
+                ++keep;
+            }
+            chosen.resize(keep);
+            std::sort(chosen.begin(), chosen.end());
+        }
+
+        // Characters get ids in sorted order, after one boundary id per word.
+        std::map<std::string, int32_t> char_ids;
+        for (size_t w : chosen) {
+            const std::string& word = words[w].first;
+            for (size_t i = 0; i < word.size(); ) {
+                size_t len = std::min(utf8_length(static_cast<unsigned char>(word[i])), word.size() - i);
+                char_ids.emplace(word.substr(i, len), 0);
+                i += len;
+            }
+        }
+        const int32_t boundaries = static_cast<int32_t>(chosen.size());
+        std::vector<std::string> char_text;
+        char_text.reserve(char_ids.size());
+        for (auto& [text, id] : char_ids) {
+            id = boundaries + static_cast<int32_t>(char_text.size());
+            char_text.push_back(text);
+        }
+
+        std::vector<int32_t> text;
+        std::vector<int32_t> owner;       // chosen-word index per position, -1 on boundaries
+        std::vector<int32_t> to_boundary; // characters until the word's boundary
+        for (size_t k = 0; k < chosen.size(); ++k) {
+            const std::string& word = words[chosen[k]].first;
+            size_t begin = text.size();
+            for (size_t i = 0; i < word.size(); ) {
+                size_t len = std::min(utf8_length(static_cast<unsigned char>(word[i])), word.size() - i);
+                text.push_back(char_ids[word.substr(i, len)]);
+                owner.push_back(static_cast<int32_t>(k));
+                i += len;
+            }
+            for (size_t p = begin; p < text.size(); ++p) to_boundary.push_back(static_cast<int32_t>(text.size() - p));
+            text.push_back(static_cast<int32_t>(k));
+            owner.push_back(-1);
+            to_boundary.push_back(0);
+        }
+        char_ids.clear();
+
+        const int32_t alphabet = boundaries + static_cast<int32_t>(char_text.size());
+        const std::vector<int32_t> sa = build_suffix_array(text, alphabet);
+        const std::vector<int32_t> lcp = build_lcp_array(text, sa);
+        const int32_t n = static_cast<int32_t>(text.size());
+
+        // Prefix sums of word counts in suffix-array order give interval frequencies.
+        std::vector<size_t> weight(n + 1, 0);
+        for (int32_t r = 0; r < n; ++r) {
+            int32_t w = owner[sa[r]];
+            weight[r + 1] = weight[r] + (w >= 0 ? words[chosen[w]].second : 0);
+        }
+
+        std::vector<Candidate> heap;
+        const int32_t max_chars = static_cast<int32_t>(std::min<size_t>(options.max_piece_chars, INT32_MAX));
+        auto offer = [&](int32_t pos, int32_t depth, int32_t parent_depth, size_t frequency) {
+            int32_t length = std::min(depth, max_chars);
+            if (length < 2 || length <= parent_depth || frequency < options.min_frequency) return;
+            Candidate c{ static_cast<uint64_t>(frequency) * static_cast<uint64_t>(length), frequency, pos, length };
+            if (heap.size() < options.max_pieces) {
+                heap.push_back(c);
+                std::push_heap(heap.begin(), heap.end(), better);
+            } else if (better(c, heap.front())) {
+                std::pop_heap(heap.begin(), heap.end(), better);
+                heap.back() = c;
+                std::push_heap(heap.begin(), heap.end(), better);
+            }
+        };
+
+        // Internal nodes: bottom-up walk over LCP intervals.
+        struct Interval {
+            int32_t depth;
+            int32_t lb;
+        };
+        std::vector<Interval> stack = { { 0, 0 } };
+        for (int32_t i = 1; i <= n; ++i) {
+            int32_t cur = i < n ? lcp[i] : 0;
+            int32_t lb = i - 1;
+            while (stack.back().depth > cur) {
+                Interval top = stack.back();
+                stack.pop_back();
+                int32_t parent = std::max(cur, stack.back().depth);
+                offer(sa[top.lb], top.depth, parent, weight[i] - weight[top.lb]);
+                lb = top.lb;
+            }
+            if (stack.back().depth < cur) stack.push_back(Interval{ cur, lb });
+        }
+
+        // Leaves: a suffix's own characters beyond what it shares with its neighbours.
+        for (int32_t r = 0; r < n; ++r) {
+            int32_t pos = sa[r];
+            if (owner[pos] < 0) continue;
+            int32_t shared = std::max(lcp[r], r + 1 < n ? lcp[r + 1] : 0);
+            offer(pos, to_boundary[pos], shared, words[chosen[owner[pos]]].second);
+        }
+
+        std::sort(heap.begin(), heap.end(), better);
+        std::vector<std::pair<std::string, size_t>> result;
+        result.reserve(heap.size());
+        for (const auto& c : heap) {
+            std::string piece;
+            for (int32_t k = 0; k < c.length; ++k) piece += char_text[text[c.pos + k] - boundaries];
+            result.emplace_back(std::move(piece), c.frequency);
+        }
+        return result;
+    }
+
+} // namespace auratokenizer
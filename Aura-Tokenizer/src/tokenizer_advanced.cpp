@@ -272,8 +272,8 @@ namespace auratokenizer {
                 // If we can replace vocab_, that's best.
                 vocab_ = new_vocab;
                 
-                // Also update model scores
-                // model_->set_scores(...) // TokenizerModel needs a setter for scores
+                // Piece scores travel with the vocab (Vocab::score), so the
+                // tokenizer picks them up in set_vocab() below.
             }
         } else {
             throw TokenizerException("Training is not supported for this algorithm.");
@@ -74,12 +74,19 @@ namespace auratokenizer {
         oss << "normalize_whitespace=" << (normalize_whitespace ? "true" : "false") << ", ";
         oss << "remove_control_chars=" << (remove_control_chars ? "true" : "false") << ", ";
         oss << "remove_diacritics=" << (remove_diacritics ? "true" : "false") << ", ";
+        oss << "clean_text=" << (clean_text ? "true" : "false") << ", ";
+        oss << "strip_accents_with_lowercase=" << (strip_accents_with_lowercase ? "true" : "false") << ", ";
+        oss << "use_precompiled_charsmap=" << (use_precompiled_charsmap ? "true" : "false") << ", ";
+        oss << "byte_level=" << (byte_level ? "true" : "false") << ", ";
+        oss << "byte_level_pattern=" << byte_level_pattern << ", ";
+        oss << "add_prefix_space=" << (add_prefix_space ? "true" : "false") << ", ";
         oss << "min_frequency=" << min_frequency << ", ";
         oss << "max_tokens=" << max_tokens << ", ";
         oss << "use_regex=" << (use_regex ? "true" : "false") << ", ";
         oss << "regex_pattern=\"" << regex_pattern << "\", ";
         oss << "max_length=" << max_length << ", ";
-        oss << "pad_to_max_length=" << (pad_to_max_length ? "true" : "false");
+        oss << "pad_to_max_length=" << (pad_to_max_length ? "true" : "false") << ", ";
+        oss << "encode_cache_bytes=" << encode_cache_bytes;
         oss << "}";
         return oss.str();
     }
@@ -145,6 +152,20 @@ namespace auratokenizer {
                 config.remove_control_chars = (value == "true");
             } else if (key == "remove_diacritics") {
                 config.remove_diacritics = (value == "true");
+            } else if (key == "clean_text") {
+                config.clean_text = (value == "true");
+            } else if (key == "strip_accents_with_lowercase") {
+                config.strip_accents_with_lowercase = (value == "true");
+            } else if (key == "use_precompiled_charsmap") {
+                config.use_precompiled_charsmap = (value == "true");
+            } else if (key == "byte_level") {
+                config.byte_level = (value == "true");
+            } else if (key == "byte_level_pattern") {
+                if (value == "CL100K") config.byte_level_pattern = ByteLevelPattern::CL100K;
+                else if (value == "LLAMA3") config.byte_level_pattern = ByteLevelPattern::LLAMA3;
+                else config.byte_level_pattern = ByteLevelPattern::GPT2;
+            } else if (key == "add_prefix_space") {
+                config.add_prefix_space = (value == "true");
             } else if (key == "min_frequency") {
                 config.min_frequency = std::stoul(value);
             } else if (key == "max_tokens") {
@@ -157,6 +178,8 @@ namespace auratokenizer {
                 config.max_length = std::stoi(value);
             } else if (key == "pad_to_max_length") {
                 config.pad_to_max_length = (value == "true");
+            } else if (key == "encode_cache_bytes") {
+                config.encode_cache_bytes = std::stoul(value);
             }
             
             pos = value_end + 1;
@@ -17,4 +17,18 @@ namespace auratokenizer {
         return config_;
     }
 
+    DecodeStream TokenizerBase::decode_stream(bool skip_special_tokens) const {
+        (void)skip_special_tokens;
+        throw TokenizerException("decode_stream is not supported by this tokenizer");
+    }
+
+    void TokenizerBase::encode_into(std::string_view text, EncodeBuffer& out) {
+        out.clear();
+        std::vector<Token> tokens = encode(std::string(text));
+        out.reserve(tokens.size());
+        for (const auto& token : tokens) {
+            out.push(token.id, token.offset.start, token.offset.end, token.is_special);
+        }
+    }
+
 } // namespace auratokenizer
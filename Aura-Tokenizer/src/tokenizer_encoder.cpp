@@ -17,7 +17,8 @@ namespace auratokenizer {
 
     Encoder::Encoder(const TokenizerConfig& config)
         : TokenizerBase(config),
-          config_(config)
+          config_(config),
+          normalizer_(config)
     {
         vocab_ = std::make_unique<Vocab>();
         initialize_special_tokens();
@@ -32,8 +33,7 @@ namespace auratokenizer {
 
         // Apply Unicode normalization if configured
         if (config_.normalization != NormalizationForm::NONE) {
-            UnicodeNormalizer normalizer(config_);
-            normalized = normalizer.normalize(txt);
+            normalized = normalizer_.normalize(txt);
         }
 
         // Apply lowercase if configured
@@ -74,48 +74,65 @@ namespace auratokenizer {
 
     // --- TokenizerBase Interface ---
     std::vector<Token> Encoder::encode(const std::string& text) {
-        std::vector<int> ids = encode_to_ids(text);
+        EncodeBuffer buffer;
+        encode_into(text, buffer);
         std::vector<Token> tokens;
-        tokens.reserve(ids.size());
-        size_t offset = 0;
-        for (int id : ids) {
-            std::string tok = vocab_->get_token(id);
-            tokens.emplace_back(id, tok, vocab_->is_special_token_id(id), OffsetMapping{static_cast<int>(offset), static_cast<int>(offset + tok.size())});
-            offset += tok.size();
+        tokens.reserve(buffer.size());
+        for (size_t i = 0; i < buffer.size(); ++i) {
+            const int id = buffer.ids[i];
+            tokens.emplace_back(id, vocab_->get_token(id), buffer.special[i] != 0, buffer.offsets[i]);
         }
         return tokens;
     }
 
     std::vector<int> Encoder::encode_to_ids(const std::string& text) {
-        // 1) Basic normalization & "pre‐tokenize" (whitespace split)
-        std::vector<std::string> words = pre_tokenize(text);
-        std::vector<int> ids;
-        ids.reserve(words.size() + 2); // +2 for optional BOS/EOS
+        EncodeBuffer buffer;
+        encode_into(text, buffer);
+        return std::move(buffer.ids);
+    }
+
+    void Encoder::encode_into(std::string_view text, EncodeBuffer& out) {
+        out.clear();
+
+        // 1) Unicode normalization, only when configured (lowercasing is applied per byte below)
+        std::string_view input = text;
+        const bool normalized = config_.normalization != NormalizationForm::NONE && !normalizer_.is_identity();
+        if (normalized) {
+            input = normalizer_.normalize_view(text, out.normalized);
+        }
+        out.reserve(input.size() + 2); // +2 for optional BOS/EOS
 
         // 2) Possibly add BOS
         if (config_.add_special_tokens && !config_.bos_token.empty()) {
-            ids.push_back(vocab_->get_token_id(config_.bos_token));
-        }
-
-        // 3) For each "word," break into subwords (in this simple version, char-level)
-        for (auto const& word : words) {
-            std::vector<std::string> subwords = word_tokenize(word);
-            for (auto const& sub : subwords) {
-                int id = vocab_->get_token_id(sub);
-                if (id == -1) {
-                    // Unknown → UNK
-                    id = vocab_->get_token_id(config_.unk_token);
-                }
-                ids.push_back(id);
+            out.push(vocab_->get_token_id(config_.bos_token), 0, 0, true);
+        }
+
+        // 3) Whitespace-separated words, split into single-byte subwords
+        const size_t first = out.size();
+        int unk_id = vocab_->get_token_id(config_.unk_token);
+        for (size_t i = 0; i < input.size(); ++i) {
+            char c = input[i];
+            if (std::isspace(static_cast<unsigned char>(c))) continue;
+            if (config_.lowercase) {
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+            int id = vocab_->find_token_id(std::string_view(&c, 1));
+            if (id == -1) {
+                // Unknown → UNK
+                id = unk_id;
             }
+            out.push(id, i, i + 1, id >= 0 && vocab_->is_special_token_id(id));
+        }
+
+        // Offsets into the normalized copy are mapped back to text
+        if (normalized) {
+            out.normalized.to_original(out.offsets, first);
         }
 
         // 4) Possibly add EOS
         if (config_.add_special_tokens && !config_.eos_token.empty()) {
-            ids.push_back(vocab_->get_token_id(config_.eos_token));
+            out.push(vocab_->get_token_id(config_.eos_token), text.size(), text.size(), true);
         }
-
-        return ids;
     }
 
     /* ------------------------- Core Decode / Decode_from_ids ------------------------- */
@@ -202,6 +219,7 @@ namespace auratokenizer {
         std::string config_str(config_len, '\0');
         file.read(&config_str[0], config_len);
         config_ = TokenizerConfig::from_string(config_str);
+        normalizer_.set_config(config_);
 
         // Load vocabulary
         vocab_->load(file);
@@ -308,6 +326,7 @@ namespace auratokenizer {
 
     void Encoder::set_config(const TokenizerConfig& config) {
         config_ = config;
+        normalizer_.set_config(config_);
     }
 
     void Encoder::set_vocab(std::shared_ptr<Vocab> vocab) {
@@ -99,6 +99,10 @@ void TokenizerJsonParser::parse_pre_tokenizer(const nlohmann::json& json_pre_tok
     if (json_pre_tokenizer.contains("type")) {
         std::string type = json_pre_tokenizer["type"].get<std::string>();
         if (type == "ByteLevel") {
+            config.byte_level = true;
+            if (json_pre_tokenizer.contains("add_prefix_space")) {
+                config.add_prefix_space = json_pre_tokenizer["add_prefix_space"].get<bool>();
+            }
             pre_tokenizer = std::make_shared<auratokenizer::ByteLevelPreTokenizer>(config);
         } else if (type == "Whitespace") {
             // Assuming Whitespace pre-tokenizer is a RegexPreTokenizer with a specific pattern
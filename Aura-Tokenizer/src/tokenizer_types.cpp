@@ -80,4 +80,14 @@ namespace auratokenizer {
         }
         return os;
     }
+
+    std::ostream& operator<<(std::ostream& os, const ByteLevelPattern& val) {
+        switch (val) {
+        case ByteLevelPattern::GPT2:   os << "GPT2"; break;
+        case ByteLevelPattern::CL100K: os << "CL100K"; break;
+        case ByteLevelPattern::LLAMA3: os << "LLAMA3"; break;
+        default: os << "Unknown"; break;
+        }
+        return os;
+    }
 }
\ No newline at end of file
@@ -2,10 +2,12 @@
 
 #include "trie.h"
 #include "tokenizer_core.h"
+#include "corpus_reader.h"
 #include <queue>
 #include <cstring>
 #include <stdexcept>
 #include <algorithm>
+#include <limits>
 
 namespace auratokenizer {
 
@@ -163,4 +165,212 @@ namespace auratokenizer {
         return node;
     }
 
+    // --- FrozenTrie ---
+
+    namespace {
+
+        constexpr char kFrozenMagic[8] = { 'A', 'U', 'R', 'A', 'T', 'R', 'I', 'E' };
+        constexpr uint32_t kByteOrderTag = 0x01020304u;
+        constexpr uint32_t kFrozenVersion = 1;
+        constexpr size_t kRootTableSize = 256;
+
+        struct FrozenHeader {
+            char     magic[8];
+            uint32_t byte_order;   // kByteOrderTag in the writer's byte order
+            uint32_t version;
+            uint64_t node_count;
+            uint64_t token_count;
+        };
+
+        static_assert(sizeof(FrozenHeader) == 32, "FrozenHeader layout is part of the blob format");
+
+    } // namespace
+
+    FrozenTrie::FrozenTrie() : size_(0) {
+        root_children_.assign(kRootTableSize, NO_NODE);
+        nodes_.push_back(Node{ 0, 0, -1 });
+    }
+
+    void FrozenTrie::build(const Trie& trie) {
+        std::vector<uint32_t> root_children(kRootTableSize, NO_NODE);
+        std::vector<Node> nodes;
+        std::vector<uint8_t> labels;
+        std::vector<const Trie::Node*> order;  // source node of each frozen node
+
+        nodes.push_back(Node{ 0, 0, trie.root_->token_id });
+        labels.push_back(0);
+        order.push_back(trie.root_.get());
+
+        // Breadth first: the children of node i are appended as one run when i is visited.
+        std::vector<std::pair<uint8_t, const Trie::Node*>> children;
+        for (size_t i = 0; i < order.size(); ++i) {
+            children.clear();
+            for (const auto& [c, child] : order[i]->children) {
+                children.emplace_back(static_cast<uint8_t>(c), child.get());
+            }
+            std::sort(children.begin(), children.end(),
+                [](const auto& a, const auto& b) { return a.first < b.first; });
+
+            if (order.size() + children.size() > std::numeric_limits<uint32_t>::max()) {
+                throw TokenizerException("FrozenTrie: too many nodes");
+            }
+            nodes[i].first_child = static_cast<uint32_t>(order.size());
+            nodes[i].child_count = static_cast<uint32_t>(children.size());
+            for (const auto& [c, child] : children) {
+                if (i == ROOT_NODE) root_children[c] = static_cast<uint32_t>(order.size());
+                nodes.push_back(Node{ 0, 0, child->token_id });
+                labels.push_back(c);
+                order.push_back(child);
+            }
+        }
+
+        root_children_.adopt(std::move(root_children));
+        nodes_.adopt(std::move(nodes));
+        labels_.adopt(std::move(labels));
+        size_ = trie.size_;
+        mapping_.reset();
+    }
+
+    int FrozenTrie::get_id(std::string_view token_text) const {
+        uint32_t node = ROOT_NODE;
+        for (char c : token_text) {
+            node = child(node, static_cast<unsigned char>(c));
+            if (node == NO_NODE) return -1;
+        }
+        return nodes_[node].token_id;
+    }
+
+    std::pair<int, int> FrozenTrie::longest_prefix(const std::string& text, size_t start_pos) const {
+        std::pair<int, int> best{ -1, 0 };
+        if (start_pos >= text.size()) return best;
+        for_each_prefix(std::string_view(text).substr(start_pos), [&](int id, int length) {
+            best = { id, length };
+        });
+        return best;
+    }
+
+    std::vector<std::pair<int, int>> FrozenTrie::all_prefixes(const std::string& text, size_t start_pos) const {
+        std::vector<std::pair<int, int>> matches;
+        if (start_pos >= text.size()) return matches;
+        for_each_prefix(std::string_view(text).substr(start_pos), [&](int id, int length) {
+            matches.emplace_back(id, length);
+        });
+        return matches;
+    }
+
+    std::vector<char> FrozenTrie::serialize() const {
+        FrozenHeader header{};
+        std::memcpy(header.magic, kFrozenMagic, sizeof(kFrozenMagic));
+        header.byte_order = kByteOrderTag;
+        header.version = kFrozenVersion;
+        header.node_count = nodes_.size();
+        header.token_count = size_;
+
+        const size_t root_bytes = kRootTableSize * sizeof(uint32_t);
+        const size_t node_bytes = nodes_.size() * sizeof(Node);
+        std::vector<char> blob(sizeof(header) + root_bytes + node_bytes + labels_.size());
+        char* out = blob.data();
+        std::memcpy(out, &header, sizeof(header));
+        out += sizeof(header);
+        std::memcpy(out, root_children_.data(), root_bytes);
+        out += root_bytes;
+        std::memcpy(out, nodes_.data(), node_bytes);
+        out += node_bytes;
+        std::memcpy(out, labels_.data(), labels_.size());
+        return blob;
+    }
+
+    void FrozenTrie::deserialize(const std::vector<char>& data) {
+        deserialize(data.data(), data.size());
+    }
+
+    void FrozenTrie::deserialize(const char* data, size_t size) {
+        read_blob(data, size, true);
+    }
+
+    void FrozenTrie::view(const char* data, size_t size) {
+        read_blob(data, size, false);
+    }
+
+    void FrozenTrie::map_file(const std::string& path) {
+        auto file = std::make_shared<const MappedFile>(path);
+        read_blob(file->view().data(), file->size(), false);
+        mapping_ = std::move(file);
+    }
+
+    void FrozenTrie::read_blob(const char* data, size_t size, bool copy) {
+        FrozenHeader header;
+        if (size < sizeof(header)) throw TokenizerException("FrozenTrie: truncated blob");
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, kFrozenMagic, sizeof(kFrozenMagic)) != 0) {
+            throw TokenizerException("FrozenTrie: not a frozen trie blob");
+        }
+        if (header.byte_order != kByteOrderTag || header.version != kFrozenVersion) {
+            throw TokenizerException("FrozenTrie: unsupported blob version or byte order");
+        }
+        if (header.node_count == 0 || header.node_count > std::numeric_limits<uint32_t>::max()) {
+            throw TokenizerException("FrozenTrie: corrupt blob header");
+        }
+        const size_t root_bytes = kRootTableSize * sizeof(uint32_t);
+        const uint64_t node_bytes = header.node_count * sizeof(Node);
+        if (sizeof(header) + root_bytes + node_bytes + header.node_count > size) {
+            throw TokenizerException("FrozenTrie: truncated blob");
+        }
+
+        const char* root_data = data + sizeof(header);
+        const char* node_data = root_data + root_bytes;
+        const char* label_data = node_data + node_bytes;
+        const size_t count = static_cast<size_t>(header.node_count);
+        FrozenTrie loaded;
+        if (copy) {
+            std::vector<uint32_t> root_children(kRootTableSize);
+            std::memcpy(root_children.data(), root_data, root_bytes);
+            std::vector<Node> nodes(count);
+            std::memcpy(nodes.data(), node_data, static_cast<size_t>(node_bytes));
+            loaded.root_children_.adopt(std::move(root_children));
+            loaded.nodes_.adopt(std::move(nodes));
+            loaded.labels_.adopt(std::vector<uint8_t>(label_data, label_data + count));
+        } else {
+            if (reinterpret_cast<uintptr_t>(data) % alignof(Node) != 0) {
+                throw TokenizerException("FrozenTrie: misaligned blob");
+            }
+            loaded.root_children_.view(reinterpret_cast<const uint32_t*>(root_data), kRootTableSize);
+            loaded.nodes_.view(reinterpret_cast<const Node*>(node_data), count);
+            loaded.labels_.view(reinterpret_cast<const uint8_t*>(label_data), count);
+        }
+        loaded.size_ = static_cast<size_t>(header.token_count);
+        if (copy) loaded.validate();
+        *this = std::move(loaded);
+    }
+
+    void FrozenTrie::validate() const {
+        const size_t n = nodes_.size();
+        // Breadth-first order: each node's children follow it and every node but the root is claimed once.
+        size_t next_child = 1;
+        for (size_t i = 0; i < n; ++i) {
+            const Node& node = nodes_[i];
+            if (node.first_child != next_child && node.child_count != 0) {
+                throw TokenizerException("FrozenTrie: child ranges out of order");
+            }
+            if (node.child_count > kRootTableSize || n - next_child < node.child_count) {
+                throw TokenizerException("FrozenTrie: child range out of bounds");
+            }
+            for (uint32_t k = 1; k < node.child_count; ++k) {
+                if (labels_[node.first_child + k - 1] >= labels_[node.first_child + k]) {
+                    throw TokenizerException("FrozenTrie: unsorted child labels");
+                }
+            }
+            next_child += node.child_count;
+        }
+        if (next_child != n) throw TokenizerException("FrozenTrie: unreachable nodes");
+        const Node& root = nodes_[ROOT_NODE];
+        for (size_t c = 0; c < kRootTableSize; ++c) {
+            uint32_t target = root_children_[c];
+            if (target == NO_NODE) continue;
+            if (target < root.first_child || target - root.first_child >= root.child_count || labels_[target] != c) {
+                throw TokenizerException("FrozenTrie: root table disagrees with the root's children");
+            }
+        }
+    }
+
 } // namespace auratokenizer
@@ -1,5 +1,9 @@
 #include "unicode_normalizer.h"
 #include "icu_utils.h"  // for ICUUtils::normalize, strip_accents, to_lower
+#include "ascii_scan.h"
+#include "utf8_scan.h"
+#include <unicode/uchar.h>
+#include <unicode/utf8.h>
 #include <thread>
 #include <future>
 #include <algorithm>
@@ -7,6 +11,194 @@
 
 namespace auratokenizer {
 
+    namespace {
+
+        constexpr char kReplacementChar[] = "\xEF\xBF\xBD";  // U+FFFD
+
+        bool is_ascii_control(unsigned char c) {
+            return c < 0x20 || c == 0x7F;
+        }
+
+        bool is_control(UChar32 c) {
+            int8_t type = u_charType(c);
+            return type == U_CONTROL_CHAR || type == U_FORMAT_CHAR;
+        }
+
+        // Copy text to out, replacing ill-formed sequences with U+FFFD and
+        // applying the whitespace and control-character cleanup. record, if
+        // given, receives what happened to each character.
+        void clean_utf8(std::string_view text, bool whitespace, bool controls, std::string& out,
+                        NormalizedString::Step* record = nullptr) {
+            out.clear();
+            out.reserve(text.size());
+            const uint8_t* s = reinterpret_cast<const uint8_t*>(text.data());
+            const int32_t n = static_cast<int32_t>(text.size());
+            int32_t i = 0;
+            while (i < n) {
+                if (s[i] < 0x80) {
+                    if (!whitespace && !controls) {
+                        size_t run = ascii_prefix_length(text.data() + i, text.size() - i);
+                        out.append(text.data() + i, run);
+                        if (record) record->keep(run);
+                        i += static_cast<int32_t>(run);
+                        continue;
+                    }
+                    const unsigned char c = s[i++];
+                    if (whitespace && is_ascii_space(c)) out.push_back(' ');
+                    else if (!(controls && is_ascii_control(c))) out.push_back(static_cast<char>(c));
+                    else if (record) {
+                        record->change(1, 0);
+                        continue;
+                    }
+                    if (record) record->keep(1);
+                    continue;
+                }
+                const int32_t begin = i;
+                UChar32 c;
+                U8_NEXT(s, i, n, c);
+                const size_t length = static_cast<size_t>(i - begin);
+                if (c < 0) {
+                    out.append(kReplacementChar, 3);
+                    if (record) record->change(length, 3);
+                } else if (whitespace && u_isUWhiteSpace(c)) {
+                    out.push_back(' ');
+                    if (record) record->change(length, 1);
+                } else if (!(controls && is_control(c))) {
+                    out.append(text.data() + begin, length);
+                    if (record) record->keep(length);
+                } else if (record) {
+                    record->change(length, 0);
+                }
+            }
+        }
+
+        // Drop nonspacing marks (general category Mn) from well-formed UTF-8.
+        void drop_marks_utf8(std::string_view text, std::string& out, NormalizedString::Step* record = nullptr) {
+            out.clear();
+            out.reserve(text.size());
+            const uint8_t* s = reinterpret_cast<const uint8_t*>(text.data());
+            const int32_t n = static_cast<int32_t>(text.size());
+            int32_t i = 0;
+            while (i < n) {
+                const int32_t begin = i;
+                UChar32 c;
+                U8_NEXT(s, i, n, c);
+                const size_t length = static_cast<size_t>(i - begin);
+                if (c < 0 || u_charType(c) != U_NON_SPACING_MARK) {
+                    out.append(text.data() + begin, length);
+                    if (record) record->keep(length);
+                } else if (record) {
+                    record->change(length, 0);
+                }
+            }
+        }
+
+        // UTF-16 text for the accent-stripping transliterator that remembers,
+        // for every code unit, the input bytes it came from. A replacement of
+        // equal length keeps the units' origins; any other gives every new unit
+        // the whole range it replaced, and an insertion that of its neighbour.
+        class TrackedText : public icu::Replaceable {
+        public:
+            explicit TrackedText(std::string_view utf8) {
+                const uint8_t* s = reinterpret_cast<const uint8_t*>(utf8.data());
+                const int32_t n = static_cast<int32_t>(utf8.size());
+                origins_.reserve(utf8.size());
+                for (int32_t i = 0; i < n;) {
+                    const int32_t begin = i;
+                    UChar32 c;
+                    U8_NEXT(s, i, n, c);
+                    if (c < 0) c = 0xFFFD;
+                    text_.append(c);
+                    origins_.insert(origins_.end(), U16_LENGTH(c), Origin{ static_cast<uint32_t>(begin), static_cast<uint32_t>(i) });
+                }
+            }
+
+            void extractBetween(int32_t start, int32_t limit, icu::UnicodeString& target) const override {
+                text_.extractBetween(start, limit, target);
+            }
+
+            void handleReplaceBetween(int32_t start, int32_t limit, const icu::UnicodeString& text) override {
+                if (text.length() != limit - start) {
+                    Origin origin;
+                    if (limit > start) {
+                        origin = origins_[start];
+                        for (int32_t k = start + 1; k < limit; ++k) {
+                            origin.begin = std::min(origin.begin, origins_[k].begin);
+                            origin.end = std::max(origin.end, origins_[k].end);
+                        }
+                    } else if (start < static_cast<int32_t>(origins_.size())) {
+                        origin = origins_[start];  // inserted text belongs to the character it precedes
+                    } else {
+                        origin = start > 0 ? origins_[start - 1] : Origin{ 0, 0 };
+                    }
+                    origins_.erase(origins_.begin() + start, origins_.begin() + limit);
+                    origins_.insert(origins_.begin() + start, static_cast<size_t>(text.length()), origin);
+                }
+                text_.handleReplaceBetween(start, limit, text);
+            }
+
+            void copy(int32_t start, int32_t limit, int32_t dest) override {
+                const std::vector<Origin> copied(origins_.begin() + start, origins_.begin() + limit);
+                origins_.insert(origins_.begin() + dest, copied.begin(), copied.end());
+                text_.copy(start, limit, dest);
+            }
+
+            // Write the text as UTF-8 and record, group by group of units
+            // with the same origin, how the input_size input bytes became it.
+            void to_utf8(size_t input_size, std::string& out, NormalizedString::Step& record) const {
+                size_t consumed = 0;
+                size_t group_out = 0;
+                Origin group{ 0, 0 };
+                bool open = false;
+                auto flush = [&]() {
+                    if (!open) return;
+                    // Units moved backwards by a transliteration rule stay with the earlier group.
+                    const size_t begin = std::max<size_t>(group.begin, consumed);
+                    const size_t end = std::max<size_t>(group.end, begin);
+                    if (begin > consumed) record.change(begin - consumed, 0);
+                    record.change(end - begin, out.size() - group_out);
+                    consumed = end;
+                };
+                for (int32_t i = 0; i < text_.length();) {
+                    const UChar32 c = text_.char32At(i);
+                    const Origin& origin = origins_[i];
+                    if (!open || origin.begin != group.begin || origin.end != group.end) {
+                        flush();
+                        group = origin;
+                        group_out = out.size();
+                        open = true;
+                    }
+                    char bytes[U8_MAX_LENGTH];
+                    int32_t length = 0;
+                    UBool error = false;
+                    U8_APPEND(reinterpret_cast<uint8_t*>(bytes), length, U8_MAX_LENGTH, c, error);
+                    // A lone surrogate becomes U+FFFD, as in UnicodeString::toUTF8String().
+                    if (error) out.append(kReplacementChar, 3);
+                    else out.append(bytes, static_cast<size_t>(length));
+                    i += U16_LENGTH(c);
+                }
+                flush();
+                if (consumed < input_size) record.change(input_size - consumed, 0);
+            }
+
+            Replaceable* clone() const override { return new TrackedText(*this); }
+
+        protected:
+            int32_t getLength() const override { return text_.length(); }
+            char16_t getCharAt(int32_t offset) const override { return text_.charAt(offset); }
+            UChar32 getChar32At(int32_t offset) const override { return text_.char32At(offset); }
+
+        private:
+            struct Origin {
+                uint32_t begin;
+                uint32_t end;
+            };
+            icu::UnicodeString text_;
+            std::vector<Origin> origins_;
+        };
+
+    } // namespace
+
     ////////////////////////////////////////////////////////////////////////////////
     // Constructor
     ////////////////////////////////////////////////////////////////////////////////
@@ -18,27 +210,180 @@ namespace auratokenizer {
     ////////////////////////////////////////////////////////////////////////////////
 
     std::string UnicodeNormalizer::normalize(const std::string& text) const {
-        if (text.empty()) return std::string();
+        std::string out;
+        normalize_into(text, out);
+        return out;
+    }
+
+    void UnicodeNormalizer::normalize_into(std::string_view text, std::string& out) const {
+        apply_steps(text, out, nullptr);
+    }
+
+    void UnicodeNormalizer::normalize(NormalizedString& text) const {
+        thread_local std::string unused;
+        apply_steps(text.get(), unused, &text);
+    }
+
+    std::string_view UnicodeNormalizer::normalize_view(std::string_view text, NormalizedString& scratch) const {
+        if (is_identity()) return text;
+        scratch.reset(text);
+        normalize(scratch);
+        return scratch.get();
+    }
 
-        // 1) Unicode normalization via ICUUtils
-        std::string out = icu_utils::ICUUtils::normalize(text, config_.normalization);
+    void UnicodeNormalizer::apply_steps(std::string_view text, std::string& out, NormalizedString* aligned) const {
+        using icu_utils::ICUUtils;
+        const bool whitespace = config_.normalize_whitespace;
+        const bool controls = config_.remove_control_chars;
+        const bool lowercase = config_.lowercase;
 
-        // 2) Custom transformations
-        for (auto& fn : custom_transformations_) {
-            out = fn(out);
+        // Each step reads cur and writes target(), then commit() makes that
+        // the new cur. Without alignment the two buffers take turns; with it
+        // every step is folded into aligned, whose text cur then views.
+        // text may view out, so out is only written at the end.
+        thread_local std::string buffers[2];
+        thread_local NormalizedString::Step step;
+        thread_local icu::Edits edits;
+        NormalizedString::Step* record = aligned ? &step : nullptr;
+        icu::Edits* icu_edits = aligned ? &edits : nullptr;
+        std::string_view cur = text;
+        int filled = -1;  // the buffer cur views, if any
+        step.clear();
+        auto target = [&]() -> std::string& { return buffers[filled == 0 ? 1 : 0]; };
+        auto commit = [&]() {
+            std::string& produced = target();
+            if (aligned) {
+                aligned->update(produced, step);
+                step.clear();
+                cur = aligned->get();
+            } else {
+                filled = &produced == &buffers[0] ? 0 : 1;
+                cur = produced;
+            }
+        };
+        auto record_edits = [&]() {
+            if (!record || !edits.hasChanges()) return;
+            UErrorCode status = U_ZERO_ERROR;
+            for (icu::Edits::Iterator it = edits.getFineIterator(); it.next(status);) {
+                if (it.hasChange()) record->change(static_cast<size_t>(it.oldLength()), static_cast<size_t>(it.newLength()));
+                else record->keep(static_cast<size_t>(it.oldLength()));
+            }
+        };
+        auto finish = [&]() {
+            if (aligned) return;
+            if (filled >= 0) std::swap(out, buffers[filled]);  // out's old buffer becomes this thread's scratch
+            else out.assign(cur.data(), cur.size());
+        };
+
+        // ASCII is unchanged by every normalization form, accent stripping and
+        // diacritic removal, so cleanup and lowercasing are one byte loop.
+        if (custom_transformations_.empty() && is_ascii(cur)) {
+            std::string& next = target();
+            next.clear();
+            next.reserve(cur.size());
+            size_t kept = 0;
+            for (unsigned char c : cur) {
+                if (whitespace && is_ascii_space(c)) c = ' ';
+                else if (controls && is_ascii_control(c)) {
+                    if (record) {
+                        record->keep(kept);
+                        record->change(1, 0);
+                        kept = 0;
+                    }
+                    continue;
+                }
+                else if (lowercase && c >= 'A' && c <= 'Z') c = static_cast<unsigned char>(c + ('a' - 'A'));
+                next.push_back(static_cast<char>(c));
+                ++kept;
+            }
+            commit();
+            finish();
+            return;
         }
 
-        // 3) Strip accents if requested
-        if (config_.strip_accents) {
-            out = icu_utils::ICUUtils::strip_accents(out);
+        // 1) Cleanup; any ICU step also needs well-formed input.
+        const bool icu_steps = config_.normalization != NormalizationForm::NONE || config_.strip_accents
+            || config_.remove_diacritics || lowercase;
+        if (whitespace || controls || (icu_steps && !ICUUtils::is_valid_utf8(cur))) {
+            clean_utf8(cur, whitespace, controls, target(), record);
+            commit();
         }
 
-        // 4) Lowercase if requested
-        if (config_.lowercase) {
-            out = icu_utils::ICUUtils::to_lower(out);
+        // 2) Unicode normalization, UTF-8 to UTF-8
+        if (config_.normalization != NormalizationForm::NONE) {
+            ICUUtils::normalize_utf8(cur, config_.normalization, target(), icu_edits);
+            record_edits();
+            commit();
         }
 
-        return out;
+        // 3) Custom transformations; opaque, so a changed text aligns as a whole.
+        // Their output is made well-formed again.
+        if (!custom_transformations_.empty()) {
+            for (auto& fn : custom_transformations_) {
+                target() = fn(filled >= 0 ? buffers[filled] : std::string(cur));
+                if (record && target() != cur) record->change(cur.size(), target().size());
+                commit();
+            }
+            if (icu_steps) {
+                clean_utf8(cur, false, false, target(), record);
+                commit();
+            }
+        }
+
+        // 4) Strip accents: the transliterator is the one step that needs UTF-16
+        if (config_.strip_accents && !is_ascii(cur)) {
+            std::string& next = target();
+            next.clear();
+            if (record) {
+                TrackedText tracked(cur);
+                ICUUtils::strip_accents(tracked);
+                tracked.to_utf8(cur.size(), next, *record);
+            } else {
+                icu::UnicodeString ustr = icu::UnicodeString::fromUTF8(icu::StringPiece(cur.data(), static_cast<int32_t>(cur.size())));
+                ICUUtils::strip_accents(ustr);
+                ustr.toUTF8String(next);
+            }
+            commit();
+        }
+
+        // 5) Remove diacritics: decompose, drop marks, recompose unless a decomposed form was asked for
+        if (config_.remove_diacritics && !is_ascii(cur)) {
+            ICUUtils::normalize_utf8(cur, NormalizationForm::NFD, target(), icu_edits);
+            record_edits();
+            commit();
+            drop_marks_utf8(cur, target(), record);
+            commit();
+            if (config_.normalization != NormalizationForm::NFD && config_.normalization != NormalizationForm::NFKD) {
+                ICUUtils::normalize_utf8(cur, NormalizationForm::NFC, target(), icu_edits);
+                record_edits();
+                commit();
+            }
+        }
+
+        // 6) Lowercase, UTF-8 to UTF-8
+        if (lowercase) {
+            ICUUtils::to_lower_utf8(cur, target(), icu_edits);
+            record_edits();
+            commit();
+        }
+
+        finish();
+    }
+
+    bool UnicodeNormalizer::is_identity() const {
+        return config_.normalization == NormalizationForm::NONE &&
+               custom_transformations_.empty() &&
+               !config_.normalize_whitespace &&
+               !config_.remove_control_chars &&
+               !config_.strip_accents &&
+               !config_.remove_diacritics &&
+               !config_.lowercase;
+    }
+
+    std::string_view UnicodeNormalizer::normalize_view(std::string_view text, std::string& scratch) const {
+        if (is_identity()) return text;
+        normalize_into(text, scratch);
+        return scratch;
     }
 
     ////////////////////////////////////////////////////////////////////////////////
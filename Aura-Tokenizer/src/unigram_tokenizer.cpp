@@ -1,6 +1,10 @@
 #include "unigram_tokenizer.h"
 #include "tokenizer_exception.h"
+#include "serialization_utils.h"
+#include "utf8_scan.h"
 #include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <limits>
 
 namespace auratokenizer {
@@ -11,6 +15,8 @@ UnigramTokenizer::UnigramTokenizer(const TokenizerConfig& config)
       vocab_(std::make_shared<Vocab>())
 {
     initialize_special_tokens();
+    ensure_charsmap();
+    rebuild_lattice_index();
 }
 
 UnigramTokenizer::~UnigramTokenizer() = default;
@@ -52,55 +58,77 @@ void UnigramTokenizer::initialize_special_tokens() {
     }
 }
 
-std::vector<std::string> UnigramTokenizer::pre_tokenize(const std::string& text) const {
-    // For Unigram, typically pre-tokenize by characters or simple whitespace
-    // For now, a simple character-level pre-tokenization
-    std::vector<std::string> result;
-    for (char c : text) {
-        result.push_back(std::string(1, c));
-    }
-    return result;
-}
-
 std::vector<Token> UnigramTokenizer::encode(const std::string& text) {
-    std::string normalized_text = normalizer_.normalize(text);
-    std::vector<std::string> segments = viterbi_segment(normalized_text);
+    NormalizedString normalized;
+    const std::string_view input = normalize_view(text, normalized);
+
+    std::vector<Piece> pieces;
+    viterbi(input, pieces);
+
+    // Token text is the normalized piece; its offset is into text.
+    std::vector<OffsetMapping> offsets;
+    offsets.reserve(pieces.size());
+    for (const auto& piece : pieces) {
+        offsets.push_back(OffsetMapping{ static_cast<int>(piece.begin), static_cast<int>(piece.end) });
+    }
+    if (normalizes()) normalized.to_original(offsets);
 
     std::vector<Token> tokens;
-    for (const auto& segment : segments) {
-        int id = vocab_->get_token_id(segment);
-        tokens.emplace_back(id, segment, vocab_->is_special_token(segment));
+    tokens.reserve(pieces.size());
+    for (size_t i = 0; i < pieces.size(); ++i) {
+        const Piece& piece = pieces[i];
+        tokens.emplace_back(piece.id, std::string(input.substr(piece.begin, piece.end - piece.begin)), false, offsets[i]);
     }
     return tokens;
 }
 
 std::vector<int> UnigramTokenizer::encode_to_ids(const std::string& text) {
-    std::string normalized_text = normalizer_.normalize(text);
-    std::vector<std::string> segments = viterbi_segment(normalized_text);
+    EncodeBuffer buffer;
+    encode_into(text, buffer);
+    return std::move(buffer.ids);
+}
 
-    std::vector<int> ids;
-    for (const auto& segment : segments) {
-        ids.push_back(vocab_->get_token_id(segment));
+void UnigramTokenizer::encode_into(std::string_view text, EncodeBuffer& out) {
+    out.clear();
+    std::string_view input = normalize_view(text, out.normalized);
+
+    thread_local std::vector<Piece> pieces;
+    viterbi(input, pieces);
+    for (const auto& piece : pieces) {
+        out.push(piece.id, piece.begin, piece.end, false);
     }
-    return ids;
+    if (normalizes()) out.normalized.to_original(out.offsets);
 }
 
 std::string UnigramTokenizer::decode(const std::vector<Token>& tokens) {
     std::string decoded_text;
     for (const auto& token : tokens) {
-        decoded_text += token.text;
+        // encode() already spells byte-fallback tokens as their byte; a token
+        // rebuilt from its id still carries the "<0xXX>" piece.
+        if ((vocab_->flags(token.id) & Vocab::BYTE_FALLBACK) && token.text == vocab_->get_token_view(token.id)) {
+            decoded_text.push_back(static_cast<char>(Vocab::byte_value(token.text)));
+        } else {
+            decoded_text += token.text;
+        }
     }
     return decoded_text;
 }
 
 std::string UnigramTokenizer::decode_from_ids(const std::vector<int>& ids) {
+    // Share the byte-fallback rule with the streaming decoder.
+    DecodeStream stream = decode_stream();
     std::string decoded_text;
     for (int id : ids) {
-        decoded_text += vocab_->get_token(id);
+        stream.step(id, decoded_text);
     }
+    stream.flush(decoded_text);
     return decoded_text;
 }
 
+DecodeStream UnigramTokenizer::decode_stream(bool skip_special_tokens) const {
+    return DecodeStream(vocab_, DecodeStream::Mode::RAW, skip_special_tokens);
+}
+
 std::vector<std::vector<int>> UnigramTokenizer::batch_encode(const std::vector<std::string>& texts) {
     std::vector<std::vector<int>> batch_ids;
     batch_ids.reserve(texts.size());
@@ -120,11 +148,33 @@ std::vector<std::string> UnigramTokenizer::batch_decode(const std::vector<std::v
 }
 
 void UnigramTokenizer::save(const std::string& path) {
-    throw TokenizerException("UnigramTokenizer::save not implemented yet.");
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs) { throw TokenizerException("Failed to open file for writing: " + path); }
+    config_.save(ofs);
+    vocab_->save(ofs);
+
+    // The charsmap carries the normalization settings; empty when not in use.
+    std::vector<char> charsmap;
+    if (config_.use_precompiled_charsmap) charsmap = charsmap_.serialize();
+    write_vector(ofs, charsmap);
 }
 
 void UnigramTokenizer::load(const std::string& path) {
-    throw TokenizerException("UnigramTokenizer::load not implemented yet.");
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) { throw TokenizerException("Failed to open file for reading: " + path); }
+
+    config_.load(ifs);
+    vocab_->load(ifs);
+
+    std::vector<char> charsmap;
+    read_vector(ifs, charsmap);
+    if (!ifs) { throw TokenizerException("UnigramTokenizer: truncated model file: " + path); }
+    if (!charsmap.empty()) {
+        charsmap_.deserialize(charsmap);
+        charsmap_.apply_settings(config_);
+        config_.use_precompiled_charsmap = true;
+    }
+    set_config(config_);
 }
 
 void UnigramTokenizer::train(const std::vector<std::string>& corpus, size_t vocab_size) {
@@ -135,6 +185,7 @@ void UnigramTokenizer::add_special_tokens(const std::vector<std::string>& tokens
     for (const auto& token : tokens) {
         vocab_->add_special_token(token, SpecialTokenType::CUSTOM);
     }
+    rebuild_lattice_index();
 }
 
 std::vector<std::string> UnigramTokenizer::get_special_tokens() const {
@@ -165,51 +216,124 @@ void UnigramTokenizer::set_config(const TokenizerConfig& config) {
     config_ = config;
     normalizer_.set_config(config_);
     initialize_special_tokens();
+    ensure_charsmap();
+    rebuild_lattice_index();
+}
+
+void UnigramTokenizer::ensure_charsmap() {
+    if (!config_.use_precompiled_charsmap) return;
+    if (charsmap_.empty() || !charsmap_.matches(config_)) charsmap_.build(config_);
+}
+
+bool UnigramTokenizer::normalizes() const {
+    return config_.use_precompiled_charsmap || !normalizer_.is_identity();
+}
+
+std::string_view UnigramTokenizer::normalize_view(std::string_view text, NormalizedString& scratch) const {
+    if (!config_.use_precompiled_charsmap) return normalizer_.normalize_view(text, scratch);
+    return charsmap_.normalize_view(text, scratch);
 }
 
 void UnigramTokenizer::set_vocab(std::shared_ptr<Vocab> vocab) {
     vocab_ = vocab;
     initialize_special_tokens();
+    rebuild_lattice_index();
 }
 
 void UnigramTokenizer::set_vocab_and_scores(std::shared_ptr<Vocab> vocab, const std::unordered_map<std::string, float>& scores) {
     vocab_ = vocab;
-    scores_ = scores;
+    for (const auto& [token, score] : scores) vocab_->set_score(vocab_->get_token_id(token), score);
+    rebuild_lattice_index();
 }
 
-std::vector<std::string> UnigramTokenizer::viterbi_segment(const std::string& text) const {
-    // This is a simplified Viterbi algorithm for demonstration.
-    // A full implementation would be more complex, involving dynamic programming
-    // to find the best segmentation based on token scores.
+void UnigramTokenizer::rebuild_lattice_index() {
+    float min_score = std::numeric_limits<float>::max();
+    int max_id = -1;
+    vocab_->for_each_token([&](std::string_view, int id) {
+        max_id = std::max(max_id, id);
+        if (vocab_->has_score(id)) min_score = std::min(min_score, vocab_->score(id));
+    });
+    // Without scores every piece costs the same, so Viterbi picks the fewest pieces.
+    const float default_score = min_score == std::numeric_limits<float>::max() ? -1.0f : min_score;
+    unk_score_ = default_score - UNK_PENALTY;
+
+    std::vector<std::pair<std::string, int32_t>> pieces;
+    pieces.reserve(vocab_->size());
+    piece_scores_.assign(static_cast<size_t>(max_id + 1), default_score);
+    vocab_->for_each_token([&](std::string_view token, int id) {
+        // Control symbols, unused ids and "<0xXX>" byte pieces never match text.
+        if (vocab_->flags(id) & (Vocab::SPECIAL | Vocab::UNUSED | Vocab::BYTE_FALLBACK)) return;
+        pieces.emplace_back(token, id);
+        if (vocab_->has_score(id)) piece_scores_[id] = vocab_->score(id);
+    });
+    piece_trie_.build(pieces, true);
+
+    // SentencePiece byte fallback: unknown characters become "<0xXX>" pieces.
+    byte_fallback_ids_.assign(256, -1);
+    char name[8];
+    for (int b = 0; b < 256; ++b) {
+        std::snprintf(name, sizeof(name), "<0x%02X>", b);
+        byte_fallback_ids_[b] = vocab_->get_token_id(name);
+        if (byte_fallback_ids_[b] < 0) {
+            byte_fallback_ids_.clear();
+            break;
+        }
+    }
+}
 
-    if (text.empty()) return {};
+void UnigramTokenizer::viterbi(std::string_view text, std::vector<Piece>& pieces) const {
+    pieces.clear();
+    const size_t n = text.size();
+    if (n == 0) return;
+
+    // Lattice arena: best path ending at each byte position, reused across calls.
+    constexpr float NO_PATH = -std::numeric_limits<float>::infinity();
+    constexpr int UNKNOWN = -2;
+    thread_local std::vector<float> best_score;
+    thread_local std::vector<uint32_t> best_start;
+    thread_local std::vector<int> best_id;
+    best_score.assign(n + 1, NO_PATH);
+    best_start.assign(n + 1, 0);
+    best_id.assign(n + 1, UNKNOWN);
+    best_score[0] = 0.0f;
+
+    auto relax = [&](size_t begin, size_t end, int id, float score) {
+        float total = best_score[begin] + score;
+        if (total > best_score[end]) {
+            best_score[end] = total;
+            best_start[end] = static_cast<uint32_t>(begin);
+            best_id[end] = id;
+        }
+    };
 
-    std::vector<std::string> result;
-    std::string current_segment;
+    for (size_t i = 0; i < n; ++i) {
+        if (best_score[i] == NO_PATH) continue;
 
-    for (char c : text) {
-        current_segment += c;
-        // Check if current_segment is in vocab
-        if (vocab_->contains_token(current_segment)) {
-            // If it is, and it's a good candidate, add it and reset
-            // This logic needs to be more sophisticated for actual Unigram
-            result.push_back(current_segment);
-            current_segment.clear();
-        }
-    }
-    // Add any remaining segment
-    if (!current_segment.empty()) {
-        result.push_back(current_segment);
+        const size_t char_len = std::min(utf8_length(static_cast<unsigned char>(text[i])), n - i);
+
+        // Common-prefix search: every vocab piece starting at i is an edge.
+        bool covers_char = false;
+        piece_trie_.common_prefix_search(text.substr(i), [&](size_t length, int32_t id) {
+            relax(i, i + length, id, piece_scores_[id]);
+            if (length == char_len) covers_char = true;
+        });
+        if (!covers_char) relax(i, i + char_len, UNKNOWN, unk_score_);
     }
 
-    // Fallback: if no segmentation found, return character by character
-    if (result.empty() && !text.empty()) {
-        for (char c : text) {
-            result.push_back(std::string(1, c));
+    int unk_id = vocab_->get_special_token_id(SpecialTokenType::UNK);
+    for (size_t end = n; end > 0; end = best_start[end]) {
+        size_t begin = best_start[end];
+        if (best_id[end] != UNKNOWN) {
+            pieces.push_back(Piece{ begin, end, best_id[end] });
+        } else if (!byte_fallback_ids_.empty()) {
+            for (size_t b = end; b > begin; --b) {
+                pieces.push_back(Piece{ b - 1, b, byte_fallback_ids_[static_cast<unsigned char>(text[b - 1])] });
+            }
+        } else {
+            pieces.push_back(Piece{ begin, end, unk_id });
         }
     }
-
-    return result;
+    std::reverse(pieces.begin(), pieces.end());
 }
 
 } // namespace auratokenizer
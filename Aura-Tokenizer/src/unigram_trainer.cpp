@@ -1,12 +1,148 @@
 ﻿#include "unigram_trainer.h"
 #include "tokenizer_types.h"    // For TokenizerException
+#include "double_array_trie.h"  // Piece lattice lookups
+#include "suffix_array.h"       // Seed substring extraction
+#include "utf8_scan.h"          // utf8_length, is_ascii_space
 #include <algorithm>            // std::sort, std::transform
+#include <chrono>
+#include <cmath>
 #include <fstream>              // std::ifstream, std::ofstream
+#include <future>
+#include <limits>
 #include <stdexcept>
 #include <sstream>              // std::stringstream
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
 
 namespace auratokenizer {
 
+    namespace {
+
+        constexpr std::size_t kMaxPieceChars = 16;       // longest seed piece, in characters
+        constexpr double kMinExpectedCount = 0.5;        // M-step drops rarer pieces
+        constexpr double kShrinkFactor = 0.75;           // keep at least this share per prune
+        constexpr double kExtraRatio = 1.1;              // EM stops at this multiple of the budget
+        constexpr std::size_t kEmSubIterations = 2;
+        constexpr std::size_t kMaxRounds = 64;
+
+        struct LatticeEdge {
+            uint32_t begin;
+            uint32_t end;
+            int32_t  piece;
+        };
+
+        // All piece occurrences in word, ordered by start position.
+        void collect_edges(const DoubleArrayTrie& trie, std::string_view word, std::vector<LatticeEdge>& edges) {
+            edges.clear();
+            for (std::size_t i = 0; i < word.size(); ++i) {
+                trie.common_prefix_search(word.substr(i), [&](std::size_t length, int32_t piece) {
+                    edges.push_back(LatticeEdge{ static_cast<uint32_t>(i), static_cast<uint32_t>(i + length), piece });
+                });
+            }
+        }
+
+        double log_sum_exp(double a, double b) {
+            if (a == -std::numeric_limits<double>::infinity()) return b;
+            if (b == -std::numeric_limits<double>::infinity()) return a;
+            double hi = std::max(a, b);
+            return hi + std::log1p(std::exp(std::min(a, b) - hi));
+        }
+
+        // Best path through the edges; skip_piece is excluded. Returns false if there is none.
+        bool viterbi_path(const std::vector<LatticeEdge>& edges, std::size_t length, const std::vector<float>& scores,
+            int32_t skip_piece, std::vector<int32_t>& path)
+        {
+            thread_local std::vector<double> best;
+            thread_local std::vector<const LatticeEdge*> back;
+            best.assign(length + 1, -std::numeric_limits<double>::infinity());
+            back.assign(length + 1, nullptr);
+            best[0] = 0.0;
+            for (const auto& edge : edges) {
+                if (edge.piece == skip_piece || best[edge.begin] == -std::numeric_limits<double>::infinity()) continue;
+                double score = best[edge.begin] + scores[edge.piece];
+                if (score > best[edge.end]) {
+                    best[edge.end] = score;
+                    back[edge.end] = &edge;
+                }
+            }
+            path.clear();
+            if (!back[length]) return false;
+            for (std::size_t pos = length; pos > 0; pos = back[pos]->begin) path.push_back(back[pos]->piece);
+            return true;
+        }
+
+        // Digamma function, as used by SentencePiece for the Bayesian M-step.
+        double digamma(double x) {
+            double result = 0.0;
+            for (; x < 7.0; ++x) result -= 1.0 / x;
+            x -= 0.5;
+            double xx = 1.0 / x;
+            double xx2 = xx * xx;
+            double xx4 = xx2 * xx2;
+            result += std::log(x) + (1.0 / 24.0) * xx2 - (7.0 / 960.0) * xx4 +
+                (31.0 / 8064.0) * xx4 * xx2 - (127.0 / 30720.0) * xx4 * xx4;
+            return result;
+        }
+
+        std::size_t resident_set_bytes() {
+#ifdef _WIN32
+            PROCESS_MEMORY_COUNTERS counters;
+            if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+                return static_cast<std::size_t>(counters.WorkingSetSize);
+            }
+            return 0;
+#elif defined(__linux__)
+            std::ifstream statm("/proc/self/statm");
+            std::size_t pages = 0, resident = 0;
+            if (statm >> pages >> resident) return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+            return 0;
+#else
+            return 0;
+#endif
+        }
+
+        double elapsed_ms(std::chrono::steady_clock::time_point since) {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+        }
+
+        DoubleArrayTrie build_piece_trie(const std::vector<std::string>& texts) {
+            std::vector<std::pair<std::string, int32_t>> entries;
+            entries.reserve(texts.size());
+            for (std::size_t i = 0; i < texts.size(); ++i) entries.emplace_back(texts[i], static_cast<int32_t>(i));
+            DoubleArrayTrie trie;
+            trie.build(entries, true);
+            return trie;
+        }
+
+        // Run fn(begin, end) over [0, count) split into one contiguous range per thread.
+        template <typename Result, typename Fn>
+        std::vector<Result> parallel_ranges(std::size_t count, std::size_t threads, Fn fn) {
+            threads = std::max<std::size_t>(1, std::min(threads, count));
+            std::size_t step = (count + threads - 1) / std::max<std::size_t>(threads, 1);
+            std::vector<std::future<Result>> futures;
+            for (std::size_t begin = step; begin < count; begin += step) {
+                futures.push_back(std::async(std::launch::async, fn, begin, std::min(count, begin + step)));
+            }
+            std::vector<Result> results;
+            results.push_back(fn(0, std::min(count, step)));
+            for (auto& fut : futures) results.push_back(fut.get());
+            return results;
+        }
+
+    } // namespace
+
     /*-------------------------------------------------------------------------*/
     /*  UnigramTrainer – Constructors / Configuration                           */
     /*-------------------------------------------------------------------------*/
@@ -63,19 +199,7 @@ namespace auratokenizer {
     }
 
     void UnigramTrainer::train_from_file(const std::string& file_path) {
-        std::ifstream infile(file_path);
-        if (!infile.is_open()) {
-            throw TokenizerException("Failed to open training file: " + file_path);
-        }
-
-        std::unordered_map<std::string, std::size_t> frequencies;
-        std::string line;
-        while (std::getline(infile, line)) {
-            process_text(line, frequencies);
-        }
-        infile.close();
-
-        build_vocab(frequencies);
+        train_from_files({ file_path });
     }
 
     void UnigramTrainer::train_from_files(const std::vector<std::string>& file_paths) {
@@ -83,18 +207,10 @@ namespace auratokenizer {
             throw TokenizerException("No file paths provided for UnigramTrainer::train_from_files");
         }
 
-        std::unordered_map<std::string, std::size_t> frequencies;
-        for (const auto& path : file_paths) {
-            std::ifstream infile(path);
-            if (!infile.is_open()) {
-                throw TokenizerException("Failed to open training file: " + path);
-            }
-            std::string line;
-            while (std::getline(infile, line)) {
-                process_text(line, frequencies);
-            }
-            infile.close();
-        }
+        // Files are memory-mapped and counted on all cores into per-thread maps.
+        CorpusCounts frequencies = count_corpus_files(file_paths,
+            [this](std::string_view line, CorpusCounts& counts) { process_text(line, counts); },
+            num_threads_);
 
         build_vocab(frequencies);
     }
@@ -196,6 +312,40 @@ namespace auratokenizer {
         config_.regex_pattern = pattern;
     }
 
+    void UnigramTrainer::set_num_threads(std::size_t threads) {
+        num_threads_ = threads;
+    }
+
+    void UnigramTrainer::set_seed_size(std::size_t size) {
+        if (size == 0) {
+            throw TokenizerException("Seed size must be >= 1");
+        }
+        seed_size_ = size;
+    }
+
+    void UnigramTrainer::set_seed_memory_budget(std::size_t bytes) {
+        if (bytes == 0) {
+            throw TokenizerException("Seed memory budget must be >= 1 byte");
+        }
+        seed_memory_budget_ = bytes;
+    }
+
+    void UnigramTrainer::set_progress_callback(std::function<void(const RoundStats&)> callback) {
+        progress_ = std::move(callback);
+    }
+
+    const std::unordered_map<std::string, float>& UnigramTrainer::get_scores() const {
+        return scores_;
+    }
+
+    const std::vector<UnigramTrainer::RoundStats>& UnigramTrainer::get_round_stats() const {
+        return round_stats_;
+    }
+
+    std::size_t UnigramTrainer::thread_count() const {
+        return num_threads_ ? num_threads_ : std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+
     std::shared_ptr<Vocab> UnigramTrainer::get_vocab() const {
         return vocab_;
     }
@@ -203,15 +353,15 @@ namespace auratokenizer {
     /*-------------------------------------------------------------------------*/
     /*  Private – process_text: normalize & count frequencies                   */
     /*-------------------------------------------------------------------------*/
-    void UnigramTrainer::process_text(const std::string& text,
-        std::unordered_map<std::string, std::size_t>& frequencies)
+    void UnigramTrainer::process_text(std::string_view text,
+        std::unordered_map<std::string, std::size_t>& frequencies) const
     {
         if (text.empty()) {
             return;
         }
 
         // 1) Normalize via ICU / UnicodeNormalizer
-        std::string normalized = normalizer_.normalize(text);
+        std::string normalized = normalizer_.normalize(std::string(text));
 
         // 2) Tokenize
         std::vector<std::string> tokens = tokenize_text(normalized);
@@ -225,7 +375,7 @@ namespace auratokenizer {
     }
 
     /*-------------------------------------------------------------------------*/
-    /*  Private – tokenize_text: character‐level or regex                        */
+    /*  Private – tokenize_text: split into words                               */
     /*-------------------------------------------------------------------------*/
     std::vector<std::string> UnigramTrainer::tokenize_text(const std::string& text) const {
         if (use_regex_ && !regex_pattern_.empty()) {
@@ -237,37 +387,226 @@ namespace auratokenizer {
             return { text };  // For now, fallback to whole‐string token
         }
 
-        // Default: split to single Unicode characters (UTF-8 aware)
-        std::vector<std::string> tokens;
-        tokens.reserve(text.size());
-        for (size_t i = 0; i < text.size(); ) {
-            unsigned char c = static_cast<unsigned char>(text[i]);
-            int len = 1;
-            if (c < 0x80) {
-                len = 1;
+        // Default: a new word starts at every whitespace byte, which stays attached
+        // to the word it precedes (" world"), mirroring SentencePiece's "▁world".
+        std::vector<std::string> words;
+        std::size_t start = 0;
+        for (std::size_t i = 1; i <= text.size(); ++i) {
+            if (i == text.size() || is_ascii_space(text[i])) {
+                words.emplace_back(text, start, i - start);
+                start = i;
             }
-            else if ((c & 0xE0) == 0xC0) {
-                len = 2;
+        }
+        return words;
+    }
+
+    /*-------------------------------------------------------------------------*/
+    /*  Private – make_seed_pieces: characters + frequent substrings            */
+    /*-------------------------------------------------------------------------*/
+    std::vector<UnigramTrainer::Piece> UnigramTrainer::make_seed_pieces(const WordList& words) const {
+        // Characters are always counted in full: they are required pieces.
+        std::unordered_map<std::string, std::size_t> chars;
+        for (const auto& [word, count] : words) {
+            for (std::size_t i = 0; i < word.size(); ) {
+                std::size_t len = std::min(utf8_length(static_cast<unsigned char>(word[i])), word.size() - i);
+                chars[word.substr(i, len)] += count;
+                i += len;
             }
-            else if ((c & 0xF0) == 0xE0) {
-                len = 3;
+        }
+
+        // Multi-character candidates come from the suffix and LCP arrays,
+        // already ranked by frequency * length as SentencePiece does.
+        SeedPieceOptions options;
+        options.max_pieces = seed_size_ > chars.size() ? seed_size_ - chars.size() : 0;
+        options.max_piece_chars = kMaxPieceChars;
+        options.min_frequency = std::max<std::size_t>(min_frequency_, 1);
+        options.memory_budget_bytes = seed_memory_budget_;
+        std::vector<std::pair<std::string, std::size_t>> ranked = extract_seed_pieces(words, options);
+
+        double total = 0.0;
+        for (const auto& [text, freq] : chars) total += static_cast<double>(freq);
+        for (const auto& [text, freq] : ranked) total += static_cast<double>(freq);
+        const double log_total = std::log(total);
+
+        std::vector<Piece> pieces;
+        pieces.reserve(chars.size() + ranked.size());
+        std::vector<std::pair<std::string, std::size_t>> sorted_chars(chars.begin(), chars.end());
+        std::sort(sorted_chars.begin(), sorted_chars.end());
+        for (const auto& [text, freq] : sorted_chars) {
+            pieces.push_back(Piece{ text, static_cast<float>(std::log(static_cast<double>(freq)) - log_total), true });
+        }
+        for (auto& [text, freq] : ranked) {
+            pieces.push_back(Piece{ std::move(text), static_cast<float>(std::log(static_cast<double>(freq)) - log_total), false });
+        }
+        return pieces;
+    }
+
+    /*-------------------------------------------------------------------------*/
+    /*  Private – run_em_step: parallel E-step, Bayesian M-step                 */
+    /*-------------------------------------------------------------------------*/
+    double UnigramTrainer::run_em_step(const WordList& words, std::vector<Piece>& pieces) const {
+        std::vector<std::string> texts;
+        std::vector<float> scores;
+        texts.reserve(pieces.size());
+        scores.reserve(pieces.size());
+        for (const auto& piece : pieces) {
+            texts.push_back(piece.text);
+            scores.push_back(piece.score);
+        }
+        const DoubleArrayTrie trie = build_piece_trie(texts);
+
+        // E-step: expected piece counts by forward-backward over each word's lattice.
+        struct Partial {
+            std::vector<double> expected;
+            double log_likelihood = 0.0;
+            double occurrences = 0.0;
+        };
+        auto e_step = [&](std::size_t begin, std::size_t end) {
+            Partial part;
+            part.expected.assign(pieces.size(), 0.0);
+            std::vector<LatticeEdge> edges;
+            std::vector<double> alpha, beta;
+            constexpr double NEG_INF = -std::numeric_limits<double>::infinity();
+            for (std::size_t w = begin; w < end; ++w) {
+                const std::string& word = words[w].first;
+                const double count = static_cast<double>(words[w].second);
+                collect_edges(trie, word, edges);
+                alpha.assign(word.size() + 1, NEG_INF);
+                beta.assign(word.size() + 1, NEG_INF);
+                alpha[0] = 0.0;
+                beta[word.size()] = 0.0;
+                for (const auto& e : edges) alpha[e.end] = log_sum_exp(alpha[e.end], alpha[e.begin] + scores[e.piece]);
+                for (auto it = edges.rbegin(); it != edges.rend(); ++it) {
+                    beta[it->begin] = log_sum_exp(beta[it->begin], scores[it->piece] + beta[it->end]);
+                }
+                const double z = alpha[word.size()];
+                if (z == NEG_INF) continue;
+                for (const auto& e : edges) {
+                    part.expected[e.piece] += count * std::exp(alpha[e.begin] + scores[e.piece] + beta[e.end] - z);
+                }
+                part.log_likelihood += count * z;
+                part.occurrences += count;
             }
-            else if ((c & 0xF8) == 0xF0) {
-                len = 4;
+            return part;
+        };
+        std::vector<Partial> parts = parallel_ranges<Partial>(words.size(), thread_count(), e_step);
+
+        std::vector<double> expected(pieces.size(), 0.0);
+        double log_likelihood = 0.0, occurrences = 0.0;
+        for (const auto& part : parts) {
+            for (std::size_t i = 0; i < expected.size(); ++i) expected[i] += part.expected[i];
+            log_likelihood += part.log_likelihood;
+            occurrences += part.occurrences;
+        }
+
+        // M-step: drop rare pieces, then re-estimate with digamma smoothing.
+        std::vector<Piece> kept;
+        std::vector<double> kept_counts;
+        kept.reserve(pieces.size());
+        for (std::size_t i = 0; i < pieces.size(); ++i) {
+            if (!pieces[i].required && expected[i] < kMinExpectedCount) continue;
+            kept.push_back(std::move(pieces[i]));
+            kept_counts.push_back(std::max(expected[i], kMinExpectedCount));
+        }
+        double sum = 0.0;
+        for (double c : kept_counts) sum += c;
+        const double log_sum = digamma(sum);
+        for (std::size_t i = 0; i < kept.size(); ++i) {
+            kept[i].score = static_cast<float>(digamma(kept_counts[i]) - log_sum);
+        }
+        pieces.swap(kept);
+        return occurrences > 0.0 ? -log_likelihood / occurrences : 0.0;
+    }
+
+    /*-------------------------------------------------------------------------*/
+    /*  Private – prune_pieces: drop the pieces whose loss is smallest          */
+    /*-------------------------------------------------------------------------*/
+    void UnigramTrainer::prune_pieces(const WordList& words, std::vector<Piece>& pieces, std::size_t target) const {
+        std::vector<std::string> texts;
+        std::vector<float> scores;
+        for (const auto& piece : pieces) {
+            texts.push_back(piece.text);
+            scores.push_back(piece.score);
+        }
+        const DoubleArrayTrie trie = build_piece_trie(texts);
+
+        // Viterbi frequency of every piece over the corpus.
+        auto count_viterbi = [&](std::size_t begin, std::size_t end) {
+            std::vector<double> freq(pieces.size(), 0.0);
+            std::vector<LatticeEdge> edges;
+            std::vector<int32_t> path;
+            for (std::size_t w = begin; w < end; ++w) {
+                collect_edges(trie, words[w].first, edges);
+                if (!viterbi_path(edges, words[w].first.size(), scores, -1, path)) continue;
+                for (int32_t p : path) freq[p] += static_cast<double>(words[w].second);
             }
-            tokens.emplace_back(text.substr(i, len));
-            i += len;
+            return freq;
+        };
+        std::vector<std::vector<double>> parts = parallel_ranges<std::vector<double>>(words.size(), thread_count(), count_viterbi);
+        std::vector<double> freq(pieces.size(), 0.0);
+        for (const auto& part : parts) {
+            for (std::size_t i = 0; i < freq.size(); ++i) freq[i] += part[i];
         }
-        return tokens;
+        double sum = 0.0;
+        for (double f : freq) sum += f;
+        if (sum <= 0.0) return;
+        const double log_sum = std::log(sum);
+
+        // Loss of removing piece i: its Viterbi occurrences are re-segmented by
+        // the best alternative path through the remaining pieces.
+        std::vector<char> keep(pieces.size(), 0);
+        std::vector<std::pair<double, std::size_t>> candidates;
+        std::vector<LatticeEdge> edges;
+        std::vector<int32_t> alternative;
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < pieces.size(); ++i) {
+            if (pieces[i].required) {
+                keep[i] = 1;
+                ++kept;
+                continue;
+            }
+            if (freq[i] == 0.0) continue; // never on a best path: free to drop
+            collect_edges(trie, pieces[i].text, edges);
+            if (!viterbi_path(edges, pieces[i].text.size(), scores, static_cast<int32_t>(i), alternative)) {
+                keep[i] = 1;
+                ++kept;
+                continue;
+            }
+            const double f = freq[i];
+            const double logprob_piece = std::log(f) - log_sum;
+            const double log_sum_alt = std::log(sum + f * (static_cast<double>(alternative.size()) - 1.0));
+            double logprob_alt = 0.0;
+            for (int32_t a : alternative) logprob_alt += std::log(freq[a] + f) - log_sum_alt;
+            candidates.emplace_back(f * (logprob_piece - logprob_alt), i);
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        });
+        const std::size_t new_size = std::max(target, static_cast<std::size_t>(pieces.size() * kShrinkFactor));
+        for (const auto& candidate : candidates) {
+            if (kept >= new_size) break;
+            keep[candidate.second] = 1;
+            ++kept;
+        }
+
+        std::vector<Piece> survivors;
+        survivors.reserve(kept);
+        for (std::size_t i = 0; i < pieces.size(); ++i) {
+            if (keep[i]) survivors.push_back(std::move(pieces[i]));
+        }
+        pieces.swap(survivors);
     }
 
     /*-------------------------------------------------------------------------*/
-    /*  Private – build_vocab: create & prune the Vocab                         */
+    /*  Private – build_vocab: EM rounds, pruning, final Vocab                  */
     /*-------------------------------------------------------------------------*/
     void UnigramTrainer::build_vocab(const std::unordered_map<std::string, std::size_t>& frequencies)
     {
         // 1) Reset & add special tokens
         vocab_->clear();  // Clear existing maps
+        scores_.clear();
+        round_stats_.clear();
         vocab_->add_special_token(config_.unk_token, SpecialTokenType::UNK);
         vocab_->add_special_token(config_.pad_token, SpecialTokenType::PAD);
         vocab_->add_special_token(config_.bos_token, SpecialTokenType::BOS);
@@ -281,30 +620,57 @@ namespace auratokenizer {
         if (!config_.cls_token.empty()) {
             vocab_->add_special_token(config_.cls_token, SpecialTokenType::CLS);
         }
+        if (frequencies.empty()) {
+            return;
+        }
+        const std::size_t budget = max_tokens_ > vocab_->size() ? max_tokens_ - vocab_->size() : 0;
+
+        // 2) Seed pieces, sorted word list for reproducible runs
+        WordList words(frequencies.begin(), frequencies.end());
+        std::sort(words.begin(), words.end());
+        std::vector<Piece> pieces = make_seed_pieces(words);
+
+        // 3) EM + prune rounds until the piece count is near the budget
+        const std::size_t em_target = static_cast<std::size_t>(budget * kExtraRatio);
+        for (std::size_t round = 1; round <= kMaxRounds; ++round) {
+            RoundStats stats{ round, 0, 0.0, 0.0, 0.0, 0 };
+            auto start = std::chrono::steady_clock::now();
+            for (std::size_t sub = 0; sub < kEmSubIterations; ++sub) {
+                stats.objective = run_em_step(words, pieces);
+            }
+            stats.em_ms = elapsed_ms(start);
 
-        // 2) Collect all (token, freq) pairs that meet min_frequency_
-        std::vector<std::pair<std::string, std::size_t>> candidates;
-        candidates.reserve(frequencies.size());
-        for (const auto& kv : frequencies) {
-            if (kv.second >= min_frequency_) {
-                candidates.emplace_back(kv.first, kv.second);
+            const std::size_t before = pieces.size();
+            if (before > em_target) {
+                start = std::chrono::steady_clock::now();
+                prune_pieces(words, pieces, em_target);
+                stats.prune_ms = elapsed_ms(start);
             }
+            stats.pieces = pieces.size();
+            stats.rss_bytes = resident_set_bytes();
+            round_stats_.push_back(stats);
+            if (progress_) progress_(stats);
+            if (before <= em_target || pieces.size() == before) break;
         }
 
-        // 3) Sort candidates by descending frequency
-        std::sort(candidates.begin(), candidates.end(),
-            [](auto& a, auto& b) {
-                return a.second > b.second;
-            });
-
-        // 4) Insert tokens into Vocab up to max_tokens_
-        std::size_t count_added = 0;
-        for (const auto& p : candidates) {
-            if (count_added >= max_tokens_) {
-                break;
-            }
-            vocab_->add_token(p.first);
-            count_added++;
+        // 4) Final selection: every character, then the best-scoring pieces
+        std::vector<const Piece*> chosen;
+        std::vector<const Piece*> optional;
+        for (const auto& piece : pieces) {
+            (piece.required ? chosen : optional).push_back(&piece);
+        }
+        auto by_score = [](const Piece* a, const Piece* b) {
+            return a->score != b->score ? a->score > b->score : a->text < b->text;
+        };
+        std::sort(optional.begin(), optional.end(), by_score);
+        for (const Piece* piece : optional) {
+            if (chosen.size() >= budget) break;
+            chosen.push_back(piece);
+        }
+        std::sort(chosen.begin(), chosen.end(), by_score);
+        for (const Piece* piece : chosen) {
+            vocab_->add_token_with_score(piece->text, piece->score);
+            scores_[piece->text] = piece->score;
         }
     }
 
@@ -1,35 +1,241 @@
 ﻿#include "vocab.h"
+#include "corpus_reader.h"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <limits>
 #include <stdexcept>
 
 namespace auratokenizer {
 
+    namespace {
+
+        // -- Binary format --
+
+        constexpr char kMagic[8] = { 'A', 'U', 'R', 'A', 'V', 'O', 'C', 'B' };
+        constexpr uint32_t kByteOrderTag = 0x01020304u;
+        constexpr uint32_t kSwappedByteOrderTag = 0x04030201u;
+        constexpr uint32_t kFormatVersion = 1;
+        constexpr uint64_t kChecksumSeed = 0x5EEDC0DEu;
+        // 32-bit arena offsets and ids keep every real vocabulary far below this.
+        constexpr uint64_t kMaxFileSize = uint64_t(1) << 36;
+
+        enum SectionTag : uint32_t {
+            SECTION_ARENA = 1,
+            SECTION_ENTRIES = 2,
+            SECTION_ID_SPANS = 3,
+            SECTION_SLOTS = 4,
+            SECTION_SPECIALS = 5,
+            SECTION_SCORES = 6,      // optional: absent means no scores
+            SECTION_FLAGS = 7,       // optional: absent means flags from SECTION_SPECIALS
+        };
+        constexpr uint32_t kRequiredSections = 5;
+        constexpr uint32_t kSectionCount = 7;
+
+        struct FileHeader {
+            char     magic[8];
+            uint32_t byte_order;     // kByteOrderTag in the writer's byte order
+            uint32_t version;
+            uint64_t file_size;      // header, directory and sections
+            uint64_t checksum;       // of everything after the header
+            uint32_t section_count;
+            int32_t  next_id;
+            uint64_t reserved;
+        };
+
+        struct SectionEntry {
+            uint32_t tag;
+            uint32_t element_size;
+            uint64_t offset;         // from the start of the header, 8-byte aligned
+            uint64_t count;
+        };
+
+        struct SpecialRecord {
+            int32_t type;            // SpecialTokenType, or -1 for a special id without a type slot
+            int32_t id;
+        };
+
+        bool is_hex_digit(char c) {
+            return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f');
+        }
+
+        int hex_value(char c) {
+            return c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10;
+        }
+
+        // SentencePiece byte-fallback pieces are spelled "<0xXX>".
+        bool is_byte_piece(std::string_view token) {
+            return token.size() == 6 && token.compare(0, 3, "<0x") == 0 && token[5] == '>'
+                && is_hex_digit(token[3]) && is_hex_digit(token[4]);
+        }
+
+        static_assert(sizeof(FileHeader) == 48, "FileHeader layout is part of the file format");
+        static_assert(sizeof(SectionEntry) == 24, "SectionEntry layout is part of the file format");
+
+        constexpr uint64_t kMul0 = 0x9E3779B97F4A7C15ull;
+        constexpr uint64_t kMul1 = 0xC2B2AE3D27D4EB4Full;
+
+        uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+        uint64_t fmix(uint64_t h) {
+            h ^= h >> 33;
+            h *= 0xFF51AFD7ED558CCDull;
+            h ^= h >> 33;
+            h *= 0xC4CEB9FE1A85EC53ull;
+            h ^= h >> 33;
+            return h;
+        }
+
+        // Fixed by the file format: the saved hash slots depend on it.
+        uint64_t hash_bytes(const char* data, size_t size, uint64_t seed) {
+            uint64_t h = seed ^ (static_cast<uint64_t>(size) * kMul0);
+            size_t i = 0;
+            for (; i + 8 <= size; i += 8) {
+                uint64_t k;
+                std::memcpy(&k, data + i, 8);
+                h = rotl(h ^ (k * kMul1), 31) * kMul0;
+            }
+            if (i < size) {
+                uint64_t k = 0;
+                std::memcpy(&k, data + i, size - i);
+                h = rotl(h ^ (k * kMul1), 31) * kMul0;
+            }
+            return fmix(h);
+        }
+
+        void check_header(const FileHeader& header) {
+            if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+                throw TokenizerException("Vocab: not a binary vocab file");
+            }
+            if (header.byte_order == kSwappedByteOrderTag) {
+                throw TokenizerException("Vocab: file was written with the opposite byte order");
+            }
+            if (header.byte_order != kByteOrderTag) {
+                throw TokenizerException("Vocab: corrupt byte-order tag");
+            }
+            if (header.version != kFormatVersion) {
+                throw TokenizerException("Vocab: unsupported format version " + std::to_string(header.version));
+            }
+            if (header.file_size < sizeof(FileHeader) + static_cast<uint64_t>(header.section_count) * sizeof(SectionEntry)
+                || header.file_size % 8 != 0 || header.file_size > kMaxFileSize
+                || header.file_size > std::numeric_limits<size_t>::max()) {
+                throw TokenizerException("Vocab: corrupt header");
+            }
+        }
+
+        template <typename T>
+        const T* section(const char* blob, uint64_t file_size, const SectionEntry& entry) {
+            if (entry.element_size != sizeof(T) || entry.offset % 8 != 0 || entry.offset > file_size
+                || entry.count > (file_size - entry.offset) / sizeof(T)) {
+                throw TokenizerException("Vocab: corrupt section " + std::to_string(entry.tag));
+            }
+            return reinterpret_cast<const T*>(blob + entry.offset);
+        }
+
+    } // namespace
+
     Vocab::Vocab() : next_id_(0) {}
 
     void Vocab::clear() {
-        token_to_id_.clear();
-        id_to_token_.clear();
+        arena_.clear();
+        entries_.clear();
+        id_spans_.clear();
+        scores_.clear();
+        flags_.clear();
+        slots_.clear();
         special_token_ids_.clear();
-        special_ids_set_.clear();
         next_id_ = 0;
+        mapping_.reset();
     }
 
-    void Vocab::add_token(const std::string& token, int id) {
-        if (token.empty() || has_token(token)) {
-            return;
+    uint64_t Vocab::hash_token(std::string_view token) {
+        return hash_bytes(token.data(), token.size(), 0);
+    }
+
+    size_t Vocab::find_slot(std::string_view token, uint64_t hash) const {
+        const size_t mask = slots_.size() - 1;
+        const uint32_t tag = static_cast<uint32_t>(hash >> 32);
+        for (size_t i = static_cast<size_t>(hash) & mask; ; i = (i + 1) & mask) {
+            const Slot& slot = slots_[i];
+            if (slot.entry == EMPTY_SLOT) return i;
+            if (slot.tag != tag) continue;
+            const Entry& entry = entries_[slot.entry];
+            if (entry.length == token.size() && std::memcmp(arena_.data() + entry.offset, token.data(), token.size()) == 0) {
+                return i;
+            }
+        }
+    }
+
+    void Vocab::grow_slots() {
+        std::vector<Slot> old(slots_.begin(), slots_.end());
+        slots_.assign(old.empty() ? 64 : old.size() * 2, Slot{ 0, EMPTY_SLOT });
+        const size_t mask = slots_.size() - 1;
+        for (const Slot& slot : old) {
+            if (slot.entry == EMPTY_SLOT) continue;
+            const Entry& entry = entries_[slot.entry];
+            size_t i = static_cast<size_t>(hash_token(std::string_view(arena_.data() + entry.offset, entry.length))) & mask;
+            while (slots_[i].entry != EMPTY_SLOT) i = (i + 1) & mask;
+            slots_.set(i, slot);
+        }
+    }
+
+    int Vocab::insert(std::string_view token, int id) {
+        if ((entries_.size() + 1) * 2 > slots_.size()) grow_slots();
+        const uint64_t hash = hash_token(token);
+        const size_t slot = find_slot(token, hash);
+        if (slots_[slot].entry != EMPTY_SLOT) return -1;
+
+        if (arena_.size() + token.size() > std::numeric_limits<uint32_t>::max()) {
+            throw TokenizerException("Vocab: token text exceeds 4 GiB");
+        }
+        const int assigned_id = (id < 0) ? next_id_ : id;
+        const uint32_t offset = static_cast<uint32_t>(arena_.size());
+        const uint32_t length = static_cast<uint32_t>(token.size());
+        arena_.append(token.data(), token.size());
+        slots_.set(slot, Slot{ static_cast<uint32_t>(hash >> 32), static_cast<uint32_t>(entries_.size()) });
+        entries_.push_back(Entry{ offset, length, assigned_id });
+
+        if (static_cast<size_t>(assigned_id) >= id_spans_.size()) {
+            id_spans_.resize(static_cast<size_t>(assigned_id) + 1, TokenSpan{ NO_TOKEN, 0 });
+            scores_.resize(id_spans_.size(), 0.0f);
+            flags_.resize(id_spans_.size(), 0);
         }
-        int assigned_id = (id < 0) ? next_id_++ : id;
-        token_to_id_[token] = assigned_id;
-        id_to_token_[assigned_id] = token;
+        id_spans_.set(assigned_id, TokenSpan{ offset, length });
+        scores_.set(assigned_id, 0.0f);
+        flags_.set(assigned_id, is_byte_piece(token) ? BYTE_FALLBACK : 0);
         if (assigned_id >= next_id_) {
             next_id_ = assigned_id + 1;
         }
+        mapping_.reset(); // every table now owns its elements
+        return assigned_id;
+    }
+
+    void Vocab::add_token(const std::string& token, int id) {
+        if (token.empty()) {
+            return;
+        }
+        insert(token, id);
     }
 
     void Vocab::add_token_with_score(const std::string& token, double score, int id) {
-        // For now, we ignore the score and just add the token
-        // In a more sophisticated implementation, you might want to store scores
         add_token(token, id);
+        set_score(find_token_id(token), static_cast<float>(score));
+    }
+
+    void Vocab::set_score(int id, float score) {
+        if (!has_id(id)) return;
+        scores_.set(id, score);
+        flags_.set(id, flags_[id] | HAS_SCORE);
+    }
+
+    void Vocab::set_flags(int id, uint8_t set, uint8_t clear) {
+        if (!has_id(id)) return;
+        flags_.set(id, static_cast<uint8_t>((flags_[id] & ~clear) | set));
+    }
+
+    int Vocab::byte_value(std::string_view token) {
+        if (!is_byte_piece(token)) return -1;
+        return hex_value(token[3]) * 16 + hex_value(token[4]);
     }
 
     void Vocab::add_tokens(const std::vector<std::string>& tokens) {
@@ -39,45 +245,62 @@ namespace auratokenizer {
     }
 
     int Vocab::get_token_id(const std::string& token) const {
-        auto it = token_to_id_.find(token);
-        return (it != token_to_id_.end()) ? it->second : -1;
+        return find_token_id(token);
+    }
+
+    int Vocab::find_token_id(std::string_view token) const {
+        if (entries_.empty()) return -1;
+        const uint32_t entry = slots_[find_slot(token, hash_token(token))].entry;
+        return entry == EMPTY_SLOT ? -1 : entries_[entry].id;
+    }
+
+    std::string_view Vocab::get_token_view(int id) const {
+        if (id < 0 || static_cast<size_t>(id) >= id_spans_.size()) return {};
+        const TokenSpan& span = id_spans_[id];
+        if (span.offset == NO_TOKEN) return {};
+        return std::string_view(arena_.data() + span.offset, span.length);
     }
 
     std::string Vocab::get_token(int id) const {
-        auto it = id_to_token_.find(id);
-        return (it != id_to_token_.end()) ? it->second : "";
+        return std::string(get_token_view(id));
+    }
+
+    std::unordered_map<std::string, int> Vocab::get_token_to_id() const {
+        std::unordered_map<std::string, int> map;
+        map.reserve(entries_.size());
+        for_each_token([&](std::string_view token, int id) { map.emplace(token, id); });
+        return map;
     }
 
     bool Vocab::has_token(const std::string& token) const {
-        return token_to_id_.count(token);
+        return find_token_id(token) >= 0;
     }
 
     bool Vocab::has_id(int id) const {
-        return id_to_token_.count(id);
+        return id >= 0 && static_cast<size_t>(id) < id_spans_.size() && id_spans_[id].offset != NO_TOKEN;
     }
 
     size_t Vocab::size() const {
-        return token_to_id_.size();
+        return entries_.size();
     }
 
     void Vocab::add_special_token(const std::string& token, SpecialTokenType type) {
-        if (token.empty() || has_token(token)) return;
+        if (token.empty()) return;
 
-        int id = next_id_++;
-        token_to_id_[token] = id;
-        id_to_token_[id] = token;
+        int id = insert(token, -1);
+        if (id < 0) return;
         special_token_ids_[type] = id;
-        special_ids_set_.insert(id);
+        flags_.set(id, flags_[id] | SPECIAL);
     }
 
     bool Vocab::is_special_token(const std::string& token) const {
-        auto it = token_to_id_.find(token);
-        if (it == token_to_id_.end()) return false;
-        return special_ids_set_.count(it->second);
+        int id = find_token_id(token);
+        if (id < 0) return false;
+        return is_special_token_id(id);
     }
 
     bool Vocab::is_special_token_id(int id) const {
-        return special_ids_set_.count(id);
+        return (flags(id) & SPECIAL) != 0;
     }
 
     std::vector<std::string> Vocab::get_special_tokens() const {
@@ -98,6 +321,193 @@ namespace auratokenizer {
         return get_token(id);
     }
 
-    void Vocab::save(std::ostream& out) const { /* Your existing implementation is likely fine */ }
-    void Vocab::load(std::istream& in) { /* Your existing implementation is likely fine */ }
-}
\ No newline at end of file
+    // -- Serialization --
+
+    void Vocab::save(std::ostream& out) const {
+        // Which ids are special is in the flags; the records only keep the type slots.
+        std::vector<SpecialRecord> specials;
+        for (const auto& [type, id] : special_token_ids_) specials.push_back(SpecialRecord{ static_cast<int32_t>(type), id });
+        std::sort(specials.begin(), specials.end(), [](const SpecialRecord& a, const SpecialRecord& b) { return a.type < b.type; });
+
+        std::string blob(sizeof(FileHeader) + kSectionCount * sizeof(SectionEntry), '\0');
+        std::vector<SectionEntry> directory;
+        auto add_section = [&](uint32_t tag, const void* data, size_t element_size, size_t count) {
+            blob.resize((blob.size() + 7) & ~size_t(7), '\0');
+            directory.push_back(SectionEntry{ tag, static_cast<uint32_t>(element_size), blob.size(), count });
+            if (count) blob.append(static_cast<const char*>(data), element_size * count);
+        };
+        add_section(SECTION_ARENA, arena_.data(), sizeof(char), arena_.size());
+        add_section(SECTION_ENTRIES, entries_.data(), sizeof(Entry), entries_.size());
+        add_section(SECTION_ID_SPANS, id_spans_.data(), sizeof(TokenSpan), id_spans_.size());
+        add_section(SECTION_SLOTS, slots_.data(), sizeof(Slot), slots_.size());
+        add_section(SECTION_SPECIALS, specials.data(), sizeof(SpecialRecord), specials.size());
+        add_section(SECTION_SCORES, scores_.data(), sizeof(float), scores_.size());
+        add_section(SECTION_FLAGS, flags_.data(), sizeof(uint8_t), flags_.size());
+        blob.resize((blob.size() + 7) & ~size_t(7), '\0');
+        std::memcpy(&blob[sizeof(FileHeader)], directory.data(), directory.size() * sizeof(SectionEntry));
+
+        FileHeader header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.byte_order = kByteOrderTag;
+        header.version = kFormatVersion;
+        header.file_size = blob.size();
+        header.section_count = kSectionCount;
+        header.next_id = next_id_;
+        header.checksum = hash_bytes(blob.data() + sizeof(FileHeader), blob.size() - sizeof(FileHeader), kChecksumSeed);
+        std::memcpy(&blob[0], &header, sizeof(header));
+
+        out.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+        if (!out) throw TokenizerException("Vocab: failed to write vocabulary");
+    }
+
+    void Vocab::load(std::istream& in) {
+        FileHeader header;
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+            throw TokenizerException("Vocab: truncated vocabulary header");
+        }
+        check_header(header);
+        const std::streamsize rest = static_cast<std::streamsize>(header.file_size - sizeof(header));
+
+        // Don't allocate for a size the stream cannot hold (only seekable streams can tell).
+        const std::streampos here = in.tellg();
+        if (here != std::streampos(-1)) {
+            in.seekg(0, std::ios::end);
+            const std::streampos end = in.tellg();
+            in.seekg(here);
+            if (end != std::streampos(-1) && end - here < rest) {
+                throw TokenizerException("Vocab: truncated vocabulary");
+            }
+        }
+
+        // 8-byte aligned so sections can be read in place before copying.
+        std::vector<uint64_t> buffer(header.file_size / 8);
+        char* blob = reinterpret_cast<char*>(buffer.data());
+        std::memcpy(blob, &header, sizeof(header));
+        if (!in.read(blob + sizeof(header), rest)) {
+            throw TokenizerException("Vocab: truncated vocabulary");
+        }
+        read_blob(blob, header.file_size, true, true);
+    }
+
+    void Vocab::save(const std::string& path) const {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) throw TokenizerException("Failed to open file for writing: " + path);
+        save(out);
+    }
+
+    void Vocab::load(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) throw TokenizerException("Failed to open file for reading: " + path);
+        load(in);
+    }
+
+    void Vocab::map_file(const std::string& path, bool verify_checksum) {
+        auto file = std::make_shared<const MappedFile>(path);
+        read_blob(file->view().data(), file->size(), verify_checksum, false);
+        mapping_ = std::move(file);
+    }
+
+    void Vocab::read_blob(const char* blob, size_t size, bool verify_checksum, bool copy_tables) {
+        FileHeader header;
+        if (size < sizeof(header)) throw TokenizerException("Vocab: truncated vocabulary header");
+        std::memcpy(&header, blob, sizeof(header));
+        check_header(header);
+        if (header.file_size > size) throw TokenizerException("Vocab: truncated vocabulary");
+        if (reinterpret_cast<uintptr_t>(blob) % 8 != 0) throw TokenizerException("Vocab: misaligned vocabulary data");
+        if (verify_checksum
+            && hash_bytes(blob + sizeof(header), header.file_size - sizeof(header), kChecksumSeed) != header.checksum) {
+            throw TokenizerException("Vocab: checksum mismatch");
+        }
+
+        // Unknown sections are skipped so later versions can add data.
+        const SectionEntry* directory = reinterpret_cast<const SectionEntry*>(blob + sizeof(header));
+        const SectionEntry* found[kSectionCount + 1] = {};
+        for (uint32_t i = 0; i < header.section_count; ++i) {
+            if (directory[i].tag >= 1 && directory[i].tag <= kSectionCount) found[directory[i].tag] = &directory[i];
+        }
+        for (uint32_t tag = 1; tag <= kRequiredSections; ++tag) {
+            if (!found[tag]) throw TokenizerException("Vocab: missing section " + std::to_string(tag));
+        }
+        const uint64_t file_size = header.file_size;
+        const char* arena = section<char>(blob, file_size, *found[SECTION_ARENA]);
+        const Entry* entries = section<Entry>(blob, file_size, *found[SECTION_ENTRIES]);
+        const TokenSpan* spans = section<TokenSpan>(blob, file_size, *found[SECTION_ID_SPANS]);
+        const Slot* slots = section<Slot>(blob, file_size, *found[SECTION_SLOTS]);
+        const SpecialRecord* specials = section<SpecialRecord>(blob, file_size, *found[SECTION_SPECIALS]);
+        const size_t arena_size = found[SECTION_ARENA]->count;
+        const size_t entry_count = found[SECTION_ENTRIES]->count;
+        const size_t span_count = found[SECTION_ID_SPANS]->count;
+        const size_t slot_count = found[SECTION_SLOTS]->count;
+        const size_t special_count = found[SECTION_SPECIALS]->count;
+        const float* scores = nullptr;
+        const uint8_t* flags = nullptr;
+        if (found[SECTION_SCORES]) {
+            scores = section<float>(blob, file_size, *found[SECTION_SCORES]);
+            if (found[SECTION_SCORES]->count != span_count) throw TokenizerException("Vocab: corrupt score table");
+        }
+        if (found[SECTION_FLAGS]) {
+            flags = section<uint8_t>(blob, file_size, *found[SECTION_FLAGS]);
+            if (found[SECTION_FLAGS]->count != span_count) throw TokenizerException("Vocab: corrupt flag table");
+        }
+
+        // Lookups rely on a power-of-two table with at least one empty slot.
+        if ((slot_count & (slot_count - 1)) != 0 || (entry_count && slot_count <= entry_count)) {
+            throw TokenizerException("Vocab: corrupt hash index");
+        }
+        if (verify_checksum) {
+            for (size_t i = 0; i < entry_count; ++i) {
+                if (entries[i].offset > arena_size || entries[i].length > arena_size - entries[i].offset || entries[i].id < 0
+                    || static_cast<size_t>(entries[i].id) >= span_count) {
+                    throw TokenizerException("Vocab: corrupt entry table");
+                }
+            }
+            for (size_t i = 0; i < span_count; ++i) {
+                if (spans[i].offset != NO_TOKEN && (spans[i].offset > arena_size || spans[i].length > arena_size - spans[i].offset)) {
+                    throw TokenizerException("Vocab: corrupt id table");
+                }
+            }
+            for (size_t i = 0; i < slot_count; ++i) {
+                if (slots[i].entry != EMPTY_SLOT && slots[i].entry >= entry_count) {
+                    throw TokenizerException("Vocab: corrupt hash index");
+                }
+            }
+        }
+
+        for (size_t i = 0; i < special_count; ++i) {
+            if (specials[i].id < 0 || static_cast<size_t>(specials[i].id) >= span_count) {
+                throw TokenizerException("Vocab: corrupt special tokens");
+            }
+        }
+
+        clear();
+        if (copy_tables) {
+            arena_.append(arena, arena_size);
+            entries_.append(entries, entry_count);
+            id_spans_.append(spans, span_count);
+            slots_.append(slots, slot_count);
+            if (scores) scores_.append(scores, span_count);
+            if (flags) flags_.append(flags, span_count);
+        } else {
+            arena_.view(arena, arena_size);
+            entries_.view(entries, entry_count);
+            id_spans_.view(spans, span_count);
+            slots_.view(slots, slot_count);
+            if (scores) scores_.view(scores, span_count);
+            if (flags) flags_.view(flags, span_count);
+        }
+        if (!scores) scores_.assign(span_count, 0.0f);
+        if (!flags) {
+            flags_.assign(span_count, 0);
+            for (size_t i = 0; i < entry_count; ++i) {
+                std::string_view token(arena + entries[i].offset, entries[i].length);
+                if (is_byte_piece(token)) flags_.set(entries[i].id, BYTE_FALLBACK);
+            }
+        }
+        for (size_t i = 0; i < special_count; ++i) {
+            const SpecialRecord& record = specials[i];
+            if (!flags) flags_.set(record.id, flags_[record.id] | SPECIAL);
+            if (record.type >= 0) special_token_ids_[static_cast<SpecialTokenType>(record.type)] = record.id;
+        }
+        next_id_ = header.next_id;
+    }
+}
@@ -1,5 +1,6 @@
 #include "wordpiece_model.h"
 #include <algorithm>
+#include <map>
 #include <iostream>
 
 namespace auratokenizer {
@@ -14,41 +15,193 @@ void WordPieceModel::initialize(
     vocab_ = vocab;
     unk_token_ = unk_token;
     max_input_chars_per_word_ = max_input_chars_per_word;
+    build_trie();
+}
+
+void WordPieceModel::build_trie() {
+    // Build a pointer trie first, then renumber it breadth-first.
+    struct BuildNode {
+        std::map<unsigned char, int32_t> children;
+        int32_t token_id = -1;
+    };
+    std::vector<BuildNode> nodes(2);
+    auto insert = [&](int32_t node, std::string_view key, int id) {
+        for (unsigned char c : key) {
+            auto it = nodes[node].children.find(c);
+            if (it == nodes[node].children.end()) {
+                it = nodes[node].children.emplace(c, static_cast<int32_t>(nodes.size())).first;
+                nodes.emplace_back();
+            }
+            node = it->second;
+        }
+        nodes[node].token_id = id;
+    };
+    for (const auto& [token, id] : vocab_) {
+        if (token.empty()) continue;
+        // Every piece can start a word verbatim, "##x" included.
+        insert(ROOT, token, id);
+        if (token.size() > 2 && token.compare(0, 2, "##") == 0) {
+            insert(SUFFIX_ROOT, std::string_view(token).substr(2), id);
+        }
+    }
+
+    const size_t count = nodes.size();
+    std::vector<int32_t> order = { ROOT, SUFFIX_ROOT }; // BFS order of build nodes
+    std::vector<int32_t> renumber(count, -1);
+    renumber[ROOT] = ROOT;
+    renumber[SUFFIX_ROOT] = SUFFIX_ROOT;
+    child_begin_.assign(count + 1, 0);
+    label_.assign(count, 0);
+    depth_.assign(count, 0);
+    token_id_.assign(count, -1);
+    for (size_t k = 0; k < order.size(); ++k) {
+        int32_t old_id = order[k];
+        child_begin_[k] = static_cast<int32_t>(order.size());
+        token_id_[k] = nodes[old_id].token_id;
+        for (const auto& [c, child] : nodes[old_id].children) {
+            int32_t id = static_cast<int32_t>(order.size());
+            renumber[child] = id;
+            label_[id] = c;
+            depth_[id] = depth_[k] + 1;
+            order.push_back(child);
+        }
+    }
+    child_begin_[count] = static_cast<int32_t>(count);
+
+    // Failure links and pops, in BFS order so parents and shallower nodes
+    // come first. A piece node pops itself and continues at the "##" root;
+    // any other node pops what its parent pops, plus what each failure hop
+    // pops, until some failure state extends by the node's byte.
+    std::vector<int32_t> parent(count, -1);
+    for (int32_t v = 0; v < static_cast<int32_t>(count); ++v) {
+        for (int32_t u = child_begin_[v]; u < child_begin_[v + 1]; ++u) parent[u] = v;
+    }
+    fail_.assign(count, -1);
+    pops_begin_.assign(count + 1, 0);
+    pops_.clear();
+    for (int32_t u = 0; u < static_cast<int32_t>(count); ++u) {
+        pops_begin_[u] = static_cast<int32_t>(pops_.size());
+        if (u <= SUFFIX_ROOT) continue;
+        if (token_id_[u] >= 0) {
+            fail_[u] = SUFFIX_ROOT;
+            pops_.push_back(u);
+            continue;
+        }
+        int32_t v = parent[u];
+        std::vector<int32_t> pops(pops_.begin() + pops_begin_[v], pops_.begin() + pops_begin_[v + 1]);
+        int32_t z = fail_[v];
+        while (z >= 0 && transition(z, label_[u]) < 0) {
+            pops.insert(pops.end(), pops_.begin() + pops_begin_[z], pops_.begin() + pops_begin_[z + 1]);
+            z = fail_[z];
+        }
+        if (z < 0) continue; // no greedy continuation: matching falls back here
+        fail_[u] = transition(z, label_[u]);
+        pops_.insert(pops_.end(), pops.begin(), pops.end());
+    }
+    pops_begin_[count] = static_cast<int32_t>(pops_.size());
 }
 
 std::vector<std::string> WordPieceModel::tokenize(const std::string& word) const {
+    std::vector<PieceSpan> spans;
+    tokenize_spans(word, spans);
+
     std::vector<std::string> output_tokens;
-    if (word.empty()) {
-        return output_tokens;
+    output_tokens.reserve(spans.size());
+    for (const auto& span : spans) {
+        if (span.unk) {
+            output_tokens.push_back(unk_token_);
+        } else if (span.begin > 0) {
+            output_tokens.push_back("##" + word.substr(span.begin, span.end - span.begin));
+        } else {
+            output_tokens.push_back(word.substr(span.begin, span.end - span.begin));
+        }
     }
+    return output_tokens;
+}
 
-    std::string current_word = word;
-    int start = 0;
-    while (start < current_word.length()) {
-        int end = current_word.length();
-        std::string current_chunk;
-        bool found_in_vocab = false;
-        while (start < end) {
-            std::string chunk = current_word.substr(start, end - start);
-            if (start > 0) {
-                chunk = "##" + chunk;
+int32_t WordPieceModel::transition(int32_t node, unsigned char c) const {
+    int32_t lo = child_begin_[node], hi = child_begin_[node + 1];
+    while (lo < hi) {
+        int32_t mid = lo + (hi - lo) / 2;
+        if (label_[mid] < c) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return (lo < child_begin_[node + 1] && label_[lo] == c) ? lo : -1;
+}
+
+void WordPieceModel::emit_pops(int32_t node, size_t& pos, std::vector<PieceSpan>& out) const {
+    for (int32_t k = pops_begin_[node]; k < pops_begin_[node + 1]; ++k) {
+        int32_t piece = pops_[k];
+        size_t end = pos + static_cast<size_t>(depth_[piece]);
+        out.push_back(PieceSpan{ pos, end, false, token_id_[piece] });
+        pos = end;
+    }
+}
+
+void WordPieceModel::greedy_from(std::string_view word, size_t start, std::vector<PieceSpan>& out) const {
+    // Plain longest match per piece; only reached for words that end in unk.
+    while (start < word.size()) {
+        int32_t node = start == 0 ? ROOT : SUFFIX_ROOT;
+        size_t end = 0;
+        int32_t id = -1;
+        for (size_t i = start; i < word.size(); ++i) {
+            node = transition(node, static_cast<unsigned char>(word[i]));
+            if (node < 0) break;
+            if (token_id_[node] >= 0) {
+                end = i + 1;
+                id = token_id_[node];
             }
-            if (vocab_.count(chunk)) {
-                current_chunk = chunk;
-                found_in_vocab = true;
-                break;
+        }
+        if (id < 0) {
+            out.push_back(PieceSpan{ start, word.size(), true });
+            return; // If a chunk is not found, the rest of the word is unknown
+        }
+        out.push_back(PieceSpan{ start, end, false, id });
+        start = end;
+    }
+}
+
+void WordPieceModel::tokenize_spans(std::string_view word, std::vector<PieceSpan>& out) const {
+    if (word.empty()) return;
+    if (max_input_chars_per_word_ >= 0 && word.size() > static_cast<size_t>(max_input_chars_per_word_)) {
+        size_t chars = 0;
+        for (unsigned char c : word) chars += (c & 0xC0) != 0x80;
+        if (chars > static_cast<size_t>(max_input_chars_per_word_)) {
+            out.push_back(PieceSpan{ 0, word.size(), true });
+            return;
+        }
+    }
+    if (child_begin_.empty()) {
+        out.push_back(PieceSpan{ 0, word.size(), true });
+        return;
+    }
+
+    size_t pos = 0;        // end of the last popped piece
+    int32_t node = ROOT;
+    for (size_t i = 0; i < word.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(word[i]);
+        int32_t next;
+        while ((next = transition(node, c)) < 0) {
+            if (fail_[node] < 0) {
+                greedy_from(word, pos, out);
+                return;
             }
-            end--;
+            emit_pops(node, pos, out);
+            node = fail_[node];
         }
-        if (found_in_vocab) {
-            output_tokens.push_back(current_chunk);
-            start = end;
-        } else {
-            output_tokens.push_back(unk_token_);
-            break; // If a chunk is not found, the rest of the word is unknown
+        node = next;
+    }
+    while (node != SUFFIX_ROOT) {
+        if (fail_[node] < 0) {
+            greedy_from(word, pos, out);
+            return;
         }
+        emit_pops(node, pos, out);
+        node = fail_[node];
     }
-    return output_tokens;
 }
 
 std::vector<std::vector<std::string>> WordPieceModel::batch_tokenize(const std::vector<std::string>& words) const {
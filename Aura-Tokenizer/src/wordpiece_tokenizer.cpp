@@ -1,5 +1,6 @@
 #include "wordpiece_tokenizer.h"
 #include "tokenizer_exception.h"
+#include "wordpiece_trainer.h"
 
 namespace auratokenizer {
 
@@ -51,63 +52,71 @@ void WordPieceTokenizer::initialize_special_tokens() {
 }
 
 std::vector<Token> WordPieceTokenizer::encode(const std::string& text) {
-    if (!wordpiece_model_) {
-        throw TokenizerException("WordPieceModel not set for WordPieceTokenizer.");
-    }
-    std::string normalized_text = normalizer_.normalize(text);
-    // WordPiece typically works on pre-tokenized words (e.g., whitespace separated)
-    // For simplicity, we'll treat the whole normalized_text as one word for now.
-    // A proper implementation would use a pre-tokenizer here.
-    std::vector<std::string> word_pieces = wordpiece_model_->tokenize(normalized_text);
-
+    EncodeBuffer buffer;
+    encode_into(text, buffer);
     std::vector<Token> tokens;
-    for (const auto& piece : word_pieces) {
-        int id = vocab_->get_token_id(piece);
-        tokens.emplace_back(id, piece, vocab_->is_special_token(piece));
+    tokens.reserve(buffer.size());
+    for (size_t i = 0; i < buffer.size(); ++i) {
+        tokens.emplace_back(buffer.ids[i], vocab_->get_token(buffer.ids[i]), buffer.special[i] != 0, buffer.offsets[i]);
     }
     return tokens;
 }
 
 std::vector<int> WordPieceTokenizer::encode_to_ids(const std::string& text) {
+    EncodeBuffer buffer;
+    encode_into(text, buffer);
+    return std::move(buffer.ids);
+}
+
+void WordPieceTokenizer::encode_into(std::string_view text, EncodeBuffer& out) {
     if (!wordpiece_model_) {
         throw TokenizerException("WordPieceModel not set for WordPieceTokenizer.");
     }
-    std::string normalized_text = normalizer_.normalize(text);
-    std::vector<std::string> word_pieces = wordpiece_model_->tokenize(normalized_text);
-
-    std::vector<int> ids;
-    for (const auto& piece : word_pieces) {
-        ids.push_back(vocab_->get_token_id(piece));
+    out.clear();
+    const int unk_id = vocab_->get_token_id(wordpiece_model_->get_unk_token());
+    if (config_.base_model == ModelType::BERT) {
+        BertPipeline(*matcher_, bert_options(config_)).encode(text, unk_id, out);
+        return;
     }
-    return ids;
+
+    // Normalize as configured, then split on whitespace and punctuation only.
+    std::string_view input = normalizer_.normalize_view(text, out.normalized);
+    BertPipeline(*matcher_, split_only_options()).encode(input, unk_id, out);
+    if (!normalizer_.is_identity()) out.normalized.to_original(out.offsets);
 }
 
 std::string WordPieceTokenizer::decode(const std::vector<Token>& tokens) {
     std::string decoded_text;
+    bool first = true;
     for (const auto& token : tokens) {
-        // Remove ## for decoding
-        std::string piece = token.text;
-        if (piece.rfind("##", 0) == 0) {
-            piece = piece.substr(2);
+        if (token.text.empty()) continue;
+        // "##" joins onto the previous piece, anything else starts a new word
+        if (token.text.rfind("##", 0) == 0) {
+            decoded_text.append(token.text, 2, std::string::npos);
+        } else {
+            if (!first) decoded_text += ' ';
+            decoded_text += token.text;
         }
-        decoded_text += piece;
+        first = false;
     }
     return decoded_text;
 }
 
 std::string WordPieceTokenizer::decode_from_ids(const std::vector<int>& ids) {
+    // Share the joining rule with the streaming decoder.
+    DecodeStream stream = decode_stream();
     std::string decoded_text;
     for (int id : ids) {
-        std::string piece = vocab_->get_token(id);
-        // Remove ## for decoding
-        if (piece.rfind("##", 0) == 0) {
-            piece = piece.substr(2);
-        }
-        decoded_text += piece;
+        stream.step(id, decoded_text);
     }
+    stream.flush(decoded_text);
     return decoded_text;
 }
 
+DecodeStream WordPieceTokenizer::decode_stream(bool skip_special_tokens) const {
+    return DecodeStream(vocab_, DecodeStream::Mode::WORDPIECE, skip_special_tokens);
+}
+
 std::vector<std::vector<int>> WordPieceTokenizer::batch_encode(const std::vector<std::string>& texts) {
     std::vector<std::vector<int>> batch_ids;
     batch_ids.reserve(texts.size());
@@ -135,7 +144,12 @@ void WordPieceTokenizer::load(const std::string& path) {
 }
 
 void WordPieceTokenizer::train(const std::vector<std::string>& corpus, size_t vocab_size) {
-    throw TokenizerException("WordPieceTokenizer::train not implemented yet.");
+    WordPieceTrainer trainer(config_);
+    trainer.set_vocab_size(vocab_size);
+    trainer.train(corpus);
+    vocab_ = trainer.get_vocab();
+    initialize_special_tokens();
+    set_wordpiece_model(trainer.get_model());
 }
 
 void WordPieceTokenizer::add_special_tokens(const std::vector<std::string>& tokens) {
@@ -177,6 +191,25 @@ void WordPieceTokenizer::set_config(const TokenizerConfig& config) {
 void WordPieceTokenizer::set_vocab(std::shared_ptr<Vocab> vocab) {
     vocab_ = vocab;
     initialize_special_tokens();
+    sync_matcher();
+}
+
+void WordPieceTokenizer::sync_matcher() {
+    matcher_ = wordpiece_model_;
+    if (!wordpiece_model_) return;
+    // Pieces already in vocab_ (e.g. special tokens) keep their vocab id;
+    // rebuild the matcher only if that makes any id differ.
+    std::unordered_map<std::string, int> ids;
+    bool differs = false;
+    for (const auto& pair : wordpiece_model_->get_vocab()) {
+        int id = vocab_->get_token_id(pair.first);
+        differs |= id != pair.second;
+        ids.emplace(pair.first, id);
+    }
+    if (!differs) return;
+    auto remapped = std::make_shared<models::WordPieceModel>();
+    remapped->initialize(ids, wordpiece_model_->get_unk_token(), wordpiece_model_->get_max_input_chars_per_word());
+    matcher_ = remapped;
 }
 
 void WordPieceTokenizer::set_wordpiece_model(std::shared_ptr<models::WordPieceModel> model) {
@@ -187,6 +220,7 @@ void WordPieceTokenizer::set_wordpiece_model(std::shared_ptr<models::WordPieceMo
             vocab_->add_token_to_vocab(pair.first, pair.second);
         }
     }
+    sync_matcher();
 }
 
 } // namespace auratokenizer
@@ -0,0 +1,334 @@
+#include "wordpiece_trainer.h"
+#include "bert_pipeline.h"
+#include "tokenizer_exception.h"
+#include "utf8_scan.h"
+
+#include <algorithm>
+#include <fstream>
+#include <future>
+#include <thread>
+
+namespace auratokenizer {
+
+    namespace {
+
+        constexpr const char* kContinuation = "##";
+
+        bool is_continuation(const std::string& symbol) {
+            return symbol.size() > 2 && symbol.compare(0, 2, kContinuation) == 0;
+        }
+
+    } // namespace
+
+    WordPieceTrainer::WordPieceTrainer(const TokenizerConfig& config)
+        : min_frequency_(config.min_frequency),
+        vocab_size_(config.vocab_size),
+        normalizer_(config),
+        vocab_(std::make_shared<Vocab>())
+    {
+        config_ = config;
+    }
+
+    void WordPieceTrainer::set_vocab_size(size_t size) {
+        if (size == 0) throw TokenizerException("Vocabulary size must be positive");
+        vocab_size_ = size;
+        config_.vocab_size = size;
+    }
+
+    void WordPieceTrainer::set_min_frequency(size_t freq) {
+        if (freq == 0) throw TokenizerException("Minimum frequency must be at least 1");
+        min_frequency_ = freq;
+        config_.min_frequency = freq;
+    }
+
+    TokenizerConfig WordPieceTrainer::get_config() const {
+        return config_;
+    }
+
+    void WordPieceTrainer::set_config(const TokenizerConfig& config) {
+        config_ = config;
+        min_frequency_ = config.min_frequency;
+        vocab_size_ = config.vocab_size;
+        normalizer_.set_config(config);
+    }
+
+    std::shared_ptr<Vocab> WordPieceTrainer::get_vocab() const {
+        return vocab_;
+    }
+
+    std::shared_ptr<models::WordPieceModel> WordPieceTrainer::get_model() const {
+        auto model = std::make_shared<models::WordPieceModel>();
+        model->initialize(vocab_->get_token_to_id(), config_.unk_token);
+        return model;
+    }
+
+    // -- Counting --
+
+    void WordPieceTrainer::count_words(std::string_view text, CorpusCounts& counts) const {
+        thread_local std::string key;
+        if (config_.base_model == ModelType::BERT) {
+            // Exactly the words WordPieceTokenizer's BERT pipeline will match.
+            BertPipeline::split_words(text, bert_options(config_), [&](std::string_view word) {
+                key.assign(word.data(), word.size());
+                counts[key]++;
+            });
+            return;
+        }
+        // Likewise for the normalize-then-split path of other configs.
+        std::string normalized = normalizer_.normalize(std::string(text));
+        BertPipeline::split_words(normalized, split_only_options(), [&](std::string_view word) {
+            key.assign(word.data(), word.size());
+            counts[key]++;
+        });
+    }
+
+    void WordPieceTrainer::train(const std::vector<std::string>& texts) {
+        if (texts.empty()) {
+            throw TokenizerException("Empty corpus provided for WordPieceTrainer::train");
+        }
+        size_t threads = num_threads_ ? num_threads_ : std::max<size_t>(1, std::thread::hardware_concurrency());
+        threads = std::min(threads, std::max<size_t>(1, texts.size() / 256));
+        const size_t per_thread = (texts.size() + threads - 1) / threads;
+
+        auto count_range = [&](size_t begin, size_t end) {
+            CorpusCounts counts;
+            for (size_t i = begin; i < end; ++i) count_words(texts[i], counts);
+            return counts;
+        };
+        std::vector<std::future<CorpusCounts>> futures;
+        for (size_t t = 1; t < threads; ++t) {
+            size_t begin = std::min(texts.size(), t * per_thread);
+            size_t end = std::min(texts.size(), begin + per_thread);
+            futures.push_back(std::async(std::launch::async, count_range, begin, end));
+        }
+        word_counts_ = count_range(0, std::min(texts.size(), per_thread));
+        for (auto& fut : futures) {
+            CorpusCounts part = fut.get();
+            if (part.size() > word_counts_.size()) word_counts_.swap(part);
+            for (auto& [word, count] : part) word_counts_[word] += count;
+        }
+        train_words();
+    }
+
+    void WordPieceTrainer::train_from_file(const std::string& file_path) {
+        train_from_files({ file_path });
+    }
+
+    void WordPieceTrainer::train_from_files(const std::vector<std::string>& file_paths) {
+        if (file_paths.empty()) {
+            throw TokenizerException("No file paths provided for WordPieceTrainer::train_from_files");
+        }
+        word_counts_ = count_corpus_files(file_paths,
+            [this](std::string_view line, CorpusCounts& counts) { count_words(line, counts); },
+            num_threads_);
+        if (word_counts_.empty()) throw TokenizerException("Empty corpus provided for training");
+        train_words();
+    }
+
+    // -- Merge state --
+
+    uint32_t WordPieceTrainer::intern(const std::string& text) {
+        auto it = symbol_ids_.find(text);
+        if (it != symbol_ids_.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(symbols_.size());
+        symbols_.push_back(text);
+        symbol_ids_.emplace(text, id);
+        symbol_counts_.push_back(0);
+        symbol_pairs_.emplace_back();
+        return id;
+    }
+
+    void WordPieceTrainer::add_pair(uint32_t left, uint32_t right, int64_t delta, uint32_t word) {
+        uint64_t key = pack(left, right);
+        int64_t& count = pair_counts_[key];
+        count += delta;
+        if (delta <= 0) return;
+        auto& list = pair_words_[key];
+        if (list.empty()) {
+            // First sighting: let both symbols find this pair when their counts change.
+            symbol_pairs_[left].push_back(key);
+            if (right != left) symbol_pairs_[right].push_back(key);
+        }
+        if (list.empty() || list.back() != word) list.push_back(word);
+    }
+
+    bool WordPieceTrainer::heap_less(const PairEntry& a, const PairEntry& b) const {
+        // score = count / (left_count * right_count), compared without division.
+        long double sa = static_cast<long double>(a.count) * b.left_count * b.right_count;
+        long double sb = static_cast<long double>(b.count) * a.left_count * a.right_count;
+        if (sa != sb) return sa < sb;
+        if (a.count != b.count) return a.count < b.count;
+        // Equal scores and counts: the lexicographically smaller pair ranks higher.
+        if (a.left != b.left) return symbols_[a.left] > symbols_[b.left];
+        return symbols_[a.right] > symbols_[b.right];
+    }
+
+    void WordPieceTrainer::push_pair(uint64_t key) {
+        auto it = pair_counts_.find(key);
+        if (it == pair_counts_.end() || it->second < static_cast<int64_t>(min_frequency_)) return;
+        uint32_t left = static_cast<uint32_t>(key >> 32), right = static_cast<uint32_t>(key);
+        heap_.push_back(PairEntry{ it->second, symbol_counts_[left], symbol_counts_[right], left, right });
+        std::push_heap(heap_.begin(), heap_.end(), [this](const PairEntry& a, const PairEntry& b) { return heap_less(a, b); });
+    }
+
+    void WordPieceTrainer::apply_merge(uint32_t left, uint32_t right, uint32_t merged) {
+        auto found = pair_words_.find(pack(left, right));
+        if (found == pair_words_.end()) return;
+        std::vector<uint32_t> affected = std::move(found->second);
+        pair_words_.erase(found);
+        std::sort(affected.begin(), affected.end());
+        affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+
+        std::vector<uint32_t> rewritten;
+        std::vector<uint64_t> rescore;
+        for (uint32_t w : affected) {
+            Word& word = words_[w];
+            const auto& old = word.symbols;
+            rewritten.clear();
+            int64_t merges = 0;
+            for (size_t i = 0; i < old.size(); ++i) {
+                if (i + 1 < old.size() && old[i] == left && old[i + 1] == right) {
+                    rewritten.push_back(merged);
+                    ++merges;
+                    ++i;
+                } else {
+                    rewritten.push_back(old[i]);
+                }
+            }
+            if (merges == 0) continue; // stale index entry
+
+            for (size_t i = 0; i + 1 < old.size(); ++i) {
+                add_pair(old[i], old[i + 1], -word.count, w);
+                rescore.push_back(pack(old[i], old[i + 1]));
+            }
+            for (size_t i = 0; i + 1 < rewritten.size(); ++i) {
+                add_pair(rewritten[i], rewritten[i + 1], word.count, w);
+                rescore.push_back(pack(rewritten[i], rewritten[i + 1]));
+            }
+            symbol_counts_[left] -= merges * word.count;
+            symbol_counts_[right] -= merges * word.count;
+            symbol_counts_[merged] += merges * word.count;
+            word.symbols.swap(rewritten);
+        }
+        pair_counts_.erase(pack(left, right));
+
+        // Every live pair touching left or right has a new denominator.
+        for (uint32_t symbol : { left, right }) {
+            auto& pairs = symbol_pairs_[symbol];
+            pairs.erase(std::remove_if(pairs.begin(), pairs.end(), [this](uint64_t key) {
+                auto it = pair_counts_.find(key);
+                return it == pair_counts_.end() || it->second <= 0;
+            }), pairs.end());
+            rescore.insert(rescore.end(), pairs.begin(), pairs.end());
+        }
+        std::sort(rescore.begin(), rescore.end());
+        rescore.erase(std::unique(rescore.begin(), rescore.end()), rescore.end());
+        for (uint64_t key : rescore) push_pair(key);
+    }
+
+    void WordPieceTrainer::learn_merges() {
+        pair_counts_.clear();
+        pair_words_.clear();
+        heap_.clear();
+        for (uint32_t w = 0; w < words_.size(); ++w) {
+            const Word& word = words_[w];
+            for (size_t i = 0; i + 1 < word.symbols.size(); ++i) {
+                add_pair(word.symbols[i], word.symbols[i + 1], word.count, w);
+            }
+        }
+        auto less = [this](const PairEntry& a, const PairEntry& b) { return heap_less(a, b); };
+        for (const auto& [key, count] : pair_counts_) {
+            if (count < static_cast<int64_t>(min_frequency_)) continue;
+            uint32_t left = static_cast<uint32_t>(key >> 32), right = static_cast<uint32_t>(key);
+            heap_.push_back(PairEntry{ count, symbol_counts_[left], symbol_counts_[right], left, right });
+        }
+        std::make_heap(heap_.begin(), heap_.end(), less);
+
+        while (vocab_->size() < vocab_size_ && !heap_.empty()) {
+            std::pop_heap(heap_.begin(), heap_.end(), less);
+            PairEntry top = heap_.back();
+            heap_.pop_back();
+
+            // Any change since the push re-pushed the pair; this entry is just stale.
+            auto it = pair_counts_.find(pack(top.left, top.right));
+            if (it == pair_counts_.end() || it->second != top.count
+                || symbol_counts_[top.left] != top.left_count || symbol_counts_[top.right] != top.right_count) {
+                continue;
+            }
+
+            const std::string& right_text = symbols_[top.right];
+            uint32_t merged = intern(symbols_[top.left] + right_text.substr(is_continuation(right_text) ? 2 : 0));
+            vocab_->add_token(symbols_[merged]);
+            apply_merge(top.left, top.right, merged);
+        }
+        heap_.clear();
+        pair_words_.clear();
+    }
+
+    void WordPieceTrainer::train_words() {
+        symbols_.clear();
+        symbol_ids_.clear();
+        symbol_counts_.clear();
+        symbol_pairs_.clear();
+
+        // Sorted so word indices (and therefore the run) are reproducible.
+        std::vector<std::pair<std::string, size_t>> sorted(word_counts_.begin(), word_counts_.end());
+        std::sort(sorted.begin(), sorted.end());
+        words_.clear();
+        words_.reserve(sorted.size());
+        std::string symbol;
+        for (const auto& [text, count] : sorted) {
+            Word word{ {}, static_cast<int64_t>(count) };
+            for (size_t i = 0; i < text.size(); ) {
+                size_t len = std::min(utf8_length(static_cast<unsigned char>(text[i])), text.size() - i);
+                symbol.assign(i == 0 ? "" : kContinuation);
+                symbol.append(text, i, len);
+                uint32_t id = intern(symbol);
+                symbol_counts_[id] += word.count;
+                word.symbols.push_back(id);
+                i += len;
+            }
+            words_.push_back(std::move(word));
+        }
+
+        vocab_ = std::make_shared<Vocab>();
+        if (!config_.unk_token.empty()) vocab_->add_special_token(config_.unk_token, SpecialTokenType::UNK);
+        if (!config_.pad_token.empty()) vocab_->add_special_token(config_.pad_token, SpecialTokenType::PAD);
+        if (!config_.bos_token.empty()) vocab_->add_special_token(config_.bos_token, SpecialTokenType::BOS);
+        if (!config_.eos_token.empty()) vocab_->add_special_token(config_.eos_token, SpecialTokenType::EOS);
+        if (!config_.mask_token.empty()) vocab_->add_special_token(config_.mask_token, SpecialTokenType::MASK);
+        if (!config_.sep_token.empty()) vocab_->add_special_token(config_.sep_token, SpecialTokenType::SEP);
+        if (!config_.cls_token.empty()) vocab_->add_special_token(config_.cls_token, SpecialTokenType::CLS);
+
+        // The whole alphabet, word-initial and "##" forms, so every seen word can be spelled.
+        std::vector<std::string> alphabet(symbols_.begin(), symbols_.end());
+        std::sort(alphabet.begin(), alphabet.end());
+        for (const auto& text : alphabet) vocab_->add_token(text);
+
+        learn_merges();
+    }
+
+    // -- Persistence --
+
+    void WordPieceTrainer::save(const std::string& path) {
+        std::ofstream outfile(path, std::ios::binary);
+        if (!outfile.is_open()) {
+            throw TokenizerException("Failed to open file for writing: " + path);
+        }
+        config_.save(outfile);
+        vocab_->save(outfile);
+    }
+
+    void WordPieceTrainer::load(const std::string& path) {
+        std::ifstream infile(path, std::ios::binary);
+        if (!infile.is_open()) {
+            throw TokenizerException("Failed to open file for reading: " + path);
+        }
+        TokenizerConfig config;
+        config.load(infile);
+        set_config(config);
+        vocab_ = std::make_shared<Vocab>();
+        vocab_->load(infile);
+    }
+
+} // namespace auratokenizer
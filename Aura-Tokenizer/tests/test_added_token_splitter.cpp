@@ -0,0 +1,96 @@
+#include "added_token_splitter.h"
+#include "bpe_tokenizer.h"
+#include <gtest/gtest.h>
+
+namespace auratokenizer {
+namespace {
+
+using Segment = AddedTokenSplitter::Segment;
+
+std::vector<std::string> pieces(const std::string& text, const std::vector<Segment>& segments) {
+    std::vector<std::string> result;
+    for (const auto& s : segments) {
+        std::string piece = text.substr(s.begin, s.end - s.begin);
+        result.push_back(s.id >= 0 ? "<" + std::to_string(s.id) + ">" + piece : piece);
+    }
+    return result;
+}
+
+TEST(AddedTokenSplitter, FindsChatMarkers) {
+    AddedTokenSplitter splitter;
+    splitter.build({ { "<|im_start|>", 1 }, { "<|im_end|>", 2 } });
+
+    const std::string text = "<|im_start|>user\nhi<|im_end|>\n<|im_start|>";
+    std::vector<Segment> segments;
+    splitter.split(text, segments);
+    std::vector<std::string> expected = { "<1><|im_start|>", "user\nhi", "<2><|im_end|>", "\n", "<1><|im_start|>" };
+    EXPECT_EQ(pieces(text, segments), expected);
+
+    splitter.split("<|im_sta", segments);
+    ASSERT_EQ(segments.size(), 1u);
+    EXPECT_EQ(segments[0].id, -1);
+}
+
+TEST(AddedTokenSplitter, LeftmostLongestOnOverlaps) {
+    AddedTokenSplitter splitter;
+    splitter.build({ { "ab", 1 }, { "abcd", 2 }, { "bcde", 3 }, { "e", 4 } });
+
+    std::vector<Segment> segments;
+    const std::string text = "xabcdex abcx bcdex";
+    splitter.split(text, segments);
+    std::vector<std::string> expected = { "x", "<2>abcd", "<4>e", "x ", "<1>ab", "cx ", "<3>bcde", "x" };
+    EXPECT_EQ(pieces(text, segments), expected);
+}
+
+TEST(AddedTokenSplitter, StripAndSingleWord) {
+    AddedTokenSplitter splitter;
+    AddedToken mask{ "<mask>", 1 };
+    mask.lstrip = true;
+    mask.rstrip = true;
+    AddedToken word{ "cat", 2 };
+    word.single_word = true;
+    splitter.build({ mask, word });
+
+    std::vector<Segment> segments;
+    std::string text = "a  <mask>\t b";
+    splitter.split(text, segments);
+    std::vector<std::string> expected = { "a", "<1>  <mask>\t ", "b" };
+    EXPECT_EQ(pieces(text, segments), expected);
+
+    text = "concat cat_ cat, (cat)";
+    splitter.split(text, segments);
+    expected = { "concat cat_ ", "<2>cat", ", (", "<2>cat", ")" };
+    EXPECT_EQ(pieces(text, segments), expected);
+}
+
+TEST(AddedTokenSplitter, BPEKeepsSpecialTokensWhole) {
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NONE;
+    config.byte_level = true;
+    BPETokenizer tokenizer(config);
+    auto vocab = std::make_shared<Vocab>();
+    tokenizer.set_vocab(vocab);
+    for (int b = 0; b < 256; ++b) vocab->add_token(byte_level::to_unicode(std::string(1, static_cast<char>(b))));
+    tokenizer.add_tokens({ { "<|im_start|>", -1 }, { "<|im_end|>", -1 } });
+    int start_id = vocab->get_token_id("<|im_start|>");
+    int end_id = vocab->get_token_id("<|im_end|>");
+    int cls_id = tokenizer.get_special_token_id(SpecialTokenType::CLS);
+
+    const std::string text = "[CLS]<|im_start|>hi<|im_end|>";
+    EncodeBuffer buffer;
+    tokenizer.encode_into(text, buffer);
+    std::vector<int> expected = { cls_id, start_id, vocab->get_token_id("h"), vocab->get_token_id("i"), end_id };
+    EXPECT_EQ(buffer.ids, expected);
+    EXPECT_EQ(buffer.offsets[1].start, 5);
+    EXPECT_EQ(buffer.offsets[1].end, 17);
+    EXPECT_TRUE(buffer.special[1]);
+    EXPECT_FALSE(buffer.special[2]);
+
+    std::vector<Token> tokens = tokenizer.encode(text);
+    ASSERT_EQ(tokens.size(), expected.size());
+    EXPECT_EQ(tokens[1].text, "<|im_start|>");
+    EXPECT_EQ(tokenizer.decode_from_ids(buffer.ids), text);
+}
+
+} // namespace
+} // namespace auratokenizer
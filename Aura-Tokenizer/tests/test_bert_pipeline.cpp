@@ -0,0 +1,130 @@
+#include "bert_pipeline.h"
+#include "wordpiece_tokenizer.h"
+#include <gtest/gtest.h>
+
+namespace auratokenizer {
+namespace {
+
+std::unordered_map<std::string, int> bert_vocab() {
+    return { { "[UNK]", 0 }, { "hello", 1 }, { ",", 2 }, { "world", 3 }, { "!", 4 }, { "un", 5 },
+             { "##aff", 6 }, { "##able", 7 }, { "cafe", 8 }, { "\xE6\x88\x91", 9 }, { "\xE7\x88\xB1", 10 },
+             { "ab", 11 }, { "Hello", 12 } };
+}
+
+std::vector<std::pair<int, int>> offsets_of(const EncodeBuffer& out) {
+    std::vector<std::pair<int, int>> result;
+    for (const auto& o : out.offsets) result.emplace_back(o.start, o.end);
+    return result;
+}
+
+TEST(BertPipeline, SplitsNormalizesAndTracksOffsets) {
+    models::WordPieceModel model;
+    model.initialize(bert_vocab(), "[UNK]");
+    BertPipeline pipeline(model, BertOptions());
+
+    EncodeBuffer out;
+    pipeline.encode("Hello, World!  unaffable", 0, out);
+    EXPECT_EQ(out.ids, (std::vector<int>{ 1, 2, 3, 4, 5, 6, 7 }));
+    EXPECT_EQ(offsets_of(out), (std::vector<std::pair<int, int>>{
+        { 0, 5 }, { 5, 6 }, { 7, 12 }, { 12, 13 }, { 15, 17 }, { 17, 20 }, { 20, 24 } }));
+
+    // Accents are stripped, but offsets cover the original two-byte character.
+    out.clear();
+    pipeline.encode("CAF\xC3\x89", 0, out);
+    EXPECT_EQ(out.ids, (std::vector<int>{ 8 }));
+    EXPECT_EQ(offsets_of(out), (std::vector<std::pair<int, int>>{ { 0, 5 } }));
+
+    // CJK ideographs are words of their own; U+3000 and NBSP are whitespace.
+    out.clear();
+    pipeline.encode("\xE6\x88\x91\xE7\x88\xB1\xE3\x80\x80hello\xC2\xA0world", 0, out);
+    EXPECT_EQ(out.ids, (std::vector<int>{ 9, 10, 1, 3 }));
+    EXPECT_EQ(out.offsets[1].start, 3);
+    EXPECT_EQ(out.offsets[2].start, 9);
+
+    // Control characters and invalid bytes vanish without splitting the word.
+    out.clear();
+    pipeline.encode("a\x01" "b \xFF", 0, out);
+    EXPECT_EQ(out.ids, (std::vector<int>{ 11 }));
+    EXPECT_EQ(offsets_of(out), (std::vector<std::pair<int, int>>{ { 0, 3 } }));
+
+    // Unknown words are flagged special.
+    out.clear();
+    pipeline.encode("hello xyz", 0, out);
+    EXPECT_EQ(out.ids, (std::vector<int>{ 1, 0 }));
+    EXPECT_EQ(out.special, (std::vector<uint8_t>{ 0, 1 }));
+}
+
+TEST(BertPipeline, CasedOptionsKeepCaseAndAccents) {
+    models::WordPieceModel model;
+    model.initialize(bert_vocab(), "[UNK]");
+    BertOptions options;
+    options.lowercase = false;
+    options.strip_accents = false;
+    BertPipeline pipeline(model, options);
+
+    EncodeBuffer out;
+    pipeline.encode("Hello caf\xC3\xA9", 0, out);
+    EXPECT_EQ(out.ids, (std::vector<int>{ 12, 0 }));
+}
+
+TEST(BertPipeline, WordPieceTokenizerUsesPipelineForBert) {
+    TokenizerConfig config;
+    config.base_model = ModelType::BERT;
+    config.lowercase = true;
+    WordPieceTokenizer tokenizer(config);
+    auto model = std::make_shared<models::WordPieceModel>();
+    model->initialize(bert_vocab(), "[UNK]");
+    tokenizer.set_wordpiece_model(model);
+
+    std::vector<int> ids = tokenizer.encode_to_ids("Hello, unaffable world!");
+    ASSERT_EQ(ids.size(), 7u);
+    EXPECT_EQ(tokenizer.decode_from_ids(ids), "hello , unaffable world !");
+
+    std::vector<Token> tokens = tokenizer.encode("Hello, unaffable");
+    ASSERT_EQ(tokens.size(), 5u);
+    EXPECT_EQ(tokens[3].text, "##aff");
+    EXPECT_EQ(tokens[3].offset.start, 9);
+    EXPECT_EQ(tokens[3].offset.end, 12);
+}
+
+TEST(BertPipeline, DefaultBertConfigCleansText) {
+    TokenizerConfig config;
+    config.base_model = ModelType::BERT;
+    WordPieceTokenizer tokenizer(config);
+    auto model = std::make_shared<models::WordPieceModel>();
+    model->initialize(bert_vocab(), "[UNK]");
+    tokenizer.set_wordpiece_model(model);
+
+    EXPECT_EQ(tokenizer.encode_to_ids("a\x01" "b"), (std::vector<int>{ 11 }));
+    config.clean_text = false;
+    EXPECT_FALSE(bert_options(config).clean_text);
+}
+
+TEST(BertPipeline, LowercaseStripsAccentsOnlyWhenAsked) {
+    TokenizerConfig config;
+    config.lowercase = true;
+    EXPECT_TRUE(bert_options(config).lowercase);
+    EXPECT_FALSE(bert_options(config).strip_accents);
+    config.strip_accents_with_lowercase = true;
+    EXPECT_TRUE(bert_options(config).strip_accents);
+    config.lowercase = false;
+    EXPECT_FALSE(bert_options(config).strip_accents);
+    config.strip_accents = true;
+    EXPECT_TRUE(bert_options(config).strip_accents);
+
+    // Uncased but accented: "CAFÉ" becomes "café", which is not "cafe".
+    models::WordPieceModel model;
+    model.initialize(bert_vocab(), "[UNK]");
+    config = TokenizerConfig();
+    config.lowercase = true;
+    EncodeBuffer out;
+    BertPipeline(model, bert_options(config)).encode("CAF\xC3\x89", 0, out);
+    EXPECT_EQ(out.ids, (std::vector<int>{ 0 }));
+    config.strip_accents_with_lowercase = true;
+    out.clear();
+    BertPipeline(model, bert_options(config)).encode("CAF\xC3\x89", 0, out);
+    EXPECT_EQ(out.ids, (std::vector<int>{ 8 }));
+}
+
+} // namespace
+} // namespace auratokenizer
@@ -0,0 +1,96 @@
+#include "bpe_merge_engine.h"
+#include <gtest/gtest.h>
+
+#include <random>
+#include <unordered_map>
+
+namespace auratokenizer {
+namespace {
+
+// Reference implementation: the original rescanning string-based merge loop.
+std::vector<std::string> naive_merge(const std::string& word,
+                                     const std::vector<std::pair<std::string, std::string>>& merges) {
+    std::unordered_map<std::string, int> ranks;
+    for (size_t i = 0; i < merges.size(); ++i) {
+        ranks[merges[i].first + " " + merges[i].second] = static_cast<int>(i);
+    }
+    std::vector<std::string> parts;
+    for (char c : word) parts.emplace_back(1, c);
+    while (parts.size() > 1) {
+        int best_rank = -1;
+        int merge_idx = -1;
+        for (size_t i = 0; i + 1 < parts.size(); ++i) {
+            auto it = ranks.find(parts[i] + " " + parts[i + 1]);
+            if (it != ranks.end() && (best_rank == -1 || it->second < best_rank)) {
+                best_rank = it->second;
+                merge_idx = static_cast<int>(i);
+            }
+        }
+        if (merge_idx == -1) break;
+        parts[merge_idx] += parts[merge_idx + 1];
+        parts.erase(parts.begin() + merge_idx + 1);
+    }
+    return parts;
+}
+
+std::vector<std::string> engine_merge(const BPEMergeEngine& engine, const std::string& word) {
+    std::vector<uint32_t> symbols;
+    engine.merge_word(word, symbols);
+    std::vector<std::string> parts;
+    for (uint32_t s : symbols) parts.push_back(engine.symbol_text(s));
+    return parts;
+}
+
+TEST(BPEMergeEngine, EmptyRulesSplitsBytes) {
+    BPEMergeEngine engine;
+    auto parts = engine_merge(engine, "abc");
+    ASSERT_EQ(parts.size(), 3u);
+    EXPECT_EQ(parts[0], "a");
+    EXPECT_EQ(parts[2], "c");
+}
+
+TEST(BPEMergeEngine, LowestRankLeftmostFirst) {
+    std::vector<std::pair<std::string, std::string>> merges = {
+        {"a", "a"}, {"aa", "a"}, {"b", "c"}, {"a", "bc"}
+    };
+    BPEMergeEngine engine;
+    engine.build(merges);
+    for (const std::string word : {"aaa", "aaaa", "aaaaa", "abc", "aabcaa", "cba"}) {
+        EXPECT_EQ(engine_merge(engine, word), naive_merge(word, merges)) << word;
+    }
+}
+
+TEST(BPEMergeEngine, DuplicateRuleUsesLastRank) {
+    std::vector<std::pair<std::string, std::string>> merges = {
+        {"a", "b"}, {"b", "c"}, {"a", "b"}
+    };
+    BPEMergeEngine engine;
+    engine.build(merges);
+    EXPECT_EQ(engine_merge(engine, "abc"), naive_merge("abc", merges));
+}
+
+TEST(BPEMergeEngine, MatchesNaiveOnRandomRules) {
+    std::mt19937 rng(1234);
+    const std::string alphabet = "abcd";
+    for (int round = 0; round < 20; ++round) {
+        std::vector<std::string> pieces = { "a", "b", "c", "d" };
+        std::vector<std::pair<std::string, std::string>> merges;
+        for (int i = 0; i < 30; ++i) {
+            const std::string& l = pieces[rng() % pieces.size()];
+            const std::string& r = pieces[rng() % pieces.size()];
+            merges.emplace_back(l, r);
+            pieces.push_back(l + r);
+        }
+        BPEMergeEngine engine;
+        engine.build(merges);
+        for (int w = 0; w < 50; ++w) {
+            std::string word;
+            size_t len = 1 + rng() % 24;
+            for (size_t i = 0; i < len; ++i) word += alphabet[rng() % alphabet.size()];
+            EXPECT_EQ(engine_merge(engine, word), naive_merge(word, merges)) << word;
+        }
+    }
+}
+
+} // namespace
+} // namespace auratokenizer
@@ -0,0 +1,121 @@
+#include "bpe_tokenizer.h"
+#include "bpe_trainer.h"
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <sstream>
+
+namespace auratokenizer {
+namespace {
+
+using Merges = std::vector<std::pair<std::string, std::string>>;
+
+TokenizerConfig trainer_config() {
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NONE;
+    config.min_frequency = 1;
+    return config;
+}
+
+// Straightforward reference: recount every pair after each merge.
+Merges naive_merges(const std::vector<std::string>& corpus, size_t num_merges) {
+    std::map<std::vector<std::string>, int> words;
+    for (const auto& line : corpus) {
+        std::istringstream iss(line);
+        std::string w;
+        while (iss >> w) {
+            std::vector<std::string> symbols;
+            for (char c : w) symbols.emplace_back(1, c);
+            words[symbols]++;
+        }
+    }
+    Merges merges;
+    while (merges.size() < num_merges) {
+        std::map<std::pair<std::string, std::string>, int> counts;
+        for (const auto& [symbols, count] : words) {
+            for (size_t i = 0; i + 1 < symbols.size(); ++i) counts[{ symbols[i], symbols[i + 1] }] += count;
+        }
+        if (counts.empty()) break;
+        auto best = counts.begin();
+        for (auto it = counts.begin(); it != counts.end(); ++it) {
+            if (it->second > best->second) best = it; // map order = lexicographic tie-break
+        }
+        merges.push_back(best->first);
+        std::map<std::vector<std::string>, int> next;
+        for (const auto& [symbols, count] : words) {
+            std::vector<std::string> out;
+            for (size_t i = 0; i < symbols.size(); ++i) {
+                if (i + 1 < symbols.size() && symbols[i] == best->first.first && symbols[i + 1] == best->first.second) {
+                    out.push_back(symbols[i] + symbols[i + 1]);
+                    ++i;
+                } else {
+                    out.push_back(symbols[i]);
+                }
+            }
+            next[out] += count;
+        }
+        words.swap(next);
+    }
+    return merges;
+}
+
+TEST(BPETrainer, MatchesNaiveRecount) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> letter(0, 3), length(1, 9);
+    std::vector<std::string> corpus;
+    for (int line = 0; line < 200; ++line) {
+        std::string text;
+        for (int w = 0; w < 6; ++w) {
+            int n = length(rng);
+            for (int i = 0; i < n; ++i) text.push_back(static_cast<char>('a' + letter(rng)));
+            text.push_back(' ');
+        }
+        corpus.push_back(text);
+    }
+
+    BPETrainer trainer(trainer_config());
+    auto vocab = std::make_shared<Vocab>();
+    const size_t base = 7 + 4; // special tokens + alphabet
+    trainer.train(corpus, vocab, base + 60);
+    Merges expected = naive_merges(corpus, 60);
+    EXPECT_EQ(trainer.get_merge_rules(), expected);
+    EXPECT_EQ(vocab->size(), base + 60);
+
+    BPETrainer again(trainer_config());
+    again.train(corpus, std::make_shared<Vocab>(), base + 60);
+    EXPECT_EQ(again.get_merge_rules(), trainer.get_merge_rules());
+}
+
+TEST(BPETrainer, StopsBelowMinFrequency) {
+    TokenizerConfig config = trainer_config();
+    config.min_frequency = 3;
+    BPETrainer trainer(config);
+    auto vocab = std::make_shared<Vocab>();
+    trainer.train({ "ab ab ab cd cd" }, vocab, 100);
+    Merges expected = { { "a", "b" } };
+    EXPECT_EQ(trainer.get_merge_rules(), expected);
+}
+
+TEST(BPETrainer, TrainedTokenizerEncodesWholeWords) {
+    BPETokenizer tokenizer(trainer_config());
+    tokenizer.train({ "low lower lowest", "low low newer" }, 40);
+    std::vector<Token> tokens = tokenizer.encode("low");
+    ASSERT_EQ(tokens.size(), 1u);
+    EXPECT_EQ(tokens[0].text, "low");
+    EXPECT_EQ(tokenizer.decode(tokenizer.encode("lowest newer")), "lowestnewer");
+}
+
+TEST(BPETrainer, ByteLevelMergesUseMappedAlphabet) {
+    TokenizerConfig config = trainer_config();
+    config.byte_level = true;
+    BPETrainer trainer(config);
+    auto vocab = std::make_shared<Vocab>();
+    trainer.train({ "a a a" }, vocab, 7 + 256 + 1);
+    Merges expected = { { "\xC4\xA0", "a" } }; // "Ġ" is the mapped space
+    EXPECT_EQ(trainer.get_merge_rules(), expected);
+    EXPECT_TRUE(vocab->has_token("\xC4\xA0" "a"));
+}
+
+} // namespace
+} // namespace auratokenizer
@@ -0,0 +1,96 @@
+#include "bpe_word_cache.h"
+#include "bpe_tokenizer.h"
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace auratokenizer {
+namespace {
+
+TEST(BPEWordCache, DisabledByZeroCapacity) {
+    BPEWordCache cache(0);
+    std::vector<BPEWordCache::Piece> out;
+    cache.insert("hello", { {1, 2, false} });
+    EXPECT_FALSE(cache.lookup("hello", out));
+    EXPECT_EQ(cache.stats().entries, 0u);
+}
+
+TEST(BPEWordCache, HitMissAndEviction) {
+    BPEWordCache cache(4096, 1);
+    std::vector<BPEWordCache::Piece> out;
+    EXPECT_FALSE(cache.lookup("w0", out));
+
+    for (int i = 0; i < 200; ++i) {
+        cache.insert("w" + std::to_string(i), { {i, static_cast<uint32_t>(i), false} });
+    }
+    auto stats = cache.stats();
+    EXPECT_LE(stats.bytes, stats.capacity_bytes);
+    EXPECT_GT(stats.evictions, 0u);
+    EXPECT_EQ(stats.misses, 1u);
+
+    ASSERT_TRUE(cache.lookup("w199", out));
+    ASSERT_EQ(out.size(), 1u);
+    EXPECT_EQ(out[0].id, 199);
+    EXPECT_EQ(cache.stats().hits, 1u);
+
+    cache.clear();
+    EXPECT_EQ(cache.stats().entries, 0u);
+}
+
+TEST(BPEWordCache, ReferencedEntriesSurviveOneSweep) {
+    BPEWordCache cache(1024, 1);
+    std::vector<BPEWordCache::Piece> out;
+    cache.insert("hot", { {7, 7, false} });
+    for (int i = 0; i < 20; ++i) {
+        ASSERT_TRUE(cache.lookup("hot", out));
+        cache.insert("cold" + std::to_string(i), { {i, 0, false} });
+    }
+    EXPECT_TRUE(cache.lookup("hot", out));
+}
+
+TEST(BPEWordCache, TokenizerResultsMatchUncached) {
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NONE;
+    BPETokenizer plain(config);
+    config.encode_cache_bytes = 1 << 20;
+    BPETokenizer cached(config);
+
+    std::vector<std::string> merges = { "l o", "lo w", "e r", "low er" };
+    for (BPETokenizer* t : { &plain, &cached }) {
+        auto vocab = std::make_shared<Vocab>();
+        t->set_vocab(vocab);
+        for (const std::string tok : { "l", "o", "w", "e", "r", "lo", "low", "er", "lower" }) vocab->add_token(tok);
+        t->set_merge_rules(merges);
+    }
+
+    const std::string text = "lower low lower newer lower";
+    EXPECT_EQ(cached.encode_to_ids(text), plain.encode_to_ids(text));
+    EXPECT_EQ(cached.encode_to_ids(text), plain.encode_to_ids(text));
+    auto stats = cached.get_cache_stats();
+    EXPECT_GT(stats.hits, 0u);
+
+    // Changing the model must invalidate cached words.
+    cached.set_merge_rules({ "l o" });
+    plain.set_merge_rules({ "l o" });
+    EXPECT_EQ(cached.encode_to_ids(text), plain.encode_to_ids(text));
+}
+
+TEST(BPEWordCache, ConcurrentAccess) {
+    BPEWordCache cache(1 << 16);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&cache, t]() {
+            std::vector<BPEWordCache::Piece> out;
+            for (int i = 0; i < 2000; ++i) {
+                std::string word = "w" + std::to_string((i * 7 + t) % 300);
+                if (!cache.lookup(word, out)) cache.insert(word, { {i, 0, false} });
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.hits + stats.misses, 8000u);
+}
+
+} // namespace
+} // namespace auratokenizer
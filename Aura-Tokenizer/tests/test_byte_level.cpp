@@ -0,0 +1,94 @@
+#include "byte_level.h"
+#include "byte_level_pre_tokenizer.h"
+#include "bpe_tokenizer.h"
+#include <gtest/gtest.h>
+
+namespace auratokenizer {
+namespace {
+
+std::vector<std::string> split_text(const std::string& text, ByteLevelPattern pattern) {
+    std::vector<byte_level::Span> spans;
+    byte_level::split(text, pattern, spans);
+    std::vector<std::string> pieces;
+    for (const auto& s : spans) pieces.push_back(text.substr(s.begin, s.end - s.begin));
+    return pieces;
+}
+
+TEST(ByteLevel, TablesRoundTrip) {
+    EXPECT_EQ(byte_level::to_unicode(" "), "\xC4\xA0");   // U+0120 'Ġ'
+    EXPECT_EQ(byte_level::to_unicode("\n"), "\xC4\x8A");  // U+010A 'Ċ'
+    EXPECT_EQ(byte_level::to_unicode("abc"), "abc");
+
+    std::string all;
+    for (int b = 0; b < 256; ++b) all.push_back(static_cast<char>(b));
+    EXPECT_EQ(byte_level::from_unicode(byte_level::to_unicode(all)), all);
+}
+
+TEST(ByteLevel, Gpt2Split) {
+    std::vector<std::string> expected = { "Hello", " world", "'s", " ", " test", " 12345", "\n\n" };
+    EXPECT_EQ(split_text("Hello world's  test 12345\n\n", ByteLevelPattern::GPT2), expected);
+
+    expected = { "I", "'", "M", " h\xC3\xA9llo", "!!", " w\xC3\xB6rld" };
+    EXPECT_EQ(split_text("I'M h\xC3\xA9llo!! w\xC3\xB6rld", ByteLevelPattern::GPT2), expected);
+}
+
+TEST(ByteLevel, Cl100kSplit) {
+    std::vector<std::string> expected = { "Hello", " world", "'s", " ", " test", " ", "123", "45", "\n\n" };
+    EXPECT_EQ(split_text("Hello world's  test 12345\n\n", ByteLevelPattern::CL100K), expected);
+
+    expected = { "I", "'M", "\n\n", "world", ".\n", " x" };
+    EXPECT_EQ(split_text("I'M\n\nworld.\n x", ByteLevelPattern::CL100K), expected);
+}
+
+TEST(ByteLevel, InvalidUtf8MakesProgress) {
+    std::string text = "a\xFF\xC3 b";
+    std::string joined;
+    for (const auto& piece : split_text(text, ByteLevelPattern::GPT2)) joined += piece;
+    EXPECT_EQ(joined, text);
+}
+
+TEST(ByteLevel, PreTokenizerMapsPieces) {
+    TokenizerConfig config;
+    config.add_prefix_space = true;
+    ByteLevelPreTokenizer pre(config);
+    std::vector<std::string> expected = { "\xC4\xA0hello", "\xC4\xA0world" };
+    EXPECT_EQ(pre.pre_tokenize("hello world"), expected);
+}
+
+TEST(ByteLevel, TokenizerRoundTrip) {
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NONE;
+    config.normalize_whitespace = false;
+    config.remove_control_chars = false;
+    config.byte_level = true;
+    BPETokenizer tokenizer(config);
+
+    auto vocab = std::make_shared<Vocab>();
+    tokenizer.set_vocab(vocab);
+    for (int b = 0; b < 256; ++b) vocab->add_token(byte_level::to_unicode(std::string(1, static_cast<char>(b))));
+    for (const std::string tok : { "\xC4\xA0w", "\xC4\xA0wo", "or", "ld", "orld", "\xC4\xA0world" }) vocab->add_token(tok);
+    tokenizer.set_merge_rules({ "\xC4\xA0 w", "o r", "l d", "or ld", "\xC4\xA0w orld" });
+
+    std::vector<Token> tokens = tokenizer.encode("hi world");
+    ASSERT_EQ(tokens.size(), 3u);
+    EXPECT_EQ(tokens[2].text, "\xC4\xA0world");
+    EXPECT_EQ(tokens[2].id, vocab->get_token_id("\xC4\xA0world"));
+
+    const std::string text = "hi world\n\tna\xC3\xAFve \xF0\x9F\x99\x82";
+    EXPECT_EQ(tokenizer.decode_from_ids(tokenizer.encode_to_ids(text)), text);
+}
+
+TEST(ByteLevel, DefaultConfigKeepsWhitespaceAndControls) {
+    TokenizerConfig config;
+    config.byte_level = true;
+    BPETokenizer tokenizer(config);
+    auto vocab = std::make_shared<Vocab>();
+    tokenizer.set_vocab(vocab);
+    for (int b = 0; b < 256; ++b) vocab->add_token(byte_level::to_unicode(std::string(1, static_cast<char>(b))));
+
+    const std::string text = "def f():\n\treturn 1\n\x01";
+    EXPECT_EQ(tokenizer.decode_from_ids(tokenizer.encode_to_ids(text)), text);
+}
+
+} // namespace
+} // namespace auratokenizer
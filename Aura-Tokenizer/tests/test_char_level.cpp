@@ -0,0 +1,77 @@
+#include "char_level_tokenizer.h"
+#include <gtest/gtest.h>
+
+namespace auratokenizer {
+namespace {
+
+TokenizerConfig plain_config() {
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NONE;
+    return config;
+}
+
+TEST(CharLevelTokenizer, EncodesCodepointsNotBytes) {
+    CharLevelTokenizer tokenizer(plain_config());
+    // Two-, three- and four-byte characters next to ASCII.
+    const std::string text = "a\xC3\xA9\xE4\xB8\xAD\xF0\x9F\x98\x80z";
+    tokenizer.train({ text }, 0);
+
+    std::vector<Token> tokens = tokenizer.encode(text);
+    ASSERT_EQ(tokens.size(), 5u);
+    EXPECT_EQ(tokens[1].text, "\xC3\xA9");
+    EXPECT_EQ(tokens[2].text, "\xE4\xB8\xAD");
+    EXPECT_EQ(tokens[3].text, "\xF0\x9F\x98\x80");
+    EXPECT_EQ(tokens[3].offset.start, 6);
+    EXPECT_EQ(tokens[3].offset.end, 10);
+    for (const auto& token : tokens) EXPECT_FALSE(token.is_special) << token.text;
+
+    std::vector<int> ids = tokenizer.encode_to_ids(text);
+    EXPECT_EQ(tokenizer.decode_from_ids(ids), text);
+}
+
+TEST(CharLevelTokenizer, UnknownCharactersAndInvalidBytesMapToUnk) {
+    CharLevelTokenizer tokenizer(plain_config());
+    tokenizer.train({ "ab" }, 0);
+    const int unk = tokenizer.get_special_token_id(SpecialTokenType::UNK);
+    ASSERT_GE(unk, 0);
+
+    EncodeBuffer out;
+    tokenizer.encode_into("a\xC3\xA9q\xFF" "b", out);
+    EXPECT_EQ(out.ids, (std::vector<int>{ tokenizer.encode_to_ids("a")[0], unk, unk, unk, tokenizer.encode_to_ids("b")[0] }));
+    EXPECT_EQ(out.special, (std::vector<uint8_t>{ 0, 1, 1, 1, 0 }));
+    EXPECT_EQ(out.offsets[1].end, 3);
+    EXPECT_EQ(out.offsets[3].start, 4);
+    EXPECT_EQ(out.offsets[3].end, 5);
+}
+
+TEST(CharLevelTokenizer, LongAsciiRunsAndVocabUpdates) {
+    CharLevelTokenizer tokenizer(plain_config());
+    std::string text;
+    for (int i = 0; i < 100; ++i) text += static_cast<char>('a' + i % 26);
+    text += "\xC3\xA9";
+    text += text;
+    tokenizer.train({ text }, 0);
+
+    EncodeBuffer out;
+    tokenizer.encode_into(text, out);
+    ASSERT_EQ(out.size(), 202u);
+    for (size_t i = 0; i < out.size(); ++i) {
+        auto expected = tokenizer.encode_to_ids(text.substr(out.offsets[i].start, out.offsets[i].end - out.offsets[i].start));
+        ASSERT_EQ(expected.size(), 1u);
+        EXPECT_EQ(out.ids[i], expected[0]);
+    }
+
+    // Characters added to the shared vocab are picked up by the next set_vocab().
+    auto vocab = std::make_shared<Vocab>();
+    vocab->add_token("x");
+    tokenizer.set_vocab(vocab);
+    const int unk = tokenizer.get_special_token_id(SpecialTokenType::UNK);
+    EXPECT_EQ(tokenizer.encode_to_ids("\xCE\xA9")[0], unk);
+    vocab->add_token("\xCE\xA9");
+    EXPECT_EQ(tokenizer.encode_to_ids("\xCE\xA9")[0], unk);
+    tokenizer.set_vocab(vocab);
+    EXPECT_EQ(tokenizer.encode_to_ids("\xCE\xA9")[0], vocab->get_token_id("\xCE\xA9"));
+}
+
+} // namespace
+} // namespace auratokenizer
@@ -0,0 +1,82 @@
+#include "bpe_trainer.h"
+#include "corpus_reader.h"
+#include "tokenizer_exception.h"
+#include "unigram_trainer.h"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace auratokenizer {
+namespace {
+
+class TempFile {
+public:
+    explicit TempFile(const std::string& contents) {
+        static int counter = 0;
+        path_ = ::testing::TempDir() + "aura_corpus_" + std::to_string(counter++) + ".txt";
+        std::ofstream(path_, std::ios::binary) << contents;
+    }
+    ~TempFile() { std::remove(path_.c_str()); }
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+void count_words(std::string_view line, CorpusCounts& counts) {
+    std::istringstream iss{ std::string(line) };
+    std::string word;
+    while (iss >> word) counts[word]++;
+}
+
+TEST(CorpusReader, ParallelCountsMatchSequential) {
+    std::string text;
+    for (int i = 0; i < 500; ++i) {
+        text += "w" + std::to_string(i % 37) + " shared w" + std::to_string(i % 11) + (i % 3 ? "\n" : "\r\n");
+    }
+    TempFile a(text), b("tail without newline"), empty("");
+
+    CorpusCounts expected;
+    std::istringstream lines(text + "\ntail without newline");
+    std::string line;
+    while (std::getline(lines, line)) count_words(line, expected);
+
+    // Tiny chunks force many newline-aligned splits across threads.
+    CorpusCounts counts = count_corpus_files({ a.path(), b.path(), empty.path() }, count_words, 4, 64);
+    EXPECT_EQ(counts, expected);
+    EXPECT_EQ(counts["shared"], 500u);
+    EXPECT_EQ(counts.count("w1\r"), 0u);
+}
+
+TEST(CorpusReader, MissingFileThrows) {
+    EXPECT_THROW(count_corpus_files({ ::testing::TempDir() + "aura_no_such_file.txt" }, count_words), TokenizerException);
+}
+
+TEST(CorpusReader, TrainersReadFiles) {
+    std::vector<std::string> corpus = { "low lower lowest", "newer wider low", "low low" };
+    std::string joined;
+    for (const auto& line : corpus) joined += line + "\n";
+    TempFile file(joined);
+
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NONE;
+    config.min_frequency = 1;
+    config.vocab_size = 40;
+
+    BPETrainer from_memory(config), from_file(config);
+    from_memory.train(corpus, std::make_shared<Vocab>(), config.vocab_size);
+    from_file.set_num_threads(3);
+    from_file.train_from_file(file.path(), std::make_shared<Vocab>());
+    EXPECT_EQ(from_file.get_merge_rules(), from_memory.get_merge_rules());
+    EXPECT_EQ(from_file.get_vocab_counts(), from_memory.get_vocab_counts());
+
+    UnigramTrainer unigram(config);
+    unigram.set_num_threads(2);
+    unigram.train_from_files({ file.path() });
+    EXPECT_TRUE(unigram.get_vocab()->has_token("l"));
+}
+
+} // namespace
+} // namespace auratokenizer
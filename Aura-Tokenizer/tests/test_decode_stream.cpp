@@ -0,0 +1,79 @@
+#include "bpe_tokenizer.h"
+#include "byte_level.h"
+#include "streaming.h"
+#include "vocab.h"
+#include "wordpiece_tokenizer.h"
+#include <gtest/gtest.h>
+
+namespace auratokenizer {
+namespace {
+
+TEST(DecodeStream, ByteLevelHoldsSplitCodepoints) {
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NONE;
+    config.byte_level = true;
+    BPETokenizer tokenizer(config);
+    auto vocab = std::make_shared<Vocab>();
+    tokenizer.set_vocab(vocab);
+    for (int b = 0; b < 256; ++b) vocab->add_token(byte_level::to_unicode(std::string(1, static_cast<char>(b))));
+
+    // "é🙂" with no merges: every byte is its own token.
+    const std::string text = "a \xC3\xA9\xF0\x9F\x99\x82!";
+    std::vector<int> ids = tokenizer.encode_to_ids(text);
+    ASSERT_EQ(ids.size(), text.size());
+
+    DecodeStream stream = tokenizer.decode_stream();
+    std::vector<std::string> steps;
+    for (int id : ids) steps.push_back(stream.step(id));
+    EXPECT_EQ(stream.flush(), "");
+
+    std::vector<std::string> expected = { "a", " ", "", "\xC3\xA9", "", "", "", "\xF0\x9F\x99\x82", "!" };
+    EXPECT_EQ(steps, expected);
+    EXPECT_EQ(tokenizer.decode_from_ids(ids), text);
+}
+
+TEST(DecodeStream, FlushReleasesTruncatedSequence) {
+    auto vocab = std::make_shared<Vocab>();
+    vocab->add_token("ok");
+    vocab->add_token("\xE2\x82"); // first two bytes of "€"
+    DecodeStream stream(vocab, DecodeStream::Mode::RAW);
+    std::string out;
+    EXPECT_TRUE(stream.step(vocab->get_token_id("ok"), out));
+    EXPECT_FALSE(stream.step(vocab->get_token_id("\xE2\x82"), out));
+    EXPECT_EQ(stream.pending_bytes(), 2u);
+    stream.flush(out);
+    EXPECT_EQ(out, "ok\xE2\x82");
+}
+
+TEST(DecodeStream, WordPieceJoins) {
+    WordPieceTokenizer tokenizer;
+    auto model = std::make_shared<models::WordPieceModel>();
+    model->initialize({ { "the", 100 }, { "un", 101 }, { "##aff", 102 }, { "##able", 103 } }, "[UNK]");
+    tokenizer.set_wordpiece_model(model);
+
+    std::vector<int> ids = { tokenizer.get_special_token_id(SpecialTokenType::CLS), 100, 101, 102, 103 };
+    DecodeStream stream = tokenizer.decode_stream(true);
+    std::string out;
+    for (int id : ids) stream.step(id, out);
+    stream.flush(out);
+    EXPECT_EQ(out, "the unaffable");
+
+    EXPECT_EQ(tokenizer.decode_from_ids({ 100, 101, 102, 103 }), "the unaffable");
+}
+
+TEST(DecodeStream, MetaspaceDropsLeadingSpace) {
+    auto vocab = std::make_shared<Vocab>();
+    for (const std::string tok : { "\xE2\x96\x81Hello", "\xE2\x96\x81wor", "ld" }) vocab->add_token(tok);
+    DecodeStream stream(vocab, DecodeStream::Mode::METASPACE);
+    std::string out;
+    for (const std::string tok : { "\xE2\x96\x81Hello", "\xE2\x96\x81wor", "ld" }) {
+        stream.step(vocab->get_token_id(tok), out);
+    }
+    EXPECT_EQ(out, "Hello world");
+
+    stream.reset();
+    EXPECT_EQ(stream.step(vocab->get_token_id("\xE2\x96\x81wor")), "wor");
+}
+
+} // namespace
+} // namespace auratokenizer
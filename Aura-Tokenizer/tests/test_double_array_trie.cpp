@@ -0,0 +1,153 @@
+#include "double_array_trie.h"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace auratokenizer {
+namespace {
+
+std::vector<std::pair<std::string, int32_t>> sample_keys() {
+    return { { "a", 0 }, { "ab", 1 }, { "abc", 2 }, { "abcdef", 3 }, { "b", 4 },
+             { "banana", 5 }, { "band", 6 }, { "\xE2\x96\x81the", 7 }, { "\xFF", 8 } };
+}
+
+std::vector<std::pair<size_t, int32_t>> prefixes(const DoubleArrayTrie& trie, std::string_view text) {
+    std::vector<std::pair<size_t, int32_t>> matches;
+    trie.common_prefix_search(text, [&](size_t length, int32_t value) { matches.emplace_back(length, value); });
+    return matches;
+}
+
+TEST(DoubleArrayTrie, BuildFindsEveryKeyWithAndWithoutTails) {
+    for (bool compress : { false, true }) {
+        DoubleArrayTrie trie;
+        auto keys = sample_keys();
+        keys.emplace_back("ab", 9);  // duplicate: last value wins
+        keys.emplace_back("", 10);   // ignored
+        trie.build(keys, compress);
+
+        EXPECT_EQ(trie.size(), 9u);
+        EXPECT_EQ(trie.has_tails(), compress);
+        EXPECT_EQ(trie.find("ab"), 9);
+        EXPECT_EQ(trie.find("banana"), 5);
+        EXPECT_EQ(trie.find("\xFF"), 8);
+        EXPECT_EQ(trie.find("ban"), -1);
+        EXPECT_EQ(trie.find("bananas"), -1);
+        EXPECT_EQ(trie.find("abcde"), -1);
+        EXPECT_EQ(trie.find(""), -1);
+        EXPECT_NO_THROW(trie.validate());
+
+        EXPECT_EQ(prefixes(trie, "abcdefg"),
+                  (std::vector<std::pair<size_t, int32_t>>{ { 1, 0 }, { 2, 9 }, { 3, 2 }, { 6, 3 } }));
+        EXPECT_EQ(prefixes(trie, "banan"), (std::vector<std::pair<size_t, int32_t>>{ { 1, 4 } }));
+        EXPECT_EQ(trie.predictive_search("ban").size(), 2u);
+        EXPECT_EQ(trie.predictive_search("bana").front().first, "banana");
+    }
+}
+
+TEST(DoubleArrayTrie, InsertRelocatesAndMatchesAMap) {
+    for (bool compress : { false, true }) {
+        DoubleArrayTrie trie;
+        trie.build(sample_keys(), compress);
+        std::map<std::string, int32_t> expected;
+        for (const auto& key : sample_keys()) expected[key.first] = key.second;
+
+        std::mt19937 rng(7);
+        for (int32_t i = 0; i < 3000; ++i) {
+            std::string key(1 + rng() % 6, '\0');
+            for (char& c : key) c = static_cast<char>("abcdn\x80\xFF"[rng() % 7]);
+            trie.insert(key, 100 + i);
+            expected[key] = 100 + i;
+        }
+
+        ASSERT_NO_THROW(trie.validate());
+        EXPECT_EQ(trie.size(), expected.size());
+        for (const auto& entry : expected) EXPECT_EQ(trie.find(entry.first), entry.second) << entry.first;
+        const auto all = trie.predictive_search("");
+        const std::map<std::string, int32_t> listed(all.begin(), all.end());
+        EXPECT_EQ(listed, expected);
+
+        trie.optimize();
+        EXPECT_NO_THROW(trie.validate());
+        for (const auto& entry : expected) EXPECT_EQ(trie.find(entry.first), entry.second);
+    }
+}
+
+TEST(DoubleArrayTrie, LargeBuildStaysLinear) {
+    // SentencePiece-style pieces: one shared prefix, then a wide fan-out that
+    // leaves the low cells crowded. Searching every free cell for each node
+    // took hundreds of probes per cell here; skipping crowded cells keeps it
+    // to a few.
+    std::mt19937 rng(19);
+    std::vector<std::pair<std::string, int32_t>> keys;
+    while (keys.size() < 250000) {
+        std::string key = "\xE2\x96\x81";
+        const size_t length = 1 + rng() % 8;
+        for (size_t i = 0; i < length; ++i) key += static_cast<char>(33 + rng() % 94);
+        keys.emplace_back(key, static_cast<int32_t>(keys.size()));
+    }
+    DoubleArrayTrie trie;
+    trie.build(keys);
+    EXPECT_LT(trie.build_probes(), 16 * trie.capacity());
+    trie.validate();
+    for (const auto& [key, value] : keys) ASSERT_NE(trie.find(key), -1) << key;
+}
+
+TEST(DoubleArrayTrie, SerializedBlobIsUsableInPlace) {
+    DoubleArrayTrie trie;
+    trie.build(sample_keys(), true);
+    const std::vector<char> blob = trie.serialize();
+
+    DoubleArrayTrie copied;
+    copied.deserialize(blob);
+    DoubleArrayTrie viewed;
+    viewed.view(blob.data(), blob.size());
+    for (const auto& key : sample_keys()) {
+        EXPECT_EQ(copied.find(key.first), key.second);
+        EXPECT_EQ(viewed.find(key.first), key.second);
+    }
+    EXPECT_EQ(prefixes(viewed, "bandana"), prefixes(trie, "bandana"));
+
+    // Modifying a viewed trie copies it first.
+    viewed.insert("bandana", 42);
+    EXPECT_EQ(viewed.find("bandana"), 42);
+    EXPECT_EQ(viewed.find("band"), 6);
+
+    const std::string path = ::testing::TempDir() + "dat_test.bin";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+    }
+    DoubleArrayTrie mapped;
+    mapped.map_file(path);
+    EXPECT_EQ(mapped.find("\xE2\x96\x81the"), 7);
+    std::remove(path.c_str());
+
+    std::vector<char> damaged = blob;
+    damaged[0] = 'X';
+    EXPECT_THROW(copied.deserialize(damaged), TokenizerException);
+    EXPECT_THROW(copied.deserialize(blob.data(), blob.size() - 4), TokenizerException);
+    EXPECT_EQ(copied.find("abc"), 2);  // unchanged on failure
+}
+
+TEST(DoubleArrayTrie, FailLinksRequireAnUncompressedTrie) {
+    DoubleArrayTrie trie;
+    trie.build(sample_keys(), true);
+    EXPECT_THROW(trie.rebuild_fail_links(), TokenizerException);
+
+    trie.build({ { "he", 0 }, { "she", 1 }, { "hers", 2 } });
+    trie.rebuild_fail_links();
+    int32_t state = DoubleArrayTrie::root();
+    for (char c : std::string("she")) state = trie.next_state(state, static_cast<unsigned char>(c));
+    EXPECT_EQ(trie.value(state), 1);
+    EXPECT_EQ(trie.depth(state), 3);
+    ASSERT_GE(trie.output_link(state), 0);
+    EXPECT_EQ(trie.value(trie.output_link(state)), 0);
+}
+
+} // namespace
+} // namespace auratokenizer
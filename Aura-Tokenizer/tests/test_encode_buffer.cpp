@@ -0,0 +1,139 @@
+#include "bpe_tokenizer.h"
+#include "char_level_tokenizer.h"
+#include "tokenizer_encoder.h"
+#include "unigram_tokenizer.h"
+#include "wordpiece_tokenizer.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Counting allocations made inside the library needs a replacement global
+// operator new. Outside steady_state_allocations() it behaves exactly like
+// the standard one; the local build links this file into its own
+// executable (auratokenizer_alloc_tests) so no other test runs with it.
+namespace {
+    std::atomic<bool> g_counting{ false };
+    std::atomic<size_t> g_allocations{ 0 };
+}
+
+// The replacement allocates with malloc, so free() is the matching release.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(size_t size) {
+    if (g_counting.load(std::memory_order_relaxed)) g_allocations.fetch_add(1, std::memory_order_relaxed);
+    while (true) {
+        if (void* p = std::malloc(size ? size : 1)) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace auratokenizer {
+namespace {
+
+// Allocations made by encode_into once the buffer and thread-local scratch are warm.
+size_t steady_state_allocations(TokenizerBase& tokenizer, const std::string& text, EncodeBuffer& buffer) {
+    tokenizer.encode_into(text, buffer);
+    tokenizer.encode_into(text, buffer);
+    g_allocations = 0;
+    g_counting = true;
+    for (int i = 0; i < 10; ++i) tokenizer.encode_into(text, buffer);
+    g_counting = false;
+    return g_allocations.load();
+}
+
+TokenizerConfig plain_config() {
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NONE;
+    return config;
+}
+
+TEST(EncodeBuffer, BPEMatchesEncodeAndDoesNotAllocate) {
+    BPETokenizer tokenizer(plain_config());
+    auto vocab = std::make_shared<Vocab>();
+    tokenizer.set_vocab(vocab);
+    for (const std::string tok : { "l", "o", "w", "e", "r", "n", "lo", "low", "er", "lower" }) vocab->add_token(tok);
+    tokenizer.set_merge_rules({ "l o", "lo w", "e r", "low er" });
+
+    const std::string text = "lower  low\tnewer";
+    EncodeBuffer buffer;
+    tokenizer.encode_into(text, buffer);
+
+    std::vector<Token> tokens = tokenizer.encode(text);
+    ASSERT_EQ(buffer.size(), tokens.size());
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        EXPECT_EQ(buffer.ids[i], tokens[i].id);
+        const auto& off = buffer.offsets[i];
+        EXPECT_EQ(text.substr(off.start, off.end - off.start), tokens[i].text);
+    }
+    EXPECT_EQ(steady_state_allocations(tokenizer, text, buffer), 0u);
+}
+
+TEST(EncodeBuffer, ByteLevelPrefixSpaceOffsets) {
+    TokenizerConfig config = plain_config();
+    config.byte_level = true;
+    config.add_prefix_space = true;
+    BPETokenizer tokenizer(config);
+
+    // No merges: " hi", " you" become one piece per byte, offsets in the unprefixed text.
+    EncodeBuffer buffer;
+    tokenizer.encode_into("hi you", buffer);
+    ASSERT_EQ(buffer.size(), 7u);
+    EXPECT_EQ(buffer.offsets[0].start, 0);
+    EXPECT_EQ(buffer.offsets[0].end, 0);
+    EXPECT_EQ(buffer.offsets[1].start, 0);
+    EXPECT_EQ(buffer.offsets[1].end, 1);
+    EXPECT_EQ(buffer.offsets[3].start, 2);
+    EXPECT_EQ(buffer.offsets[3].end, 3);
+}
+
+TEST(EncodeBuffer, OtherTokenizersMatchEncodeToIds) {
+    const std::string text = "abc ab";
+    EncodeBuffer buffer;
+
+    CharLevelTokenizer chars(plain_config());
+    chars.train({ text }, 0);
+    chars.encode_into(text, buffer);
+    EXPECT_EQ(buffer.ids, chars.encode_to_ids(text));
+    EXPECT_EQ(buffer.offsets[4].start, 4);
+    EXPECT_EQ(steady_state_allocations(chars, text, buffer), 0u);
+
+    UnigramTokenizer unigram(plain_config());
+    auto uvocab = std::make_shared<Vocab>();
+    for (const std::string tok : { "ab", "c", " " }) uvocab->add_token(tok);
+    unigram.set_vocab(uvocab);
+    unigram.encode_into(text, buffer);
+    std::vector<int> expected = { uvocab->get_token_id("ab"), uvocab->get_token_id("c"),
+                                  uvocab->get_token_id(" "), uvocab->get_token_id("ab") };
+    EXPECT_EQ(buffer.ids, expected);
+    EXPECT_EQ(buffer.offsets[3].start, 4);
+    EXPECT_EQ(steady_state_allocations(unigram, text, buffer), 0u);
+
+    WordPieceTokenizer wordpiece(plain_config());
+    auto model = std::make_shared<models::WordPieceModel>();
+    model->initialize({ { "[UNK]", 0 }, { "un", 1 }, { "##aff", 2 }, { "##able", 3 } }, "[UNK]");
+    wordpiece.set_wordpiece_model(model);
+    wordpiece.encode_into("unaffable", buffer);
+    EXPECT_EQ(buffer.ids, wordpiece.encode_to_ids("unaffable"));
+    ASSERT_EQ(buffer.size(), 3u);
+    EXPECT_EQ(buffer.offsets[1].start, 2);
+    EXPECT_EQ(buffer.offsets[1].end, 5);
+    EXPECT_EQ(steady_state_allocations(wordpiece, "unaffable", buffer), 0u);
+
+    Encoder encoder(plain_config());
+    encoder.encode_into(text, buffer);
+    EXPECT_EQ(buffer.size(), 7u); // BOS + 5 chars + EOS
+    EXPECT_EQ(buffer.ids, encoder.encode_to_ids(text));
+    EXPECT_TRUE(buffer.special.front());
+    EXPECT_EQ(steady_state_allocations(encoder, text, buffer), 0u);
+}
+
+} // namespace
+} // namespace auratokenizer
@@ -0,0 +1,292 @@
+#include "normalized_string.h"
+#include "bpe_tokenizer.h"
+#include "char_level_tokenizer.h"
+#include "icu_utils.h"
+#include "precompiled_charsmap.h"
+#include "tokenizer_exception.h"
+#include "unicode_normalizer.h"
+#include "unigram_tokenizer.h"
+#include "wordpiece_tokenizer.h"
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace auratokenizer {
+namespace {
+
+void expect_span(const NormalizedString& text, size_t begin, size_t end, int original_begin, int original_end) {
+    const OffsetMapping span = text.original_span(begin, end);
+    EXPECT_EQ(span.start, original_begin) << "[" << begin << ", " << end << ")";
+    EXPECT_EQ(span.end, original_end) << "[" << begin << ", " << end << ")";
+}
+
+// Every normalized byte maps into the original, in order.
+void expect_monotone(const NormalizedString& text) {
+    int start = 0;
+    int end = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        const OffsetMapping span = text.original_span(i, i + 1);
+        ASSERT_GE(span.start, start) << i;
+        ASSERT_GE(span.end, end) << i;
+        ASSERT_LE(span.start, span.end) << i;
+        ASSERT_LE(span.end, static_cast<int>(text.original_size())) << i;
+        start = span.start;
+        end = span.end;
+    }
+}
+
+TEST(NormalizedString, StepsComposeIntoOneAlignment) {
+    // "a" U+FB01 "x": the ligature becomes "fi", then "a" is deleted, then "_" inserted.
+    NormalizedString text("a\xEF\xAC\x81x");
+    NormalizedString::Step step;
+    step.keep(1);
+    step.change(3, 2);
+    step.keep(1);
+    std::string next = "afix";
+    text.update(next, step);
+    EXPECT_EQ(text.get(), "afix");
+    expect_span(text, 0, 1, 0, 1);
+    expect_span(text, 1, 2, 1, 4);
+    expect_span(text, 2, 3, 1, 4);
+    expect_span(text, 1, 4, 1, 5);
+
+    step.clear();
+    step.change(1, 0);
+    next = "fix";
+    text.update(next, step);
+    std::vector<OffsetMapping> offsets = { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 3 } };
+    text.to_original(offsets);
+    EXPECT_EQ(offsets[0].start, 1);
+    EXPECT_EQ(offsets[0].end, 4);
+    EXPECT_EQ(offsets[1].start, 1);
+    EXPECT_EQ(offsets[2].start, 4);
+    EXPECT_EQ(offsets[2].end, 5);
+    EXPECT_EQ(offsets[3].start, 5);  // the end maps to the end
+    EXPECT_EQ(offsets[3].end, 5);
+
+    step.clear();
+    step.change(0, 1);
+    next = "_fix";
+    text.update(next, step);
+    expect_span(text, 0, 1, 1, 1);
+    expect_span(text, 0, 2, 1, 4);
+    EXPECT_EQ(text.original_size(), 5u);
+
+    step.clear();
+    step.keep(2);
+    next = "too long";
+    EXPECT_THROW(text.update(next, step), TokenizerException);
+}
+
+TEST(NormalizedString, InPlaceChangesKeepOneSpan) {
+    NormalizedString text("ABC");
+    NormalizedString::Step step;
+    step.change(1, 1);
+    step.keep(1);
+    EXPECT_FALSE(step.changes_lengths());
+    std::string next = "abC";
+    text.update(next, step);
+    EXPECT_EQ(text.get(), "abC");
+    EXPECT_EQ(text.span_count(), 1u);
+    expect_span(text, 1, 2, 1, 2);
+}
+
+TEST(NormalizedString, RewindAndAppendSplicePieces) {
+    NormalizedString::Step step;
+    step.keep(4);
+    step.change(1, 0);
+    step.rewind(2);
+    EXPECT_EQ(step.old_size(), 2u);
+    EXPECT_EQ(step.new_size(), 2u);
+    step.change(2, 1);
+    EXPECT_THROW(step.rewind(3), TokenizerException);
+
+    // "e" U+0301 composes to U+00E9 in a piece that is spliced into the outer step.
+    NormalizedString piece("e\xCC\x81");
+    NormalizedString::Step inner;
+    inner.change(3, 2);
+    std::string composed = "\xC3\xA9";
+    piece.update(composed, inner);
+
+    NormalizedString text("x e\xCC\x81!");
+    step.clear();
+    step.keep(2);
+    step.append(piece);
+    EXPECT_EQ(step.old_size(), 5u);
+    std::string next = "x \xC3\xA9!";
+    text.update(next, step);
+    expect_span(text, 2, 4, 2, 5);
+    expect_span(text, 4, 5, 5, 6);
+}
+
+std::string random_text(std::mt19937& rng) {
+    static const std::vector<std::string> parts = {
+        "a", "Z", " ", "hello", "\t", "\x01", "I", "\xCC\x81", "\xCC\xA3", "\xC3\xA9", "E\xCC\x81", "\xCE\xA3",
+        "\xCE\xB1", "\xE1\xBE\x8F", "\xEF\xAC\x81", "\xEF\xBC\xA1", "\xC2\xA0", "\xE2\x80\x8B", "\xD0\x96",
+        "\xE6\x97\xA5", "\xEA\xB0\x80", "\xFF", "\xC3" };
+    std::string text;
+    const size_t count = rng() % 12;
+    for (size_t i = 0; i < count; ++i) text += parts[rng() % parts.size()];
+    return text;
+}
+
+TEST(NormalizedString, NormalizersTrackEveryStep) {
+    std::mt19937 rng(5);
+    const NormalizationForm forms[] = { NormalizationForm::NONE, NormalizationForm::NFC, NormalizationForm::NFD,
+                                        NormalizationForm::NFKC, NormalizationForm::NFKD };
+    for (NormalizationForm form : forms) {
+        for (int flags = 0; flags < 32; flags += 5) {
+            TokenizerConfig config;
+            config.normalization = form;
+            config.lowercase = flags & 1;
+            config.strip_accents = flags & 2;
+            config.normalize_whitespace = flags & 4;
+            config.remove_control_chars = flags & 8;
+            config.remove_diacritics = flags & 16;
+            const UnicodeNormalizer normalizer(config);
+            PrecompiledCharsmap charsmap;
+            charsmap.build(config);
+            NormalizedString text;
+            for (int round = 0; round < 100; ++round) {
+                const std::string input = random_text(rng);
+                const std::string expected = normalizer.normalize(input);
+                text.reset(input);
+                normalizer.normalize(text);
+                ASSERT_EQ(text.get(), expected) << config.to_string() << " " << input;
+                expect_monotone(text);
+                text.reset(input);
+                charsmap.normalize(text);
+                ASSERT_EQ(text.get(), expected) << config.to_string() << " " << input;
+                expect_monotone(text);
+            }
+        }
+    }
+}
+
+TEST(NormalizedString, NormalizerOffsetsPointAtTheOriginalCharacters) {
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NFD;
+    config.strip_accents = true;
+    config.lowercase = true;
+    NormalizedString text("Caf\xC3\xA9!");
+    UnicodeNormalizer(config).normalize(text);
+    EXPECT_EQ(text.get(), "cafe!");
+    expect_span(text, 3, 4, 3, 5);
+    expect_span(text, 4, 5, 5, 6);
+
+    config.normalization = NormalizationForm::NFKC;
+    config.strip_accents = false;
+    config.remove_control_chars = true;
+    for (bool precompiled : { false, true }) {
+        text.reset("\xEF\xAC\x81\x01X");
+        if (precompiled) {
+            PrecompiledCharsmap charsmap;
+            charsmap.build(config);
+            charsmap.normalize(text);
+        } else {
+            UnicodeNormalizer(config).normalize(text);
+        }
+        EXPECT_EQ(text.get(), "fix");
+        expect_span(text, 0, 1, 0, 3);
+        expect_span(text, 1, 2, 0, 3);
+        expect_span(text, 2, 3, 4, 5);  // the control character is gone
+    }
+}
+
+TEST(NormalizedString, TokenizerOffsetsPointIntoTheInput) {
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NFKC;
+    config.lowercase = true;
+    const std::string text = "A\xEF\xAC\x81";
+
+    CharLevelTokenizer chars(config);
+    chars.train({ "afi" }, 0);
+    std::vector<Token> tokens = chars.encode(text);
+    ASSERT_EQ(tokens.size(), 3u);
+    EXPECT_EQ(tokens[1].text, "f");
+    EXPECT_EQ(tokens[1].offset.start, 1);
+    EXPECT_EQ(tokens[1].offset.end, 4);
+    EXPECT_EQ(tokens[2].offset.start, 1);
+    EXPECT_EQ(tokens[2].offset.end, 4);
+    EXPECT_EQ(chars.decode(tokens), "afi");
+    EncodeBuffer buffer;
+    chars.encode_into(text, buffer);
+    EXPECT_EQ(buffer.offsets[2].end, 4);
+
+    // Unigram, through the normalizer and through the precompiled charsmap.
+    for (bool precompiled : { false, true }) {
+        config.use_precompiled_charsmap = precompiled;
+        UnigramTokenizer unigram(config);
+        auto vocab = std::make_shared<Vocab>();
+        unigram.set_vocab(vocab);
+        const std::unordered_map<std::string, float> scores = {
+            { "caf", -1.0f }, { "\xC3\xA9", -1.0f }, { " ", -1.0f }, { "fi", -1.0f } };
+        for (const auto& [piece, score] : scores) vocab->add_token(piece);
+        unigram.set_vocab_and_scores(vocab, scores);
+
+        const std::string input = "CAFE\xCC\x81 \xEF\xAC\x81";
+        unigram.encode_into(input, buffer);
+        ASSERT_EQ(buffer.size(), 4u);
+        const int expected[][2] = { { 0, 3 }, { 3, 6 }, { 6, 7 }, { 7, 10 } };
+        for (size_t i = 0; i < buffer.size(); ++i) {
+            EXPECT_EQ(buffer.offsets[i].start, expected[i][0]) << precompiled << " " << i;
+            EXPECT_EQ(buffer.offsets[i].end, expected[i][1]) << precompiled << " " << i;
+        }
+        tokens = unigram.encode(input);
+        ASSERT_EQ(tokens.size(), 4u);
+        EXPECT_EQ(tokens[1].text, "\xC3\xA9");
+        EXPECT_EQ(tokens[1].offset.start, 3);
+        EXPECT_EQ(tokens[1].offset.end, 6);
+    }
+    config.use_precompiled_charsmap = false;
+
+    // BPE maps each segment between added tokens on its own.
+    BPETokenizer bpe(config);
+    auto vocab = std::make_shared<Vocab>();
+    bpe.set_vocab(vocab);
+    for (const std::string token : { "f", "i", "x", "fi" }) vocab->add_token(token);
+    bpe.set_merge_rules({ "f i" });
+    bpe.add_tokens({ { "<|sep|>", -1 } });
+    const std::string input = "\xEF\xAC\x81X<|sep|>\xEF\xAC\x81";
+    bpe.encode_into(input, buffer);
+    const std::vector<int> ids = { vocab->get_token_id("fi"), vocab->get_token_id("x"),
+                                   vocab->get_token_id("<|sep|>"), vocab->get_token_id("fi") };
+    EXPECT_EQ(buffer.ids, ids);
+    ASSERT_EQ(buffer.size(), 4u);
+    const int expected[][2] = { { 0, 3 }, { 3, 4 }, { 4, 11 }, { 11, 14 } };
+    for (size_t i = 0; i < buffer.size(); ++i) {
+        EXPECT_EQ(buffer.offsets[i].start, expected[i][0]) << i;
+        EXPECT_EQ(buffer.offsets[i].end, expected[i][1]) << i;
+    }
+    tokens = bpe.encode(input);
+    ASSERT_EQ(tokens.size(), 4u);
+    EXPECT_EQ(tokens[3].offset.start, 11);
+    EXPECT_EQ(tokens[3].offset.end, 14);
+
+    // WordPiece outside the BERT pipeline.
+    WordPieceTokenizer wordpiece(config);
+    auto model = std::make_shared<models::WordPieceModel>();
+    model->initialize({ { "[UNK]", 0 }, { "a", 1 }, { "##fi", 2 } }, "[UNK]");
+    wordpiece.set_wordpiece_model(model);
+    tokens = wordpiece.encode(text);
+    ASSERT_EQ(tokens.size(), 2u);
+    EXPECT_EQ(tokens[1].text, "##fi");
+    EXPECT_EQ(tokens[1].offset.start, 1);
+    EXPECT_EQ(tokens[1].offset.end, 4);
+}
+
+TEST(NormalizedString, WordSpansAreByteRanges) {
+    const std::string text = "h\xC3\xA9llo, w\xC3\xB6rld";
+    const std::vector<OffsetMapping> spans = icu_utils::ICUUtils::segment_word_spans(text);
+    const std::vector<std::string> words = icu_utils::ICUUtils::segment_words(text);
+    ASSERT_EQ(spans.size(), words.size());
+    for (size_t i = 0; i < spans.size(); ++i) {
+        EXPECT_EQ(text.substr(spans[i].start, spans[i].end - spans[i].start), words[i]);
+    }
+    EXPECT_EQ(spans.back().end, static_cast<int>(text.size()));
+}
+
+} // namespace
+} // namespace auratokenizer
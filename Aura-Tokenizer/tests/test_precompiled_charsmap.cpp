@@ -0,0 +1,176 @@
+#include "precompiled_charsmap.h"
+#include "tokenizer_exception.h"
+#include "unigram_tokenizer.h"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace auratokenizer {
+namespace {
+
+std::string encode_utf8(uint32_t c) {
+    std::string s;
+    if (c < 0x80) {
+        s += static_cast<char>(c);
+    } else if (c < 0x800) {
+        s += static_cast<char>(0xC0 | (c >> 6));
+        s += static_cast<char>(0x80 | (c & 0x3F));
+    } else if (c < 0x10000) {
+        s += static_cast<char>(0xE0 | (c >> 12));
+        s += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        s += static_cast<char>(0x80 | (c & 0x3F));
+    } else {
+        s += static_cast<char>(0xF0 | (c >> 18));
+        s += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+        s += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        s += static_cast<char>(0x80 | (c & 0x3F));
+    }
+    return s;
+}
+
+std::string random_text(std::mt19937& rng) {
+    // Composed and decomposed letters, marks that reorder, final sigma, Greek
+    // next to punctuation, Hangul jamo, Indic vowel signs and ill-formed bytes,
+    // mixed with code points drawn from a few blocks.
+    static const std::vector<std::string> parts = {
+        "a", "Z", " ", "hello", "\t", "\n", ";", "I", "\xCC\x81", "\xCC\xA3", "\xC3\xA9", "E\xCC\x81",
+        "\xCE\xA3", "\xCE\xB1", "\xE1\x84\x80", "\xE1\x85\xA1", "\xEA\xB0\x80", "\xE0\xAD\x87",
+        "\xE0\xAC\xBE", "\xCD\x85", "\xEF\xAC\x81", "\xEF\xBC\xA1", "\xFF", "\xC3", "\xED\xA0\x80" };
+    static const uint32_t ranges[][2] = {
+        { 0x01, 0x80 }, { 0x80, 0x250 }, { 0x300, 0x370 }, { 0x370, 0x530 }, { 0x1E00, 0x2100 },
+        { 0x3000, 0x3100 }, { 0xF900, 0xFB50 }, { 0xFE00, 0xFFFE }, { 0x1D400, 0x1D800 } };
+    std::string text;
+    const size_t count = rng() % 16;
+    for (size_t i = 0; i < count; ++i) {
+        if (rng() % 2) {
+            text += parts[rng() % parts.size()];
+        } else {
+            const auto& range = ranges[rng() % (sizeof(ranges) / sizeof(ranges[0]))];
+            text += encode_utf8(range[0] + rng() % (range[1] - range[0]));
+        }
+    }
+    return text;
+}
+
+std::vector<TokenizerConfig> sample_configs() {
+    std::vector<TokenizerConfig> configs(5);
+    for (TokenizerConfig& config : configs) {
+        config.normalize_whitespace = true;
+        config.remove_control_chars = true;
+    }
+    configs[1].normalization = NormalizationForm::NFKC;
+    configs[1].lowercase = true;
+    configs[2].normalization = NormalizationForm::NFKD;
+    configs[2].lowercase = true;
+    configs[2].strip_accents = true;
+    configs[3].normalization = NormalizationForm::NONE;
+    configs[3].remove_diacritics = true;
+    configs[3].normalize_whitespace = false;
+    configs[4].normalization = NormalizationForm::NFD;
+    configs[4].normalize_whitespace = false;
+    configs[4].remove_control_chars = false;
+    return configs;
+}
+
+TEST(PrecompiledCharsmap, MatchesUnicodeNormalizer) {
+    std::mt19937 rng(3);
+    for (const TokenizerConfig& config : sample_configs()) {
+        PrecompiledCharsmap charsmap;
+        charsmap.build(config);
+        EXPECT_TRUE(charsmap.matches(config));
+        EXPECT_GT(charsmap.size(), 0u);
+        const UnicodeNormalizer normalizer(config);
+        for (int round = 0; round < 1000; ++round) {
+            const std::string text = random_text(rng);
+            EXPECT_EQ(charsmap.normalize(text), normalizer.normalize(text)) << config.to_string() << " " << text;
+        }
+    }
+
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NFKC;
+    config.lowercase = true;
+    config.normalize_whitespace = true;
+    PrecompiledCharsmap charsmap;
+    charsmap.build(config);
+    EXPECT_EQ(charsmap.normalize("Caf\xC3\xA9 \xEF\xAC\x81 \xEF\xBC\xA1\tOK"), "caf\xC3\xA9 fi a ok");
+    // Decomposed input composes from the table; final sigma takes the ICU path.
+    EXPECT_EQ(charsmap.normalize("Cafe\xCC\x81"), "caf\xC3\xA9");
+    EXPECT_EQ(charsmap.normalize("\xCE\x9F\xCE\xA3 \xCE\xA3\xCE\x9F"), "\xCE\xBF\xCF\x82 \xCF\x83\xCE\xBF");
+
+    // normalize_view() may be given a view of its own scratch buffer.
+    std::string scratch = "ABC";
+    EXPECT_EQ(charsmap.normalize_view(scratch, scratch), "abc");
+
+    config.lowercase = false;
+    EXPECT_FALSE(charsmap.matches(config));
+    charsmap.apply_settings(config);
+    EXPECT_TRUE(config.lowercase);
+    EXPECT_THROW(PrecompiledCharsmap().normalize("a"), TokenizerException);
+}
+
+TEST(PrecompiledCharsmap, BlobRoundTripsAndRejectsDamage) {
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NFKC;
+    config.lowercase = true;
+    PrecompiledCharsmap charsmap;
+    charsmap.build(config);
+    const std::vector<char> blob = charsmap.serialize();
+
+    PrecompiledCharsmap copied;
+    copied.deserialize(blob);
+    PrecompiledCharsmap viewed;
+    viewed.view(blob.data(), blob.size());
+    EXPECT_EQ(copied.size(), charsmap.size());
+    EXPECT_TRUE(viewed.matches(config));
+    std::mt19937 rng(8);
+    for (int round = 0; round < 300; ++round) {
+        const std::string text = random_text(rng);
+        const std::string expected = charsmap.normalize(text);
+        EXPECT_EQ(copied.normalize(text), expected);
+        EXPECT_EQ(viewed.normalize(text), expected);
+    }
+
+    std::vector<char> truncated(blob.begin(), blob.end() - 4);
+    EXPECT_THROW(copied.deserialize(truncated), TokenizerException);
+    std::vector<char> bad_magic = blob;
+    bad_magic[0] ^= 0x20;
+    EXPECT_THROW(copied.deserialize(bad_magic), TokenizerException);
+    EXPECT_THROW(copied.deserialize(std::vector<char>(16, 'x')), TokenizerException);
+    EXPECT_THROW(PrecompiledCharsmap().serialize(), TokenizerException);
+}
+
+TEST(PrecompiledCharsmap, UnigramModelFileCarriesTheCharsmap) {
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NFKC;
+    config.lowercase = true;
+    config.use_precompiled_charsmap = true;
+    UnigramTokenizer tokenizer(config);
+    auto vocab = std::make_shared<Vocab>();
+    tokenizer.set_vocab(vocab);
+    const std::unordered_map<std::string, float> scores = {
+        { "caf", -2.0f }, { "\xC3\xA9", -2.0f }, { "fi", -1.0f }, { " ", -1.0f }, { "c", -4.0f }, { "a", -4.0f },
+        { "f", -4.0f } };
+    for (const auto& [piece, score] : scores) vocab->add_token(piece);
+    tokenizer.set_vocab_and_scores(vocab, scores);
+
+    const std::string text = "CAFE\xCC\x81 \xEF\xAC\x81";
+    const std::vector<int> ids = tokenizer.encode_to_ids(text);
+    const UnicodeNormalizer normalizer(config);
+    EXPECT_EQ(tokenizer.decode_from_ids(ids), normalizer.normalize(text));
+
+    const std::string path = ::testing::TempDir() + "unigram_charsmap_test.bin";
+    tokenizer.save(path);
+    UnigramTokenizer loaded;
+    loaded.load(path);
+    EXPECT_TRUE(loaded.get_config().use_precompiled_charsmap);
+    EXPECT_TRUE(loaded.get_config().lowercase);
+    EXPECT_EQ(loaded.get_config().normalization, NormalizationForm::NFKC);
+    EXPECT_EQ(loaded.encode_to_ids(text), ids);
+    std::remove(path.c_str());
+}
+
+} // namespace
+} // namespace auratokenizer
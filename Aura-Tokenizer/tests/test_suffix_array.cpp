@@ -0,0 +1,121 @@
+#include "suffix_array.h"
+#include "unigram_trainer.h"
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+
+namespace auratokenizer {
+namespace {
+
+std::vector<int32_t> random_text(std::mt19937& rng, size_t length, int32_t alphabet) {
+    std::uniform_int_distribution<int32_t> dist(0, alphabet - 1);
+    std::vector<int32_t> text(length);
+    for (auto& c : text) c = dist(rng);
+    return text;
+}
+
+// Weighted occurrence count of every substring of 2..max_chars ASCII characters.
+std::map<std::string, size_t> naive_counts(const std::vector<std::pair<std::string, size_t>>& words, size_t max_chars) {
+    std::map<std::string, size_t> counts;
+    for (const auto& [word, count] : words) {
+        for (size_t a = 0; a < word.size(); ++a) {
+            for (size_t len = 2; len <= max_chars && a + len <= word.size(); ++len) {
+                counts[word.substr(a, len)] += count;
+            }
+        }
+    }
+    return counts;
+}
+
+TEST(SuffixArrayTest, MatchesNaiveSortAndLcp) {
+    std::mt19937 rng(7);
+    for (int round = 0; round < 200; ++round) {
+        int32_t alphabet = 1 + round % 5;
+        std::vector<int32_t> text = random_text(rng, 1 + rng() % 60, alphabet);
+
+        std::vector<int32_t> expected(text.size());
+        for (size_t i = 0; i < text.size(); ++i) expected[i] = static_cast<int32_t>(i);
+        std::sort(expected.begin(), expected.end(), [&](int32_t a, int32_t b) {
+            return std::lexicographical_compare(text.begin() + a, text.end(), text.begin() + b, text.end());
+        });
+        std::vector<int32_t> sa = build_suffix_array(text, alphabet);
+        ASSERT_EQ(sa, expected);
+
+        std::vector<int32_t> lcp = build_lcp_array(text, sa);
+        ASSERT_EQ(lcp[0], 0);
+        for (size_t r = 1; r < sa.size(); ++r) {
+            int32_t h = 0;
+            while (sa[r] + h < static_cast<int32_t>(text.size()) && sa[r - 1] + h < static_cast<int32_t>(text.size())
+                && text[sa[r] + h] == text[sa[r - 1] + h]) {
+                ++h;
+            }
+            ASSERT_EQ(lcp[r], h);
+        }
+    }
+    EXPECT_TRUE(build_suffix_array({}, 1).empty());
+}
+
+TEST(SuffixArrayTest, SeedPiecesHaveExactWeightedFrequencies) {
+    std::mt19937 rng(11);
+    std::vector<std::pair<std::string, size_t>> words;
+    for (int w = 0; w < 80; ++w) {
+        std::string word;
+        for (size_t k = 0, len = 1 + rng() % 12; k < len; ++k) word += static_cast<char>('a' + rng() % 3);
+        words.emplace_back(word, 1 + rng() % 5);
+    }
+    SeedPieceOptions options;
+    options.max_piece_chars = 6;
+    options.min_frequency = 2;
+    auto pieces = extract_seed_pieces(words, options);
+    auto naive = naive_counts(words, options.max_piece_chars);
+    ASSERT_FALSE(pieces.empty());
+
+    size_t best = 0;
+    for (const auto& [text, count] : naive) {
+        if (count >= options.min_frequency) best = std::max(best, count * text.size());
+    }
+    EXPECT_EQ(pieces.front().second * pieces.front().first.size(), best);
+
+    std::set<std::string> seen;
+    for (size_t i = 0; i < pieces.size(); ++i) {
+        const auto& [text, count] = pieces[i];
+        EXPECT_TRUE(seen.insert(text).second) << text;
+        EXPECT_GE(text.size(), 2u);
+        EXPECT_LE(text.size(), options.max_piece_chars);
+        EXPECT_EQ(count, naive[text]) << text;
+        EXPECT_GE(count, options.min_frequency);
+        if (i > 0) {
+            EXPECT_LE(count * text.size(), pieces[i - 1].second * pieces[i - 1].first.size());
+        }
+    }
+
+    // A tiny budget samples the words; results stay valid and reproducible.
+    options.memory_budget_bytes = 4096;
+    auto sampled = extract_seed_pieces(words, options);
+    EXPECT_EQ(sampled, extract_seed_pieces(words, options));
+    for (const auto& [text, count] : sampled) EXPECT_LE(count, naive[text]) << text;
+}
+
+TEST(SuffixArrayTest, TrainerSeedsFromSuffixArray) {
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NONE;
+    config.max_tokens = 30;
+    UnigramTrainer trainer(config);
+    trainer.set_num_threads(1);
+    trainer.set_seed_memory_budget(1 << 20);
+    EXPECT_THROW(trainer.set_seed_memory_budget(0), TokenizerException);
+    std::vector<std::string> corpus;
+    for (int i = 0; i < 20; ++i) corpus.push_back("the cat sat on the mat with the hat");
+    trainer.train(corpus);
+    const auto& scores = trainer.get_scores();
+    EXPECT_TRUE(scores.count("t"));
+    bool has_multi = std::any_of(scores.begin(), scores.end(),
+        [](const auto& entry) { return entry.first.size() > 1; });
+    EXPECT_TRUE(has_multi);
+}
+
+} // namespace
+} // namespace auratokenizer
@@ -0,0 +1,82 @@
+#include "trie.h"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace auratokenizer {
+namespace {
+
+void fill_sample(Trie& trie) {
+    const std::vector<std::string> tokens = { "a", "ab", "abc", "abcdef", "b", "banana", "band",
+                                              "\xE2\x96\x81the", "\xFF", "\x80\x81" };
+    for (size_t i = 0; i < tokens.size(); ++i) trie.insert(tokens[i], static_cast<int>(i));
+    // A wide node past the linear-scan limit.
+    for (int c = 0; c < 40; ++c) trie.insert(std::string("x") + static_cast<char>('0' + c), 100 + c);
+}
+
+TEST(FrozenTrie, MatchesTheMutableTrie) {
+    Trie trie;
+    fill_sample(trie);
+    FrozenTrie frozen;
+    frozen.build(trie);
+    EXPECT_EQ(frozen.size(), trie.size());
+
+    std::mt19937 rng(11);
+    const std::string alphabet = "abcdnx0AZ\xE2\x96\x81\xFF\x80";
+    for (int round = 0; round < 2000; ++round) {
+        std::string text(rng() % 8, '\0');
+        for (char& c : text) c = alphabet[rng() % alphabet.size()];
+        const size_t start = text.empty() ? 0 : rng() % text.size();
+        EXPECT_EQ(frozen.get_id(text), trie.get_id(text)) << text;
+        EXPECT_EQ(frozen.longest_prefix(text, start), trie.longest_prefix(text, start)) << text;
+        EXPECT_EQ(frozen.all_prefixes(text, start), trie.all_prefixes(text, start)) << text;
+    }
+    EXPECT_EQ(frozen.get_id("x7"), 107);
+    EXPECT_EQ(frozen.get_id("xW"), 139);
+    EXPECT_FALSE(frozen.contains(""));
+    EXPECT_FALSE(frozen.contains("abcd"));
+}
+
+TEST(FrozenTrie, BlobRoundTripsAndMapsInPlace) {
+    Trie trie;
+    fill_sample(trie);
+    FrozenTrie frozen;
+    frozen.build(trie);
+    const std::vector<char> blob = frozen.serialize();
+
+    FrozenTrie copied;
+    copied.deserialize(blob);
+    FrozenTrie viewed;
+    viewed.view(blob.data(), blob.size());
+    for (const std::string text : { "abcdefg", "bandana", "\xE2\x96\x81them", "x39", "\x80\x81" }) {
+        EXPECT_EQ(copied.all_prefixes(text, 0), frozen.all_prefixes(text, 0));
+        EXPECT_EQ(viewed.all_prefixes(text, 0), frozen.all_prefixes(text, 0));
+    }
+    EXPECT_EQ(viewed.node_count(), frozen.node_count());
+
+    const std::string path = ::testing::TempDir() + "frozen_trie_test.bin";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+    }
+    FrozenTrie mapped;
+    mapped.map_file(path);
+    EXPECT_EQ(mapped.get_id("banana"), 5);
+    std::remove(path.c_str());
+
+    std::vector<char> damaged = blob;
+    damaged[0] = 'X';
+    EXPECT_THROW(copied.deserialize(damaged), TokenizerException);
+    EXPECT_THROW(copied.deserialize(blob.data(), blob.size() - 1), TokenizerException);
+    damaged = blob;
+    damaged[32 + 1024 + 12 * 3] ^= 0x7F;  // first_child of node 3
+    EXPECT_THROW(copied.deserialize(damaged), TokenizerException);
+    EXPECT_EQ(copied.get_id("abc"), 2);  // unchanged on failure
+}
+
+} // namespace
+} // namespace auratokenizer
@@ -0,0 +1,178 @@
+#include "unicode_normalizer.h"
+#include "icu_utils.h"
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace auratokenizer {
+namespace {
+
+// The straightforward whole-string ICU round trip the fast paths must reproduce.
+std::string reference_normalize(const std::string& text, NormalizationForm form) {
+    UErrorCode status = U_ZERO_ERROR;
+    const icu::Normalizer2* normalizer = nullptr;
+    switch (form) {
+    case NormalizationForm::NFC: normalizer = icu::Normalizer2::getNFCInstance(status); break;
+    case NormalizationForm::NFD: normalizer = icu::Normalizer2::getNFDInstance(status); break;
+    case NormalizationForm::NFKC: normalizer = icu::Normalizer2::getNFKCInstance(status); break;
+    case NormalizationForm::NFKD: normalizer = icu::Normalizer2::getNFKDInstance(status); break;
+    default: return text;
+    }
+    icu::UnicodeString out;
+    normalizer->normalize(icu::UnicodeString::fromUTF8(text), out, status);
+    std::string result;
+    out.toUTF8String(result);
+    return result;
+}
+
+std::string reference_lower(const std::string& text) {
+    icu::UnicodeString ustr = icu::UnicodeString::fromUTF8(text);
+    ustr.toLower();
+    std::string result;
+    ustr.toUTF8String(result);
+    return result;
+}
+
+std::string random_text(std::mt19937& rng) {
+    // ASCII runs mixed with composed and decomposed letters, marks, compatibility
+    // characters, CJK, Hangul jamo and ill-formed bytes.
+    static const std::vector<std::string> parts = {
+        "a", "e", "Z", " ", "hello", "\t", "\xCC\x81", "\xCC\xA3", "\xC3\xA9", "\xC3\x85",
+        "\xEF\xAC\x81", "\xEF\xBC\xA1", "\xE2\x91\xA0", "\xE4\xB8\xAD", "\xE1\x84\x80", "\xE1\x85\xA1",
+        "\xCE\xA3", "\xC4\xB0", "\xFF", "\xC3", "\xE4\xB8", "\xED\xA0\x80" };
+    std::string text;
+    const size_t count = rng() % 12;
+    for (size_t i = 0; i < count; ++i) text += parts[rng() % parts.size()];
+    return text;
+}
+
+TEST(UnicodeNormalizer, FastPathsMatchTheFullIcuRoundTrip) {
+    std::mt19937 rng(5);
+    const NormalizationForm forms[] = { NormalizationForm::NFC, NormalizationForm::NFD,
+                                        NormalizationForm::NFKC, NormalizationForm::NFKD };
+    for (int round = 0; round < 3000; ++round) {
+        const std::string text = random_text(rng);
+        for (NormalizationForm form : forms) {
+            EXPECT_EQ(icu_utils::ICUUtils::normalize(text, form), reference_normalize(text, form)) << text;
+        }
+        EXPECT_EQ(icu_utils::ICUUtils::to_lower(text), reference_lower(text)) << text;
+    }
+
+    std::string all_ascii;
+    for (int c = 0; c < 128; ++c) all_ascii.push_back(static_cast<char>(c));
+    EXPECT_EQ(icu_utils::ICUUtils::to_lower(all_ascii), reference_lower(all_ascii));
+    EXPECT_EQ(icu_utils::ICUUtils::strip_accents(all_ascii), all_ascii);
+    EXPECT_TRUE(icu_utils::ICUUtils::is_valid_utf8("caf\xC3\xA9"));
+    EXPECT_FALSE(icu_utils::ICUUtils::is_valid_utf8("caf\xC3"));
+}
+
+TEST(UnicodeNormalizer, AsciiInputSkipsIcuButKeepsTheSameSteps) {
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NFKC;
+    config.lowercase = true;
+    config.strip_accents = true;
+    UnicodeNormalizer normalizer(config);
+
+    EXPECT_EQ(normalizer.normalize("Hello, World!"), "hello, world!");
+    // A combining accent after ASCII still composes, then strips.
+    EXPECT_EQ(normalizer.normalize("Cafe\xCC\x81 OK"), "cafe ok");
+    // Compatibility characters that fold to ASCII.
+    EXPECT_EQ(normalizer.normalize("\xEF\xBC\xA1\xEF\xAC\x81"), "afi");
+}
+
+TEST(UnicodeNormalizer, FusedPipelineMatchesTheStepByStepRoundTrips) {
+    std::mt19937 rng(9);
+    for (NormalizationForm form : { NormalizationForm::NONE, NormalizationForm::NFC, NormalizationForm::NFKD }) {
+        for (int options = 0; options < 4; ++options) {
+            TokenizerConfig config;
+            config.normalization = form;
+            config.normalize_whitespace = false;
+            config.remove_control_chars = false;
+            config.strip_accents = (options & 1) != 0;
+            config.lowercase = (options & 2) != 0;
+            UnicodeNormalizer normalizer(config);
+
+            std::string out;
+            for (int round = 0; round < 300; ++round) {
+                const std::string text = random_text(rng);
+                // Any ICU step replaces ill-formed bytes with U+FFFD.
+                std::string expected = reference_normalize(text, form);
+                if (form == NormalizationForm::NONE && (config.strip_accents || config.lowercase)) {
+                    expected.clear();
+                    icu::UnicodeString::fromUTF8(text).toUTF8String(expected);
+                }
+                if (config.strip_accents) expected = icu_utils::ICUUtils::strip_accents(expected);
+                if (config.lowercase) expected = reference_lower(expected);
+                normalizer.normalize_into(text, out);
+                EXPECT_EQ(out, expected) << text;
+            }
+        }
+    }
+}
+
+TEST(UnicodeNormalizer, CleansWhitespaceAndControlsAndRemovesDiacritics) {
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NONE;
+    UnicodeNormalizer normalizer(config);  // cleanup is opt-in
+    EXPECT_TRUE(normalizer.is_identity());
+    EXPECT_EQ(normalizer.normalize("a\tb\r\n"), "a\tb\r\n");
+
+    config.normalize_whitespace = true;
+    config.remove_control_chars = true;
+    normalizer.set_config(config);
+    EXPECT_FALSE(normalizer.is_identity());
+    EXPECT_EQ(normalizer.normalize("a\tb\r\nc\x01\x7F\vd"), "a b  c d");
+    EXPECT_EQ(normalizer.normalize("x\xC2\xA0y\xE2\x80\x83z\xE2\x80\x8B!\xC2\x85"), "x y z! ");
+    EXPECT_EQ(normalizer.normalize(std::string("nul\0", 4)), "nul");
+    EXPECT_EQ(normalizer.normalize("bad\xFF"), "bad\xEF\xBF\xBD");
+
+    config.normalize_whitespace = false;
+    config.remove_control_chars = false;
+    config.remove_diacritics = true;
+    config.normalization = NormalizationForm::NFC;
+    normalizer.set_config(config);
+    // Marks go, the script stays (strip_accents would transliterate to Latin).
+    EXPECT_EQ(normalizer.normalize("Cr\xC3\xA8me \xD0\xB9 \xE4\xB8\xAD\t"), "Creme \xD0\xB8 \xE4\xB8\xAD\t");
+    config.normalization = NormalizationForm::NFD;
+    normalizer.set_config(config);
+    EXPECT_EQ(normalizer.normalize("\xC3\x85ngstr\xC3\xB6m"), "Angstrom");
+
+    // normalize_view() may be given a view of its own scratch buffer.
+    std::string scratch = "Caf\xC3\xA9";
+    std::string_view view = normalizer.normalize_view(scratch, scratch);
+    EXPECT_EQ(view, "Cafe");
+}
+
+TEST(UnicodeNormalizer, IcuHelpersAreSafeToCallFromManyThreads) {
+    const std::string text = "Cr\xC3\xA8me br\xC3\xBBl\xC3\xA9" "e, \xD0\xBC\xD0\xB8\xD1\x80! \xE6\x97\xA5\xE6\x9C\xAC. Next one?";
+    using icu_utils::ICUUtils;
+    const std::string nfkd = ICUUtils::normalize(text, NormalizationForm::NFKD);
+    const std::string stripped = ICUUtils::strip_accents(text);
+    const std::vector<std::string> words = ICUUtils::segment_words(text);
+    const std::vector<std::string> sentences = ICUUtils::segment_sentences(text);
+    const std::vector<std::string> characters = ICUUtils::segment_characters(text);
+
+    std::vector<int> mismatches(8, 0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < mismatches.size(); ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 200; ++i) {
+                mismatches[t] += ICUUtils::normalize(text, NormalizationForm::NFKD) != nfkd;
+                mismatches[t] += ICUUtils::strip_accents(text) != stripped;
+                mismatches[t] += ICUUtils::segment_words(text) != words;
+                mismatches[t] += ICUUtils::segment_sentences(text) != sentences;
+                mismatches[t] += ICUUtils::segment_characters(text) != characters;
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    for (int count : mismatches) EXPECT_EQ(count, 0);
+    EXPECT_EQ(sentences.size(), 3u);
+    EXPECT_EQ(stripped, "Creme brulee, mir! ri ben. Next one?");
+}
+
+} // namespace
+} // namespace auratokenizer
@@ -0,0 +1,74 @@
+#include "unigram_tokenizer.h"
+#include "unigram_trainer.h"
+#include <gtest/gtest.h>
+
+namespace auratokenizer {
+namespace {
+
+std::vector<std::string> make_corpus() {
+    std::vector<std::string> corpus;
+    for (int i = 0; i < 50; ++i) {
+        corpus.push_back("the quick brown fox jumps over the lazy dog");
+        corpus.push_back("the lazy dog sleeps while the quick fox runs");
+        corpus.push_back("a quick brown dog and a lazy brown fox");
+    }
+    return corpus;
+}
+
+TEST(UnigramTrainer, TrainsWithinBudgetAndKeepsCharacters) {
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NONE;
+    config.max_tokens = 40; // small enough to force pruning rounds
+    UnigramTrainer trainer(config);
+    trainer.set_num_threads(3);
+
+    std::vector<UnigramTrainer::RoundStats> reported;
+    trainer.set_progress_callback([&](const UnigramTrainer::RoundStats& stats) { reported.push_back(stats); });
+    trainer.train(make_corpus());
+
+    auto vocab = trainer.get_vocab();
+    EXPECT_LE(vocab->size(), 40u);
+    for (char c : std::string("thequickbrownfxjmpsvlazydg ")) {
+        EXPECT_TRUE(vocab->has_token(std::string(1, c))) << c;
+    }
+    EXPECT_TRUE(vocab->has_token(" the") || vocab->has_token(" lazy") || vocab->has_token(" quick"));
+
+    // Rounds shrink the piece set and are reported with timings.
+    ASSERT_GE(reported.size(), 2u);
+    EXPECT_EQ(reported.size(), trainer.get_round_stats().size());
+    EXPECT_GE(reported.front().prune_ms, 0.0);
+    for (size_t i = 1; i < reported.size(); ++i) EXPECT_LE(reported[i].pieces, reported[i - 1].pieces);
+    EXPECT_GT(reported.front().objective, 0.0);
+    EXPECT_GE(reported.front().em_ms, 0.0);
+
+    // Scores are log-probabilities and plug straight into the tokenizer.
+    for (const auto& [piece, score] : trainer.get_scores()) EXPECT_LT(score, 0.0f) << piece;
+    UnigramTokenizer tokenizer(config);
+    tokenizer.set_vocab_and_scores(vocab, trainer.get_scores());
+    const std::string text = "the quick brown fox";
+    std::vector<Token> tokens = tokenizer.encode(text);
+    EXPECT_LT(tokens.size(), text.size());
+    EXPECT_EQ(tokenizer.decode(tokens), text);
+}
+
+TEST(UnigramTrainer, ResultDoesNotDependOnThreadCount) {
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NONE;
+    config.max_tokens = 50;
+
+    UnigramTrainer single(config), multi(config);
+    single.set_num_threads(1);
+    multi.set_num_threads(4);
+    single.train(make_corpus());
+    multi.train(make_corpus());
+
+    ASSERT_EQ(single.get_scores().size(), multi.get_scores().size());
+    for (const auto& [piece, score] : single.get_scores()) {
+        auto it = multi.get_scores().find(piece);
+        ASSERT_NE(it, multi.get_scores().end()) << piece;
+        EXPECT_NEAR(it->second, score, 1e-4f);
+    }
+}
+
+} // namespace
+} // namespace auratokenizer
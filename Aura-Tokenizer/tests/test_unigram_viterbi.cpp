@@ -0,0 +1,164 @@
+#include "unigram_tokenizer.h"
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <thread>
+
+namespace auratokenizer {
+namespace {
+
+TokenizerConfig plain_config() {
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NONE;
+    return config;
+}
+
+std::vector<std::string> texts(const std::vector<Token>& tokens) {
+    std::vector<std::string> result;
+    for (const auto& t : tokens) result.push_back(t.text);
+    return result;
+}
+
+std::unique_ptr<UnigramTokenizer> make_tokenizer(const std::unordered_map<std::string, float>& scores) {
+    auto tokenizer = std::make_unique<UnigramTokenizer>(plain_config());
+    auto vocab = std::make_shared<Vocab>();
+    tokenizer->set_vocab(vocab);
+    for (const auto& [piece, score] : scores) vocab->add_token(piece);
+    tokenizer->set_vocab_and_scores(vocab, scores);
+    return tokenizer;
+}
+
+TEST(UnigramViterbi, PicksHighestScoringPath) {
+    std::unordered_map<std::string, float> scores = {
+        { "a", -2.0f }, { "b", -2.0f }, { "c", -1.0f }, { "ab", -1.0f }, { "abc", -5.0f }, { "bc", -0.5f }
+    };
+    // ab+c = -2.0 beats a+bc = -2.5, a+b+c = -5.0 and abc = -5.0.
+    EXPECT_EQ(texts(make_tokenizer(scores)->encode("abc")), (std::vector<std::string>{ "ab", "c" }));
+
+    scores["abc"] = -1.5f;
+    EXPECT_EQ(texts(make_tokenizer(scores)->encode("abc")), (std::vector<std::string>{ "abc" }));
+}
+
+TEST(UnigramViterbi, MatchesExhaustiveSearch) {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> score(-8.0f, -0.1f);
+    std::unordered_map<std::string, float> scores = { { "a", -3.0f }, { "b", -3.0f }, { "c", -3.0f } };
+    const std::string alphabet = "abc";
+    for (int i = 0; i < 40; ++i) {
+        std::string piece;
+        int len = 2 + static_cast<int>(rng() % 4);
+        for (int k = 0; k < len; ++k) piece.push_back(alphabet[rng() % 3]);
+        scores[piece] = score(rng);
+    }
+    auto tokenizer = make_tokenizer(scores);
+
+    for (int trial = 0; trial < 50; ++trial) {
+        std::string text;
+        int len = 1 + static_cast<int>(rng() % 14);
+        for (int k = 0; k < len; ++k) text.push_back(alphabet[rng() % 3]);
+
+        // Reference DP over substrings.
+        std::vector<float> best(text.size() + 1, -std::numeric_limits<float>::infinity());
+        best[0] = 0.0f;
+        for (size_t end = 1; end <= text.size(); ++end) {
+            for (size_t begin = 0; begin < end; ++begin) {
+                auto it = scores.find(text.substr(begin, end - begin));
+                if (it != scores.end()) best[end] = std::max(best[end], best[begin] + it->second);
+            }
+        }
+
+        float total = 0.0f;
+        std::string joined;
+        for (const auto& token : tokenizer->encode(text)) {
+            total += scores.at(token.text);
+            joined += token.text;
+        }
+        EXPECT_EQ(joined, text);
+        EXPECT_NEAR(total, best[text.size()], 1e-4f) << text;
+    }
+}
+
+TEST(UnigramViterbi, UnknownCharactersFallBack) {
+    auto tokenizer = make_tokenizer({ { "a", -1.0f }, { "b", -1.0f }, { "ab", -1.0f } });
+    int unk = tokenizer->get_special_token_id(SpecialTokenType::UNK);
+
+    EncodeBuffer buffer;
+    tokenizer->encode_into("ab\xC3\xA9" "b", buffer); // "abéb"
+    ASSERT_EQ(buffer.size(), 3u);
+    EXPECT_EQ(buffer.ids[1], unk);
+    EXPECT_EQ(buffer.offsets[1].start, 2);
+    EXPECT_EQ(buffer.offsets[1].end, 4); // the whole two-byte character
+
+    // With "<0xXX>" pieces present, unknown characters become bytes instead.
+    auto vocab = std::make_shared<Vocab>();
+    UnigramTokenizer bytes(plain_config());
+    bytes.set_vocab(vocab);
+    char name[8];
+    for (int b = 0; b < 256; ++b) {
+        std::snprintf(name, sizeof(name), "<0x%02X>", b);
+        vocab->add_token(name);
+    }
+    vocab->add_token("a");
+    bytes.set_vocab_and_scores(vocab, { { "a", -1.0f } });
+    std::vector<int> expected = { vocab->get_token_id("a"), vocab->get_token_id("<0xC3>"), vocab->get_token_id("<0xA9>") };
+    EXPECT_EQ(bytes.encode_to_ids("a\xC3\xA9"), expected);
+    // Consecutive byte pieces decode back to the raw bytes.
+    EXPECT_EQ(bytes.decode_from_ids(expected), "a\xC3\xA9");
+    EXPECT_EQ(bytes.decode(bytes.encode("a\xC3\xA9")), "a\xC3\xA9");
+    DecodeStream stream = bytes.decode_stream();
+    EXPECT_EQ(stream.step(expected[0]), "a");
+    EXPECT_EQ(stream.step(expected[1]), "");  // held until the character is complete
+    EXPECT_EQ(stream.step(expected[2]), "\xC3\xA9");
+
+    // Literal "<0x41>" in the input is text, not the byte piece.
+    const std::vector<int> literal = bytes.encode_to_ids("<0x41>");
+    EXPECT_EQ(std::count(literal.begin(), literal.end(), vocab->get_token_id("<0x41>")), 0);
+    EXPECT_EQ(bytes.decode_from_ids(literal), "<0x41>");
+}
+
+TEST(UnigramViterbi, ReadsScoresAndFlagsFromVocab) {
+    auto vocab = std::make_shared<Vocab>();
+    UnigramTokenizer tokenizer(plain_config());
+    tokenizer.set_vocab(vocab);
+    vocab->add_token_with_score("a", -2.0);
+    vocab->add_token_with_score("b", -2.0);
+    vocab->add_token_with_score("ab", -1.0);
+    vocab->add_token_with_score("abab", -1.5);
+    tokenizer.set_vocab(vocab);
+    EXPECT_EQ(texts(tokenizer.encode("abab")), (std::vector<std::string>{ "abab" }));
+
+    // Unused pieces are left out of the lattice.
+    vocab->set_flags(vocab->get_token_id("abab"), Vocab::UNUSED);
+    tokenizer.set_vocab(vocab);
+    EXPECT_EQ(texts(tokenizer.encode("abab")), (std::vector<std::string>{ "ab", "ab" }));
+}
+
+TEST(UnigramViterbi, EncodingOnlyReadsTheIndex) {
+    auto vocab = std::make_shared<Vocab>();
+    UnigramTokenizer tokenizer(plain_config());
+    vocab->add_token_with_score("ab", -1.0);
+    vocab->add_token_with_score("c", -1.0);
+    tokenizer.set_vocab(vocab);
+
+    // Changing the shared vocab takes effect at the next set_vocab(), not mid-encode.
+    vocab->add_token_with_score("abc", -0.5);
+    EXPECT_EQ(texts(tokenizer.encode("abc")), (std::vector<std::string>{ "ab", "c" }));
+    tokenizer.set_vocab(vocab);
+    const std::vector<int> expected = tokenizer.encode_to_ids("abcab");
+
+    std::vector<std::thread> threads;
+    std::vector<int> mismatches(4, 0);
+    for (size_t t = 0; t < mismatches.size(); ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 200; ++i) mismatches[t] += tokenizer.encode_to_ids("abcab") != expected;
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(mismatches, std::vector<int>(4, 0));
+}
+
+} // namespace
+} // namespace auratokenizer
@@ -0,0 +1,195 @@
+#include "vocab.h"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace auratokenizer {
+namespace {
+
+TEST(Vocab, LooksUpTokensAndIdsAcrossGrowth) {
+    Vocab vocab;
+    vocab.add_special_token("[UNK]", SpecialTokenType::UNK);
+    for (int i = 0; i < 5000; ++i) vocab.add_token("tok" + std::to_string(i));
+    vocab.add_token("tok7");  // duplicates are ignored
+    vocab.add_token("");
+
+    ASSERT_EQ(vocab.size(), 5001u);
+    EXPECT_EQ(vocab.get_special_token_id(SpecialTokenType::UNK), 0);
+    EXPECT_TRUE(vocab.is_special_token("[UNK]"));
+    for (int i = 0; i < 5000; i += 37) {
+        const std::string token = "tok" + std::to_string(i);
+        EXPECT_EQ(vocab.get_token_id(token), i + 1);
+        EXPECT_EQ(vocab.get_token(i + 1), token);
+        EXPECT_EQ(vocab.get_token_view(i + 1), token);
+    }
+    EXPECT_EQ(vocab.get_token_id("tok5000"), -1);
+    EXPECT_FALSE(vocab.has_token("to"));
+
+    // Views into a larger buffer need no copy to be looked up.
+    const std::string text = "xxtok42yy";
+    EXPECT_EQ(vocab.find_token_id(std::string_view(text).substr(2, 5)), 43);
+}
+
+TEST(Vocab, ExplicitIdsLeaveGapsAndUnknownIdsAreEmpty) {
+    Vocab vocab;
+    vocab.add_token("a", 10);
+    vocab.add_token("b");
+    vocab.add_token("c", 3);
+
+    EXPECT_EQ(vocab.get_token_id("b"), 11);
+    EXPECT_EQ(vocab.get_token_id("c"), 3);
+    EXPECT_TRUE(vocab.has_id(10));
+    EXPECT_FALSE(vocab.has_id(4));
+    EXPECT_FALSE(vocab.has_id(-1));
+    EXPECT_TRUE(vocab.get_token_view(4).empty());
+    EXPECT_TRUE(vocab.get_token_view(100).empty());
+    EXPECT_EQ(vocab.get_token(-5), "");
+
+    std::vector<std::pair<std::string, int>> entries;
+    vocab.for_each_token([&](std::string_view token, int id) { entries.emplace_back(token, id); });
+    EXPECT_EQ(entries, (std::vector<std::pair<std::string, int>>{ { "a", 10 }, { "b", 11 }, { "c", 3 } }));
+    EXPECT_EQ(vocab.get_token_to_id().at("b"), 11);
+
+    vocab.clear();
+    EXPECT_EQ(vocab.size(), 0u);
+    EXPECT_EQ(vocab.get_token_id("a"), -1);
+    vocab.add_token("z");
+    EXPECT_EQ(vocab.get_token_id("z"), 0);
+}
+
+Vocab sample_vocab() {
+    Vocab vocab;
+    vocab.add_special_token("[UNK]", SpecialTokenType::UNK);
+    vocab.add_special_token("[CLS]", SpecialTokenType::CLS);
+    for (int i = 0; i < 300; ++i) vocab.add_token("w" + std::to_string(i * 7));
+    vocab.add_token("gap", 1000);
+    return vocab;
+}
+
+void expect_same(const Vocab& a, const Vocab& b) {
+    ASSERT_EQ(a.size(), b.size());
+    a.for_each_token([&](std::string_view token, int id) {
+        EXPECT_EQ(b.find_token_id(token), id) << token;
+        EXPECT_EQ(b.get_token_view(id), token);
+        EXPECT_EQ(b.is_special_token_id(id), a.is_special_token_id(id));
+    });
+    EXPECT_EQ(b.get_special_token_id(SpecialTokenType::CLS), a.get_special_token_id(SpecialTokenType::CLS));
+    EXPECT_FALSE(b.has_id(999));
+}
+
+TEST(Vocab, BinaryRoundTripInsideALargerStream) {
+    const Vocab vocab = sample_vocab();
+    std::stringstream stream;
+    stream << "prefix";
+    vocab.save(stream);
+    stream << "suffix";
+
+    std::string prefix(6, '\0');
+    stream.read(&prefix[0], 6);
+    Vocab loaded;
+    loaded.add_token("stale");
+    loaded.load(stream);
+    expect_same(vocab, loaded);
+    EXPECT_FALSE(loaded.has_token("stale"));
+    std::string suffix;
+    stream >> suffix;
+    EXPECT_EQ(suffix, "suffix");
+
+    // New ids continue after the highest saved id.
+    loaded.add_token("next");
+    EXPECT_EQ(loaded.get_token_id("next"), 1001);
+}
+
+TEST(Vocab, MappedFileServesLookupsInPlaceAndRejectsDamage) {
+    const std::string path = ::testing::TempDir() + "vocab_test.bin";
+    const Vocab vocab = sample_vocab();
+    vocab.save(path);
+
+    Vocab mapped;
+    mapped.map_file(path, false);
+    EXPECT_TRUE(mapped.is_mapped());
+    expect_same(vocab, mapped);
+
+    // Copies share the mapping; modifying one copies its tables into memory.
+    Vocab copy = mapped;
+    copy.add_token("extra");
+    EXPECT_FALSE(copy.is_mapped());
+    EXPECT_TRUE(mapped.is_mapped());
+    EXPECT_FALSE(mapped.has_token("extra"));
+    EXPECT_EQ(copy.get_token_id("w7"), mapped.get_token_id("w7"));
+
+    std::string bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    std::string damaged = bytes;
+    damaged[damaged.size() / 2] ^= 0x20;
+    std::istringstream damaged_stream(damaged);
+    Vocab rejected = sample_vocab();
+    EXPECT_THROW(rejected.load(damaged_stream), TokenizerException);
+    expect_same(vocab, rejected);  // unchanged on failure
+
+    std::istringstream truncated(bytes.substr(0, bytes.size() - 8));
+    EXPECT_THROW(rejected.load(truncated), TokenizerException);
+    std::istringstream not_vocab(std::string(64, 'x'));
+    EXPECT_THROW(rejected.load(not_vocab), TokenizerException);
+
+    // The header's file_size is checked before anything is allocated from it.
+    for (uint64_t file_size : { ~uint64_t(0), uint64_t(1) << 40, uint64_t(1) << 30, uint64_t(bytes.size()) + 4 }) {
+        std::string corrupt = bytes;
+        std::memcpy(&corrupt[16], &file_size, sizeof(file_size));
+        std::istringstream corrupt_stream(corrupt);
+        EXPECT_THROW(rejected.load(corrupt_stream), TokenizerException) << file_size;
+    }
+    expect_same(vocab, rejected);
+    std::remove(path.c_str());
+}
+
+TEST(Vocab, ScoresAndFlagsAreIndexedById) {
+    Vocab vocab;
+    vocab.add_special_token("<unk>", SpecialTokenType::UNK);
+    vocab.add_token("x");
+    vocab.add_token_with_score("y", -1.5);
+    vocab.add_token_with_score("x", -0.25);  // existing token: only the score changes
+    vocab.add_token("<0x41>");
+    vocab.add_token("<0xZZ>");
+
+    const int unk = vocab.get_token_id("<unk>");
+    const int x = vocab.get_token_id("x");
+    EXPECT_EQ(vocab.size(), 5u);
+    EXPECT_FLOAT_EQ(vocab.score(x), -0.25f);
+    EXPECT_FLOAT_EQ(vocab.score(vocab.get_token_id("y")), -1.5f);
+    EXPECT_TRUE(vocab.has_score(x));
+    EXPECT_FALSE(vocab.has_score(unk));
+    EXPECT_EQ(vocab.score(99), 0.0f);
+    EXPECT_EQ(vocab.flags(unk), Vocab::SPECIAL);
+    EXPECT_EQ(vocab.flags(vocab.get_token_id("<0x41>")), Vocab::BYTE_FALLBACK);
+    EXPECT_EQ(vocab.flags(vocab.get_token_id("<0xZZ>")), 0);
+    EXPECT_EQ(Vocab::byte_value("<0x41>"), 0x41);
+    EXPECT_EQ(Vocab::byte_value("<0xe9>"), 0xE9);
+    EXPECT_EQ(Vocab::byte_value("<0xZZ>"), -1);
+
+    vocab.set_flags(x, Vocab::UNUSED);
+    vocab.set_flags(unk, 0, Vocab::SPECIAL);
+    EXPECT_FALSE(vocab.is_special_token_id(unk));
+    vocab.set_flags(unk, Vocab::SPECIAL);
+
+    std::stringstream stream;
+    vocab.save(stream);
+    Vocab loaded;
+    loaded.load(stream);
+    for (int id = 0; id < 5; ++id) {
+        EXPECT_EQ(loaded.flags(id), vocab.flags(id)) << id;
+        EXPECT_EQ(loaded.score(id), vocab.score(id)) << id;
+    }
+    EXPECT_TRUE(loaded.is_special_token("<unk>"));
+}
+
+} // namespace
+} // namespace auratokenizer
@@ -0,0 +1,130 @@
+#include "wordpiece_model.h"
+#include "wordpiece_tokenizer.h"
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace auratokenizer {
+namespace {
+
+using Span = models::WordPieceModel::PieceSpan;
+
+// The classic greedy longest-match-first algorithm, probing every length.
+std::vector<Span> reference_spans(const std::unordered_map<std::string, int>& vocab, const std::string& word) {
+    std::vector<Span> out;
+    size_t start = 0;
+    while (start < word.size()) {
+        size_t end = word.size();
+        int id = -1;
+        for (; end > start; --end) {
+            auto it = vocab.find((start > 0 ? "##" : "") + word.substr(start, end - start));
+            if (it != vocab.end()) {
+                id = it->second;
+                break;
+            }
+        }
+        if (id < 0) {
+            out.push_back(Span{ start, word.size(), true });
+            break;
+        }
+        out.push_back(Span{ start, end, false, id });
+        start = end;
+    }
+    return out;
+}
+
+void expect_same(const std::vector<Span>& actual, const std::vector<Span>& expected, const std::string& word) {
+    ASSERT_EQ(actual.size(), expected.size()) << word;
+    for (size_t i = 0; i < actual.size(); ++i) {
+        EXPECT_EQ(actual[i].begin, expected[i].begin) << word;
+        EXPECT_EQ(actual[i].end, expected[i].end) << word;
+        EXPECT_EQ(actual[i].unk, expected[i].unk) << word;
+        if (!expected[i].unk) {
+            EXPECT_EQ(actual[i].id, expected[i].id) << word;
+        }
+    }
+}
+
+TEST(FastWordPiece, MatchesGreedyReferenceOnRandomVocabs) {
+    std::mt19937 rng(3);
+    const std::string alphabet = "ab#c";
+    auto random_string = [&](size_t max_len) {
+        std::string s;
+        for (size_t k = 0, len = 1 + rng() % max_len; k < len; ++k) s += alphabet[rng() % alphabet.size()];
+        return s;
+    };
+    for (int round = 0; round < 200; ++round) {
+        std::unordered_map<std::string, int> vocab;
+        for (int k = 0, n = 1 + static_cast<int>(rng() % 25); k < n; ++k) {
+            std::string token = random_string(4);
+            if (rng() % 2) token = "##" + token;
+            vocab.emplace(token, static_cast<int>(vocab.size()));
+        }
+        models::WordPieceModel model;
+        model.initialize(vocab, "[UNK]");
+        for (int w = 0; w < 30; ++w) {
+            std::string word = random_string(10);
+            std::vector<Span> spans;
+            model.tokenize_spans(word, spans);
+            expect_same(spans, reference_spans(vocab, word), word);
+        }
+    }
+}
+
+TEST(FastWordPiece, KeepsPiecesBeforeUnknownAndHandlesUtf8) {
+    std::unordered_map<std::string, int> vocab = {
+        { "[UNK]", 0 }, { "un", 1 }, { "##aff", 2 }, { "##able", 3 }, { "caf", 4 }, { "##\xC3\xA9", 5 }, { "##", 6 }
+    };
+    models::WordPieceModel model;
+    model.initialize(vocab, "[UNK]");
+
+    EXPECT_EQ(model.tokenize("unaffable"), (std::vector<std::string>{ "un", "##aff", "##able" }));
+    EXPECT_EQ(model.tokenize("caf\xC3\xA9"), (std::vector<std::string>{ "caf", "##\xC3\xA9" }));
+    EXPECT_EQ(model.tokenize("##"), (std::vector<std::string>{ "##" }));
+    EXPECT_EQ(model.tokenize("unaffxyz"), (std::vector<std::string>{ "un", "##aff", "[UNK]" }));
+    EXPECT_EQ(model.tokenize("xyz"), (std::vector<std::string>{ "[UNK]" }));
+    EXPECT_TRUE(model.tokenize("").empty());
+}
+
+TEST(FastWordPiece, EnforcesMaxInputCharsPerWord) {
+    models::WordPieceModel model;
+    model.initialize({ { "[UNK]", 0 }, { "a", 1 }, { "##a", 2 }, { "\xC3\xA9", 3 }, { "##\xC3\xA9", 4 } }, "[UNK]", 3);
+    EXPECT_EQ(model.tokenize("aaa").size(), 3u);
+    EXPECT_EQ(model.tokenize("aaaa"), (std::vector<std::string>{ "[UNK]" }));
+    // The limit counts characters, not bytes.
+    EXPECT_EQ(model.tokenize("\xC3\xA9\xC3\xA9\xC3\xA9").size(), 3u);
+}
+
+TEST(FastWordPiece, TokenizerUsesModelIds) {
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NONE;
+    WordPieceTokenizer tokenizer(config);
+    auto model = std::make_shared<models::WordPieceModel>();
+    model->initialize({ { "un", 100 }, { "##aff", 101 }, { "##able", 102 } }, "[UNK]");
+    tokenizer.set_wordpiece_model(model);
+    EXPECT_EQ(tokenizer.encode_to_ids("unaffable"), (std::vector<int>{ 100, 101, 102 }));
+
+    std::vector<Token> tokens = tokenizer.encode("unaffable");
+    ASSERT_EQ(tokens.size(), 3u);
+    EXPECT_EQ(tokens[1].text, "##aff");
+    EXPECT_EQ(tokens[2].id, 102);
+}
+
+TEST(FastWordPiece, TokenizerSplitsWordsWithoutBertPipeline) {
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NONE;
+    WordPieceTokenizer tokenizer(config);
+    auto model = std::make_shared<models::WordPieceModel>();
+    model->initialize({ { "[UNK]", 0 }, { "un", 1 }, { "##aff", 2 }, { "##able", 3 }, { ",", 4 }, { "Aff", 5 } }, "[UNK]");
+    tokenizer.set_wordpiece_model(model);
+    EXPECT_EQ(tokenizer.encode_to_ids("unaffable, Aff\tun"), (std::vector<int>{ 1, 2, 3, 4, 5, 1 }));
+
+    std::vector<Token> tokens = tokenizer.encode("un,Aff");
+    ASSERT_EQ(tokens.size(), 3u);
+    EXPECT_EQ(tokens[2].text, "Aff");
+    EXPECT_EQ(tokens[2].offset.start, 3);
+    EXPECT_EQ(tokens[2].offset.end, 6);
+}
+
+} // namespace
+} // namespace auratokenizer
@@ -0,0 +1,159 @@
+#include "wordpiece_trainer.h"
+#include "wordpiece_tokenizer.h"
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+
+namespace auratokenizer {
+namespace {
+
+TokenizerConfig plain_config(size_t vocab_size) {
+    TokenizerConfig config;
+    config.normalization = NormalizationForm::NONE;
+    config.vocab_size = vocab_size;
+    config.min_frequency = 2;
+    return config;
+}
+
+std::vector<std::string> vocab_tokens(const Vocab& vocab) {
+    std::vector<std::string> tokens;
+    for (size_t id = 0; id < vocab.size(); ++id) tokens.push_back(vocab.get_token(static_cast<int>(id)));
+    return tokens;
+}
+
+// Recounts everything after every merge; same scoring and tie-breaking.
+std::vector<std::string> naive_merges(const std::map<std::string, int64_t>& words, size_t merges, int64_t min_frequency) {
+    std::vector<std::pair<std::vector<std::string>, int64_t>> split;
+    for (const auto& [word, count] : words) {
+        std::vector<std::string> symbols;
+        for (size_t i = 0; i < word.size(); ++i) symbols.push_back((i ? "##" : "") + word.substr(i, 1));
+        split.emplace_back(symbols, count);
+    }
+    std::vector<std::string> result;
+    while (result.size() < merges) {
+        std::map<std::string, int64_t> symbol_counts;
+        std::map<std::pair<std::string, std::string>, int64_t> pair_counts;
+        for (const auto& [symbols, count] : split) {
+            for (size_t i = 0; i < symbols.size(); ++i) {
+                symbol_counts[symbols[i]] += count;
+                if (i + 1 < symbols.size()) pair_counts[{ symbols[i], symbols[i + 1] }] += count;
+            }
+        }
+        const std::pair<std::string, std::string>* best = nullptr;
+        long double best_score = -1;
+        int64_t best_count = 0;
+        for (const auto& [pair, count] : pair_counts) {
+            if (count < min_frequency) continue;
+            long double score = static_cast<long double>(count) / (static_cast<long double>(symbol_counts[pair.first]) * symbol_counts[pair.second]);
+            if (!best || score > best_score || (score == best_score && count > best_count)) {
+                best = &pair;
+                best_score = score;
+                best_count = count;
+            }
+        }
+        if (!best) break;
+        std::string merged = best->first + best->second.substr(best->second.rfind("##", 0) == 0 ? 2 : 0);
+        result.push_back(merged);
+        for (auto& [symbols, count] : split) {
+            std::vector<std::string> next;
+            for (size_t i = 0; i < symbols.size(); ++i) {
+                if (i + 1 < symbols.size() && symbols[i] == best->first && symbols[i + 1] == best->second) {
+                    next.push_back(merged);
+                    ++i;
+                } else {
+                    next.push_back(symbols[i]);
+                }
+            }
+            symbols.swap(next);
+        }
+    }
+    return result;
+}
+
+TEST(WordPieceTrainer, BuildsAlphabetWithContinuationsAndScoresByLikelihood) {
+    // "q"+"##u" always co-occur, so they score higher than the more frequent "##e"+"##r".
+    std::vector<std::string> corpus;
+    for (int i = 0; i < 3; ++i) corpus.push_back("queen quiz");
+    for (int i = 0; i < 10; ++i) corpus.push_back("ever never tree there");
+    WordPieceTrainer trainer(plain_config(100));
+    trainer.train(corpus);
+
+    auto vocab = trainer.get_vocab();
+    EXPECT_EQ(vocab->get_token(0), "[UNK]");
+    for (const std::string token : { "q", "##u", "e", "##e", "##r", "t" }) {
+        EXPECT_TRUE(vocab->has_token(token)) << token;
+    }
+    EXPECT_TRUE(vocab->has_token("qu"));
+    EXPECT_FALSE(vocab->has_token("##q"));
+
+    const auto tokens = vocab_tokens(*vocab);
+    auto position = [&](const std::string& token) {
+        return std::find(tokens.begin(), tokens.end(), token) - tokens.begin();
+    };
+    EXPECT_LT(position("qu"), position("##er"));
+}
+
+TEST(WordPieceTrainer, IncrementalMergesMatchNaiveRecount) {
+    std::mt19937 rng(5);
+    std::map<std::string, int64_t> words;
+    std::vector<std::string> corpus;
+    for (int line = 0; line < 120; ++line) {
+        std::string text;
+        for (int w = 0; w < 4; ++w) {
+            std::string word;
+            for (size_t k = 0, len = 1 + rng() % 6; k < len; ++k) word += static_cast<char>('a' + rng() % 4);
+            words[word]++;
+            text += word + " ";
+        }
+        corpus.push_back(text);
+    }
+    WordPieceTrainer trainer(plain_config(80));
+    trainer.set_num_threads(1);
+    trainer.train(corpus);
+
+    auto tokens = vocab_tokens(*trainer.get_vocab());
+    std::vector<std::string> expected = naive_merges(words, 80, 2);
+    size_t first_merge = tokens.size();
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        if (tokens[i].size() > 1 && !(tokens[i].size() == 3 && tokens[i].rfind("##", 0) == 0) && tokens[i][0] != '[') {
+            first_merge = i;
+            break;
+        }
+    }
+    ASSERT_LT(first_merge, tokens.size());
+    std::vector<std::string> learned(tokens.begin() + first_merge, tokens.end());
+    expected.resize(std::min(expected.size(), learned.size()));
+    ASSERT_GT(expected.size(), 10u);
+    EXPECT_EQ(std::vector<std::string>(learned.begin(), learned.begin() + expected.size()), expected);
+
+    WordPieceTrainer threaded(plain_config(80));
+    threaded.set_num_threads(4);
+    std::vector<std::string> big;
+    for (int copy = 0; copy < 8; ++copy) big.insert(big.end(), corpus.begin(), corpus.end());
+    threaded.train(big);
+    trainer.train(big);
+    EXPECT_EQ(vocab_tokens(*threaded.get_vocab()), vocab_tokens(*trainer.get_vocab()));
+}
+
+TEST(WordPieceTrainer, TrainedModelLoadsIntoTokenizer) {
+    TokenizerConfig config = plain_config(200);
+    config.base_model = ModelType::BERT;
+    config.lowercase = true;
+    std::vector<std::string> corpus;
+    for (int i = 0; i < 20; ++i) {
+        corpus.push_back("The unaffable tokenizer, unafraid, tokenized everything!");
+        corpus.push_back("Tokenizers tokenize; trainers train.");
+    }
+    WordPieceTokenizer tokenizer(config);
+    tokenizer.train(corpus, 200);
+
+    const std::string text = "The tokenizer trains!";
+    std::vector<int> ids = tokenizer.encode_to_ids(text);
+    ASSERT_FALSE(ids.empty());
+    EXPECT_LT(ids.size(), text.size());
+    EXPECT_EQ(tokenizer.decode_from_ids(ids), "the tokenizer trains !");
+}
+
+} // namespace
+} // namespace auratokenizer
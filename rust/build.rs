@@ -12,19 +12,28 @@ fn main() {
     println!("cargo:warning=Manifest Dir: {}", manifest_dir);
 
     cxx_build::bridge("src/ffi.rs")
+        .file("../Aura-Tokenizer/src/added_token_splitter.cpp")
+        .file("../Aura-Tokenizer/src/bert_pipeline.cpp")
+        .file("../Aura-Tokenizer/src/bpe_merge_engine.cpp")
         .file("../Aura-Tokenizer/src/bpe_tokenizer.cpp")
         .file("../Aura-Tokenizer/src/bpe_trainer.cpp")
+        .file("../Aura-Tokenizer/src/bpe_word_cache.cpp")
+        .file("../Aura-Tokenizer/src/byte_level.cpp")
         .file("../Aura-Tokenizer/src/byte_level_pre_tokenizer.cpp")
         .file("../Aura-Tokenizer/src/char_level_tokenizer.cpp")
+        .file("../Aura-Tokenizer/src/corpus_reader.cpp")
         .file("../Aura-Tokenizer/src/double_array_trie.cpp")
         .file("../Aura-Tokenizer/src/icu_integration.cpp")
         .file("../Aura-Tokenizer/src/icu_utils.cpp")
+        .file("../Aura-Tokenizer/src/normalized_string.cpp")
         .file("../Aura-Tokenizer/src/offsets.cpp")
         .file("../Aura-Tokenizer/src/plugin_registry.cpp")
         .file("../Aura-Tokenizer/src/post_processor.cpp")
         .file("../Aura-Tokenizer/src/pre_tokenizer.cpp")
+        .file("../Aura-Tokenizer/src/precompiled_charsmap.cpp")
         .file("../Aura-Tokenizer/src/serialization_utils.cpp")
         .file("../Aura-Tokenizer/src/streaming.cpp")
+        .file("../Aura-Tokenizer/src/suffix_array.cpp")
         .file("../Aura-Tokenizer/src/template_parser.cpp")
         .file("../Aura-Tokenizer/src/tokenizer_advanced.cpp")
         .file("../Aura-Tokenizer/src/tokenizer_base.cpp")
@@ -45,6 +54,7 @@ fn main() {
         .file("../Aura-Tokenizer/src/vocab.cpp")
         .file("../Aura-Tokenizer/src/wordpiece_model.cpp")
         .file("../Aura-Tokenizer/src/wordpiece_tokenizer.cpp")
+        .file("../Aura-Tokenizer/src/wordpiece_trainer.cpp")
         .file("bridge/bridge.cpp")
         .include("../Aura-Tokenizer/include")
         .include(icu_include)